@@ -0,0 +1,192 @@
+#include <string>
+#include "bayes_message_passing.h"
+#include "dataset.h"
+#include "instance_interface.h"
+#include "naive_bayes.h"
+#include "io/text_parser.h"
+#include "svm_light_reader.h"
+#include "bench_data.h"
+#include "benchmark.h"
+using namespace std;
+using namespace mlplus;
+using namespace mlplus::bench;
+
+static const int SPARSE_CLASSES = 6;
+
+static DataSet* winequality()
+{
+    static DataSet* dataset = readWinequality();
+    return dataset;
+}
+
+static DataSet* sparseClassify(int idShift)
+{
+    static DataSet* datasets[2] = {NULL, NULL};
+    DataSet*& dataset = datasets[idShift + 1];
+    if (dataset == NULL)
+    {
+        dataset = readSvmLight(projectPath("data/sparse_classify/train.samp"), idShift);
+    }
+    return dataset;
+}
+
+static DataSet* sparseSynthetic(int idShift)
+{
+    static DataSet* datasets[2] = {NULL, NULL};
+    DataSet*& dataset = datasets[idShift + 1];
+    if (dataset == NULL)
+    {
+        string path = scratchPath("bayes_sparse.samp");
+        SparseDataSpec spec;
+        spec.classes = SPARSE_CLASSES;
+        spec.features = 50000;
+        spec.featuresPerRow = 64;
+        writeFile(path, sparseRows(spec, 20000, 38));
+        dataset = readSvmLight(path, idShift);
+    }
+    return dataset;
+}
+
+static DataSet* denseSynthetic()
+{
+    static DataSet* dataset = NULL;
+    if (dataset == NULL)
+    {
+        DenseDataSpec spec;
+        spec.classes = 4;
+        spec.numeric = 12;
+        spec.nominal = 4;
+        spec.nominalValues = 16;
+        string names = scratchPath("bayes_dense.names");
+        string rows = scratchPath("bayes_dense.data");
+        writeFile(names, denseNames(spec));
+        writeFile(rows, denseRows(spec, 20000, 38));
+        // the attributes of the dataset belong to the parser
+        static TextParser parser(names);
+        dataset = parser.readData(rows);
+    }
+    return dataset;
+}
+
+static void setEventModel(NaiveBayes& model, bool multinomial)
+{
+    model.setEventModel(multinomial);
+}
+
+// BayesMsgPassing declares setEventModel without defining it
+static void setEventModel(BayesMsgPassing&, bool)
+{
+}
+
+template <class Model>
+static void train(State& state, DataSet* dataset, int classes, bool multinomial)
+{
+    if (dataset == NULL)
+    {
+        state.skip("data not found, see --project_dir");
+        return;
+    }
+    while (state.keepRunning())
+    {
+        Model model("bench", classes);
+        setEventModel(model, multinomial);
+        model.train(dataset);
+    }
+    state.setItemsProcessed(state.iterations() * dataset->numInstances());
+}
+
+template <class Model>
+static void predict(State& state, DataSet* dataset, int classes, bool multinomial)
+{
+    if (dataset == NULL)
+    {
+        state.skip("data not found, see --project_dir");
+        return;
+    }
+    Model model("bench", classes);
+    setEventModel(model, multinomial);
+    model.train(dataset);
+    int instances = dataset->numInstances();
+    while (state.keepRunning())
+    {
+        int sum = 0;
+        for (int i = 0; i < instances; ++i)
+        {
+            sum += model.predict(dataset->instanceAt(i)).first;
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * instances);
+}
+
+static void naiveBayesTrainBernoulliWinequality(State& state)
+{
+    train<NaiveBayes>(state, winequality(), 6, false);
+}
+MLPLUS_BENCHMARK(naiveBayesTrainBernoulliWinequality);
+
+static void naiveBayesPredictBernoulliWinequality(State& state)
+{
+    predict<NaiveBayes>(state, winequality(), 6, false);
+}
+MLPLUS_BENCHMARK(naiveBayesPredictBernoulliWinequality);
+
+static void naiveBayesTrainBernoulliDense(State& state)
+{
+    train<NaiveBayes>(state, denseSynthetic(), 4, false);
+}
+MLPLUS_BENCHMARK(naiveBayesTrainBernoulliDense);
+
+static void naiveBayesPredictBernoulliDense(State& state)
+{
+    predict<NaiveBayes>(state, denseSynthetic(), 4, false);
+}
+MLPLUS_BENCHMARK(naiveBayesPredictBernoulliDense);
+
+static void naiveBayesTrainMultinomialSparseClassify(State& state)
+{
+    train<NaiveBayes>(state, sparseClassify(0), SPARSE_CLASSES, true);
+}
+MLPLUS_BENCHMARK(naiveBayesTrainMultinomialSparseClassify);
+
+static void naiveBayesPredictMultinomialSparseClassify(State& state)
+{
+    predict<NaiveBayes>(state, sparseClassify(0), SPARSE_CLASSES, true);
+}
+MLPLUS_BENCHMARK(naiveBayesPredictMultinomialSparseClassify);
+
+static void naiveBayesTrainMultinomialSparse(State& state)
+{
+    train<NaiveBayes>(state, sparseSynthetic(0), SPARSE_CLASSES, true);
+}
+MLPLUS_BENCHMARK(naiveBayesTrainMultinomialSparse);
+
+static void naiveBayesPredictMultinomialSparse(State& state)
+{
+    predict<NaiveBayes>(state, sparseSynthetic(0), SPARSE_CLASSES, true);
+}
+MLPLUS_BENCHMARK(naiveBayesPredictMultinomialSparse);
+
+static void bayesMsgPassingTrainSparseClassify(State& state)
+{
+    train<BayesMsgPassing>(state, sparseClassify(-1), SPARSE_CLASSES, false);
+}
+MLPLUS_BENCHMARK(bayesMsgPassingTrainSparseClassify);
+
+static void bayesMsgPassingPredictSparseClassify(State& state)
+{
+    predict<BayesMsgPassing>(state, sparseClassify(-1), SPARSE_CLASSES, false);
+}
+MLPLUS_BENCHMARK(bayesMsgPassingPredictSparseClassify);
+
+static void bayesMsgPassingTrainSparse(State& state)
+{
+    train<BayesMsgPassing>(state, sparseSynthetic(-1), SPARSE_CLASSES, false);
+}
+MLPLUS_BENCHMARK(bayesMsgPassingTrainSparse);
+
+static void bayesMsgPassingPredictSparse(State& state)
+{
+    predict<BayesMsgPassing>(state, sparseSynthetic(-1), SPARSE_CLASSES, false);
+}
+MLPLUS_BENCHMARK(bayesMsgPassingPredictSparse);
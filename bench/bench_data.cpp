@@ -0,0 +1,68 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "dataset.h"
+#include "io/text_parser.h"
+#include "bench_data.h"
+#include "benchmark.h"
+using namespace std;
+namespace mlplus
+{
+namespace bench
+{
+string denseNames(const DenseDataSpec& spec)
+{
+    ostringstream names;
+    SyntheticDataGenerator::writeNames(spec, names);
+    return names.str();
+}
+
+string denseRows(const DenseDataSpec& spec, size_t rows, uint64_t seed)
+{
+    string text;
+    SyntheticDataGenerator(seed).appendDenseRows(spec, 0, rows, text);
+    return text;
+}
+
+string sparseRows(const SparseDataSpec& spec, size_t rows, uint64_t seed)
+{
+    string text;
+    SyntheticDataGenerator(seed).appendSparseRows(spec, 0, rows, text);
+    return text;
+}
+
+void writeFile(const string& path, const string& text)
+{
+    ofstream out(path.c_str(), ios::binary);
+    out.write(text.data(), text.size());
+}
+
+string readFile(const string& path)
+{
+    ifstream in(path.c_str(), ios::binary);
+    ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+DataSet* readWinequality()
+{
+    string csv = readFile(projectPath("data/winequality/winequality-red.train.csv"));
+    if (csv.empty())
+    {
+        return NULL;
+    }
+    // drop the header line
+    string rows = scratchPath("winequality.csv");
+    writeFile(rows, csv.substr(csv.find('\n') + 1));
+    // the parser keeps the attribute spec the dataset refers to
+    static TextParser* parser = NULL;
+    if (parser == NULL)
+    {
+        parser = new TextParser(projectPath("bench/winequality.names"));
+        parser->setDelimiter(";");
+    }
+    return parser->readData(rows);
+}
+} // namespace bench
+} // namespace mlplus
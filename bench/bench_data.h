@@ -0,0 +1,31 @@
+#ifndef MLPLUS_BENCH_DATA_H
+#define MLPLUS_BENCH_DATA_H
+#include <stdint.h>
+#include <string>
+#include "synthetic_data.h"
+namespace mlplus
+{
+class DataSet;
+namespace bench
+{
+/**
+ * Data shared by the benchmarks. The synthetic data comes from
+ * SyntheticDataGenerator with fixed seeds, so every run measures the same bytes.
+ */
+std::string denseNames(const DenseDataSpec& spec);
+std::string denseRows(const DenseDataSpec& spec, size_t rows, uint64_t seed);
+std::string sparseRows(const SparseDataSpec& spec, size_t rows, uint64_t seed);
+
+void writeFile(const std::string& path, const std::string& text);
+/**
+ * @brief the text of a file, empty when it cannot be read
+ */
+std::string readFile(const std::string& path);
+
+/**
+ * @brief data/winequality/winequality-red.train.csv read by TextParser, NULL when missing
+ */
+DataSet* readWinequality();
+} // namespace bench
+} // namespace mlplus
+#endif
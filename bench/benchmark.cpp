@@ -0,0 +1,415 @@
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "benchmark.h"
+namespace mlplus
+{
+namespace bench
+{
+namespace
+{
+struct Benchmark
+{
+    std::string name;
+    Function function;
+    int64_t arg;
+};
+
+struct Result
+{
+    std::string name;
+    std::string runType; // "iteration" or "aggregate"
+    int repetition;
+    uint64_t iterations;
+    double realNanos; // per iteration
+    double cpuNanos;
+    double itemsPerSecond;
+    double bytesPerSecond;
+    std::string label;
+    std::string error;
+};
+
+std::vector<Benchmark>& benchmarks()
+{
+    static std::vector<Benchmark> all;
+    return all;
+}
+
+std::vector<std::string>& scratchFiles()
+{
+    static std::vector<std::string> files;
+    return files;
+}
+
+std::string sProjectDir = "..";
+
+double seconds(const struct timespec& from, const struct timespec& to)
+{
+    return (to.tv_sec - from.tv_sec) + (to.tv_nsec - from.tv_nsec) * 1e-9;
+}
+
+void removeScratchFiles()
+{
+    for (size_t i = 0; i < scratchFiles().size(); ++i)
+    {
+        unlink(scratchFiles()[i].c_str());
+    }
+}
+
+Result run(const Benchmark& benchmark, uint64_t iterations, int repetition)
+{
+    State state(iterations, benchmark.arg);
+    benchmark.function(state);
+    Result result;
+    result.name = benchmark.name;
+    result.runType = "iteration";
+    result.repetition = repetition;
+    result.iterations = iterations;
+    result.realNanos = state.realSeconds() * 1e9 / iterations;
+    result.cpuNanos = state.cpuSeconds() * 1e9 / iterations;
+    result.itemsPerSecond = state.realSeconds() > 0 ? state.itemsProcessed() / state.realSeconds() : 0;
+    result.bytesPerSecond = state.realSeconds() > 0 ? state.bytesProcessed() / state.realSeconds() : 0;
+    result.label = state.label();
+    result.error = state.error();
+    return result;
+}
+
+/**
+ * @brief the first run long enough to measure, after growing the iteration count like
+ *        Google Benchmark does: aim at 1.4 times the minimum time, at most 10 times more
+ *        iterations per step
+ */
+Result calibrate(const Benchmark& benchmark, double minTime, double& lastSeconds)
+{
+    uint64_t iterations = 1;
+    for (;;)
+    {
+        Result result = run(benchmark, iterations, 0);
+        lastSeconds = result.realNanos * iterations * 1e-9;
+        if (!result.error.empty() || lastSeconds >= minTime || iterations >= 1000000000)
+        {
+            return result;
+        }
+        double multiplier = lastSeconds > 0 ? minTime * 1.4 / lastSeconds : 10.0;
+        multiplier = std::min(std::max(multiplier, 2.0), 10.0);
+        iterations = (uint64_t)(iterations * multiplier) + 1;
+    }
+}
+
+Result median(const std::vector<Result>& runs)
+{
+    std::vector<double> real, cpu, items, bytes;
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        real.push_back(runs[i].realNanos);
+        cpu.push_back(runs[i].cpuNanos);
+        items.push_back(runs[i].itemsPerSecond);
+        bytes.push_back(runs[i].bytesPerSecond);
+    }
+    size_t middle = runs.size() / 2;
+    std::nth_element(real.begin(), real.begin() + middle, real.end());
+    std::nth_element(cpu.begin(), cpu.begin() + middle, cpu.end());
+    std::nth_element(items.begin(), items.begin() + middle, items.end());
+    std::nth_element(bytes.begin(), bytes.begin() + middle, bytes.end());
+    Result result = runs[0];
+    result.name += "_median";
+    result.runType = "aggregate";
+    result.realNanos = real[middle];
+    result.cpuNanos = cpu[middle];
+    result.itemsPerSecond = items[middle];
+    result.bytesPerSecond = bytes[middle];
+    return result;
+}
+
+void writeJsonString(FILE* out, const std::string& s)
+{
+    fputc('"', out);
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        if (s[i] == '"' || s[i] == '\\')
+        {
+            fputc('\\', out);
+        }
+        fputc(s[i], out);
+    }
+    fputc('"', out);
+}
+
+void writeJson(FILE* out, const std::vector<Result>& results, const char* executable, int repetitions)
+{
+    char date[64];
+    time_t now = time(NULL);
+    struct tm local;
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime_r(&now, &local));
+    char host[256] = "";
+    gethostname(host, sizeof(host) - 1);
+    fprintf(out, "{\n  \"context\": {\n    \"date\": \"%s\",\n    \"host_name\": ", date);
+    writeJsonString(out, host);
+    fprintf(out, ",\n    \"executable\": ");
+    writeJsonString(out, executable);
+    fprintf(out, ",\n    \"num_cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+#ifdef NDEBUG
+    fprintf(out, "    \"library_build_type\": \"release\"\n  },\n");
+#else
+    fprintf(out, "    \"library_build_type\": \"debug\"\n  },\n");
+#endif
+    fprintf(out, "  \"benchmarks\": [");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        fprintf(out, "%s\n    {\n      \"name\": ", i > 0 ? "," : "");
+        writeJsonString(out, r.name);
+        fprintf(out, ",\n      \"run_type\": \"%s\",\n", r.runType.c_str());
+        fprintf(out, "      \"repetitions\": %d,\n      \"repetition_index\": %d,\n", repetitions, r.repetition);
+        if (!r.error.empty())
+        {
+            fprintf(out, "      \"error_occurred\": true,\n      \"error_message\": ");
+            writeJsonString(out, r.error);
+            fprintf(out, "\n    }");
+            continue;
+        }
+        if (r.runType == "aggregate")
+        {
+            fprintf(out, "      \"aggregate_name\": \"median\",\n");
+        }
+        fprintf(out, "      \"iterations\": %llu,\n", (unsigned long long)r.iterations);
+        fprintf(out, "      \"real_time\": %.3f,\n      \"cpu_time\": %.3f,\n      \"time_unit\": \"ns\"",
+                r.realNanos, r.cpuNanos);
+        if (r.bytesPerSecond > 0)
+        {
+            fprintf(out, ",\n      \"bytes_per_second\": %.1f", r.bytesPerSecond);
+        }
+        if (r.itemsPerSecond > 0)
+        {
+            fprintf(out, ",\n      \"items_per_second\": %.1f", r.itemsPerSecond);
+        }
+        if (!r.label.empty())
+        {
+            fprintf(out, ",\n      \"label\": ");
+            writeJsonString(out, r.label);
+        }
+        fprintf(out, "\n    }");
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+void writeConsoleHeader(FILE* out)
+{
+    fprintf(out, "%-48s %14s %14s %12s %14s %14s\n", "benchmark", "time_ns", "cpu_ns", "iterations",
+            "items/s", "MB/s");
+}
+
+void writeConsole(FILE* out, const Result& r)
+{
+    if (!r.error.empty())
+    {
+        fprintf(out, "%-48s ERROR: %s\n", r.name.c_str(), r.error.c_str());
+        return;
+    }
+    fprintf(out, "%-48s %14.1f %14.1f %12llu %14.4g %14.4g %s\n", r.name.c_str(), r.realNanos,
+            r.cpuNanos, (unsigned long long)r.iterations, r.itemsPerSecond,
+            r.bytesPerSecond / 1048576, r.label.c_str());
+}
+
+bool option(const char* argument, const char* name, const char*& value)
+{
+    size_t length = strlen(name);
+    if (strncmp(argument, name, length) == 0 && argument[length] == '=')
+    {
+        value = argument + length + 1;
+        return true;
+    }
+    return false;
+}
+} // namespace
+
+State::State(uint64_t iterations, int64_t arg):
+    mIterations(iterations), mLeft(iterations), mArg(arg), mStarted(false), mRunning(false),
+    mRealSeconds(0), mCpuSeconds(0), mItems(0), mBytes(0)
+{
+}
+
+void State::start()
+{
+    mRunning = true;
+    clock_gettime(CLOCK_MONOTONIC, &mRealStart);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &mCpuStart);
+}
+
+void State::stop()
+{
+    struct timespec real, cpu;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+    clock_gettime(CLOCK_MONOTONIC, &real);
+    mRealSeconds += seconds(mRealStart, real);
+    mCpuSeconds += seconds(mCpuStart, cpu);
+    mRunning = false;
+}
+
+void State::pauseTiming()
+{
+    if (mRunning)
+    {
+        stop();
+    }
+}
+
+void State::resumeTiming()
+{
+    if (!mRunning)
+    {
+        start();
+    }
+}
+
+void State::skip(const std::string& message)
+{
+    mError = message;
+    mLeft = 0;
+}
+
+int registerBenchmark(const char* name, Function function, int64_t arg, bool hasArg)
+{
+    Benchmark benchmark;
+    benchmark.name = name;
+    benchmark.function = function;
+    benchmark.arg = arg;
+    if (hasArg)
+    {
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), "/%lld", (long long)arg);
+        benchmark.name += suffix;
+    }
+    benchmarks().push_back(benchmark);
+    return (int)benchmarks().size();
+}
+
+std::string projectPath(const std::string& relative)
+{
+    return sProjectDir + "/" + relative;
+}
+
+std::string scratchPath(const std::string& name)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/mlplus_bench_%ld_", (long)getpid());
+    std::string file = path + name;
+    if (scratchFiles().empty())
+    {
+        atexit(removeScratchFiles);
+    }
+    scratchFiles().push_back(file);
+    return file;
+}
+} // namespace bench
+} // namespace mlplus
+
+using namespace mlplus::bench;
+
+int main(int argc, char** argv)
+{
+    const char* filter = "";
+    double minTime = 0.5;
+    int repetitions = 1;
+    bool json = false;
+    const char* outName = NULL;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* value = NULL;
+        if (option(argv[i], "--filter", value))
+        {
+            filter = value;
+        }
+        else if (option(argv[i], "--min_time", value))
+        {
+            minTime = atof(value);
+        }
+        else if (option(argv[i], "--repetitions", value))
+        {
+            repetitions = std::max(1, atoi(value));
+        }
+        else if (option(argv[i], "--format", value))
+        {
+            json = strcmp(value, "json") == 0;
+        }
+        else if (option(argv[i], "--out", value))
+        {
+            outName = value;
+        }
+        else if (option(argv[i], "--project_dir", value))
+        {
+            sProjectDir = value;
+        }
+        else if (strcmp(argv[i], "--list") == 0)
+        {
+            for (size_t j = 0; j < benchmarks().size(); ++j)
+            {
+                printf("%s\n", benchmarks()[j].name.c_str());
+            }
+            return 0;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--filter=<substring>] [--min_time=<seconds>] "
+                    "[--repetitions=<n>] [--format=console|json] [--out=<file>] "
+                    "[--project_dir=<dir with data/ and test/>] [--list]\n", argv[0]);
+            return 1;
+        }
+    }
+    FILE* out = stdout;
+    if (outName != NULL && (out = fopen(outName, "w")) == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", outName);
+        return 1;
+    }
+    // the console table goes to stderr while a json report is written
+    FILE* console = json ? stderr : out;
+    writeConsoleHeader(console);
+    std::vector<Result> results;
+    for (size_t i = 0; i < benchmarks().size(); ++i)
+    {
+        const Benchmark& benchmark = benchmarks()[i];
+        if (benchmark.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        double lastSeconds = 0;
+        Result first = calibrate(benchmark, minTime, lastSeconds);
+        std::vector<Result> runs;
+        if (!first.error.empty())
+        {
+            runs.push_back(first);
+        }
+        for (int r = 0; first.error.empty() && r < repetitions; ++r)
+        {
+            // the calibration run counts as the first repetition when it was long enough
+            runs.push_back(r == 0 && lastSeconds >= minTime ? first : run(benchmark, first.iterations, r));
+            runs.back().repetition = r;
+        }
+        for (size_t r = 0; r < runs.size(); ++r)
+        {
+            writeConsole(console, runs[r]);
+            results.push_back(runs[r]);
+        }
+        if (runs.size() > 1)
+        {
+            results.push_back(median(runs));
+            writeConsole(console, results.back());
+        }
+        fflush(console);
+    }
+    if (json)
+    {
+        writeJson(out, results, argv[0], repetitions);
+    }
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return 0;
+}
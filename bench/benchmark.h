@@ -0,0 +1,164 @@
+#ifndef MLPLUS_BENCHMARK_H
+#define MLPLUS_BENCHMARK_H
+#include <stdint.h>
+#include <time.h>
+#include <string>
+namespace mlplus
+{
+namespace bench
+{
+/**
+ * A microbenchmark in the style of Google Benchmark:
+ *
+ *     static void parseRows(State& state)
+ *     {
+ *         ... setup, not timed ...
+ *         while (state.keepRunning())
+ *         {
+ *             ... the measured work ...
+ *         }
+ *         state.setItemsProcessed(state.iterations() * rows);
+ *     }
+ *     MLPLUS_BENCHMARK(parseRows);
+ *
+ * The runner grows the iteration count until one run lasts --min_time, and
+ * reports the time per iteration as a console table or as JSON in the
+ * Google Benchmark schema, so the usual comparison scripts can read it.
+ */
+class State
+{
+public:
+    State(uint64_t iterations, int64_t arg);
+    /**
+     * @brief true while iterations are left; the clock runs from the first call to the last
+     */
+    inline bool keepRunning();
+    /**
+     * @brief exclude setup work done inside the loop from the measurement
+     */
+    void pauseTiming();
+    void resumeTiming();
+    uint64_t iterations() const
+    {
+        return mIterations;
+    }
+    /**
+     * @brief the argument of a benchmark registered with MLPLUS_BENCHMARK_ARG, 0 otherwise
+     */
+    int64_t arg() const
+    {
+        return mArg;
+    }
+    void setItemsProcessed(uint64_t items)
+    {
+        mItems = items;
+    }
+    void setBytesProcessed(uint64_t bytes)
+    {
+        mBytes = bytes;
+    }
+    void setLabel(const std::string& label)
+    {
+        mLabel = label;
+    }
+    /**
+     * @brief give up on the benchmark, e.g. when its data file is missing
+     */
+    void skip(const std::string& message);
+
+    double realSeconds() const
+    {
+        return mRealSeconds;
+    }
+    double cpuSeconds() const
+    {
+        return mCpuSeconds;
+    }
+    uint64_t itemsProcessed() const
+    {
+        return mItems;
+    }
+    uint64_t bytesProcessed() const
+    {
+        return mBytes;
+    }
+    const std::string& label() const
+    {
+        return mLabel;
+    }
+    const std::string& error() const
+    {
+        return mError;
+    }
+private:
+    void start();
+    void stop();
+
+    uint64_t mIterations;
+    uint64_t mLeft;
+    int64_t mArg;
+    bool mStarted;
+    bool mRunning;
+    struct timespec mRealStart;
+    struct timespec mCpuStart;
+    double mRealSeconds;
+    double mCpuSeconds;
+    uint64_t mItems;
+    uint64_t mBytes;
+    std::string mLabel;
+    std::string mError;
+};
+
+inline bool State::keepRunning()
+{
+    if (!mStarted)
+    {
+        mStarted = true;
+        start();
+    }
+    if (mLeft > 0 && mError.empty())
+    {
+        --mLeft;
+        return true;
+    }
+    if (mRunning)
+    {
+        stop();
+    }
+    return false;
+}
+
+typedef void (*Function)(State& state);
+
+int registerBenchmark(const char* name, Function function, int64_t arg, bool hasArg);
+
+/**
+ * @brief the path of a file given relative to the project directory, see --project_dir
+ */
+std::string projectPath(const std::string& relative);
+
+/**
+ * @brief a scratch file name that is removed when the program exits
+ */
+std::string scratchPath(const std::string& name);
+
+/**
+ * @brief keep the compiler from optimizing a result away
+ */
+template <class T>
+inline void doNotOptimize(const T& value)
+{
+    __asm__ __volatile__("" : : "r"(&value) : "memory");
+}
+} // namespace bench
+} // namespace mlplus
+
+#define MLPLUS_BENCHMARK_CONCAT2(a, b) a##b
+#define MLPLUS_BENCHMARK_CONCAT(a, b) MLPLUS_BENCHMARK_CONCAT2(a, b)
+#define MLPLUS_BENCHMARK(function) \
+    static int MLPLUS_BENCHMARK_CONCAT(function##Registered, __LINE__) __attribute__((unused)) = \
+        mlplus::bench::registerBenchmark(#function, function, 0, false)
+#define MLPLUS_BENCHMARK_ARG(function, arg) \
+    static int MLPLUS_BENCHMARK_CONCAT(function##Registered, __LINE__) __attribute__((unused)) = \
+        mlplus::bench::registerBenchmark(#function, function, arg, true)
+#endif
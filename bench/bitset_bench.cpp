@@ -0,0 +1,86 @@
+#include "bitset.h"
+#include "roaring_bitset.h"
+#include "rng.h"
+#include "benchmark.h"
+using namespace std;
+using namespace mlplus;
+using namespace mlplus::bench;
+
+static const size_t ROWS = 1 << 20;
+
+/**
+ * @brief a column of ROWS rows with each set by a chance of perMille / 1000
+ */
+static DenseBitset column(uint64_t seed, int perMille)
+{
+    Xoshiro256 rng(seed);
+    DenseBitset bits(ROWS);
+    for (size_t i = 0; i < ROWS; ++i)
+    {
+        if (rng.below(1000) < (uint32_t)perMille)
+        {
+            bits.set(i);
+        }
+    }
+    return bits;
+}
+
+/**
+ * @brief the support of a pair of items over ROWS transactions
+ */
+static void denseAndCount(State& state)
+{
+    DenseBitset a = column(1, state.arg());
+    DenseBitset b = column(2, state.arg());
+    while (state.keepRunning())
+    {
+        doNotOptimize(DenseBitset::andCount(a, b));
+    }
+    state.setItemsProcessed(state.iterations() * ROWS);
+}
+MLPLUS_BENCHMARK_ARG(denseAndCount, 10);
+MLPLUS_BENCHMARK_ARG(denseAndCount, 500);
+
+/**
+ * @brief denseAndCount on the word at a time kernels, whatever the processor has
+ */
+static void denseAndCountPortable(State& state)
+{
+    bool avx2 = bitset::usingAvx2();
+    bitset::useAvx2(false);
+    denseAndCount(state);
+    bitset::useAvx2(avx2);
+}
+MLPLUS_BENCHMARK_ARG(denseAndCountPortable, 500);
+
+static void roaringAndCount(State& state)
+{
+    RoaringBitset a = RoaringBitset::fromDense(column(1, state.arg()));
+    RoaringBitset b = RoaringBitset::fromDense(column(2, state.arg()));
+    while (state.keepRunning())
+    {
+        doNotOptimize(RoaringBitset::andCount(a, b));
+    }
+    state.setItemsProcessed(state.iterations() * ROWS);
+}
+MLPLUS_BENCHMARK_ARG(roaringAndCount, 10);
+MLPLUS_BENCHMARK_ARG(roaringAndCount, 500);
+
+/**
+ * @brief the rows of a tree node split by a column, as in growing a tree
+ */
+static void denseSplitMask(State& state)
+{
+    DenseBitset rows = column(3, 700);
+    DenseBitset test = column(4, state.arg());
+    while (state.keepRunning())
+    {
+        DenseBitset left(rows);
+        left &= test;
+        DenseBitset right(rows);
+        right.andNot(test);
+        doNotOptimize(left.count() + right.count());
+    }
+    state.setItemsProcessed(state.iterations() * ROWS);
+}
+MLPLUS_BENCHMARK_ARG(denseSplitMask, 500);
@@ -0,0 +1,247 @@
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <tr1/unordered_map>
+#include "rng.h"
+#include "flat_hash_map.h"
+#include "benchmark.h"
+using namespace std;
+using namespace mlplus;
+using namespace mlplus::bench;
+
+static const size_t LOOKUPS = 4096;
+
+/**
+ * @brief n feature ids spread over 2^24 and LOOKUPS probes, half of them
+ *        hits, like the ids of a sparse instance
+ */
+static void featureIds(size_t n, vector<int>& keys, vector<int>& probes)
+{
+    Xoshiro256 random(1);
+    keys.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        keys[i] = (int)random.below(1 << 24);
+    }
+    probes.resize(LOOKUPS);
+    for (size_t i = 0; i < LOOKUPS; ++i)
+    {
+        probes[i] = i % 2 ? keys[random.below(n)] : (int)random.below(1 << 24);
+    }
+}
+
+/**
+ * The layout of HashTable in src/util/hash_table.c, which no longer builds
+ * without the vfml headers: a bucket array of pointer lists, the element
+ * behind a void* and the key compared through a callback.
+ */
+class ChainedTable
+{
+public:
+    typedef int (*Compare)(const void*, const int);
+    explicit ChainedTable(int size): mBuckets(size)
+    {
+        for (int i = 0; i < size; ++i)
+        {
+            mBuckets[i] = new vector<void*>();
+        }
+    }
+    ~ChainedTable()
+    {
+        for (size_t i = 0; i < mBuckets.size(); ++i)
+        {
+            delete mBuckets[i];
+        }
+    }
+    void insert(int index, void* element)
+    {
+        mBuckets[index % mBuckets.size()]->push_back(element);
+    }
+    void* find(int index, Compare cmp) const
+    {
+        const vector<void*>& list = *mBuckets[index % mBuckets.size()];
+        for (size_t i = 0; i < list.size(); ++i)
+        {
+            if (cmp(list[i], index) >= 0)
+            {
+                return list[i];
+            }
+        }
+        return NULL;
+    }
+private:
+    vector<vector<void*>*> mBuckets;
+};
+
+struct Entry
+{
+    int key;
+    int slot;
+};
+
+static int compareEntry(const void* element, const int index)
+{
+    return static_cast<const Entry*>(element)->key == index ? 0 : -1;
+}
+
+static void chainedFeatureLookup(State& state)
+{
+    vector<int> keys, probes;
+    featureIds(state.arg(), keys, probes);
+    vector<Entry> entries(keys.size());
+    // one bucket per entry, as sized by its callers
+    ChainedTable table(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        entries[i].key = keys[i];
+        entries[i].slot = i;
+        table.insert(keys[i], &entries[i]);
+    }
+    while (state.keepRunning())
+    {
+        int sum = 0;
+        for (size_t i = 0; i < LOOKUPS; ++i)
+        {
+            const Entry* e = static_cast<const Entry*>(table.find(probes[i], compareEntry));
+            sum += e ? e->slot : -1;
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * LOOKUPS);
+}
+MLPLUS_BENCHMARK_ARG(chainedFeatureLookup, 64);
+MLPLUS_BENCHMARK_ARG(chainedFeatureLookup, 100000);
+
+template <class Map>
+static void featureLookup(State& state)
+{
+    vector<int> keys, probes;
+    featureIds(state.arg(), keys, probes);
+    Map table;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        table[keys[i]] = i;
+    }
+    while (state.keepRunning())
+    {
+        int sum = 0;
+        for (size_t i = 0; i < LOOKUPS; ++i)
+        {
+            typename Map::const_iterator it = table.find(probes[i]);
+            sum += it != table.end() ? it->second : -1;
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * LOOKUPS);
+}
+
+static void stdMapFeatureLookup(State& state)
+{
+    featureLookup<map<int, int> >(state);
+}
+MLPLUS_BENCHMARK_ARG(stdMapFeatureLookup, 64);
+MLPLUS_BENCHMARK_ARG(stdMapFeatureLookup, 100000);
+
+static void unorderedFeatureLookup(State& state)
+{
+    featureLookup<tr1::unordered_map<int, int> >(state);
+}
+MLPLUS_BENCHMARK_ARG(unorderedFeatureLookup, 64);
+MLPLUS_BENCHMARK_ARG(unorderedFeatureLookup, 100000);
+
+static void flatFeatureLookup(State& state)
+{
+    featureLookup<FlatHashMap<int, int> >(state);
+}
+MLPLUS_BENCHMARK_ARG(flatFeatureLookup, 64);
+MLPLUS_BENCHMARK_ARG(flatFeatureLookup, 100000);
+
+/**
+ * @brief nominal value to index, Attribute::indexOfValue
+ */
+template <class Map>
+static void nominalLookup(State& state)
+{
+    vector<string> values;
+    for (int i = 0; i < 200; ++i)
+    {
+        ostringstream os;
+        os << "value_" << i * 7919;
+        values.push_back(os.str());
+    }
+    Map table;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        table[values[i]] = i;
+    }
+    Xoshiro256 random(2);
+    vector<const string*> probes(LOOKUPS);
+    for (size_t i = 0; i < LOOKUPS; ++i)
+    {
+        probes[i] = &values[random.below(values.size())];
+    }
+    while (state.keepRunning())
+    {
+        int sum = 0;
+        for (size_t i = 0; i < LOOKUPS; ++i)
+        {
+            sum += table.find(*probes[i])->second;
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * LOOKUPS);
+}
+
+static void stdMapNominalLookup(State& state)
+{
+    nominalLookup<map<string, int> >(state);
+}
+MLPLUS_BENCHMARK(stdMapNominalLookup);
+
+static void unorderedNominalLookup(State& state)
+{
+    nominalLookup<tr1::unordered_map<string, int> >(state);
+}
+MLPLUS_BENCHMARK(unorderedNominalLookup);
+
+static void flatNominalLookup(State& state)
+{
+    nominalLookup<FlatHashMap<string, int> >(state);
+}
+MLPLUS_BENCHMARK(flatNominalLookup);
+
+template <class Map>
+static void buildTable(State& state)
+{
+    vector<int> keys, probes;
+    featureIds(state.arg(), keys, probes);
+    while (state.keepRunning())
+    {
+        Map table;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            table[keys[i]] = i;
+        }
+        doNotOptimize(table.size());
+    }
+    state.setItemsProcessed(state.iterations() * keys.size());
+}
+
+static void stdMapBuild(State& state)
+{
+    buildTable<map<int, int> >(state);
+}
+MLPLUS_BENCHMARK_ARG(stdMapBuild, 100000);
+
+static void unorderedBuild(State& state)
+{
+    buildTable<tr1::unordered_map<int, int> >(state);
+}
+MLPLUS_BENCHMARK_ARG(unorderedBuild, 100000);
+
+static void flatBuild(State& state)
+{
+    buildTable<FlatHashMap<int, int> >(state);
+}
+MLPLUS_BENCHMARK_ARG(flatBuild, 100000);
@@ -0,0 +1,75 @@
+#include <memory>
+#include <vector>
+#include "dataset.h"
+#include "instance.h"
+#include "instance_container.h"
+#include "itemset_mining.h"
+#include "rng.h"
+#include "benchmark.h"
+using namespace std;
+using namespace mlplus;
+using namespace mlplus::bench;
+
+static const size_t BASKETS = 100000;
+static const int ITEMS = 500;
+
+/**
+ * @brief BASKETS baskets of ten items or so, item k drawn by a chance
+ *        falling as 1 / (k + 1)
+ */
+static DataSet* baskets()
+{
+    Xoshiro256 rng(50);
+    DataSet* data = new DataSet("baskets", new SparseInstanceContainer());
+    vector<int> items;
+    for (size_t t = 0; t < BASKETS; ++t)
+    {
+        items.clear();
+        for (int item = 0; item < ITEMS; ++item)
+        {
+            if (rng.uniform() * (item + 1) < 1.5)
+            {
+                items.push_back(item);
+            }
+        }
+        IInstance* instance = new SparseInstance(vector<ValueType>(items.size(), 1), items, 1);
+        instance->setDataset(data);
+        data->add(instance);
+    }
+    return data;
+}
+
+/**
+ * @brief the frequent itemsets of a support of arg per mille, one thread
+ */
+static void eclatMine(State& state)
+{
+    auto_ptr<DataSet> data(baskets());
+    ItemsetMiner miner(state.arg() / 1000.0, 0, 1);
+    miner.load(data.get());
+    vector<FrequentItemset> itemsets;
+    while (state.keepRunning())
+    {
+        miner.mine(itemsets);
+        doNotOptimize(itemsets.size());
+    }
+    state.setItemsProcessed(state.iterations() * BASKETS);
+}
+MLPLUS_BENCHMARK_ARG(eclatMine, 20);
+MLPLUS_BENCHMARK_ARG(eclatMine, 5);
+
+/**
+ * @brief turning the baskets into tid sets and counting the pairs
+ */
+static void eclatLoad(State& state)
+{
+    auto_ptr<DataSet> data(baskets());
+    while (state.keepRunning())
+    {
+        ItemsetMiner miner(state.arg() / 1000.0, 0, 1);
+        miner.load(data.get());
+        doNotOptimize(miner.numFrequentItems());
+    }
+    state.setItemsProcessed(state.iterations() * BASKETS);
+}
+MLPLUS_BENCHMARK_ARG(eclatLoad, 5);
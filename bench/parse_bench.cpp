@@ -0,0 +1,193 @@
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "attribute.h"
+#include "dataset.h"
+#include "instance.h"
+#include "io/text_parser.h"
+#include "svm_light_reader.h"
+#include "bench_data.h"
+#include "benchmark.h"
+using namespace std;
+using namespace mlplus;
+using namespace mlplus::bench;
+
+static DenseDataSpec denseSpec()
+{
+    DenseDataSpec spec;
+    spec.classes = 4;
+    spec.numeric = 12;
+    spec.nominal = 4;
+    spec.nominalValues = 16;
+    return spec;
+}
+
+/**
+ * @brief the names and rows files of a synthetic dense dataset, written once per row count
+ */
+static void denseFiles(size_t rows, string& names, string& data, size_t& bytes)
+{
+    static map<size_t, pair<string, size_t> > written;
+    static string namesFile;
+    if (namesFile.empty())
+    {
+        namesFile = scratchPath("dense.names");
+        writeFile(namesFile, denseNames(denseSpec()));
+    }
+    if (written.find(rows) == written.end())
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "dense_%lu.data", (unsigned long)rows);
+        string text = denseRows(denseSpec(), rows, 38);
+        written[rows] = make_pair(scratchPath(name), text.size());
+        writeFile(written[rows].first, text);
+    }
+    names = namesFile;
+    data = written[rows].first;
+    bytes = written[rows].second;
+}
+
+static void textParserDense(State& state)
+{
+    string names, data;
+    size_t bytes = 0;
+    denseFiles(state.arg(), names, data, bytes);
+    TextParser parser(names);
+    while (state.keepRunning())
+    {
+        delete parser.readData(data);
+    }
+    state.setItemsProcessed(state.iterations() * state.arg());
+    state.setBytesProcessed(state.iterations() * bytes);
+}
+MLPLUS_BENCHMARK_ARG(textParserDense, 10000);
+MLPLUS_BENCHMARK_ARG(textParserDense, 100000);
+
+static void textParserWinequality(State& state)
+{
+    string csv = readFile(projectPath("data/winequality/winequality-red.train.csv"));
+    if (csv.empty())
+    {
+        state.skip("data/winequality not found, see --project_dir");
+        return;
+    }
+    string rows = scratchPath("winequality_rows.csv");
+    writeFile(rows, csv.substr(csv.find('\n') + 1));
+    TextParser parser(projectPath("bench/winequality.names"));
+    parser.setDelimiter(";");
+    size_t instances = 0;
+    while (state.keepRunning())
+    {
+        DataSet* dataset = parser.readData(rows);
+        instances = dataset->numInstances();
+        delete dataset;
+    }
+    state.setItemsProcessed(state.iterations() * instances);
+    state.setBytesProcessed(state.iterations() * (csv.size() - csv.find('\n') - 1));
+}
+MLPLUS_BENCHMARK(textParserWinequality);
+
+static void sparseParser(State& state, const string& path, size_t bytes)
+{
+    size_t instances = 0;
+    while (state.keepRunning())
+    {
+        DataSet* dataset = readSvmLight(path, 0);
+        instances = dataset->numInstances();
+        delete dataset;
+    }
+    state.setItemsProcessed(state.iterations() * instances);
+    state.setBytesProcessed(state.iterations() * bytes);
+}
+
+static void sparseParserSynthetic(State& state)
+{
+    SparseDataSpec spec;
+    spec.classes = 6;
+    spec.featuresPerRow = 64;
+    string text = sparseRows(spec, state.arg(), 38);
+    string path = scratchPath("sparse.samp");
+    writeFile(path, text);
+    sparseParser(state, path, text.size());
+}
+MLPLUS_BENCHMARK_ARG(sparseParserSynthetic, 10000);
+
+static void sparseParserSparseClassify(State& state)
+{
+    string path = projectPath("data/sparse_classify/train.samp");
+    size_t bytes = readFile(path).size();
+    if (bytes == 0)
+    {
+        state.skip("data/sparse_classify not found, see --project_dir");
+        return;
+    }
+    sparseParser(state, path, bytes);
+}
+MLPLUS_BENCHMARK(sparseParserSparseClassify);
+
+/**
+ * @brief look up every value of a nominal attribute with arg values, plus as many misses
+ */
+static void attributeIndexOfValue(State& state)
+{
+    vector<string> values;
+    vector<string> keys;
+    char buffer[32];
+    for (int i = 0; i < state.arg(); ++i)
+    {
+        snprintf(buffer, sizeof(buffer), "value_%d", i);
+        values.push_back(buffer);
+        keys.push_back(buffer);
+        snprintf(buffer, sizeof(buffer), "other_%d", i);
+        keys.push_back(buffer);
+    }
+    Attribute attribute("nominal", values);
+    while (state.keepRunning())
+    {
+        int sum = 0;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            sum += attribute.indexOfValue(keys[i]);
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * keys.size());
+}
+MLPLUS_BENCHMARK_ARG(attributeIndexOfValue, 8);
+MLPLUS_BENCHMARK_ARG(attributeIndexOfValue, 64);
+MLPLUS_BENCHMARK_ARG(attributeIndexOfValue, 1024);
+
+/**
+ * @brief read every stored value of a sparse instance with arg values out of 100000 attributes
+ */
+static void sparseInstanceGetValue(State& state)
+{
+    SplitMix64 random(38);
+    vector<int> indices;
+    vector<ValueType> values;
+    for (int i = 0; i < state.arg(); ++i)
+    {
+        indices.push_back(i * (100000 / state.arg()) + random.below(100000 / state.arg()));
+        values.push_back(random.below(10));
+    }
+    SparseInstance instance(values, indices, 1);
+    // visit the values in a scattered order
+    vector<int> order(indices);
+    for (size_t i = order.size(); i > 1; --i)
+    {
+        swap(order[i - 1], order[random.below(i)]);
+    }
+    while (state.keepRunning())
+    {
+        ValueType sum = 0;
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            sum += instance.getValue(order[i]);
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * order.size());
+}
+MLPLUS_BENCHMARK_ARG(sparseInstanceGetValue, 32);
+MLPLUS_BENCHMARK_ARG(sparseInstanceGetValue, 1024);
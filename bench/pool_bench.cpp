@@ -0,0 +1,132 @@
+#include <vector>
+#include "instance.h"
+#include "pool_allocator.h"
+#include "thread_pool.h"
+#include "benchmark.h"
+using namespace std;
+using namespace mlplus;
+using namespace mlplus::bench;
+
+static const int CHURN_OPS = 100000;
+static const size_t LIVE = 1024;
+
+/**
+ * @brief CHURN_OPS frees and allocations over LIVE slots of 16 to 600
+ *        bytes, the sizes of value arrays, index arrays and tokens
+ */
+template <class Allocator>
+class ChurnTask : public Runnable
+{
+public:
+    explicit ChurnTask(int seed): mSeed(seed), mLive(LIVE, (void*)NULL) {}
+    ~ChurnTask()
+    {
+        for (size_t slot = 0; slot < LIVE; ++slot)
+        {
+            Allocator::deallocate(mLive[slot], sizeOf(slot));
+        }
+    }
+    /*override*/ void run()
+    {
+        uint32_t x = mSeed;
+        for (int i = 0; i < CHURN_OPS; ++i)
+        {
+            x = x * 1664525 + 1013904223;
+            size_t slot = (x >> 8) % LIVE;
+            Allocator::deallocate(mLive[slot], sizeOf(slot));
+            mLive[slot] = Allocator::allocate(sizeOf(slot));
+        }
+    }
+private:
+    static size_t sizeOf(size_t slot)
+    {
+        return 16 + (slot * 40) % 584;
+    }
+    uint32_t mSeed;
+    vector<void*> mLive;
+};
+
+struct HeapAllocator
+{
+    static void* allocate(size_t size)
+    {
+        return ::operator new(size);
+    }
+    static void deallocate(void* p, size_t)
+    {
+        ::operator delete(p);
+    }
+};
+
+/**
+ * @brief the churn of arg() threads. The threads only contend for the heap
+ *        and the depot when they run at once, so the /4 runs say something
+ *        about scaling only on a machine with 4 or more cores
+ */
+template <class Allocator>
+static void churn(State& state)
+{
+    int threads = state.arg();
+    ThreadPool pool(threads);
+    vector<ChurnTask<Allocator>*> tasks;
+    for (int t = 0; t < threads; ++t)
+    {
+        tasks.push_back(new ChurnTask<Allocator>(t + 1));
+    }
+    while (state.keepRunning())
+    {
+        for (int t = 0; t < threads; ++t)
+        {
+            pool.submit(tasks[t]);
+        }
+        pool.wait();
+    }
+    for (int t = 0; t < threads; ++t)
+    {
+        delete tasks[t];
+    }
+    state.setItemsProcessed(state.iterations() * threads * CHURN_OPS);
+}
+
+static void heapChurn(State& state)
+{
+    churn<HeapAllocator>(state);
+}
+MLPLUS_BENCHMARK_ARG(heapChurn, 1);
+MLPLUS_BENCHMARK_ARG(heapChurn, 4);
+
+static void poolChurn(State& state)
+{
+    churn<MemoryPool>(state);
+}
+MLPLUS_BENCHMARK_ARG(poolChurn, 1);
+MLPLUS_BENCHMARK_ARG(poolChurn, 4);
+
+/**
+ * @brief copies of a sparse instance of 40 features: a value array, an
+ *        index array and a feature map each
+ */
+static void sparseInstanceCopies(State& state)
+{
+    vector<ValueType> values(40, 1);
+    vector<int> indices(40);
+    for (int i = 0; i < 40; ++i)
+    {
+        indices[i] = i * 37;
+    }
+    SparseInstance instance(values, indices, 1);
+    vector<SparseInstance*> copies(256);
+    while (state.keepRunning())
+    {
+        for (size_t i = 0; i < copies.size(); ++i)
+        {
+            copies[i] = instance.clone();
+        }
+        for (size_t i = 0; i < copies.size(); ++i)
+        {
+            delete copies[i];
+        }
+    }
+    state.setItemsProcessed(state.iterations() * copies.size());
+}
+MLPLUS_BENCHMARK(sparseInstanceCopies);
@@ -0,0 +1,87 @@
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "rng.h"
+#include "benchmark.h"
+using namespace std;
+using namespace mlplus;
+using namespace mlplus::bench;
+
+static const size_t DRAWS = 4096;
+
+/**
+ * @brief the libc generator behind src/util/random.c before it moved to xoshiro256++
+ */
+static void libcRandomUniform(State& state)
+{
+    vector<double> out(DRAWS);
+    srandom(1);
+    while (state.keepRunning())
+    {
+        for (size_t i = 0; i < DRAWS; ++i)
+        {
+            out[i] = random() / (RAND_MAX + 1.0);
+        }
+    }
+    state.setItemsProcessed(state.iterations() * DRAWS);
+}
+MLPLUS_BENCHMARK(libcRandomUniform);
+
+static void xoshiroUniform(State& state)
+{
+    vector<double> out(DRAWS);
+    Xoshiro256 random(1);
+    while (state.keepRunning())
+    {
+        for (size_t i = 0; i < DRAWS; ++i)
+        {
+            out[i] = random.uniform();
+        }
+    }
+    state.setItemsProcessed(state.iterations() * DRAWS);
+}
+MLPLUS_BENCHMARK(xoshiroUniform);
+
+static void xoshiroUniforms(State& state)
+{
+    vector<double> out(DRAWS);
+    Xoshiro256 random(1);
+    while (state.keepRunning())
+    {
+        random.uniforms(&out[0], DRAWS);
+    }
+    state.setItemsProcessed(state.iterations() * DRAWS);
+}
+MLPLUS_BENCHMARK(xoshiroUniforms);
+
+/**
+ * @brief the old RandomStandardNormal(): Box-Muller with libm on random()
+ */
+static void libcRandomGaussian(State& state)
+{
+    vector<double> out(DRAWS);
+    srandom(1);
+    while (state.keepRunning())
+    {
+        for (size_t i = 0; i < DRAWS; ++i)
+        {
+            double u1 = random() / (RAND_MAX + 1.0);
+            double u2 = random() / (RAND_MAX + 1.0);
+            out[i] = sqrt(-2 * log(1 - u1)) * cos(2 * M_PI * u2);
+        }
+    }
+    state.setItemsProcessed(state.iterations() * DRAWS);
+}
+MLPLUS_BENCHMARK(libcRandomGaussian);
+
+static void xoshiroGaussians(State& state)
+{
+    vector<double> out(DRAWS);
+    Xoshiro256 random(1);
+    while (state.keepRunning())
+    {
+        random.gaussians(&out[0], DRAWS);
+    }
+    state.setItemsProcessed(state.iterations() * DRAWS);
+}
+MLPLUS_BENCHMARK(xoshiroGaussians);
@@ -0,0 +1,269 @@
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "arena.h"
+#include "attribute_spec.h"
+#include "dataset.h"
+#include "decision_tree.h"
+#include "expression.h"
+#include "scope.h"
+#include "io/text_parser.h"
+#include "pattern_scan.h"
+#include "bench_data.h"
+#include "benchmark.h"
+using namespace std;
+using namespace mlplus;
+using namespace mlplus::bench;
+
+/**
+ * @brief test/example.cases read with test/example.names, the data of test/example.tree
+ */
+static DataSet* exampleCases(TextParser*& parser)
+{
+    static TextParser* exampleParser = NULL;
+    static DataSet* dataset = NULL;
+    if (exampleParser == NULL && !readFile(projectPath("test/example.names")).empty())
+    {
+        exampleParser = new TextParser(projectPath("test/example.names"));
+        dataset = exampleParser->readData(projectPath("test/example.cases"));
+    }
+    parser = exampleParser;
+    return dataset;
+}
+
+/**
+ * @brief the C5 model text of test/example.tree, its single tree repeated trees times
+ */
+static string boostedModel(int trees)
+{
+    string model = readFile(projectPath("test/example.tree"));
+    size_t body = model.find('\n', model.find("entries="));
+    if (model.empty() || body == string::npos)
+    {
+        return "";
+    }
+    ostringstream boosted;
+    boosted << model.substr(0, model.find("entries=")) << "entries=\"" << trees << "\"\n";
+    for (int i = 0; i < trees; ++i)
+    {
+        boosted << model.substr(body + 1);
+    }
+    return boosted.str();
+}
+
+static void decisionTreeClassify(State& state)
+{
+    TextParser* parser = NULL;
+    DataSet* dataset = exampleCases(parser);
+    string model = boostedModel(1);
+    if (dataset == NULL || model.empty())
+    {
+        state.skip("test/example.* not found, see --project_dir");
+        return;
+    }
+    istringstream in(model);
+    string header;
+    getline(in, header);
+    getline(in, header);
+    DecisionTreePtr tree = DecisionTree::readC5Text(in, parser->getAttributeSpec());
+    vector<float> confidence(parser->getAttributeSpec()->numTarget());
+    float* confidencePtr = &confidence[0];
+    int instances = dataset->numInstances();
+    while (state.keepRunning())
+    {
+        int sum = 0;
+        for (int i = 0; i < instances; ++i)
+        {
+            sum += tree->classify(dataset->instanceAt(i), &confidencePtr);
+        }
+        doNotOptimize(sum);
+    }
+    tree->free();
+    state.setItemsProcessed(state.iterations() * instances);
+}
+MLPLUS_BENCHMARK(decisionTreeClassify);
+
+static void boostDecisionTreeClassify(State& state)
+{
+    TextParser* parser = NULL;
+    DataSet* dataset = exampleCases(parser);
+    string model = boostedModel(state.arg());
+    if (dataset == NULL || model.empty())
+    {
+        state.skip("test/example.* not found, see --project_dir");
+        return;
+    }
+    istringstream in(model);
+    BoostDecisionTree tree;
+    tree.read(in, parser->getAttributeSpec());
+    vector<float> confidence(tree.numClasses());
+    float* confidencePtr = &confidence[0];
+    int instances = dataset->numInstances();
+    while (state.keepRunning())
+    {
+        int sum = 0;
+        for (int i = 0; i < instances; ++i)
+        {
+            sum += tree.classify(dataset->instanceAt(i), &confidencePtr);
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * instances);
+}
+MLPLUS_BENCHMARK_ARG(boostDecisionTreeClassify, 1);
+MLPLUS_BENCHMARK_ARG(boostDecisionTreeClassify, 10);
+
+/**
+ * @brief the names and a boosted model of arg synthetic trees, written once
+ */
+static const string& syntheticModel(int trees, TextParser*& parser)
+{
+    static map<int, string> models;
+    static TextParser* syntheticParser = NULL;
+    DenseDataSpec spec;
+    if (syntheticParser == NULL)
+    {
+        string names = scratchPath("tree.names");
+        writeFile(names, denseNames(spec));
+        syntheticParser = new TextParser(names);
+    }
+    parser = syntheticParser;
+    if (models.find(trees) == models.end())
+    {
+        TreeModelSpec model;
+        model.trees = trees;
+        model.depth = 10;
+        ostringstream text;
+        SyntheticDataGenerator(38).writeBoostedTrees(spec, model, text);
+        models[trees] = text.str();
+    }
+    return models[trees];
+}
+
+/**
+ * @brief read the trees of a boosted model one node allocation at a time, or into an arena
+ */
+static void readC5Trees(State& state, bool useArena)
+{
+    TextParser* parser = NULL;
+    const string& model = syntheticModel(state.arg(), parser);
+    AttributeSpec* spec = parser->getAttributeSpec();
+    vector<DecisionTreePtr> trees(state.arg());
+    while (state.keepRunning())
+    {
+        Arena arena(256 * 1024);
+        istringstream in(model);
+        string header;
+        getline(in, header);
+        getline(in, header);
+        for (int i = 0; i < state.arg(); ++i)
+        {
+            trees[i] = DecisionTree::readC5Text(in, spec, useArena ? &arena : NULL);
+        }
+        for (int i = 0; i < state.arg(); ++i)
+        {
+            trees[i]->free();
+        }
+    }
+    state.setItemsProcessed(state.iterations() * state.arg());
+    state.setBytesProcessed(state.iterations() * model.size());
+}
+
+static void decisionTreeReadC5Heap(State& state)
+{
+    readC5Trees(state, false);
+}
+MLPLUS_BENCHMARK_ARG(decisionTreeReadC5Heap, 100);
+
+static void decisionTreeReadC5Arena(State& state)
+{
+    readC5Trees(state, true);
+}
+MLPLUS_BENCHMARK_ARG(decisionTreeReadC5Arena, 100);
+
+static void boostDecisionTreeClassifySynthetic(State& state)
+{
+    TextParser* parser = NULL;
+    const string& model = syntheticModel(state.arg(), parser);
+    DenseDataSpec spec;
+    string rows = scratchPath("tree.data");
+    writeFile(rows, denseRows(spec, 2000, 38));
+    auto_ptr<DataSet> dataset(parser->readData(rows));
+    istringstream in(model);
+    BoostDecisionTree tree;
+    tree.read(in, parser->getAttributeSpec());
+    vector<float> confidence(tree.numClasses());
+    float* confidencePtr = &confidence[0];
+    int instances = dataset->numInstances();
+    while (state.keepRunning())
+    {
+        int sum = 0;
+        for (int i = 0; i < instances; ++i)
+        {
+            sum += tree.classify(dataset->instanceAt(i), &confidencePtr);
+        }
+        doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * instances);
+}
+MLPLUS_BENCHMARK_ARG(boostDecisionTreeClassifySynthetic, 100);
+
+/**
+ * @brief an implicit attribute as TextParser evaluates it for every row
+ */
+static void expressionEvaluate(State& state)
+{
+    Expression expression("n0 * log(n1 + 1) + n2 / (n3 + 2) - sqrt(n4)");
+    Scope scope;
+    scope.add("n0", 1.5);
+    scope.add("n1", 2.5);
+    scope.add("n2", 3.5);
+    scope.add("n3", 4.5);
+    scope.add("n4", 5.5);
+    while (state.keepRunning())
+    {
+        doNotOptimize(expression.evaluate(scope));
+    }
+    state.setItemsProcessed(state.iterations());
+}
+MLPLUS_BENCHMARK(expressionEvaluate);
+
+/**
+ * @brief scan text made of dictionary words and other words with arg patterns
+ */
+static void patternScan(State& state)
+{
+    SplitMix64 random(38);
+    vector<string> patterns;
+    vector<string> words;
+    for (int i = 0; i < 2 * state.arg(); ++i)
+    {
+        string word;
+        int length = 3 + random.below(6);
+        for (int j = 0; j < length; ++j)
+        {
+            word += (char)('a' + random.below(26));
+        }
+        (i % 2 == 0 ? patterns : words).push_back(word);
+    }
+    string text;
+    while (text.size() < (1 << 20))
+    {
+        text += random.below(2) == 0 ? patterns[random.below(patterns.size())] : words[random.below(words.size())];
+        text += ' ';
+    }
+    PatternScan scanner;
+    scanner.Init(patterns);
+    MatchCounter matches;
+    while (state.keepRunning())
+    {
+        matches.Clear();
+        doNotOptimize(scanner.Scan(text, matches));
+    }
+    state.setBytesProcessed(state.iterations() * text.size());
+}
+MLPLUS_BENCHMARK_ARG(patternScan, 1000);
+MLPLUS_BENCHMARK_ARG(patternScan, 100000);
@@ -14,7 +14,7 @@ protected:
     DataSet* mDataset;
     double mWeight;
     int mGroupId;
-    vector<ValueType> mAttrValues;
+    ValueArray mAttrValues;
 protected:
     AbstractInstance() {}
 public:
@@ -34,7 +34,7 @@ public:
     /*override*/ bool targetIsMissing();
     /*override*/ ValueType targetValue();
 
-    /*override*/ const vector<ValueType>&  getValueArray() const;
+    /*override*/ const ValueArray&  getValueArray() const;
     /*override*/ DataSet* getDataset(void);
     /*override*/ void setDataset(DataSet* instances);
 
@@ -62,6 +62,8 @@ public:
     /*override*/ void setValue(Attribute& attr, const string& value);
     /*override*/ void setValue(int attrIndex, const string& value);
     virtual void setValue(int attrIndex, ValueType value) = 0;
+    // instances are made by the million, they and their arrays come from the pool
+    MLPLUS_POOL_ALLOCATED(AbstractInstance, memory::DATASET_VALUES)
 };
 }
 
@@ -0,0 +1,80 @@
+#ifndef MLPLUS_ARENA_H
+#define MLPLUS_ARENA_H
+#include <cstddef>
+#include <new>
+#include <vector>
+#include "memory_accounting.h"
+namespace mlplus
+{
+/**
+ * A bump allocator for structures built once and released as a whole, like a
+ * decision tree model.  Allocations are carved from blocks of blockSize bytes
+ * in order, so nodes read together stay together in memory; requests larger
+ * than a quarter of a block get a block of their own.  Nothing is freed before
+ * the arena is reset or destroyed, and no destructors are run.
+ *
+ * The blocks are charged to the memory::Tag given, if any.
+ *
+ * An arena is not thread safe.
+ */
+class Arena
+{
+public:
+    explicit Arena(size_t blockSize = 64 * 1024, memory::Tag tag = memory::UNTAGGED);
+    ~Arena();
+    /**
+     * @brief size bytes aligned to align, which must be a power of two
+     */
+    inline void* alloc(size_t size, size_t align = sizeof(double));
+    template <class T>
+    inline T* allocArray(size_t n);
+    /**
+     * @brief release every block at once
+     */
+    void reset();
+    /**
+     * @brief the bytes handed out since the last reset
+     */
+    size_t bytesUsed() const {return mBytesUsed;}
+    /**
+     * @brief the bytes of all blocks held
+     */
+    size_t bytesReserved() const {return mBytesReserved;}
+    size_t numBlocks() const {return mBlocks.size();}
+private:
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+    void* allocSlow(size_t size, size_t align);
+    size_t mBlockSize;
+    memory::Tag mTag;
+    char* mPtr;
+    char* mEnd;
+    size_t mBytesUsed;
+    size_t mBytesReserved;
+    std::vector<char*> mBlocks;
+};
+
+inline void* Arena::alloc(size_t size, size_t align)
+{
+    char* p = (char*)(((size_t)mPtr + align - 1) & ~(align - 1));
+    if (p + size > mEnd || mPtr == NULL)
+    {
+        return allocSlow(size, align);
+    }
+    mPtr = p + size;
+    mBytesUsed += size;
+    return p;
+}
+
+template <class T>
+inline T* Arena::allocArray(size_t n)
+{
+    T* p = static_cast<T*>(alloc(sizeof(T) * (n == 0 ? 1 : n), __alignof__(T)));
+    for (size_t i = 0; i < n; ++i)
+    {
+        new (p + i) T();
+    }
+    return p;
+}
+} // namespace mlplus
+#endif
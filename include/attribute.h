@@ -1,10 +1,11 @@
 #ifndef MLPLUS_ATTRIBUTE_H
 #define MLPLUS_ATTRIBUTE_H
 
-#include <map>
 #include <string>
 #include <vector>
 #include <cmath>
+#include "pool_allocator.h"
+#include "flat_hash_map.h"
 #ifndef NAN
 # define NAN builtinnan("")
 #endif
@@ -71,7 +72,7 @@ protected:
     /*
      * only NAMEDNOMINAL and string attribute has mValues and mValues2Index 
      */
-    std::map<std::string, int> mValue2Index; //
+    FlatHashMap<std::string, int> mValue2Index; //
     std::vector<std::string> mValues; //index ---> string
     int  mIndex;
     AttributeType mType;
@@ -213,6 +214,11 @@ public:
     bool isRange(const std::string& str) const; 
     std::string toString() const;
     void mapValue2Index();
+    /**
+     * @brief the bytes of the attribute with its names of values
+     */
+    size_t memoryUsage() const;
+    MLPLUS_POOL_ALLOCATED(Attribute, memory::ATTRIBUTES)
 
 };
 }
@@ -48,6 +48,7 @@ public:
     /*override*/ IAttributeIterator* newIterator();
     /*override*/ VectorAttributeContainer* shallowCopy();
     /*override*/ VectorAttributeContainer* deepCopy();
+    /*override*/ size_t memoryUsage() const;
 };
 class MapAttributeContainer:public IAttributeContainer
 {
@@ -85,6 +86,7 @@ public:
     /*override*/ IAttributeIterator* newIterator();
     /*override*/ MapAttributeContainer* shallowCopy();
     /*override*/ MapAttributeContainer* deepCopy();
+    /*override*/ size_t memoryUsage() const;
 private: 
    MapContainer mAttributeMap;
 };
@@ -1,5 +1,6 @@
 #ifndef MLPLUS_ATTRIBUTE_CONTAINER_INTERFACE_H
 #define MLPLUS_ATTRIBUTE_CONTAINER_INTERFACE_H
+#include <cstddef>
 namespace mlplus
 {
 class IAttributeIterator;
@@ -16,6 +17,11 @@ public:
     virtual IAttributeIterator* newIterator() = 0;
     virtual IAttributeContainer* deepCopy() = 0;
     virtual IAttributeContainer* shallowCopy() = 0; 
+    /**
+     * @brief the bytes of the container and its attributes, attributes
+     *        shared with shallow copies are counted by each of them
+     */
+    virtual size_t memoryUsage() const = 0;
 };
 }
 #endif
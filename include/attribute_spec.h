@@ -15,7 +15,7 @@ public:
     AttributeSpec(NamesFileReader& reader);
     inline void setTarget(int index);
     inline int  getTarget() const;
-    inline int classNo(char* className) const;
+    inline int classNo(const char* className) const;
     int numTarget() const;
     int numAttributes() const;
     int mTargetIndicator; 
@@ -75,7 +75,7 @@ inline int  AttributeSpec::getTarget() const
     return mTargetIndicator;
 }
 
-inline int AttributeSpec::classNo(char* className) const
+inline int AttributeSpec::classNo(const char* className) const
 { 
     return mAttributes[mTargetIndicator]->indexOfValue(className);
 }
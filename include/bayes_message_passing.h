@@ -23,7 +23,14 @@ private:
     DistributionMapType mDistributions;
     EstimatorPtr mClassDistribution;
     int mClassesCount;
+    int mConcurrency;
+    //attribute index -> mDistributions entry, complete unless the keys are
+    //negative or too sparse for a table, then the map is searched instead
+    std::vector<EstimatorPtr> mIndex;
+    bool mIndexComplete;
     void release();
+    void rebuildIndex();
+    inline EstimatorPtr distributionAt(int attrIndex) const;
     BayesMsgPassing(const BayesMsgPassing& bas);
 public:
     BayesMsgPassing(const string& name, int nClasses);
@@ -32,14 +39,28 @@ public:
     inline void setClassDistribution(EstimatorPtr est);
     inline void setEventModel(bool v = true);
     inline bool getEventModel() const;
+    /**
+     * @brief the number of classes, as read by load()
+     */
+    inline int numClasses() const;
+    /**
+     * @brief let update() be called from many threads at once, see
+     *        NaiveBayes::setConcurrency
+     */
+    inline void setConcurrency(int stripes);
+    inline int getConcurrency() const;
     virtual void load(istream& input);
     virtual void save(ostream& output);
     virtual void train(DataSet* data);
     virtual std::pair<int, double> predict(IInstance* i);
     virtual void update(IInstance* instance);
     virtual std::vector<double> targetDistribution(IInstance* i);
+    virtual std::vector<std::pair<int, double> > predictTopK(IInstance* i, int k);
+    virtual size_t memoryUsage() const;
 private:
+    std::vector<double> logScores(IInstance* i);
     std::vector<double> sigmoidProb(const std::vector<double>& score);
+    EstimatorPtr newDiscreteEstimator(int nSymbols, bool laplace) const;
 
 };
 
@@ -48,6 +69,11 @@ inline  BayesMsgPassing::EstimatorPtr BayesMsgPassing::getClassDistribution(void
     return mClassDistribution;
 }
 
+inline int BayesMsgPassing::numClasses() const
+{
+    return mClassesCount;
+}
+
 inline void BayesMsgPassing::setClassDistribution(EstimatorPtr est)
 {
     if (mClassDistribution)
@@ -56,5 +82,29 @@ inline void BayesMsgPassing::setClassDistribution(EstimatorPtr est)
     }
     mClassDistribution = est;
 }
+
+inline BayesMsgPassing::EstimatorPtr BayesMsgPassing::distributionAt(int attrIndex) const
+{
+    if ((unsigned)attrIndex < mIndex.size())
+    {
+        return mIndex[attrIndex];
+    }
+    if (mIndexComplete)
+    {
+        return NULL;
+    }
+    DistributionMapType::const_iterator it = mDistributions.find(attrIndex);
+    return it == mDistributions.end() ? NULL : it->second;
+}
+
+inline void BayesMsgPassing::setConcurrency(int stripes)
+{
+    mConcurrency = stripes;
+}
+
+inline int BayesMsgPassing::getConcurrency() const
+{
+    return mConcurrency;
+}
 }
 #endif
@@ -0,0 +1,132 @@
+#ifndef MLPLUS_BITSET_H
+#define MLPLUS_BITSET_H
+#include <stdint.h>
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+namespace mlplus
+{
+namespace bitset
+{
+/**
+ * Kernels over arrays of n 64 bit words. On a processor with AVX2 they run
+ * on 256 bit registers, popcounts with the nibble lookup of Mula et al.;
+ * otherwise a word at a time, with the popcnt instruction where there is
+ * one. The choice is made at run time, so no -m flag is needed.
+ */
+size_t popcount(const uint64_t* words, size_t n);
+/**
+ * @brief the popcount of a & b without storing it, the support of an itemset
+ */
+size_t andCount(const uint64_t* a, const uint64_t* b, size_t n);
+void andInto(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n);
+void orInto(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n);
+void andNotInto(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n);
+bool usingAvx2();
+/**
+ * @brief switch the kernels to or from AVX2, for tests and benchmarks; call
+ *        it before any thread uses them
+ * @return false when AVX2 was asked for and the processor has none
+ */
+bool useAvx2(bool enable);
+
+inline size_t numWords(size_t bits)
+{
+    return (bits + 63) >> 6;
+}
+inline bool test(const uint64_t* words, size_t bit)
+{
+    return (words[bit >> 6] >> (bit & 63)) & 1;
+}
+inline void set(uint64_t* words, size_t bit)
+{
+    words[bit >> 6] |= (uint64_t)1 << (bit & 63);
+}
+inline void reset(uint64_t* words, size_t bit)
+{
+    words[bit >> 6] &= ~((uint64_t)1 << (bit & 63));
+}
+} // namespace bitset
+
+/**
+ * A fixed size set of bits in 64 bit words. Bits past size() are kept zero,
+ * so counts need no masking. Binary operations take sets of the same size.
+ */
+class DenseBitset
+{
+public:
+    static const size_t npos = (size_t)-1;
+    DenseBitset(): mSize(0) {}
+    explicit DenseBitset(size_t size, bool value = false);
+    void resize(size_t size, bool value = false);
+    size_t size() const
+    {
+        return mSize;
+    }
+    size_t numWords() const
+    {
+        return mWords.size();
+    }
+    const uint64_t* words() const
+    {
+        return mWords.empty() ? NULL : &mWords[0];
+    }
+    bool test(size_t i) const
+    {
+        assert(i < mSize);
+        return bitset::test(&mWords[0], i);
+    }
+    void set(size_t i)
+    {
+        assert(i < mSize);
+        bitset::set(&mWords[0], i);
+    }
+    void reset(size_t i)
+    {
+        assert(i < mSize);
+        bitset::reset(&mWords[0], i);
+    }
+    void set(size_t i, bool value)
+    {
+        value ? set(i) : reset(i);
+    }
+    void setAll();
+    void resetAll();
+    size_t count() const;
+    bool any() const;
+    /**
+     * @brief the first set bit at or after from, npos if none
+     */
+    size_t findNext(size_t from) const;
+    DenseBitset& operator&=(const DenseBitset& other);
+    DenseBitset& operator|=(const DenseBitset& other);
+    DenseBitset& andNot(const DenseBitset& other);
+    bool operator==(const DenseBitset& other) const
+    {
+        return mSize == other.mSize && mWords == other.mWords;
+    }
+    /**
+     * @brief (a & b).count() without building a & b
+     */
+    static size_t andCount(const DenseBitset& a, const DenseBitset& b);
+    size_t memoryUsage() const
+    {
+        return sizeof(*this) + mWords.capacity() * sizeof(uint64_t);
+    }
+    void swap(DenseBitset& other)
+    {
+        mWords.swap(other.mWords);
+        std::swap(mSize, other.mSize);
+    }
+private:
+    uint64_t* mutableWords()
+    {
+        return mWords.empty() ? NULL : &mWords[0];
+    }
+    void clearTail();
+    std::vector<uint64_t> mWords;
+    size_t mSize;
+};
+} // namespace mlplus
+#endif
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <utility>
+#include "vector_math.h"
 namespace mlplus
 {
 class IInstance;
@@ -24,8 +25,26 @@ public:
     virtual void load(istream& input) = 0;
     virtual void save(ostream& output) = 0;
     virtual std::vector<double> targetDistribution(IInstance* i) = 0;
+    /**
+     * @brief the k most probable classes with their probabilities, best
+     *        first. The default selects from targetDistribution(), classifiers
+     *        with raw scores override it to normalize only the selected classes.
+     */
+    virtual std::vector<std::pair<int, double> > predictTopK(IInstance* i, int k);
+    /**
+     * @brief the bytes of the model
+     */
+    virtual size_t memoryUsage() const = 0;
 };
 
+inline std::vector<std::pair<int, double> > Classifier::predictTopK(IInstance* i, int k)
+{
+    std::vector<double> dist = targetDistribution(i);
+    std::vector<std::pair<int, double> > top;
+    selectTopK(dist.empty() ? NULL : &dist[0], dist.size(), k, top);
+    return top;
+}
+
 inline bool Classifier::getDebug()
 {
     return mDebugMode;
@@ -0,0 +1,118 @@
+#ifndef MLPLUS_CROSS_VALIDATION_H
+#define MLPLUS_CROSS_VALIDATION_H
+#include <stdint.h>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "evaluation.h"
+namespace mlplus
+{
+class Classifier;
+class DataSet;
+/**
+ * Model selection over a dataset loaded once.
+ *
+ * The folds are lists of instance indices. Every fold x parameter setting is
+ * a task on a ThreadPool: it trains a new classifier on a DataSet::subset()
+ * of the other folds and evaluates the held out fold, so no instance is
+ * copied and no prediction is written out. Results come back in grid order
+ * with the metrics merged over the folds and the train and test times.
+ */
+typedef std::map<std::string, std::string> Parameters;
+
+/**
+ * the cartesian product of the values of every parameter
+ */
+class ParameterGrid
+{
+public:
+    void add(const std::string& name, const std::vector<std::string>& values);
+    /**
+     * @param values comma separated, "0.1,1,10"
+     */
+    void add(const std::string& name, const std::string& values);
+    /**
+     * @brief the number of settings, 1 for an empty grid
+     */
+    size_t size() const;
+    /**
+     * @brief the i-th setting, the last parameter added varies fastest
+     */
+    Parameters at(size_t i) const;
+private:
+    std::vector<std::pair<std::string, std::vector<std::string> > > mValues;
+};
+
+/**
+ * makes the untrained classifiers of a parameter setting. create() is called
+ * from several threads at once.
+ */
+class ClassifierFactory
+{
+public:
+    virtual ~ClassifierFactory() {}
+    /**
+     * @brief a new classifier owned by the caller, throws runtime_error on an
+     *        unknown parameter or value
+     */
+    virtual Classifier* create(const Parameters& parameters, int numClasses) = 0;
+};
+
+/**
+ * NaiveBayes, parameters:
+ *     event_model  0 Bernoulli / normal estimators, 1 multinomial
+ */
+class NaiveBayesFactory: public ClassifierFactory
+{
+public:
+    /*override*/ Classifier* create(const Parameters& parameters, int numClasses);
+};
+
+struct CrossValidationResult
+{
+    explicit CrossValidationResult(int numClasses): metrics(numClasses), trainSeconds(0), testSeconds(0) {}
+    Parameters parameters;
+    /**
+     * @brief the predictions of every held out fold together
+     */
+    ClassificationMetrics metrics;
+    std::vector<double> foldAccuracy;
+    /**
+     * @brief summed over the folds, so they are thread time rather than wall time
+     */
+    double trainSeconds;
+    double testSeconds;
+};
+
+class CrossValidation
+{
+public:
+    /**
+     * @param stratified deal the instances of every class round the folds, so
+     *        each fold keeps the class proportions
+     */
+    CrossValidation(DataSet& data, int folds, uint64_t seed = 1, bool stratified = true);
+    int numFolds() const {return mFolds.size();}
+    const std::vector<int>& testIndices(int fold) const {return mFolds[fold];}
+    /**
+     * @brief the indices of every other fold, in increasing order
+     */
+    void trainIndices(int fold, std::vector<int>& indices) const;
+    /**
+     * @brief every fold of every setting of grid, threads tasks at a time
+     * @param threads every processor if < 1
+     */
+    void run(ClassifierFactory& factory, const ParameterGrid& grid, int threads,
+             std::vector<CrossValidationResult>& results);
+    /**
+     * @brief one line per setting, the best accuracy first
+     */
+    static void print(std::ostream& out, const std::vector<CrossValidationResult>& results);
+private:
+    DataSet& mData;
+    int mNumClasses;
+    std::vector<std::vector<int> > mFolds;
+};
+} // namespace mlplus
+#endif
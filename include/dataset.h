@@ -1,11 +1,13 @@
 #ifndef MLPLUS_DATASET_H
 #define MLPLUS_DATASET_H
+#include <stdint.h>
 #include <cstdlib>
 #include <cassert>
 #include <stdexcept>
 #include <string>
 #include <memory>
 #include "attribute.h"
+#include "bitset.h"
 #include "instance_interface.h"
 #include "instance_container_interface.h"
 #include "attribute_container_interface.h"
@@ -48,6 +50,42 @@ public:
     inline void add(IInstance* instance);
     inline std::vector<ValueType> attributeArray(Attribute& attr);
     std::vector<ValueType> attributeArray(int attIndex);
+    /**
+     * @brief a bit for each instance, set where attribute attIndex is missing
+     */
+    DenseBitset missingMask(int attIndex);
+    /**
+     * @brief a dataset of the instances at indices, in that order, sharing the
+     *        attributes and the instances of this one. Nothing is copied, this
+     *        dataset must outlive the subset; the instances still report this
+     *        one as their dataset.
+     */
+    DataSet* subset(const std::vector<int>& indices);
+    /**
+     * @brief the same seeing instance indices[i] with weights[i] instead of its
+     *        own weight
+     */
+    DataSet* subset(const std::vector<int>& indices, const std::vector<double>& weights);
+    /**
+     * @brief a view of every instance in a seeded random order
+     */
+    DataSet* randomize(uint64_t seed);
+    /**
+     * @brief a bootstrap sample view: numInstances() draws with replacement,
+     *        a row drawn k times is seen k times with its own weight
+     */
+    DataSet* resample(uint64_t seed);
+    /**
+     * @brief numInstances() draws with replacement with the probability of a
+     *        row by its weight, every draw seen with weight 1
+     */
+    DataSet* resampleWithWeights(uint64_t seed);
+    DataSet* resampleWithWeights(const std::vector<double>& weights, uint64_t seed);
+    /**
+     * @brief the bytes of the dataset, its attributes and the instances it
+     *        owns; a subset or a sample counts its view, not the rows it sees
+     */
+    size_t memoryUsage() const;
 #if 0
     bool checkForAttributeType(int attType) const;
     bool isStringAttributes() const
@@ -64,19 +102,11 @@ public:
             throw new runtime_error("target index is not set");
         deleteWithMissing(mTagetIndex);
     }
-    void randomize()
-    {
-        for(int j = numInstances() - 1; j > 0; j--)
-            swap(j, (int)(random() % (j + 1)));
-    }
     bool checkInstance(Instance& instance);
     void deleteAll();
     void deleteInstance(int index);
     void deleteAttributeAt(int position);
     void deleteWithMissing(int attIndex);
-    DataSet* resample();
-    DataSet* resampleWithWeights();
-    DataSet* resampleWithWeights(vector<double>& weights);
     void swap(int i, int j);
 private:
     /*
@@ -2,7 +2,10 @@
 #define MLPLUS_DECISIONTREEH_H
 #include <vector>
 #include <list>
+#include <string>
 #include <iostream>
+#include "pool_allocator.h"
+#include "bitset.h"
 namespace mlplus
 {
 
@@ -14,16 +17,17 @@ typedef enum
     dtnSubset,
     dtnGrowing
 } TreeNodeType;
+class Arena;
 class AttributeSpec;
 class IInstance;
 class Attribute;
+class DataSet;
 class DecisionTree;
 class BoostDecisionTree; 
 typedef  DecisionTree* DecisionTreePtr;
 class DecisionTree
 {
 private:
-    typedef int64_t Set64;
     TreeNodeType mNodeType;
     AttributeSpec* mAttributeSpec;
     void* mGrowingData;
@@ -34,13 +38,20 @@ private:
     float mMid;		    /* midpoint for soft threshold */
     int mForks;
     DecisionTreePtr *mChildren;/* mChildren array*/
-    Set64       *mSubset;	   /* subsets of discrete values  */
+    uint64_t    *mSubset;	   /* the values of each fork, mSubsetWords words a fork */
+    int mSubsetWords;
     int mMyClass;
     float mErrors;
     float* mClassDist;
     float mCases;
+    Arena* mArena; /* owns the node and its arrays, NULL for the heap */
 public:
-    static DecisionTreePtr newTree(AttributeSpec* spec);
+    /**
+     * @brief a growing node; with an arena the node, its class distribution and
+     *        all arrays below it are taken from the arena, and free() leaves
+     *        them to the arena
+     */
+    static DecisionTreePtr newTree(AttributeSpec* spec, Arena* arena = NULL);
     void free();
     DecisionTreePtr clone();
     int isLeaf();
@@ -60,40 +71,64 @@ public:
     int getChildCount();
     void  treeDebug(int att, float threshold, float value);
     DecisionTreePtr getChild(int index);
+    /**
+     * @brief the child e goes to, -1 at a leaf or a growing node
+     */
+    int branch(IInstance* e);
     DecisionTreePtr oneStepClassify(IInstance* e);
+    /**
+     * @brief split the rows of data in the node mask rows among the children:
+     *        childRows[i] holds the rows that go to child i
+     */
+    void partition(DataSet* data, const DenseBitset& rows, std::vector<DenseBitset>& childRows);
     int classify(IInstance* e, float* *confidence);
     void growingNodes(std::list<DecisionTreePtr>& list);
     void gatherLeaves(std::list<DecisionTreePtr>& list);
     void gatherGrowingNodes(std::list<DecisionTreePtr>& list);
     int  countNodes();
+    /**
+     * @brief the bytes of the nodes and arrays below this one on the heap,
+     *        nothing for a tree in an arena, see Arena::bytesReserved()
+     */
+    size_t memoryUsage();
     int  getMostCommonClass();
     void setGrowingData(void *data);
     void *getGrowingData();
-    static DecisionTreePtr readC5(std::istream& in, AttributeSpec* spec);
-    static DecisionTreePtr readC5Bin(std::istream& in,AttributeSpec* spec);
-    static DecisionTreePtr readC5Text(std::istream& in, AttributeSpec* spec);
-    static DecisionTreePtr read(std::istream& in, AttributeSpec* spec);
+    static DecisionTreePtr readC5(std::istream& in, AttributeSpec* spec, Arena* arena = NULL);
+    static DecisionTreePtr readC5Bin(std::istream& in,AttributeSpec* spec, Arena* arena = NULL);
+    static DecisionTreePtr readC5Text(std::istream& in, AttributeSpec* spec, Arena* arena = NULL);
+    static DecisionTreePtr read(std::istream& in, AttributeSpec* spec, Arena* arena = NULL);
     void write(std::ostream& out);
     void print(std::ostream& out);
     void printStats(std::ostream& out);
-    inline void setBit(Set64& s, int bit) const
+    /**
+     * @brief whether the subset of fork holds the nominal value
+     */
+    inline bool inSubset(int fork, int value) const
     {
-        s |= (0x01 < bit); //s.setbit at b
-    }
-    inline bool testBit(Set64& s, int bit) const
-    {
-        return s & (0x01 < bit);
+        return value >= 0 && value < mSubsetWords * 64
+               && bitset::test(mSubset + fork * mSubsetWords, value);
     }
 private:
+    template <class T>
+    T* allocArray(int n);
+    template <class T>
+    void freeArray(T* p);
     static void getMostCommonClassHelper(DecisionTreePtr dt, long *counts);
     static void printHelper(DecisionTreePtr dt, std::ostream& out, int indent);
     static void printStatHelper(DecisionTreePtr dt, long *leavesAtLevel, long *leaves, int level, int maxLevel);
     static int which(char* val, char** list, int first, int last);
-    static Set64 makeSubset(char* PropVal, Attribute* attr);
-    static int readProp(std::istream& is, char *delim, char* propName, char* proVal);
+    static void makeSubset(const std::string& propVal, Attribute* attr, uint64_t* words);
+    static int readProp(std::istream& is, char *delim, char* propName, std::string& propVal);
     friend class BoostDecisionTree;
+    // nodes grown on the heap come from the pool, arena nodes use placement new
+    MLPLUS_POOL_ALLOCATED(DecisionTree, memory::TREE_NODES)
 };
 
+/**
+ * A boosted C5 model. All trees are read into one arena, so the model is a
+ * few contiguous blocks released at once.
+ */
 class BoostDecisionTree
 {
 public:
@@ -103,11 +138,19 @@ public:
     int classify(IInstance* e, float* *confidence);
     int numTree() const {return mTreeCount;}
     int numClasses() const {return mNumClasses;}
+    const Arena& arena() const {return *mArena;}
+    /**
+     * @brief the bytes of the model, its trees are all in the arena
+     */
+    size_t memoryUsage() const;
 private:
+    BoostDecisionTree(const BoostDecisionTree&);
+    BoostDecisionTree& operator=(const BoostDecisionTree&);
     bool readHead(std::istream& in);
     int mTreeCount;
     int mNumClasses;
     DecisionTreePtr* mppTrees;
+    Arena* mArena;
 };
 }
 #endif /* DECISIONTREEH */
@@ -8,6 +8,7 @@ namespace estimators
 {
 class BinaryEstimator: public IdentifiableEstimator<BinaryEstimator>
 {
+protected:
     double mPositiveCount;
     double mNegativeCount;
 public:
@@ -15,11 +16,13 @@ public:
 
     inline double getPostiveCount(void) const;
     inline double getNegativeCount(void) const;
+    void setCounts(double positive, double negative);
     /*override*/ double getProbability(double postive);
     using Estimator::addValue;
     /*override*/ void addValue(double pos_or_nagtive, double weight);
     /*override*/std::string toString();
     /*override*/void fromString(const std::string&);
+    /*override*/ size_t memoryUsage() const;
 
 };
 inline  double BinaryEstimator::getPostiveCount(void) const
@@ -0,0 +1,79 @@
+#ifndef MLPLUS_ESTIMATORS_CONCURRENTESTIMATOR_H
+#define MLPLUS_ESTIMATORS_CONCURRENTESTIMATOR_H
+#include <string>
+#include "estimators/discrete_estimator.h"
+#include "estimators/normal_estimator.h"
+#include "estimators/binary_estimator.h"
+#include "estimators/striped_counter.h"
+namespace mlplus
+{
+namespace estimators
+{
+/**
+ * Estimators that accept addValue() from many threads at once.
+ *
+ * Updates go to striped partial counters instead of the plain members, and
+ * every read folds the partials on top of the plain members. The plain members
+ * still receive fromString() and smoothing(), so a concurrent estimator reports
+ * the same id and serializes to the same string as its single threaded base,
+ * and saved models stay loadable by either variant.
+ */
+class ConcurrentDiscreteEstimator: public DiscreteEstimator
+{
+    StripedCounter mPartials; //[0, mNumOfClass) counts, mNumOfClass the sum
+public:
+    ConcurrentDiscreteEstimator(int nSymbols, bool laplace = 1,
+            int stripes = StripedCounter::DEFAULT_STRIPES);
+    double getCount(int data) const;
+    double getSumOfCounts(void) const;
+    /*override*/ double getProbability(double data);
+    using Estimator::addValue;
+    /*override*/ void addValue(double data, double weight);
+    /*override*/ std::string toString();
+    /*override*/ void fromString(const std::string&);
+    /*override*/ size_t memoryUsage() const;
+private:
+    ConcurrentDiscreteEstimator(const ConcurrentDiscreteEstimator&);
+};
+
+class ConcurrentNormalEstimator: public NormalEstimator
+{
+    enum {WEIGHTS = 0, VALUES, SQUARES, WIDTH};
+    StripedCounter mPartials;
+public:
+    ConcurrentNormalEstimator(double precision, int stripes = StripedCounter::DEFAULT_STRIPES);
+    double getMean() const;
+    double getStdDev() const;
+    /*override*/ double getProbability(double data);
+    using Estimator::addValue;
+    /*override*/ void addValue(double data, double weight);
+    /*override*/ std::string toString();
+    /*override*/ void fromString(const std::string&);
+    /*override*/ size_t memoryUsage() const;
+private:
+    ConcurrentNormalEstimator(const ConcurrentNormalEstimator&);
+    void moments(double& sumOfWeights, double& sumOfValues, double& sumOfValuesSq,
+            double& mean, double& stdDev) const;
+};
+
+class ConcurrentBinaryEstimator: public BinaryEstimator
+{
+    enum {POSITIVE = 0, NEGATIVE, WIDTH};
+    StripedCounter mPartials;
+public:
+    ConcurrentBinaryEstimator(bool laplace = 1, int stripes = StripedCounter::DEFAULT_STRIPES);
+    double getPostiveCount(void) const;
+    double getNegativeCount(void) const;
+    /*override*/ double getProbability(double postive);
+    using Estimator::addValue;
+    /*override*/ void addValue(double pos_or_nagtive, double weight);
+    /*override*/ std::string toString();
+    /*override*/ void fromString(const std::string&);
+    /*override*/ size_t memoryUsage() const;
+private:
+    ConcurrentBinaryEstimator(const ConcurrentBinaryEstimator&);
+};
+} // namespace estimators
+} // namespace mlplus
+
+#endif
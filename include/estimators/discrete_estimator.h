@@ -8,6 +8,7 @@ namespace estimators
 {
 class DiscreteEstimator: public IdentifiableEstimator<DiscreteEstimator>
 {
+protected:
     double* mCounts;
     double mSumOfCounts;
     int mNumOfClass;
@@ -19,13 +20,21 @@ public:
     inline int getNumOfClass(void) const;
     inline double getCount(int data) const;
     inline double getSumOfCounts(void) const;
+    inline const double* getCounts(void) const;
+    /**
+     * @brief replace all counts, the sum of counts is recomputed
+     */
+    void setCounts(const double* counts);
     /*overrid*/void smoothing(Estimator*, double);
     /*override*/ double getProbability(double data);
     using Estimator::addValue;
     /*override*/ void addValue(double data, double weight);
     /*override*/std::string toString();
     /*override*/void fromString(const std::string&);
-
+    /*override*/ size_t memoryUsage() const;
+protected:
+    static double* newCounts(int n); //zeroed
+    static void deleteCounts(double* counts, int n);
 };
 inline int DiscreteEstimator::getNumOfClass(void) const
 {
@@ -41,6 +50,10 @@ inline double DiscreteEstimator::getSumOfCounts(void) const
 {
     return mSumOfCounts;
 }
+inline const double* DiscreteEstimator::getCounts(void) const
+{
+    return mCounts;
+}
 
 } // namespace estimators
 } // namespace mlplus
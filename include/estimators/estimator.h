@@ -1,6 +1,7 @@
 #ifndef MLPLU_ESTIMATORS_ESTIMATOR_H
 #define MLPLU_ESTIMATORS_ESTIMATOR_H
 #include <string>
+#include "pool_allocator.h"
 namespace mlplus
 {
 class Instance;
@@ -21,14 +22,35 @@ public:
     virtual void fromString(const std::string&) = 0;
     virtual double logScore(int nType);
     virtual void smoothing(Estimator*, double) {};
+    /**
+     * @brief the bytes of the estimator and its counts
+     */
+    virtual size_t memoryUsage() const = 0;
+    MLPLUS_POOL_ALLOCATED(Estimator, memory::ESTIMATORS)
 };
 /**
- * thread unsafe
+ * process wide estimator type registry, ids are handed out with an atomic
+ * increment so estimators may be created from several threads at once
  * */
 struct EstimatorID
 {
     typedef unsigned int Type;
     static Type sNextID;
+    /**
+     * @brief publish a fresh id into slot unless another thread got there first
+     * @return the id stored in slot
+     */
+    static Type registerID(volatile Type* slot)
+    {
+        Type id = *slot;
+        if (id != 0)
+        {
+            return id;
+        }
+        Type fresh = __sync_add_and_fetch(&sNextID, 1);
+        Type old = __sync_val_compare_and_swap(slot, 0, fresh);
+        return old == 0 ? fresh : old;
+    }
 };
 
 template <class Derived>
@@ -36,22 +58,15 @@ class IdentifiableEstimator: public Estimator
 {
 private:
     typedef EstimatorID::Type IDType;
-    static IDType sID;
+    static volatile IDType sID;
 public:
     IdentifiableEstimator()
     {
-        if(sID == 0)
-        {
-            sID = ++EstimatorID::sNextID;
-        }
+        EstimatorID::registerID(&sID);
     }
     static IDType getStaticID()
     {
-        if(sID == 0)
-        {
-            sID = ++EstimatorID::sNextID;
-        }
-        return sID;
+        return EstimatorID::registerID(&sID);
     }
     unsigned int getID()
     {
@@ -60,7 +75,7 @@ public:
 };
 
 template <class Derived>
-EstimatorID::Type IdentifiableEstimator<Derived>::sID = 0;// namespace estimators
+volatile EstimatorID::Type IdentifiableEstimator<Derived>::sID = 0;// namespace estimators
 } // namespace mlplus
 }
 #endif
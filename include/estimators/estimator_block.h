@@ -0,0 +1,219 @@
+#ifndef MLPLUS_ESTIMATORS_ESTIMATORBLOCK_H
+#define MLPLUS_ESTIMATORS_ESTIMATORBLOCK_H
+#include <cmath>
+#include <vector>
+#include "estimators/estimator.h"
+#include "estimators/normal_estimator.h"
+#include "estimators/discrete_estimator.h"
+#include "estimators/binary_estimator.h"
+#include "special_functions.h"
+namespace mlplus
+{
+namespace estimators
+{
+/**
+ * The state of many estimators of one type, stored as flat arrays.
+ *
+ * A block holds one slot per feature, and every slot holds one estimator per
+ * class, so the per (feature, class) cells of a model live next to each other
+ * instead of behind separately allocated Estimator objects. Each estimator
+ * type gets its own specialization with non virtual update() and score()
+ * kernels.
+ *
+ * A block is filled from legacy estimators with add(), accumulates with
+ * update(), writes its state back with exportTo() and is turned into log
+ * probability tables for scoring with compile(). The accumulation state is
+ * released by compile().
+ */
+template <class EstimatorType>
+class EstimatorBlock;
+
+template <>
+class EstimatorBlock<NormalEstimator>
+{
+public:
+    explicit EstimatorBlock(int numClasses = 0);
+    void clear(int numClasses);
+    inline int size() const;
+    /**
+     * @brief append a slot initialised from one NormalEstimator per class
+     * @return the slot index
+     */
+    int add(Estimator** perClass);
+    inline void update(int slot, int cls, double data, double weight);
+    void exportTo(int slot, Estimator** perClass) const;
+    void compile();
+    size_t memoryUsage() const;
+    /**
+     * @brief scores[c] += log P(data | c) for all classes
+     */
+    inline void score(int slot, double data, double* scores) const;
+private:
+    int mNumClasses;
+    int mSize;
+    //all indexed by slot * mNumClasses + class
+    std::vector<double> mPrecision;
+    std::vector<double> mSumOfWeights;
+    std::vector<double> mSumOfValues;
+    std::vector<double> mSumOfValuesSq;
+    std::vector<double> mMean;
+    std::vector<double> mStdDev;
+};
+
+template <>
+class EstimatorBlock<DiscreteEstimator>
+{
+public:
+    explicit EstimatorBlock(int numClasses = 0);
+    void clear(int numClasses);
+    inline int size() const;
+    inline int numSymbols(int slot) const;
+    int add(Estimator** perClass);
+    inline void update(int slot, int cls, double data, double weight);
+    void exportTo(int slot, Estimator** perClass) const;
+    void compile();
+    size_t memoryUsage() const;
+    inline void score(int slot, double data, double* scores) const;
+    /**
+     * @brief scores[c] += weight * log P(symbol | c), the multinomial event model
+     */
+    inline void scoreWeighted(int slot, int symbol, double weight, double* scores) const;
+private:
+    int mNumClasses;
+    std::vector<int> mSymbols;
+    std::vector<size_t> mOffset;
+    //indexed by mOffset[slot] + symbol * mNumClasses + class
+    std::vector<double> mCounts;
+    //indexed by slot * mNumClasses + class
+    std::vector<double> mSums;
+    std::vector<double> mLogProb;
+};
+
+template <>
+class EstimatorBlock<BinaryEstimator>
+{
+public:
+    explicit EstimatorBlock(int numClasses = 0);
+    void clear(int numClasses);
+    inline int size() const;
+    int add(Estimator** perClass);
+    inline void update(int slot, int cls, double data, double weight);
+    void exportTo(int slot, Estimator** perClass) const;
+    void compile();
+    size_t memoryUsage() const;
+    inline void score(int slot, double data, double* scores) const;
+private:
+    int mNumClasses;
+    int mSize;
+    //all indexed by slot * mNumClasses + class
+    std::vector<double> mPositive;
+    std::vector<double> mNegative;
+    std::vector<double> mLogPositive;
+    std::vector<double> mLogNegative;
+};
+
+inline int EstimatorBlock<NormalEstimator>::size() const
+{
+    return mSize;
+}
+inline void EstimatorBlock<NormalEstimator>::update(int slot, int cls, double data, double weight)
+{
+    if(weight == 0)
+        return;
+    int cell = slot * mNumClasses + cls;
+    double precision = mPrecision[cell];
+    data = rint(data / precision) * precision;
+    mSumOfWeights[cell] += weight;
+    mSumOfValues[cell] += data * weight;
+    mSumOfValuesSq[cell] += data * data * weight;
+}
+inline void EstimatorBlock<NormalEstimator>::score(int slot, double data, double* scores) const
+{
+    const double* precision = &mPrecision[slot * mNumClasses];
+    const double* mean = &mMean[slot * mNumClasses];
+    const double* stdDev = &mStdDev[slot * mNumClasses];
+    for (int c = 0; c < mNumClasses; ++c)
+    {
+        double x = rint(data / precision[c]) * precision[c];
+        double zLower = (x - mean[c] - (precision[c] / 2.0)) / stdDev[c];
+        double zUpper = (x - mean[c] + (precision[c] / 2.0)) / stdDev[c];
+        scores[c] += log(phi(zUpper) - phi(zLower));
+    }
+}
+
+inline int EstimatorBlock<DiscreteEstimator>::size() const
+{
+    return mSymbols.size();
+}
+inline int EstimatorBlock<DiscreteEstimator>::numSymbols(int slot) const
+{
+    return mSymbols[slot];
+}
+inline void EstimatorBlock<DiscreteEstimator>::update(int slot, int cls, double data, double weight)
+{
+    if(data < 0 || mSymbols[slot] <= data)
+    {
+        return;
+    }
+    mCounts[mOffset[slot] + (int)data * mNumClasses + cls] += weight;
+    mSums[slot * mNumClasses + cls] += weight;
+}
+inline void EstimatorBlock<DiscreteEstimator>::scoreWeighted(int slot, int symbol, double weight,
+        double* scores) const
+{
+    if(symbol < 0 || symbol >= mSymbols[slot])
+    {
+        double missing = log(0.0) * weight;
+        for (int c = 0; c < mNumClasses; ++c)
+        {
+            scores[c] += missing;
+        }
+        return;
+    }
+    const double* logProb = &mLogProb[mOffset[slot] + symbol * mNumClasses];
+    for (int c = 0; c < mNumClasses; ++c)
+    {
+        scores[c] += logProb[c] * weight;
+    }
+}
+inline void EstimatorBlock<DiscreteEstimator>::score(int slot, double data, double* scores) const
+{
+    int symbol = (int)data;
+    if(symbol < 0 || symbol >= mSymbols[slot])
+    {
+        scoreWeighted(slot, -1, 1, scores);
+        return;
+    }
+    const double* logProb = &mLogProb[mOffset[slot] + symbol * mNumClasses];
+    for (int c = 0; c < mNumClasses; ++c)
+    {
+        scores[c] += logProb[c];
+    }
+}
+
+inline int EstimatorBlock<BinaryEstimator>::size() const
+{
+    return mSize;
+}
+inline void EstimatorBlock<BinaryEstimator>::update(int slot, int cls, double data, double weight)
+{
+    if (data > 0.99)
+    {
+        mPositive[slot * mNumClasses + cls] += weight;
+    }
+    else
+    {
+        mNegative[slot * mNumClasses + cls] += weight;
+    }
+}
+inline void EstimatorBlock<BinaryEstimator>::score(int slot, double data, double* scores) const
+{
+    const double* logProb = data > 0.9 ? &mLogPositive[slot * mNumClasses] : &mLogNegative[slot * mNumClasses];
+    for (int c = 0; c < mNumClasses; ++c)
+    {
+        scores[c] += logProb[c];
+    }
+}
+} // namespace estimators
+} // namespace mlplus
+#endif
@@ -23,6 +23,7 @@ public:
     virtual ~NormalEstimator();
     /*override*/string toString();
     /*override*/void fromString(const std::string&);
+    /*override*/ size_t memoryUsage() const;
     double round(double data)
     {
         return rint(data / mPrecision) * mPrecision;
@@ -30,6 +31,11 @@ public:
     using Estimator::addValue;
     /*override*/void addValue(double data, double weight);
     /*override*/double getProbability(double data);
+    /**
+     * @brief replace the accumulated sums, mean and standard deviation are
+     *        derived from them once instead of on every addValue()
+     */
+    void setSums(double sumOfWeights, double sumOfValues, double sumOfValuesSq);
     double getMean() const { return mMean;}
     double getStdDev() const  { return mStardardDev;}
     double getPrecision() const { return mPrecision;}
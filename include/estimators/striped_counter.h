@@ -0,0 +1,108 @@
+#ifndef MLPLUS_ESTIMATORS_STRIPEDCOUNTER_H
+#define MLPLUS_ESTIMATORS_STRIPEDCOUNTER_H
+#include <stdint.h>
+#include <cstddef>
+namespace mlplus
+{
+namespace estimators
+{
+/**
+ * A fixed width vector of double counters split into per-thread stripes.
+ *
+ * Every writer thread is bound to one stripe (round robin on first use), and
+ * each stripe starts on its own cache line, so concurrent writers do not
+ * bounce lines between cores. Updates are a lock-free compare-and-swap on the
+ * caller's stripe, which only contends when there are more writer threads
+ * than stripes. Readers fold all stripes on demand.
+ */
+class StripedCounter
+{
+public:
+    static const int DEFAULT_STRIPES = 32;
+    static const int CACHE_LINE_SIZE = 64;
+
+    StripedCounter(int width, int numStripes = DEFAULT_STRIPES);
+    ~StripedCounter();
+    inline int width() const;
+    inline int numStripes() const;
+    /**
+     * @brief add delta to counter slot of the calling thread's stripe
+     */
+    inline void add(int slot, double delta);
+    /**
+     * @brief the sum of counter slot over all stripes
+     */
+    double sum(int slot) const;
+    /**
+     * @brief out[i] += sum(i) for every slot
+     */
+    void foldInto(double* out) const;
+    void clear();
+    /**
+     * @brief drop all partials and change the width of the counter
+     */
+    void reset(int width);
+    /**
+     * @brief the stripe the calling thread writes to, assigned on first use
+     */
+    static inline int threadStripe();
+    /**
+     * @brief the bytes of the stripes
+     */
+    size_t memoryUsage() const
+    {
+        return sizeof(double) * mStride * mNumStripes;
+    }
+private:
+    StripedCounter(const StripedCounter&);
+    StripedCounter& operator=(const StripedCounter&);
+    void allocate(int width);
+    void deallocate();
+    static int nextThreadStripe();
+    static inline void atomicAdd(volatile double* target, double delta);
+
+    double* mData;
+    int mWidth;
+    int mStride; //doubles per stripe, rounded up to whole cache lines
+    int mNumStripes;
+    static __thread int tThreadStripe;
+};
+
+inline int StripedCounter::width() const
+{
+    return mWidth;
+}
+inline int StripedCounter::numStripes() const
+{
+    return mNumStripes;
+}
+inline int StripedCounter::threadStripe()
+{
+    if (tThreadStripe < 0)
+    {
+        tThreadStripe = nextThreadStripe();
+    }
+    return tThreadStripe;
+}
+inline void StripedCounter::atomicAdd(volatile double* target, double delta)
+{
+    union
+    {
+        double d;
+        uint64_t u;
+    } expected, desired;
+    do
+    {
+        expected.d = *target;
+        desired.d = expected.d + delta;
+    } while (!__sync_bool_compare_and_swap(reinterpret_cast<volatile uint64_t*>(target),
+                expected.u, desired.u));
+}
+inline void StripedCounter::add(int slot, double delta)
+{
+    int stripe = threadStripe() % mNumStripes;
+    atomicAdd(mData + stripe * mStride + slot, delta);
+}
+} // namespace estimators
+} // namespace mlplus
+#endif
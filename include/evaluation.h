@@ -0,0 +1,108 @@
+#ifndef MLPLUS_EVALUATION_H
+#define MLPLUS_EVALUATION_H
+#include <iostream>
+#include <string>
+#include <vector>
+#include "score_metrics.h"
+namespace mlplus
+{
+class Classifier;
+class DataSet;
+class IInstance;
+/**
+ * Metrics of a multiclass classifier accumulated one prediction at a time:
+ * accuracy, the confusion matrix, per class precision and recall, log-loss
+ * and the one-vs-rest ROC area of every class from score histograms.
+ * Accumulators of different chunks of the data merge() into one, so
+ * predictions never have to be written out and parsed again.
+ */
+class ClassificationMetrics
+{
+public:
+    /**
+     * @param aucBins score bins of every one-vs-rest ROC area, see ScoreHistogram
+     */
+    explicit ClassificationMetrics(int numClasses, int aucBins = 1000);
+    /**
+     * @brief a prediction given as the class probabilities, the predicted class is
+     *        the most probable one. The probabilities are normalized to sum to 1.
+     */
+    void add(int actual, const std::vector<double>& distribution, double weight = 1);
+    /**
+     * @brief a prediction whose class is not the most probable one, as with
+     *        BayesMsgPassing, whose sigmoids can tie at 1 where the scores
+     *        still rank the classes
+     */
+    void add(int actual, int predicted, const std::vector<double>& distribution, double weight = 1);
+    /**
+     * @brief a prediction without probabilities, it counts for the confusion
+     *        matrix only
+     */
+    void add(int actual, int predicted, double weight = 1);
+    void merge(const ClassificationMetrics& other);
+    int numClasses() const {return mNumClasses;}
+    double weight() const;
+    /**
+     * @brief the rows not counted as their class was outside [0, numClasses)
+     */
+    double skipped() const {return mSkipped;}
+    double accuracy() const;
+    /**
+     * @brief the weight of the rows of class actual predicted as predicted
+     */
+    double confusion(int actual, int predicted) const {return mConfusion[actual * mNumClasses + predicted];}
+    double precision(int klass) const;
+    double recall(int klass) const;
+    double f1(int klass) const;
+    /**
+     * @brief the unweighted mean F1 over the classes
+     */
+    double macroF1() const;
+    /**
+     * @brief the mean -log p(actual) of the rows with probabilities, p clipped to 1e-15
+     */
+    double logLoss() const;
+    /**
+     * @brief the ROC area of klass against the rest ranked by the probability of klass
+     */
+    double auc(int klass) const;
+    double aucError(int klass) const;
+    /**
+     * @brief the mean of the one-vs-rest ROC areas weighted by the class weights
+     */
+    double weightedAuc() const;
+    /**
+     * @brief a summary with the confusion matrix, rows are the actual classes.
+     *        Log loss and AUC are left out when no prediction came with
+     *        probabilities
+     */
+    void print(std::ostream& out, const std::vector<std::string>& classNames = std::vector<std::string>()) const;
+private:
+    double classWeight(int klass) const;
+    double predictedWeight(int klass) const;
+    int mNumClasses;
+    std::vector<double> mConfusion;
+    double mSkipped;
+    double mLogLoss;
+    double mLogLossWeight;
+    std::vector<ScoreHistogram> mRoc;
+};
+
+/**
+ * @brief predict every instance of data and accumulate the metrics. Chunks of
+ *        chunkSize instances are predicted on threads workers at once, each into
+ *        its own accumulator; the classifier must allow targetDistribution() from
+ *        several threads, as trained models do. The class of an instance is
+ *        its targetValue().
+ * @param threads the number of workers, every processor if < 1
+ */
+ClassificationMetrics evaluate(Classifier& classifier, DataSet& data, int numClasses,
+                               int threads = 0, int chunkSize = 4096);
+/**
+ * @brief the same over a list of instance indices of data, such as the test fold
+ *        of a cross validation
+ */
+ClassificationMetrics evaluate(Classifier& classifier, DataSet& data, const std::vector<int>& indices,
+                               int numClasses, int threads = 0, int chunkSize = 4096);
+} // namespace mlplus
+#endif
@@ -0,0 +1,78 @@
+#ifndef MLPLUS_FEATURE_HASHER_H
+#define MLPLUS_FEATURE_HASHER_H
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdint.h>
+#include "instance_interface.h"
+namespace mlplus
+{
+/**
+ * The hashing trick for sparse features.
+ *
+ * Every feature, given as a string or an integer id, is mapped to one of
+ * 2^bits buckets by MurmurHash3, so a model trained on hashed features has a
+ * fixed number of attributes however large the vocabulary grows, and every
+ * feature lookup is a plain array index.
+ *
+ * With signed hashing one more bit of the hash picks the sign of the value,
+ * which keeps the collisions unbiased for linear models. Count based models
+ * like NaiveBayes want it off. With numHashes > 1 a feature lands in that many
+ * buckets, hashed with seeds 0 .. numHashes - 1, each receiving the value.
+ */
+class FeatureHasher
+{
+public:
+    typedef std::pair<int, ValueType> HashedFeature; //(bucket, value)
+    static const int MAX_BITS = 30;
+    FeatureHasher(int bits, int numHashes = 1, bool signedHash = false);
+    inline int bits() const;
+    inline int numBuckets() const;
+    inline int numHashes() const;
+    inline bool isSigned() const;
+    /**
+     * @brief append the hashed contributions of one feature to out
+     */
+    void add(const char* key, size_t len, ValueType value, std::vector<HashedFeature>& out) const;
+    inline void add(const std::string& key, ValueType value, std::vector<HashedFeature>& out) const;
+    /**
+     * @brief hash a numeric feature id, the 4 bytes of id in little endian order
+     */
+    void add(int id, ValueType value, std::vector<HashedFeature>& out) const;
+    /**
+     * @brief sort the features by bucket, sum the collisions and drop zeros,
+     *        write the result as sparse instance indices (bucket + offset)
+     *        and values
+     */
+    static void finish(std::vector<HashedFeature>& features, std::vector<int>& indices,
+            std::vector<ValueType>& values, int offset = 0);
+    static uint32_t murmur3(const void* key, size_t len, uint32_t seed);
+private:
+    int mBits;
+    uint32_t mMask;
+    int mNumHashes;
+    bool mSigned;
+};
+
+inline int FeatureHasher::bits() const
+{
+    return mBits;
+}
+inline int FeatureHasher::numBuckets() const
+{
+    return 1 << mBits;
+}
+inline int FeatureHasher::numHashes() const
+{
+    return mNumHashes;
+}
+inline bool FeatureHasher::isSigned() const
+{
+    return mSigned;
+}
+inline void FeatureHasher::add(const std::string& key, ValueType value, std::vector<HashedFeature>& out) const
+{
+    add(key.data(), key.size(), value, out);
+}
+} // namespace mlplus
+#endif
@@ -0,0 +1,570 @@
+#ifndef MLPLUS_FLAT_HASH_MAP_H
+#define MLPLUS_FLAT_HASH_MAP_H
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <string>
+#include <utility>
+#include <stdint.h>
+#include <tr1/functional>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// gcc leaves the probe loop out of line, which costs more than the probe
+#ifdef __GNUC__
+#define MLPLUS_FLAT_HASH_INLINE inline __attribute__((always_inline))
+#else
+#define MLPLUS_FLAT_HASH_INLINE inline
+#endif
+
+namespace mlplus
+{
+/**
+ * @brief the default hasher of FlatHashMap, std::tr1::hash
+ */
+template <typename Key>
+struct FlatHash
+{
+    size_t operator()(const Key& key) const
+    {
+        return std::tr1::hash<Key>()(key);
+    }
+};
+
+namespace flat_hash
+{
+typedef int8_t Control;
+const Control EMPTY = -128;
+const Control DELETED = -2;
+const size_t GROUP = 16;
+
+/**
+ * @brief the 16 control bytes from ctrl, bit i of a mask is slot i
+ */
+class Group
+{
+public:
+#ifdef __SSE2__
+    explicit Group(const Control* ctrl)
+    {
+        mCtrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+    }
+    uint32_t match(Control h2) const
+    {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), mCtrl));
+    }
+    uint32_t matchEmpty() const
+    {
+        return match(EMPTY);
+    }
+    /**
+     * @brief empty or deleted, the sign bit of the control byte
+     */
+    uint32_t matchFree() const
+    {
+        return _mm_movemask_epi8(mCtrl);
+    }
+private:
+    __m128i mCtrl;
+#else
+    // two 64-bit words, bytewise tests on the high bit of every byte
+    explicit Group(const Control* ctrl)
+    {
+        memcpy(mCtrl, ctrl, sizeof(mCtrl));
+    }
+    uint32_t match(Control h2) const
+    {
+        uint64_t pattern = LSBS * (uint8_t)h2;
+        uint32_t mask = 0;
+        for (int w = 0; w < 2; ++w)
+        {
+            // may also flag the byte after a match, the keys are compared anyway
+            uint64_t x = mCtrl[w] ^ pattern;
+            mask |= pack((x - LSBS) & ~x & MSBS) << (8 * w);
+        }
+        return mask;
+    }
+    /**
+     * @brief EMPTY is the only control byte with the high bit set and bit 1 clear
+     */
+    uint32_t matchEmpty() const
+    {
+        return pack(mCtrl[0] & (~mCtrl[0] << 6) & MSBS) | pack(mCtrl[1] & (~mCtrl[1] << 6) & MSBS) << 8;
+    }
+    uint32_t matchFree() const
+    {
+        return pack(mCtrl[0] & MSBS) | pack(mCtrl[1] & MSBS) << 8;
+    }
+private:
+    static const uint64_t LSBS = 0x0101010101010101ull;
+    static const uint64_t MSBS = 0x8080808080808080ull;
+    /**
+     * @brief the high bits of the 8 bytes of x (little endian) to the low 8 bits
+     */
+    static uint32_t pack(uint64_t x)
+    {
+        return (uint32_t)(((x >> 7) * 0x0102040810204080ull) >> 56);
+    }
+    uint64_t mCtrl[2];
+#endif
+};
+
+inline int lowestBit(uint32_t mask)
+{
+    return __builtin_ctz(mask);
+}
+
+/**
+ * @brief std::tr1::hash of an integer is the integer itself, the low bits
+ *        pick the group and the high bits the control byte, so mix both
+ */
+inline size_t mix(size_t h)
+{
+    uint64_t x = (uint64_t)h * 0x9E3779B97F4A7C15ull;
+    return (size_t)(x ^ (x >> 32));
+}
+} // namespace flat_hash
+
+template <typename Map, typename Value>
+class FlatHashIterator
+{
+public:
+    FlatHashIterator(): mMap(NULL), mSlot(0) {}
+    FlatHashIterator(Map* map, size_t slot): mMap(map), mSlot(slot) {}
+    // iterator to const_iterator
+    template <typename OtherMap, typename OtherValue>
+    FlatHashIterator(const FlatHashIterator<OtherMap, OtherValue>& other):
+        mMap(other.mMap), mSlot(other.mSlot)
+    {
+    }
+    Value& operator*() const
+    {
+        return mMap->mSlots[mSlot];
+    }
+    Value* operator->() const
+    {
+        return &mMap->mSlots[mSlot];
+    }
+    FlatHashIterator& operator++()
+    {
+        ++mSlot;
+        skipFree();
+        return *this;
+    }
+    FlatHashIterator operator++(int)
+    {
+        FlatHashIterator it(*this);
+        ++*this;
+        return it;
+    }
+    template <typename OtherMap, typename OtherValue>
+    bool operator==(const FlatHashIterator<OtherMap, OtherValue>& other) const
+    {
+        return mSlot == other.mSlot;
+    }
+    template <typename OtherMap, typename OtherValue>
+    bool operator!=(const FlatHashIterator<OtherMap, OtherValue>& other) const
+    {
+        return mSlot != other.mSlot;
+    }
+private:
+    template <typename, typename> friend class FlatHashIterator;
+    template <typename, typename, typename> friend class FlatHashMap;
+    void skipFree()
+    {
+        while (mSlot < mMap->mCapacity && mMap->mCtrl[mSlot] < 0)
+        {
+            ++mSlot;
+        }
+    }
+    Map* mMap;
+    size_t mSlot;
+};
+
+/**
+ * Open addressing hash map in the Swiss table layout. Entries are kept
+ * inline in one array, and one control byte per slot holds 7 bits of the
+ * hash, or marks the slot empty or deleted. A lookup compares the control
+ * bytes of a 16 slot group at once (SSE2, or a scalar loop) and touches
+ * the entries only on a 7 bit match, so a miss rarely reads a key.
+ *
+ * It replaces std::map and the chained HashTable of hash_table.c on hot
+ * lookups. Unlike std::map, inserting may move entries, so iterators and
+ * pointers to entries are invalid after an insert that grows the table.
+ * Erasing never moves entries.
+ */
+template <typename Key, typename T, typename Hash = FlatHash<Key> >
+class FlatHashMap
+{
+public:
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef std::pair<const Key, T> value_type;
+    typedef FlatHashIterator<FlatHashMap, value_type> iterator;
+    typedef FlatHashIterator<const FlatHashMap, const value_type> const_iterator;
+
+    explicit FlatHashMap(const Hash& hash = Hash());
+    FlatHashMap(const FlatHashMap& other);
+    FlatHashMap& operator=(const FlatHashMap& other);
+    ~FlatHashMap();
+
+    size_t size() const
+    {
+        return mSize;
+    }
+    bool empty() const
+    {
+        return mSize == 0;
+    }
+    /**
+     * @brief slots allocated, a multiple of 16 or 0 before the first insert
+     */
+    size_t capacity() const
+    {
+        return mCapacity;
+    }
+    /**
+     * @brief the bytes of the table, without what the values point to
+     */
+    size_t memoryUsage() const
+    {
+        return sizeof(*this) + mCapacity * (1 + sizeof(value_type));
+    }
+    iterator begin()
+    {
+        return iterator(this, firstFull());
+    }
+    iterator end()
+    {
+        return iterator(this, mCapacity);
+    }
+    const_iterator begin() const
+    {
+        return const_iterator(this, firstFull());
+    }
+    const_iterator end() const
+    {
+        return const_iterator(this, mCapacity);
+    }
+
+    iterator find(const Key& key)
+    {
+        return iterator(this, findSlot(key));
+    }
+    const_iterator find(const Key& key) const
+    {
+        return const_iterator(this, findSlot(key));
+    }
+    size_t count(const Key& key) const
+    {
+        return findSlot(key) != mCapacity;
+    }
+    std::pair<iterator, bool> insert(const value_type& value);
+    T& operator[](const Key& key)
+    {
+        size_t slot = findSlot(key);
+        if (slot != mCapacity)
+        {
+            return mSlots[slot].second;
+        }
+        // insertNew may move mSlots, so not mSlots[insertNew(...)]
+        slot = insertNew(value_type(key, T()));
+        return mSlots[slot].second;
+    }
+    size_t erase(const Key& key);
+    void erase(iterator it);
+    /**
+     * @brief room for n entries without growing
+     */
+    void reserve(size_t n);
+    void clear();
+    void swap(FlatHashMap& other);
+private:
+    template <typename, typename> friend class FlatHashIterator;
+    enum
+    {
+        // grow past 7/8 full
+        LOAD_NUMERATOR = 7, LOAD_DENOMINATOR = 8
+    };
+    size_t hash(const Key& key) const
+    {
+        return flat_hash::mix(mHash(key));
+    }
+    static flat_hash::Control h2(size_t h)
+    {
+        return (flat_hash::Control)(h & 0x7F);
+    }
+    size_t findSlot(const Key& key) const;
+    size_t firstFull() const
+    {
+        size_t slot = 0;
+        while (slot < mCapacity && mCtrl[slot] < 0)
+        {
+            ++slot;
+        }
+        return slot;
+    }
+    /**
+     * @brief the first empty or deleted slot on the probe sequence of h
+     */
+    size_t findFree(size_t h) const;
+    /**
+     * @brief insert a key known to be missing, returns its slot
+     */
+    size_t insertNew(const value_type& value);
+    void rehash(size_t capacity);
+    void destroy();
+    static size_t maxLoad(size_t capacity)
+    {
+        return capacity / LOAD_DENOMINATOR * LOAD_NUMERATOR;
+    }
+
+    Hash mHash;
+    flat_hash::Control* mCtrl;
+    value_type* mSlots;
+    size_t mCapacity;
+    size_t mSize;
+    // inserts into empty slots left before a rehash, deleted slots count as used
+    size_t mGrowthLeft;
+};
+
+template <typename Key, typename T, typename Hash>
+FlatHashMap<Key, T, Hash>::FlatHashMap(const Hash& hash):
+    mHash(hash), mCtrl(NULL), mSlots(NULL), mCapacity(0), mSize(0), mGrowthLeft(0)
+{
+}
+
+template <typename Key, typename T, typename Hash>
+FlatHashMap<Key, T, Hash>::FlatHashMap(const FlatHashMap& other):
+    mHash(other.mHash), mCtrl(NULL), mSlots(NULL), mCapacity(0), mSize(0), mGrowthLeft(0)
+{
+    reserve(other.mSize);
+    for (const_iterator it = other.begin(); it != other.end(); ++it)
+    {
+        insert(*it);
+    }
+}
+
+template <typename Key, typename T, typename Hash>
+FlatHashMap<Key, T, Hash>& FlatHashMap<Key, T, Hash>::operator=(const FlatHashMap& other)
+{
+    if (this != &other)
+    {
+        FlatHashMap copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+template <typename Key, typename T, typename Hash>
+FlatHashMap<Key, T, Hash>::~FlatHashMap()
+{
+    destroy();
+}
+
+template <typename Key, typename T, typename Hash>
+MLPLUS_FLAT_HASH_INLINE size_t FlatHashMap<Key, T, Hash>::findSlot(const Key& key) const
+{
+    using namespace flat_hash;
+    if (mCapacity == 0)
+    {
+        return 0;
+    }
+    size_t h = hash(key);
+    size_t groupMask = mCapacity / GROUP - 1;
+    size_t group = (h >> 7) & groupMask;
+    for (size_t probe = 1; ; ++probe)
+    {
+        const Control* ctrl = mCtrl + group * GROUP;
+        Group g(ctrl);
+        for (uint32_t mask = g.match(h2(h)); mask != 0; mask &= mask - 1)
+        {
+            size_t slot = group * GROUP + lowestBit(mask);
+            if (mSlots[slot].first == key)
+            {
+                return slot;
+            }
+        }
+        // a key never probes past a group that still has an empty slot, and
+        // the load limit leaves an empty slot in every table
+        if (g.matchEmpty() != 0)
+        {
+            return mCapacity;
+        }
+        // triangular steps visit every group of a power of two table
+        group = (group + probe) & groupMask;
+    }
+}
+
+template <typename Key, typename T, typename Hash>
+size_t FlatHashMap<Key, T, Hash>::findFree(size_t h) const
+{
+    using namespace flat_hash;
+    size_t groupMask = mCapacity / GROUP - 1;
+    size_t group = (h >> 7) & groupMask;
+    for (size_t probe = 1; ; ++probe)
+    {
+        uint32_t mask = Group(mCtrl + group * GROUP).matchFree();
+        if (mask != 0)
+        {
+            return group * GROUP + lowestBit(mask);
+        }
+        group = (group + probe) & groupMask;
+    }
+}
+
+template <typename Key, typename T, typename Hash>
+std::pair<typename FlatHashMap<Key, T, Hash>::iterator, bool>
+FlatHashMap<Key, T, Hash>::insert(const value_type& value)
+{
+    size_t slot = findSlot(value.first);
+    if (slot != mCapacity)
+    {
+        return std::make_pair(iterator(this, slot), false);
+    }
+    return std::make_pair(iterator(this, insertNew(value)), true);
+}
+
+template <typename Key, typename T, typename Hash>
+size_t FlatHashMap<Key, T, Hash>::insertNew(const value_type& value)
+{
+    size_t h = hash(value.first);
+    if (mCapacity == 0)
+    {
+        rehash(flat_hash::GROUP);
+    }
+    size_t slot = findFree(h);
+    if (mCtrl[slot] == flat_hash::EMPTY && mGrowthLeft == 0)
+    {
+        // mostly tombstones: clean up in place, otherwise double
+        rehash(mSize * 2 < maxLoad(mCapacity) ? mCapacity : mCapacity * 2);
+        slot = findFree(h);
+    }
+    new (&mSlots[slot]) value_type(value);
+    mGrowthLeft -= mCtrl[slot] == flat_hash::EMPTY;
+    mCtrl[slot] = h2(h);
+    ++mSize;
+    return slot;
+}
+
+template <typename Key, typename T, typename Hash>
+size_t FlatHashMap<Key, T, Hash>::erase(const Key& key)
+{
+    size_t slot = findSlot(key);
+    if (slot == mCapacity)
+    {
+        return 0;
+    }
+    erase(iterator(this, slot));
+    return 1;
+}
+
+template <typename Key, typename T, typename Hash>
+void FlatHashMap<Key, T, Hash>::erase(iterator it)
+{
+    using namespace flat_hash;
+    size_t slot = it.mSlot;
+    assert(slot < mCapacity && mCtrl[slot] >= 0);
+    mSlots[slot].~value_type();
+    --mSize;
+    // a group with an empty slot never had a probe pass through it, so the
+    // slot can be empty again rather than a tombstone
+    if (Group(mCtrl + slot / GROUP * GROUP).matchEmpty() != 0)
+    {
+        mCtrl[slot] = EMPTY;
+        ++mGrowthLeft;
+    }
+    else
+    {
+        mCtrl[slot] = DELETED;
+    }
+}
+
+template <typename Key, typename T, typename Hash>
+void FlatHashMap<Key, T, Hash>::reserve(size_t n)
+{
+    size_t capacity = mCapacity == 0 ? flat_hash::GROUP : mCapacity;
+    while (maxLoad(capacity) < n)
+    {
+        capacity *= 2;
+    }
+    if (capacity != mCapacity)
+    {
+        rehash(capacity);
+    }
+}
+
+template <typename Key, typename T, typename Hash>
+void FlatHashMap<Key, T, Hash>::rehash(size_t capacity)
+{
+    using namespace flat_hash;
+    assert(capacity % GROUP == 0 && (capacity & (capacity - 1)) == 0);
+    assert(maxLoad(capacity) >= mSize);
+    Control* oldCtrl = mCtrl;
+    value_type* oldSlots = mSlots;
+    size_t oldCapacity = mCapacity;
+    // one block: the control bytes, then the entries, 16 byte aligned since
+    // the capacity is a multiple of 16
+    char* block = static_cast<char*>(::operator new(capacity * (1 + sizeof(value_type))));
+    mCtrl = reinterpret_cast<Control*>(block);
+    mSlots = reinterpret_cast<value_type*>(block + capacity);
+    memset(mCtrl, EMPTY, capacity);
+    mCapacity = capacity;
+    mGrowthLeft = maxLoad(capacity) - mSize;
+    for (size_t i = 0; i < oldCapacity; ++i)
+    {
+        if (oldCtrl[i] >= 0)
+        {
+            size_t h = hash(oldSlots[i].first);
+            size_t slot = findFree(h);
+            new (&mSlots[slot]) value_type(oldSlots[i]);
+            mCtrl[slot] = h2(h);
+            oldSlots[i].~value_type();
+        }
+    }
+    ::operator delete(oldCtrl);
+}
+
+template <typename Key, typename T, typename Hash>
+void FlatHashMap<Key, T, Hash>::clear()
+{
+    for (size_t i = 0; i < mCapacity; ++i)
+    {
+        if (mCtrl[i] >= 0)
+        {
+            mSlots[i].~value_type();
+        }
+    }
+    if (mCapacity != 0)
+    {
+        memset(mCtrl, flat_hash::EMPTY, mCapacity);
+    }
+    mSize = 0;
+    mGrowthLeft = maxLoad(mCapacity);
+}
+
+template <typename Key, typename T, typename Hash>
+void FlatHashMap<Key, T, Hash>::swap(FlatHashMap& other)
+{
+    std::swap(mHash, other.mHash);
+    std::swap(mCtrl, other.mCtrl);
+    std::swap(mSlots, other.mSlots);
+    std::swap(mCapacity, other.mCapacity);
+    std::swap(mSize, other.mSize);
+    std::swap(mGrowthLeft, other.mGrowthLeft);
+}
+
+template <typename Key, typename T, typename Hash>
+void FlatHashMap<Key, T, Hash>::destroy()
+{
+    clear();
+    ::operator delete(mCtrl);
+    mCtrl = NULL;
+    mSlots = NULL;
+    mCapacity = 0;
+    mGrowthLeft = 0;
+}
+} // namespace mlplus
+#endif
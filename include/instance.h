@@ -1,8 +1,8 @@
 #ifndef MLPLUS_INSTANCE_H
 #define MLPLUS_INSTANCE_H
-#include <map>
 #include <vector>
 #include "abstract_instance.h"
+#include "flat_hash_map.h"
 namespace mlplus
 {
 class DenseInstance:public AbstractInstance
@@ -18,6 +18,7 @@ public:
     /*override*/ void setValue(int attrIndex, ValueType value);
     /*override*/ ValueType getValue(int attrIndex);
     /*overirde*/ int attributeIndex(int localIdx);
+    /*override*/ size_t memoryUsage() const;
 };
 class SparseInstance: public AbstractInstance
 {
@@ -32,11 +33,12 @@ public:
     /*override*/void setValue(int attrIndex, ValueType value);
     /*override*/ValueType getValue(int attrIndex);
     /*overirde*/ int attributeIndex(int localIdx);
+    /*override*/ size_t memoryUsage() const;
 private:
     void initGlobal2LocalMap();
     int findPosition(int globalIndex) const;
-    std::vector<int> mIndices;
-    std::map<int,int> mGlobal2Local;
+    std::vector<int, PoolAllocator<int, memory::DATASET_VALUES> > mIndices;
+    FlatHashMap<int, int> mGlobal2Local;
 };
 }
 
@@ -1,7 +1,10 @@
 #ifndef MLPLUS_INSTANCE_CONTAINER_H
 #define MLPLUS_INSTANCE_CONTAINER_H
+#include <deque>
+#include <map>
 #include <vector>
 #include "instance_container_interface.h"
+#include "instance_ref.h"
 #include "iterator_interface.h"
 #include "ptr_define.h"
 namespace mlplus
@@ -35,6 +38,7 @@ public:
     /*override*/ IInstance* first();
     /*override*/ IInstance* next(int index);
     /*override*/ IInstanceIterator* newIterator();
+    /*override*/ size_t memoryUsage() const;
 private:
     std::vector<SharedInstancePtr> mInnerContainer;
     friend class DenseInstanceIterator;
@@ -55,6 +59,7 @@ public:
     /*override*/ IInstance* first();
     /*override*/ IInstance* next(int index);
     /*override*/ IInstanceIterator* newIterator();
+    /*override*/ size_t memoryUsage() const;
 private:
     std::map<int, SharedInstancePtr> mInnerContainer;
     friend class SparseInstanceIterator;
@@ -71,5 +76,58 @@ private:
     SparseInstanceContainer& mContainer;
     std::map<int, SharedInstancePtr>::iterator mCur;
 };
+class InstanceViewContainer;
+class InstanceViewIterator: public IInstanceIterator
+{
+public:
+    InstanceViewIterator(InstanceViewContainer& dit);
+    /*override*/bool hasMore() const;
+    /*override*/void  reset();
+    /*override*/IInstance* next();
+private:
+    InstanceViewContainer& mContainer;
+    unsigned mCurrent;
+};
+
+/**
+ * The instances of other containers by pointer, without owning them, so a
+ * cross validation fold or a sample is a list of rows rather than a copy.
+ * The containers the instances come from must outlive the view. The same
+ * instance may be added more than once, and with a weight of the view's own
+ * through an InstanceRef.
+ */
+class InstanceViewContainer:public IInstanceContainer
+{
+private:
+    InstanceViewContainer(const InstanceViewContainer&);
+public:
+    InstanceViewContainer();
+    /*override*/ ~InstanceViewContainer();
+    /*override*/ void clear();
+    /**
+     * @brief a dense container owning clones of the instances
+     */
+    /*override*/ DenseInstanceContainer* deepCopy();
+    /*override*/ unsigned size() const;
+    /*override*/ void add(IInstance* pInstance);
+    /*override*/ bool set(int index, IInstance* attr);
+    /*override*/ IInstance* at(int index);
+    /*override*/ IInstance* first();
+    /*override*/ IInstance* next(int index);
+    /*override*/ IInstanceIterator* newIterator();
+    /**
+     * @brief the view and its refs, not the instances it sees
+     */
+    /*override*/ size_t memoryUsage() const;
+    /**
+     * @brief add the instance seen with the given weight, its values are not copied
+     */
+    void add(IInstance* pInstance, double weight);
+    void reserve(unsigned size);
+private:
+    std::vector<IInstance*> mInnerContainer;
+    std::deque<InstanceRef> mRefs;
+    friend class InstanceViewIterator;
+};
 }
 #endif
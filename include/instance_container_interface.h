@@ -1,5 +1,6 @@
 #ifndef MLPLUS_INSTANCE_CONTAINER_INTERFACE_H
 #define MLPLUS_INSTANCE_CONTAINER_INTERFACE_H
+#include <cstddef>
 namespace mlplus
 {
 class IInstance;
@@ -18,6 +19,10 @@ public:
     virtual IInstance* first() = 0;
     virtual IInstance* next(int index) = 0;
     virtual IInstanceIterator* newIterator() = 0;
+    /**
+     * @brief the bytes of the container and the instances it owns
+     */
+    virtual size_t memoryUsage() const = 0;
     /*
        virtual bool compare(const InstanceContainer& Instances) const = 0;
        virtual bool setInstanceReader(InstanceReader* pReader) = 0;
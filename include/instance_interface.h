@@ -2,10 +2,14 @@
 #define MLPLUS_INSTANCE_INTERFACE_H
 #include <string>
 #include <iterator>
+#include <vector>
+#include "pool_allocator.h"
 namespace mlplus
 {
 using namespace std;
 typedef float ValueType;
+// the values of an instance, from the size classes of MemoryPool
+typedef std::vector<ValueType, PoolAllocator<ValueType, memory::DATASET_VALUES> > ValueArray;
 class Attribute;
 class DataSet;
 class IInstance
@@ -23,7 +27,7 @@ public:
     virtual int targetIndex() = 0;
     virtual bool targetIsMissing() = 0;
     virtual ValueType targetValue() = 0;
-    virtual const std::vector<ValueType>&  getValueArray() const = 0;
+    virtual const ValueArray&  getValueArray() const = 0;
     virtual DataSet* getDataset(void) = 0;
     virtual void setDataset(DataSet* instances) = 0;
 
@@ -52,6 +56,10 @@ public:
     virtual void setValue(int attrIndex, ValueType value) = 0;
     virtual void setValue(int attrIndex, const string& value) = 0;
     virtual void setValue(Attribute& attr, const string& value) = 0;
+    /**
+     * @brief the bytes of the instance and the arrays it owns
+     */
+    virtual size_t memoryUsage() const = 0;
 
 };
 
@@ -0,0 +1,69 @@
+#ifndef MLPLUS_INSTANCE_REF_H
+#define MLPLUS_INSTANCE_REF_H
+#include <vector>
+#include "instance_interface.h"
+namespace mlplus
+{
+/**
+ * An instance of another container seen with a weight of its own, so a
+ * weighted sample can reweight rows without copying their values. Every
+ * other call goes to the referenced instance, which must outlive the ref.
+ */
+class InstanceRef: public IInstance
+{
+public:
+    InstanceRef(IInstance* instance, double weight): mInstance(instance), mWeight(weight) {}
+    IInstance* instance() const {return mInstance;}
+    /*override*/ bool isSparse() {return mInstance->isSparse();}
+    /**
+     * @brief a copy of the referenced instance with the weight of the ref
+     */
+    /*override*/ IInstance* clone()
+    {
+        IInstance* copy = mInstance->clone();
+        copy->setWeight(mWeight);
+        return copy;
+    }
+    /*override*/ int getGroupId() const {return mInstance->getGroupId();}
+    /*override*/ void setGroupId(int id) {mInstance->setGroupId(id);}
+    /*override*/ void reserve(int numAttribue) {mInstance->reserve(numAttribue);}
+    /*override*/ Attribute* attributeAt(int globalIndex) {return mInstance->attributeAt(globalIndex);}
+    /*override*/ Attribute* targetAttribute() {return mInstance->targetAttribute();}
+    /*override*/ int attributeIndex(int localIdx) {return mInstance->attributeIndex(localIdx);}
+    /*override*/ int targetIndex() {return mInstance->targetIndex();}
+    /*override*/ bool targetIsMissing() {return mInstance->targetIsMissing();}
+    /*override*/ ValueType targetValue() {return mInstance->targetValue();}
+    /*override*/ const ValueArray& getValueArray() const {return mInstance->getValueArray();}
+    /*override*/ DataSet* getDataset(void) {return mInstance->getDataset();}
+    /*override*/ void setDataset(DataSet* instances) {mInstance->setDataset(instances);}
+    /*override*/ int numAttributes() {return mInstance->numAttributes();}
+    /*override*/ int numTargets() {return mInstance->numTargets();}
+    /*override*/ int numValues() {return mInstance->numValues();}
+    /*override*/ void replaceMissingValues(ValueType value) {mInstance->replaceMissingValues(value);}
+    /*override*/ void setTargetMissing() {mInstance->setTargetMissing();}
+    /*override*/ void setTargetValue(ValueType value) {mInstance->setTargetValue(value);}
+    /*override*/ void setTargetValue(const string& value) {mInstance->setTargetValue(value);}
+    /*override*/ bool hasMissingValue() {return mInstance->hasMissingValue();}
+    /*override*/ void setMissing(int attrIndex) {mInstance->setMissing(attrIndex);}
+    /*override*/ void setMissing(Attribute& attr) {mInstance->setMissing(attr);}
+    /*override*/ bool isMissing(int attrIndex) {return mInstance->isMissing(attrIndex);}
+    /*override*/ bool isMissing(Attribute& attr) {return mInstance->isMissing(attr);}
+    /*override*/ void setWeight(double weight) {mWeight = weight;}
+    /*override*/ double getWeight() {return mWeight;}
+    /*override*/ ValueType getValue(int attrIndex) {return mInstance->getValue(attrIndex);}
+    /*override*/ ValueType getValue(Attribute& attr) {return mInstance->getValue(attr);}
+    /*override*/ ValueType getValue(Attribute* attr) {return mInstance->getValue(attr);}
+    /*override*/ void setValue(Attribute& attr, ValueType value) {mInstance->setValue(attr, value);}
+    /*override*/ void setValue(int attrIndex, ValueType value) {mInstance->setValue(attrIndex, value);}
+    /*override*/ void setValue(int attrIndex, const string& value) {mInstance->setValue(attrIndex, value);}
+    /*override*/ void setValue(Attribute& attr, const string& value) {mInstance->setValue(attr, value);}
+    /**
+     * @brief the ref alone, the instance belongs to another container
+     */
+    /*override*/ size_t memoryUsage() const {return sizeof(*this);}
+private:
+    IInstance* mInstance;
+    double mWeight;
+};
+} // namespace mlplus
+#endif
@@ -0,0 +1,129 @@
+#ifndef MLPLUS_ITEMSET_MINING_H
+#define MLPLUS_ITEMSET_MINING_H
+#include <stdint.h>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <vector>
+#include "bitset.h"
+#include "roaring_bitset.h"
+namespace mlplus
+{
+class DataSet;
+/**
+ * Frequent itemsets and association rules (Agrawal and Srikant 1994) over
+ * the transactions of a dataset.
+ *
+ * Transaction t holds item a when attribute a of instance t is set and not
+ * zero, so a sparse dataset read from an svm-light style file is a basket
+ * file. load() turns it on its side: every frequent item gets the set of
+ * transactions holding it, a DenseBitset while it covers at least one
+ * transaction in TIDSET_DENSE and a RoaringBitset below that.
+ *
+ * mine() runs Eclat over these tid sets: the support of an itemset is the
+ * popcount of the intersection of the tid sets of two of its subsets, and
+ * only frequent itemsets have their intersection built. The subtree under
+ * each frequent item is a task on a ThreadPool. The pairs, the most
+ * candidates by far, are counted by load() in a triangular table over the
+ * rows when there are at most PAIR_TABLE_ITEMS frequent items.
+ */
+struct FrequentItemset
+{
+    std::vector<int> items; //attribute indices, increasing
+    size_t support;
+};
+
+struct AssociationRule
+{
+    std::vector<int> antecedent;
+    std::vector<int> consequent;
+    size_t support; //of the antecedent and the consequent together
+    double confidence;
+    double lift;
+};
+
+/**
+ * receives the rules as they are found
+ */
+class RuleSink
+{
+public:
+    virtual ~RuleSink() {}
+    virtual void add(const AssociationRule& rule) = 0;
+};
+
+/**
+ * writes a rule a line: "1 7 => 3\tsupport\tconfidence\tlift"
+ */
+class RuleWriter: public RuleSink
+{
+public:
+    explicit RuleWriter(std::ostream& out): mOut(out) {}
+    /*override*/ void add(const AssociationRule& rule);
+private:
+    std::ostream& mOut;
+};
+
+class ItemsetMiner
+{
+public:
+    static const size_t TIDSET_DENSE = 16;
+    static const size_t PAIR_TABLE_ITEMS = 4096;
+    /**
+     * @param minSupport the fewest transactions of a frequent itemset, a
+     *        fraction of them when below 1
+     * @param maxLength the most items of an itemset, no limit if < 1
+     * @param threads every processor if < 1
+     */
+    explicit ItemsetMiner(double minSupport, int maxLength = 0, int threads = 0);
+    /**
+     * @param skipAttribute an attribute that is no item, the target of a
+     *        labelled file
+     */
+    void load(DataSet* data, int skipAttribute = -1);
+    size_t numTransactions() const {return mNumTransactions;}
+    size_t minSupport() const {return mMinSupport;}
+    /**
+     * @brief the items in at least minSupport() transactions
+     */
+    int numFrequentItems() const {return mItems.size();}
+    /**
+     * @brief every frequent itemset, the items first
+     */
+    void mine(std::vector<FrequentItemset>& itemsets) const;
+    /**
+     * @brief every rule X => Y of confidence at least minConfidence with
+     *        X u Y in itemsets; the subsets of each one must be in itemsets
+     *        too, as mine() returns them
+     */
+    void rules(const std::vector<FrequentItemset>& itemsets, double minConfidence, RuleSink& sink) const;
+    /**
+     * @brief the bytes of the tid sets
+     */
+    size_t memoryUsage() const;
+    /**
+     * @brief the transactions of a set of items, a bitmap or a roaring set
+     */
+    struct Tidset
+    {
+        Tidset(): dense(false), support(0) {}
+        bool dense;
+        DenseBitset bits;
+        RoaringBitset ids;
+        size_t support;
+    };
+private:
+    typedef std::map<std::vector<int>, size_t> SupportMap;
+    void ruleHelper(const FrequentItemset& itemset, const SupportMap& supports,
+                    double minConfidence, RuleSink& sink) const;
+    double mSupportFraction;
+    size_t mMinSupport;
+    int mMaxLength;
+    int mThreads;
+    size_t mNumTransactions;
+    std::vector<int> mItems; //by increasing support
+    std::vector<Tidset> mTidsets;
+    std::vector<uint32_t> mPairSupport; //of ranks i < j at j * (j - 1) / 2 + i
+};
+} // namespace mlplus
+#endif
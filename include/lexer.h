@@ -3,6 +3,7 @@
 #include <inttypes.h>
 #include <map>
 #include <string>
+#include "pool_allocator.h"
 namespace mlplus
 {
 enum TokenType
@@ -65,6 +66,7 @@ public:
     {
         str[0] = '\0';
     }
+    MLPLUS_POOL_ALLOCATED(Token, memory::PARSER_BUFFERS)
 };
 class Lexer
 {
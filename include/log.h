@@ -39,9 +39,38 @@ public:
 		ERROR_LEVEL = 2
 	}LogType;
 
+	typedef enum
+    {
+		BLOCK_WHEN_FULL = 0,
+		DROP_WHEN_FULL = 1
+	}OverflowPolicy;
+
+	static const int RECORD_SIZE = 1024;
+
 	static Logger* instance();
 	static Logger* instance(LogType level);
 
+	/**
+	 * @brief switch to asynchronous logging.  Every thread formats its records
+	 *        in a thread local buffer and pushes them to a lock-free ring of
+	 *        capacity records (rounded up to a power of 2) drained by a
+	 *        background writer thread, which sleeps on a condition variable
+	 *        while the ring is empty.  When the ring is full a record is
+	 *        dropped or the caller spins until there is room, as the policy
+	 *        says.  Set the log handler before starting.
+	 * @return false if the writer thread cannot be started
+	 */
+	bool startAsync(size_t capacity = 4096, OverflowPolicy policy = DROP_WHEN_FULL);
+	/**
+	 * @brief write out the queued records and return to synchronous logging
+	 */
+	void stopAsync();
+	bool isAsync();
+	/**
+	 * @brief the number of records dropped because the ring was full
+	 */
+	unsigned long droppedRecords();
+
 	LogType setLogLevel(LogType level);
 	bool setLogHandler(const char* file = NULL);
 	FILE* setLogHandler(FILE* file_p = stderr);
@@ -62,8 +91,22 @@ private:
 	void log_trace_pure(int level, const char* fmt, va_list vap);
 	void trace_pure(const char* fmt, va_list vap);
 
+	struct LogRecord
+	{
+		volatile size_t sequence;
+		int level;
+		int length;
+		char text[RECORD_SIZE];
+	};
+
 	static void releaseHandler();
 	static void get_cur_time(char cur[]);
+	static void write_record(int level, const char* buffer, int len);
+	static bool enqueue_record(int level, const char* buffer, int len);
+	static void wake_writer();
+	static bool record_ready();
+	static bool dequeue_record();
+	static void* async_writer(void*);
 
 	int set_log_handler(const char* file);
 	//int set_log_level(int level);
@@ -74,6 +117,19 @@ private:
 	static pthread_mutex_t mlog_mutex;	
 	static const char* msg_psLevelName[];
 
+	static LogRecord* mring;
+	static size_t mring_mask;
+	static volatile size_t menqueue_pos;
+	static size_t mdequeue_pos;
+	static volatile int masync;
+	static volatile int mactive_producers;
+	static volatile unsigned long mdropped;
+	static OverflowPolicy moverflow;
+	static pthread_t mwriter;
+	static pthread_mutex_t mwriter_mutex;
+	static pthread_cond_t mwriter_cond;
+	static volatile int mwriter_sleeping;
+
 };
 }
 
@@ -0,0 +1,184 @@
+#ifndef MLPLUS_MEMORY_ACCOUNTING_H
+#define MLPLUS_MEMORY_ACCOUNTING_H
+#include <stdint.h>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+namespace mlplus
+{
+namespace memory
+{
+/**
+ * Live bytes of the core by subsystem.
+ *
+ * Allocations of the tagged subsystems charge() their tag and release() it
+ * when freed: pool allocators and MLPLUS_POOL_ALLOCATED classes take a tag,
+ * and so does an Arena. Each thread collects its changes without atomics and
+ * adds them to the process totals once they pass FLUSH_BYTES, so the totals
+ * and peaks are exact to FLUSH_BYTES per thread; flushThread() settles the
+ * calling thread's share.
+ *
+ * A Phase marks a step of a tool, like loading or training, and records the
+ * peak of the tagged bytes and of the process' resident set while it ran.
+ * A program that began a phase writes the report at exit to the file named
+ * by MLPLUS_MEMORY_OUTPUT, "-" for stderr; the report is JSON when the name
+ * ends in ".json" or when MLPLUS_MEMORY_FORMAT=json.
+ *
+ * memoryUsage() of a dataset, a container or a classifier walks the object
+ * instead and counts what it holds, tagged or not.
+ */
+enum Tag
+{
+    UNTAGGED = -1,
+    DATASET_VALUES = 0, //instances, their value and index arrays
+    ATTRIBUTES,
+    ESTIMATORS,
+    TREE_NODES,
+    PARSER_BUFFERS, //lines, fields and tokens of the parsers
+    NUM_TAGS
+};
+static const int64_t FLUSH_BYTES = 64 * 1024;
+
+const char* tagName(Tag tag);
+inline void charge(Tag tag, size_t bytes);
+inline void release(Tag tag, size_t bytes);
+/**
+ * @brief add the calling thread's pending changes to the totals
+ */
+void flushThread();
+/**
+ * @brief the bytes of tag in use, and the most ever in use
+ */
+int64_t bytesInUse(Tag tag);
+int64_t peakBytes(Tag tag);
+int64_t totalBytesInUse();
+int64_t totalPeakBytes();
+/**
+ * @brief the peak resident set of the process in bytes
+ */
+size_t peakResidentBytes();
+
+struct PhaseRecord
+{
+    std::string name;
+    int64_t startBytes;
+    int64_t endBytes;
+    int64_t peakBytes; //of all tags together
+    int64_t endBytesByTag[NUM_TAGS];
+    size_t peakResidentBytes; //of the process, so far
+    double seconds;
+};
+
+/**
+ * A step of a program from construction to end() or destruction. Phases may
+ * nest, an outer phase's peak covers its inner ones.
+ */
+class Phase
+{
+public:
+    explicit Phase(const std::string& name);
+    ~Phase();
+    void end();
+private:
+    Phase(const Phase&);
+    Phase& operator=(const Phase&);
+    PhaseRecord mRecord;
+    int64_t mOuterPeak;
+    double mStart;
+    bool mEnded;
+};
+
+/**
+ * @brief every phase ended, in the order they ended
+ */
+std::vector<PhaseRecord> phases();
+/**
+ * @brief the bytes in use and the peak of every tag, then the phases
+ */
+void report(FILE* out, bool json);
+
+/**
+ * @brief a buffer of a few objects whose size changes, charged as it goes;
+ *        the charge is released on destruction
+ */
+class ScopedCharge
+{
+public:
+    explicit ScopedCharge(Tag tag): mTag(tag), mBytes(0) {}
+    ~ScopedCharge()
+    {
+        release(mTag, mBytes);
+    }
+    void set(size_t bytes)
+    {
+        if (bytes != mBytes)
+        {
+            charge(mTag, bytes);
+            release(mTag, mBytes);
+            mBytes = bytes;
+        }
+    }
+private:
+    ScopedCharge(const ScopedCharge&);
+    ScopedCharge& operator=(const ScopedCharge&);
+    Tag mTag;
+    size_t mBytes;
+};
+
+/**
+ * @brief the heap bytes of a string, nothing when it fits in the object
+ */
+inline size_t stringBytes(const std::string& s)
+{
+#if defined(_GLIBCXX_USE_CXX11_ABI) && _GLIBCXX_USE_CXX11_ABI
+    return s.capacity() > 15 ? s.capacity() + 1 : 0;
+#else
+    return s.capacity() > 0 ? s.capacity() + 1 + 3 * sizeof(size_t) : 0;
+#endif
+}
+template <class Vector>
+inline size_t vectorBytes(const Vector& v)
+{
+    return v.capacity() * sizeof(typename Vector::value_type);
+}
+/**
+ * @brief the bytes of a std::map or std::set node holding a value of valueSize
+ */
+inline size_t treeNodeBytes(size_t valueSize)
+{
+    return valueSize + 4 * sizeof(void*);
+}
+/**
+ * @brief the count block of a tr1::shared_ptr
+ */
+static const size_t SHARED_COUNT_BYTES = 4 * sizeof(void*);
+
+namespace detail
+{
+extern __thread int64_t tPending[NUM_TAGS];
+// 0 until the thread's first flush, so its first charge registers it
+extern __thread int64_t tFlushBytes;
+void flush(Tag tag);
+}
+
+inline void charge(Tag tag, size_t bytes)
+{
+    int64_t pending = detail::tPending[tag] += bytes;
+    if (pending >= detail::tFlushBytes)
+    {
+        detail::flush(tag);
+    }
+}
+
+inline void release(Tag tag, size_t bytes)
+{
+    int64_t pending = detail::tPending[tag] -= bytes;
+    if (-pending >= detail::tFlushBytes)
+    {
+        detail::flush(tag);
+    }
+}
+} // namespace memory
+} // namespace mlplus
+#endif
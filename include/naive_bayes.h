@@ -9,6 +9,7 @@
 #include "dataset.h"
 #include "classifier.h"
 #include "estimators/estimator.h"
+#include "naive_bayes_kernel.h"
 using namespace mlplus::estimators;
 namespace mlplus
 {
@@ -25,6 +26,9 @@ private:
     EstimatorPtr mClassDistribution;
     int mClassesCount;
     bool mEventModel;
+    int mConcurrency;
+    NaiveBayesKernel mKernel;
+    bool mKernelReady;
     void release();
     NaiveBayes(const NaiveBayes& bas);
 public:
@@ -37,20 +41,56 @@ public:
     inline void setClassDistribution(EstimatorPtr est);
     inline void setEventModel(bool v = true);
     inline bool getEventModel() const;
+    /**
+     * @brief the number of classes, as read by load()
+     */
+    inline int numClasses() const;
+    /**
+     * @brief let update() be called from many threads at once.
+     *        estimators created by later train()/load() calls keep striped
+     *        counters with the given number of stripes, 0 restores the single
+     *        writer estimators. train() on a dataset without instances only
+     *        allocates the model, so ingest threads can feed it afterwards.
+     *        Every stripe of an estimator takes at least one 64 byte cache
+     *        line, so with the default 32 stripes a binary or normal
+     *        estimator grows from tens of bytes to 2KB. For large sparse
+     *        models, use few stripes or fold into a single writer model
+     *        after ingest. Concurrent models run on the virtual
+     *        estimators, never on the compiled kernel.
+     */
+    inline void setConcurrency(int stripes);
+    inline int getConcurrency() const;
+    /**
+     * @brief copy the estimators into the devirtualized scoring kernel.
+     *        train() and load() compile on their own; update(),
+     *        setDistribution() and setClassDistribution() fall back to the
+     *        virtual estimators until compile() is called again. Models with
+     *        concurrent estimators or estimator types the kernel does not know
+     *        are never compiled.
+     * @return true if predictions now go through the kernel
+     */
+    bool compile();
     virtual void load(istream& input);
     virtual void save(ostream& output);
     virtual void train(DataSet* data);
     virtual std::pair<int, double> predict(IInstance* i);
     virtual void update(IInstance* instance);
     virtual std::vector<double> targetDistribution(IInstance* i);
+    virtual std::vector<std::pair<int, double> > predictTopK(IInstance* i, int k);
+    virtual size_t memoryUsage() const;
 private:
     void trainBernoulli(DataSet* data);
     void trainMultinomial(DataSet* data);
+    void accumulate(DataSet* data);
     void updateBernoulli(IInstance* instance);
     void updateMultinomial(IInstance* instance);
-    std::vector<double> predictBernoulli(IInstance* i);
-    std::vector<double> predictMultinomial(IInstance* i);
+    std::vector<double> scoreBernoulli(IInstance* i);
+    std::vector<double> scoreMultinomial(IInstance* i);
+    std::vector<double> logScores(IInstance* i);
     std::vector<double> scoreToProb(const std::vector<double>& score);
+    EstimatorPtr newDiscreteEstimator(int nSymbols) const;
+    EstimatorPtr newNormalEstimator(double precision) const;
+    EstimatorPtr newBinaryEstimator() const;
 };
 
 inline  NaiveBayes::EstimatorPtr NaiveBayes::getDistribution(int attrIndex, int clsIndex) 
@@ -75,6 +115,7 @@ inline void NaiveBayes::setDistribution(int attrIndex, int clsIndex, EstimatorPt
         delete p;
     }
     p  = est;
+    mKernelReady = false;
 }
 
 inline  NaiveBayes::EstimatorPtr NaiveBayes::getClassDistribution(void) const
@@ -89,6 +130,7 @@ inline void NaiveBayes::setClassDistribution(EstimatorPtr est)
         delete mClassDistribution;
     }
     mClassDistribution = est;
+    mKernelReady = false;
 }
 
 inline void NaiveBayes::setEventModel(bool v)
@@ -100,6 +142,25 @@ inline bool NaiveBayes::getEventModel() const
 {
     return mEventModel;
 }
+
+inline int NaiveBayes::numClasses() const
+{
+    return mClassesCount;
+}
+
+inline void NaiveBayes::setConcurrency(int stripes)
+{
+    mConcurrency = stripes;
+    if (stripes > 0)
+    {
+        mKernelReady = false;
+    }
+}
+
+inline int NaiveBayes::getConcurrency() const
+{
+    return mConcurrency;
+}
 } // namespace
 
 #endif
@@ -0,0 +1,98 @@
+#ifndef MLPLUS_CLASSIFIERS_BAYES_NAIVEBAYESKERNEL
+#define MLPLUS_CLASSIFIERS_BAYES_NAIVEBAYESKERNEL
+
+#include <map>
+#include <vector>
+#include "instance_interface.h"
+#include "estimators/estimator.h"
+#include "estimators/estimator_block.h"
+namespace mlplus
+{
+/**
+ * The devirtualized training and scoring loops of NaiveBayes.
+ *
+ * The per (attribute, class) estimators of a model are copied into one
+ * EstimatorBlock per estimator type, and every attribute maps to a (block,
+ * slot) pair through a plain vector, so update() and score() run without a
+ * std::map lookup and without a virtual call per class. The legacy Estimator
+ * objects stay the model of record: import() reads them, exportTo() writes the
+ * accumulated state back so save()/load() and getDistribution() keep working.
+ *
+ * A compiled kernel is read only and may be shared by many scoring threads.
+ */
+class NaiveBayesKernel
+{
+public:
+    typedef std::map<int, estimators::Estimator**> DistributionMapType;
+    NaiveBayesKernel();
+    /**
+     * @brief copy the state of the given estimators
+     * @return false if any estimator is missing or of a type the kernel has
+     *         no block for, the kernel is left empty then
+     */
+    bool import(const DistributionMapType& dists, estimators::Estimator* classDist,
+            int numClasses, bool eventModel);
+    void clear();
+    inline bool empty() const;
+    void update(IInstance* instance);
+    void exportTo(DistributionMapType& dists, estimators::Estimator* classDist) const;
+    /**
+     * @brief build the log probability tables, no update() after this
+     */
+    void compile();
+    /**
+     * @brief the unnormalized log posterior of every class
+     */
+    void score(IInstance* instance, double* scores) const;
+    size_t memoryUsage() const;
+private:
+    enum Kind {NONE = 0, NORMAL, DISCRETE, BINARY};
+    struct Slot
+    {
+        Slot(int k = NONE, int s = 0): kind(k), slot(s) {}
+        int kind;
+        int slot;
+    };
+    void updateBernoulli(IInstance* instance);
+    void updateMultinomial(IInstance* instance);
+    void scoreBernoulli(IInstance* instance, double* scores) const;
+    void scoreMultinomial(IInstance* instance, double* scores) const;
+    inline void updateSlot(const Slot& s, int cls, double data, double weight);
+
+    int mNumClasses;
+    bool mEventModel;
+    bool mCompiled;
+    std::vector<Slot> mSlots; //indexed by attribute index
+    std::vector<int> mAttributes; //attributes having a slot, in map order
+    estimators::EstimatorBlock<estimators::NormalEstimator> mNormal;
+    estimators::EstimatorBlock<estimators::DiscreteEstimator> mDiscrete;
+    estimators::EstimatorBlock<estimators::BinaryEstimator> mBinary;
+    std::vector<double> mClassCounts;
+    std::vector<double> mLogPrior;
+};
+
+inline bool NaiveBayesKernel::empty() const
+{
+    return mNumClasses == 0;
+}
+
+inline void NaiveBayesKernel::updateSlot(const Slot& s, int cls, double data, double weight)
+{
+    switch(s.kind)
+    {
+    case NORMAL:
+        mNormal.update(s.slot, cls, data, weight);
+        break;
+    case DISCRETE:
+        mDiscrete.update(s.slot, cls, data, weight);
+        break;
+    case BINARY:
+        mBinary.update(s.slot, cls, data, weight);
+        break;
+    default:
+        break;
+    }
+}
+} // namespace mlplus
+
+#endif
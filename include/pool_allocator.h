@@ -0,0 +1,260 @@
+#ifndef MLPLUS_POOL_ALLOCATOR_H
+#define MLPLUS_POOL_ALLOCATOR_H
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <stdint.h>
+#include "memory_accounting.h"
+namespace mlplus
+{
+/**
+ * A size class allocator for the small objects the core makes by the
+ * million: instance value arrays, sparse index arrays, lexer tokens and tree
+ * nodes. Requests up to MAX_SIZE bytes are rounded up to one of NUM_CLASSES
+ * sizes and served from 64KB blocks, larger ones go to operator new.
+ *
+ * Every thread keeps a free list per class and allocates and frees from it
+ * without a lock. An empty list takes a batch of objects from the depot of
+ * the class, a full one gives a batch back, so the shared mutex is taken
+ * once per batch. An object may be freed by another thread than the one
+ * that allocated it. A thread's lists go back to the depot when it exits.
+ *
+ * Blocks are kept until releaseFreeBlocks() finds all of their objects free.
+ *
+ * Deallocation needs the size that was asked for, like an STL allocator, so
+ * objects carry no header. The same size lets the tagged allocators below
+ * charge the subsystem they serve, see memory_accounting.h.
+ */
+class MemoryPool
+{
+public:
+    enum
+    {
+        MAX_SIZE = 4096,
+        NUM_CLASSES = 30,
+        BLOCK_SIZE = 64 * 1024
+    };
+    static inline void* allocate(size_t size);
+    static inline void deallocate(void* p, size_t size);
+    /**
+     * @brief the class of a size: 16 byte steps to 256, 64 byte steps to
+     *        1024, then 2048 and 4096
+     */
+    static inline size_t sizeClass(size_t size);
+    static inline size_t classSize(size_t sizeClass);
+    /**
+     * @brief the bytes an allocation of size takes, its class size
+     */
+    static inline size_t allocatedSize(size_t size);
+    /**
+     * @brief give the objects cached by the calling thread back to the depot
+     */
+    static void flushThreadCache();
+    /**
+     * @brief flush and free the calling thread's lists, done as a thread exits
+     */
+    static void releaseThreadCache();
+    /**
+     * @brief free the blocks whose objects are all in the depot, returns the
+     *        bytes released. Objects cached by other threads keep their blocks.
+     */
+    static size_t releaseFreeBlocks();
+    /**
+     * @brief the bytes of all blocks held
+     */
+    static size_t bytesReserved();
+private:
+    struct FreeObject
+    {
+        FreeObject* next;
+    };
+    struct ThreadCache
+    {
+        FreeObject* head[NUM_CLASSES];
+        uint32_t count[NUM_CLASSES];
+        // a thread gives back a batch when it caches twice as many
+        uint32_t limit[NUM_CLASSES];
+    };
+    static void* allocateSlow(size_t sizeClass);
+    static void deallocateSlow(void* p, size_t sizeClass);
+    static __thread ThreadCache* tCache;
+};
+
+/**
+ * An STL allocator over MemoryPool, e.g. std::vector<int, PoolAllocator<int> >.
+ * All instances are equal, memory from one may be freed by any other.
+ * With a memory::Tag as Tag the bytes are charged to it.
+ */
+template <class T, int Tag = memory::UNTAGGED>
+class PoolAllocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+    template <class U>
+    struct rebind
+    {
+        typedef PoolAllocator<U, Tag> other;
+    };
+    PoolAllocator() {}
+    template <class U>
+    PoolAllocator(const PoolAllocator<U, Tag>&) {}
+    pointer address(reference x) const
+    {
+        return &x;
+    }
+    const_pointer address(const_reference x) const
+    {
+        return &x;
+    }
+    pointer allocate(size_type n, const void* = 0)
+    {
+        if (Tag >= 0)
+        {
+            memory::charge((memory::Tag)Tag, MemoryPool::allocatedSize(n * sizeof(T)));
+        }
+        return static_cast<pointer>(MemoryPool::allocate(n * sizeof(T)));
+    }
+    void deallocate(pointer p, size_type n)
+    {
+        if (Tag >= 0 && p != NULL)
+        {
+            memory::release((memory::Tag)Tag, MemoryPool::allocatedSize(n * sizeof(T)));
+        }
+        MemoryPool::deallocate(p, n * sizeof(T));
+    }
+    size_type max_size() const
+    {
+        return (size_t)-1 / sizeof(T);
+    }
+    void construct(pointer p, const T& value)
+    {
+        new (p) T(value);
+    }
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+};
+
+template <class T, class U, int Tag>
+inline bool operator==(const PoolAllocator<T, Tag>&, const PoolAllocator<U, Tag>&)
+{
+    return true;
+}
+
+template <class T, class U, int Tag>
+inline bool operator!=(const PoolAllocator<T, Tag>&, const PoolAllocator<U, Tag>&)
+{
+    return false;
+}
+
+/**
+ * @brief class operators new and delete over MemoryPool charging memory::Tag
+ *        tag; placement new stays available for arenas. Classes with
+ *        subclasses need a virtual destructor, delete passes the size of the
+ *        most derived object then.
+ */
+#define MLPLUS_POOL_ALLOCATED(Cls, tag) \
+    public: \
+    static void* operator new(size_t size) \
+    { \
+        mlplus::memory::charge(tag, mlplus::MemoryPool::allocatedSize(size)); \
+        return mlplus::MemoryPool::allocate(size); \
+    } \
+    static void operator delete(void* p, size_t size) \
+    { \
+        if (p != NULL) \
+        { \
+            mlplus::memory::release(tag, mlplus::MemoryPool::allocatedSize(size)); \
+        } \
+        mlplus::MemoryPool::deallocate(p, size); \
+    } \
+    static void* operator new(size_t, void* p) \
+    { \
+        return p; \
+    } \
+    static void operator delete(void*, void*) \
+    { \
+    }
+
+inline size_t MemoryPool::sizeClass(size_t size)
+{
+    if (size <= 256)
+    {
+        return size <= 16 ? 0 : (size - 1) >> 4;
+    }
+    if (size <= 1024)
+    {
+        return 16 + ((size - 257) >> 6);
+    }
+    return size <= 2048 ? 28 : 29;
+}
+
+inline size_t MemoryPool::classSize(size_t sizeClass)
+{
+    assert(sizeClass < NUM_CLASSES);
+    if (sizeClass < 16)
+    {
+        return 16 * (sizeClass + 1);
+    }
+    if (sizeClass < 28)
+    {
+        return 256 + 64 * (sizeClass - 15);
+    }
+    return sizeClass == 28 ? 2048 : 4096;
+}
+
+inline size_t MemoryPool::allocatedSize(size_t size)
+{
+    return size > MAX_SIZE ? size : classSize(sizeClass(size));
+}
+
+inline void* MemoryPool::allocate(size_t size)
+{
+    if (size > MAX_SIZE)
+    {
+        return ::operator new(size);
+    }
+    size_t c = sizeClass(size);
+    ThreadCache* cache = tCache;
+    if (cache != NULL && cache->head[c] != NULL)
+    {
+        FreeObject* object = cache->head[c];
+        cache->head[c] = object->next;
+        --cache->count[c];
+        return object;
+    }
+    return allocateSlow(c);
+}
+
+inline void MemoryPool::deallocate(void* p, size_t size)
+{
+    if (p == NULL)
+    {
+        return;
+    }
+    if (size > MAX_SIZE)
+    {
+        ::operator delete(p);
+        return;
+    }
+    size_t c = sizeClass(size);
+    ThreadCache* cache = tCache;
+    if (cache == NULL || cache->count[c] >= cache->limit[c])
+    {
+        deallocateSlow(p, c);
+        return;
+    }
+    FreeObject* object = static_cast<FreeObject*>(p);
+    object->next = cache->head[c];
+    cache->head[c] = object;
+    ++cache->count[c];
+}
+} // namespace mlplus
+#endif
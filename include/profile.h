@@ -0,0 +1,111 @@
+#ifndef MLPLUS_PROFILE_H
+#define MLPLUS_PROFILE_H
+#include <stdint.h>
+#include <time.h>
+#include <cstdio>
+namespace mlplus
+{
+namespace profile
+{
+/**
+ * Hot path instrumentation.
+ *
+ * MLPLUS_PROFILE_SCOPE(name) times the enclosing scope, and
+ * MLPLUS_PROFILE_COUNT(name, n) adds n to a counter. Both expand to nothing
+ * unless the code is built with -DMLPLUS_PROFILE.
+ *
+ * Every call site registers its probe once, and probes with the same name
+ * share totals. Each thread accumulates into its own slots without atomics,
+ * and report() sums over the threads. A profiled program writes the report
+ * at exit: to stderr, or to the file named by MLPLUS_PROFILE_OUTPUT. The
+ * report is JSON when that file name ends in ".json" or when
+ * MLPLUS_PROFILE_FORMAT=json.
+ */
+static const int MAX_PROBES = 256;
+
+struct ProbeSlot
+{
+    uint64_t calls;
+    uint64_t count;
+    uint64_t ticks;
+};
+
+/**
+ * @brief the index of the probe called name, -1 when all probes are taken
+ */
+int registerProbe(const char* name);
+/**
+ * @brief the calling thread's MAX_PROBES slots
+ */
+ProbeSlot* threadSlots();
+/**
+ * @brief a cycle counter on x86, monotonic nanoseconds elsewhere
+ */
+inline uint64_t ticks();
+/**
+ * @brief the totals of every probe over all threads, times in milliseconds
+ */
+void report(FILE* out, bool json);
+void reset();
+
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(int probe): mSlot(probe >= 0 ? threadSlots() + probe : NULL), mStart(ticks()) {}
+    ~ScopedTimer()
+    {
+        if (mSlot != NULL)
+        {
+            ++mSlot->calls;
+            mSlot->ticks += ticks() - mStart;
+        }
+    }
+private:
+    ScopedTimer(const ScopedTimer&);
+    ScopedTimer& operator=(const ScopedTimer&);
+    ProbeSlot* mSlot;
+    uint64_t mStart;
+};
+
+inline void count(int probe, uint64_t n)
+{
+    if (probe >= 0)
+    {
+        ProbeSlot& slot = threadSlots()[probe];
+        ++slot.calls;
+        slot.count += n;
+    }
+}
+
+inline uint64_t ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+} // namespace profile
+} // namespace mlplus
+
+#define MLPLUS_PROFILE_CONCAT2(a, b) a##b
+#define MLPLUS_PROFILE_CONCAT(a, b) MLPLUS_PROFILE_CONCAT2(a, b)
+#ifdef MLPLUS_PROFILE
+#define MLPLUS_PROFILE_SCOPE(name) \
+    static const int MLPLUS_PROFILE_CONCAT(mlplusProbe, __LINE__) = mlplus::profile::registerProbe(name); \
+    mlplus::profile::ScopedTimer MLPLUS_PROFILE_CONCAT(mlplusTimer, __LINE__)(MLPLUS_PROFILE_CONCAT(mlplusProbe, __LINE__))
+#define MLPLUS_PROFILE_COUNT(name, n) \
+    do \
+    { \
+        static const int mlplusProbe = mlplus::profile::registerProbe(name); \
+        mlplus::profile::count(mlplusProbe, n); \
+    } while (0)
+#else
+#define MLPLUS_PROFILE_SCOPE(name)
+#define MLPLUS_PROFILE_COUNT(name, n) do {} while (0)
+#endif
+#endif
@@ -0,0 +1,106 @@
+#ifndef MLPLUS_RNG_H
+#define MLPLUS_RNG_H
+#include <stdint.h>
+#include <cstddef>
+namespace mlplus
+{
+/**
+ * xoshiro256++ (Blackman and Vigna 2019): 256 bits of state, period
+ * 2^256 - 1, a few cycles per 64-bit output and no locks, so every thread
+ * keeps its own generator.
+ *
+ * Streams split one seed for parallel work. jump() advances a generator by
+ * 2^128 draws, so stream(seed, i) and stream(seed, j) never overlap in
+ * practice. Work split by index gives the same numbers on any number of
+ * threads.
+ *
+ * src/util/random.c implements the same generator in C behind the old
+ * Random* API, with a generator per thread.
+ */
+class Xoshiro256
+{
+public:
+    /**
+     * @brief the state is expanded from seed with splitmix64
+     */
+    explicit Xoshiro256(uint64_t seed = 1);
+    inline uint64_t next();
+    /**
+     * @brief uniform in [0, 1) with 53 random bits
+     */
+    inline double uniform();
+    /**
+     * @brief uniform in [0, n)
+     */
+    inline uint32_t below(uint32_t n);
+    /**
+     * @brief standard normal by the Box-Muller transform, the second value of
+     *        every pair is kept for the next call
+     */
+    double gaussian();
+    /**
+     * @brief advance by 2^128 draws
+     */
+    void jump();
+    /**
+     * @brief advance by 2^192 draws, for streams of streams
+     */
+    void longJump();
+    /**
+     * @brief the generator of seed jumped index times, O(index)
+     */
+    static Xoshiro256 stream(uint64_t seed, uint64_t index);
+    /**
+     * @brief n uniforms in [0, 1), the same as n calls to uniform()
+     */
+    void uniforms(double* out, size_t n);
+    /**
+     * @brief n normal values; pairs come from the uniforms of uniforms(), so
+     *        the result depends on the state only and not on earlier gaussian() calls
+     */
+    void gaussians(double* out, size_t n, double mean = 0, double stdev = 1);
+private:
+    static inline uint64_t rotl(uint64_t x, int k);
+    void jump(const uint64_t* polynomial);
+    uint64_t mState[4];
+    double mSpare;
+    bool mHasSpare;
+};
+
+/**
+ * @brief the calling thread's generator, stream k of a fixed seed for the
+ *        k-th thread to ask unless seedThreadRandom() was called first. Workers
+ *        that need reproducible numbers seed it with their task index.
+ */
+Xoshiro256& threadRandom();
+void seedThreadRandom(uint64_t seed, uint64_t stream);
+
+inline uint64_t Xoshiro256::rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+inline uint64_t Xoshiro256::next()
+{
+    uint64_t result = rotl(mState[0] + mState[3], 23) + mState[0];
+    uint64_t t = mState[1] << 17;
+    mState[2] ^= mState[0];
+    mState[3] ^= mState[1];
+    mState[1] ^= mState[2];
+    mState[0] ^= mState[3];
+    mState[2] ^= t;
+    mState[3] = rotl(mState[3], 45);
+    return result;
+}
+
+inline double Xoshiro256::uniform()
+{
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+inline uint32_t Xoshiro256::below(uint32_t n)
+{
+    return (uint32_t)(((next() >> 32) * n) >> 32);
+}
+} // namespace mlplus
+#endif
@@ -0,0 +1,93 @@
+#ifndef MLPLUS_ROARING_BITSET_H
+#define MLPLUS_ROARING_BITSET_H
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+#include "bitset.h"
+namespace mlplus
+{
+/**
+ * A compressed set of 32 bit integers in the layout of Roaring bitmaps.
+ *
+ * The values are split by their high 16 bits into containers. A container of
+ * at most ARRAY_MAX values keeps them as a sorted array of their low 16 bits,
+ * a fuller one as a bitmap of 1024 words, which the bitset kernels combine.
+ * A sparse column, like the rows holding a rare item, costs two bytes a row
+ * where a DenseBitset would cost a bit of every row of the dataset.
+ */
+class RoaringBitset
+{
+public:
+    static const size_t ARRAY_MAX = 4096;
+    static const size_t BITMAP_WORDS = 1024;
+    RoaringBitset() {}
+    static RoaringBitset fromDense(const DenseBitset& bits);
+    void add(uint32_t value);
+    bool contains(uint32_t value) const;
+    size_t cardinality() const;
+    bool empty() const
+    {
+        return mContainers.empty();
+    }
+    void clear()
+    {
+        mContainers.clear();
+    }
+    void swap(RoaringBitset& other)
+    {
+        mContainers.swap(other.mContainers);
+    }
+    /**
+     * @brief out = a & b, a | b and a & ~b; out may not be a or b
+     */
+    static void intersect(const RoaringBitset& a, const RoaringBitset& b, RoaringBitset& out);
+    static void unite(const RoaringBitset& a, const RoaringBitset& b, RoaringBitset& out);
+    static void subtract(const RoaringBitset& a, const RoaringBitset& b, RoaringBitset& out);
+    /**
+     * @brief the cardinality of a & b without building it
+     */
+    static size_t andCount(const RoaringBitset& a, const RoaringBitset& b);
+    /**
+     * @brief the same against the first bits.size() values held dense; a
+     *        bitmap container meets its 1024 words of bits word by word
+     */
+    static void intersect(const RoaringBitset& a, const DenseBitset& bits, RoaringBitset& out);
+    static size_t andCount(const RoaringBitset& a, const DenseBitset& bits);
+    /**
+     * @brief the values, ascending
+     */
+    void toVector(std::vector<uint32_t>& out) const;
+    /**
+     * @brief the values below size as a DenseBitset of size bits
+     */
+    DenseBitset toDense(size_t size) const;
+    bool operator==(const RoaringBitset& other) const;
+    size_t memoryUsage() const;
+private:
+    struct Container
+    {
+        explicit Container(uint16_t k = 0): key(k), cardinality(0) {}
+        uint16_t key;
+        uint32_t cardinality;
+        std::vector<uint16_t> array; //sorted, when bitmap is empty
+        std::vector<uint64_t> bitmap;
+        bool isBitmap() const
+        {
+            return !bitmap.empty();
+        }
+        bool contains(uint16_t low) const;
+        void add(uint16_t low);
+        /**
+         * @brief switch to the smaller layout for cardinality
+         */
+        void normalize();
+    };
+    static void intersect(const Container& a, const Container& b, Container& out);
+    static void unite(const Container& a, const Container& b, Container& out);
+    static void subtract(const Container& a, const Container& b, Container& out);
+    static size_t andCount(const Container& a, const Container& b);
+    const Container* find(uint16_t key) const;
+    std::vector<Container> mContainers; //by key
+};
+} // namespace mlplus
+#endif
@@ -0,0 +1,55 @@
+#ifndef MLPLUS_SAMPLING_H
+#define MLPLUS_SAMPLING_H
+#include <stdint.h>
+#include <vector>
+#include "synthetic_data.h"
+namespace mlplus
+{
+class DataSet;
+/**
+ * Walker's alias method: after O(n) setup, draws index i with probability
+ * weights[i] / sum(weights) in O(1) from one bounded integer and one uniform.
+ */
+class AliasTable
+{
+public:
+    /**
+     * @brief negative and NaN weights count as 0, throws runtime_error when
+     *        no weight is positive
+     */
+    explicit AliasTable(const std::vector<double>& weights);
+    size_t size() const {return mProbability.size();}
+    /**
+     * @param random any generator with below(n) and uniform(), like SplitMix64
+     */
+    template <class Random>
+    int operator()(Random& random) const;
+private:
+    std::vector<double> mProbability;
+    std::vector<int> mAlias;
+};
+
+/**
+ * @brief draws rows in [0, rows) uniformly with replacement
+ */
+void bootstrapIndices(int rows, int draws, SplitMix64& random, std::vector<int>& indices);
+/**
+ * @brief draws rows with replacement by the weights of the table
+ */
+void weightedIndices(const AliasTable& table, int draws, SplitMix64& random, std::vector<int>& indices);
+/**
+ * @brief bags bootstrap views of data, see DataSet::resample(). Bag b is
+ *        drawn from stream b of seed, so the bags are the same on any number
+ *        of threads. The caller owns the views; data must outlive them.
+ * @param threads every processor if < 1
+ */
+void bootstrapBags(DataSet& data, int bags, uint64_t seed, int threads, std::vector<DataSet*>& views);
+
+template <class Random>
+int AliasTable::operator()(Random& random) const
+{
+    int i = random.below(mProbability.size());
+    return random.uniform() < mProbability[i] ? i : mAlias[i];
+}
+} // namespace mlplus
+#endif
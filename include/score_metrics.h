@@ -0,0 +1,320 @@
+#ifndef MLPLUS_SCORE_METRICS_H
+#define MLPLUS_SCORE_METRICS_H
+#include <stdint.h>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include <tr1/unordered_map>
+#include "thread_pool.h"
+namespace mlplus
+{
+/**
+ * Streaming metrics of binary predictions.
+ *
+ * Every accumulator takes (score, positive, negative): the predicted
+ * probability and the weights of the positive and negative outcomes seen with
+ * it, clicks and pv - clicks for a click log. Nothing keeps the rows, so the
+ * memory does not grow with the input. Accumulators filled by different threads
+ * or files are combined with merge().
+ */
+class BinaryMetrics
+{
+public:
+    explicit BinaryMetrics(double threshold = 0.5);
+    inline void add(double score, double positive, double negative);
+    void merge(const BinaryMetrics& other);
+    double weight() const {return mPositive + mNegative;}
+    double positives() const {return mPositive;}
+    double negatives() const {return mNegative;}
+    /**
+     * @brief the share of the weight on the right side of the threshold
+     */
+    double accuracy() const;
+    double rmse() const;
+    /**
+     * @brief the mean negative log likelihood, scores are clipped to [1e-15, 1 - 1e-15]
+     */
+    double logLoss() const;
+    double meanScore() const;
+    double meanOutcome() const;
+private:
+    double mThreshold;
+    double mPositive;
+    double mNegative;
+    double mScoreSum;
+    double mSquaredError;
+    double mLogLoss;
+    double mCorrect;
+};
+
+/**
+ * the outcomes of a range of scores
+ */
+struct ScoreBin
+{
+    ScoreBin(): positive(0), negative(0), scoreSum(0) {}
+    inline void add(double score, double positiveWeight, double negativeWeight);
+    inline void merge(const ScoreBin& other);
+    double positive;
+    double negative;
+    double scoreSum; // weighted by positive + negative
+};
+
+struct CurveMetrics
+{
+    double auc;
+    /**
+     * the largest difference to the exact ROC area: outcomes sharing a bin count as
+     * tied, while their real order could be anything
+     */
+    double aucError;
+    /**
+     * the area under the precision-recall curve as average precision
+     */
+    double prAuc;
+};
+
+/**
+ * ROC and PR area from the outcomes at decreasing scores, one add() per
+ * distinct score or score bin.
+ */
+class CurveSweep
+{
+public:
+    CurveSweep(): mTruePositive(0), mFalsePositive(0), mArea(0), mTies(0), mPrecisionSum(0) {}
+    inline void add(double positive, double negative);
+    CurveMetrics metrics() const;
+private:
+    double mTruePositive;
+    double mFalsePositive;
+    double mArea;
+    double mTies;
+    double mPrecisionSum;
+};
+
+/**
+ * Outcomes counted in equal-width score bins over [low, high], scores outside go
+ * to the first or last bin. The ROC area comes with an error bound that shrinks
+ * with the bin width.
+ */
+class ScoreHistogram
+{
+public:
+    explicit ScoreHistogram(int bins = 65536, double low = 0, double high = 1);
+    inline void add(double score, double positive, double negative);
+    /**
+     * @brief other must have the same bins
+     */
+    void merge(const ScoreHistogram& other);
+    CurveMetrics curve() const;
+    /**
+     * @brief the bins combined into buckets of equal width for a reliability table;
+     *        bucket i covers [low + i * (high - low) / buckets, ...)
+     */
+    void calibration(int buckets, std::vector<ScoreBin>& out) const;
+    int numBins() const {return mBins.size();}
+    const ScoreBin& bin(int i) const {return mBins[i];}
+    inline int binOf(double score) const;
+private:
+    double mLow;
+    double mHigh;
+    double mScale;
+    std::vector<ScoreBin> mBins;
+};
+
+/**
+ * Exact ROC and PR area over any number of rows in bounded memory.
+ *
+ * Each thread adds its rows through its own Writer, which sorts runs of
+ * runRecords rows and folds equal scores together before handing them over,
+ * so the sorting runs in parallel. The sorter keeps runs in memory up to
+ * memoryLimit bytes and spills the rest to temporary files; curve() merges all
+ * runs in one pass.
+ */
+class ScoreSorter
+{
+private:
+    struct Record
+    {
+        double score;
+        double positive;
+        double negative;
+    };
+public:
+    /**
+     * @param tempDir where to spill runs, the stdio default when empty
+     */
+    explicit ScoreSorter(size_t memoryLimit = (size_t)1 << 30, size_t runRecords = 1 << 20,
+                         const std::string& tempDir = "");
+    ~ScoreSorter();
+
+    class Writer
+    {
+    public:
+        explicit Writer(ScoreSorter& sorter);
+        /**
+         * @brief flushes the rows left
+         */
+        ~Writer();
+        inline void add(double score, double positive, double negative);
+        void flush();
+    private:
+        Writer(const Writer&);
+        Writer& operator=(const Writer&);
+        ScoreSorter& mSorter;
+        std::vector<Record> mRecords;
+    };
+
+    /**
+     * @brief merge every run; all writers must be flushed
+     */
+    CurveMetrics curve();
+    size_t numRuns() const {return mMemoryRuns.size() + mFileRuns.size();}
+    size_t numSpilledRuns() const {return mFileRuns.size();}
+private:
+    ScoreSorter(const ScoreSorter&);
+    ScoreSorter& operator=(const ScoreSorter&);
+    class RunCursor;
+    struct CursorOrder;
+    static bool higherScore(const Record& a, const Record& b);
+    /**
+     * @brief sort and fold the records, then keep them or write them out
+     */
+    void addRun(std::vector<Record>& records);
+    FILE* openTemp();
+    size_t mMemoryLimit;
+    size_t mRunRecords;
+    std::string mTempDir;
+    size_t mMemoryUsed;
+    std::vector<std::vector<Record>*> mMemoryRuns;
+    std::vector<FILE*> mFileRuns;
+    Mutex mMutex;
+};
+
+/**
+ * Metrics per group of rows, such as a query or a slice. Each group keeps its
+ * BinaryMetrics and the score bins it has seen out of bins, so the memory grows
+ * with the groups and their distinct bins, not with the rows.
+ */
+class GroupMetrics
+{
+public:
+    explicit GroupMetrics(int bins = 100, double threshold = 0.5);
+    inline void add(const std::string& group, double score, double positive, double negative);
+    void merge(const GroupMetrics& other);
+    size_t numGroups() const {return mGroups.size();}
+    /**
+     * @brief the mean of the group ROC areas weighted by the group weight, over the
+     *        groups with both outcomes
+     * @param error the weighted mean of the error bounds
+     */
+    double groupAuc(double* error = NULL) const;
+    /**
+     * @brief one tab separated line per group in key order:
+     *        group weight positives auc logloss mean_score mean_outcome
+     */
+    void write(FILE* out) const;
+private:
+    typedef std::vector<std::pair<int, ScoreBin> > SparseBins; // ordered by bin
+    struct Group
+    {
+        explicit Group(double threshold): metrics(threshold) {}
+        BinaryMetrics metrics;
+        SparseBins bins;
+    };
+    typedef std::tr1::unordered_map<std::string, Group> GroupMap;
+    static void addBin(SparseBins& bins, int index, const ScoreBin& bin);
+    static bool binBefore(const std::pair<int, ScoreBin>& a, const std::pair<int, ScoreBin>& b);
+    static bool keyBefore(const GroupMap::value_type* a, const GroupMap::value_type* b);
+    static CurveMetrics curve(const SparseBins& bins);
+    Group& group(const std::string& key);
+    int mBins;
+    double mThreshold;
+    GroupMap mGroups;
+};
+
+/**
+ * @brief parse a decimal number such as -12.5e-3 after any blanks, much faster than
+ *        strtod; falls back to strtod for nan, inf and hexadecimal
+ * @return the end of the number, NULL if there is none before end
+ */
+const char* parseDouble(const char* p, const char* end, double& value);
+
+inline void BinaryMetrics::add(double score, double positive, double negative)
+{
+    double weight = positive + negative;
+    mPositive += positive;
+    mNegative += negative;
+    mScoreSum += weight * score;
+    mSquaredError += positive * (1 - score) * (1 - score) + negative * score * score;
+    double clipped = score < 1e-15 ? 1e-15 : (score > 1 - 1e-15 ? 1 - 1e-15 : score);
+    mLogLoss -= positive * log(clipped) + negative * log(1 - clipped);
+    mCorrect += score >= mThreshold ? positive : negative;
+}
+
+inline void ScoreBin::add(double score, double positiveWeight, double negativeWeight)
+{
+    positive += positiveWeight;
+    negative += negativeWeight;
+    scoreSum += score * (positiveWeight + negativeWeight);
+}
+
+inline void ScoreBin::merge(const ScoreBin& other)
+{
+    positive += other.positive;
+    negative += other.negative;
+    scoreSum += other.scoreSum;
+}
+
+inline void CurveSweep::add(double positive, double negative)
+{
+    // the negatives here rank below every positive seen so far and tie with these
+    mArea += negative * (mTruePositive + 0.5 * positive);
+    mTies += positive * negative;
+    mTruePositive += positive;
+    mFalsePositive += negative;
+    if (positive > 0)
+    {
+        mPrecisionSum += positive * mTruePositive / (mTruePositive + mFalsePositive);
+    }
+}
+
+inline int ScoreHistogram::binOf(double score) const
+{
+    if (!(score > mLow))
+    {
+        return 0;
+    }
+    double offset = (score - mLow) * mScale;
+    int last = mBins.size() - 1;
+    return offset >= last ? last : (int)offset;
+}
+
+inline void ScoreHistogram::add(double score, double positive, double negative)
+{
+    mBins[binOf(score)].add(score, positive, negative);
+}
+
+inline void ScoreSorter::Writer::add(double score, double positive, double negative)
+{
+    Record record = {score, positive, negative};
+    mRecords.push_back(record);
+    if (mRecords.size() >= mSorter.mRunRecords)
+    {
+        flush();
+    }
+}
+
+inline void GroupMetrics::add(const std::string& key, double score, double positive, double negative)
+{
+    Group& g = group(key);
+    g.metrics.add(score, positive, negative);
+    ScoreBin bin;
+    bin.add(score, positive, negative);
+    int index = score > 0 ? (score >= 1 ? mBins - 1 : (int)(score * mBins)) : 0;
+    addBin(g.bins, index, bin);
+}
+} // namespace mlplus
+#endif
@@ -0,0 +1,23 @@
+#ifndef MLPLUS_SVM_LIGHT_READER_H
+#define MLPLUS_SVM_LIGHT_READER_H
+#include <string>
+namespace mlplus
+{
+class DataSet;
+class FeatureHasher;
+/**
+ * @brief read svm-light rows, "label id:value id:value ...", into a DataSet
+ *        of SparseInstances over a MapAttributeContainer
+ *
+ * The target is attribute 0 with the value label - 1, and feature id lands
+ * on attribute id + idShift. bayes_msg_passing reads with an idShift of -1,
+ * and a feature that would land on the target is dropped. With a hasher the
+ * raw ids are hashed instead and bucket b is attribute b + 1. An attribute
+ * is created for every index that occurs. Blank lines are skipped.
+ *
+ * @return NULL when the file cannot be opened
+ * @throw std::runtime_error on a field that is not id:value
+ */
+DataSet* readSvmLight(const std::string& path, int idShift = 0, const FeatureHasher* hasher = NULL);
+} // namespace mlplus
+#endif
@@ -0,0 +1,176 @@
+#ifndef MLPLUS_SYNTHETIC_DATA_H
+#define MLPLUS_SYNTHETIC_DATA_H
+#include <stdint.h>
+#include <cmath>
+#include <ostream>
+#include <string>
+namespace mlplus
+{
+/**
+ * Seeded generators of large synthetic datasets for load and scaling tests.
+ *
+ * Row r depends only on the seed and r. Any range of rows can therefore be
+ * generated on its own: by several threads at once, or resumed halfway, and
+ * the bytes are the same as a single pass over all rows.
+ *
+ * Dense rows follow the names file from writeNames():
+ *     class: c0, c1, ...            the target, first column
+ *     n0 .. : continuous            numeric, class k centers on k / 2
+ *     s0 .. : v0, v1, ...           nominal, a third of the values follow the class
+ *     x0 .. := n0 + n1, ...         implicit expressions over the numeric attributes
+ * Sparse rows are svm-light: "class id:count ..." with classes counted from 1.
+ * Feature ids in [1, features] follow a Zipf distribution. Every class rotates
+ * half of its ids by its own offset, so the classes can be told apart.
+ */
+struct DenseDataSpec
+{
+    DenseDataSpec(): classes(2), numeric(10), nominal(2), nominalValues(8), implicit(1) {}
+    int classes;
+    int numeric;
+    int nominal;
+    int nominalValues;
+    int implicit;
+};
+
+struct SparseDataSpec
+{
+    SparseDataSpec(): classes(2), features(100000), featuresPerRow(32), zipfExponent(1.0) {}
+    int classes;
+    uint32_t features;
+    int featuresPerRow; // the mean, rows have 1 to 2 * featuresPerRow - 1 draws
+    double zipfExponent;
+};
+
+struct TreeModelSpec
+{
+    TreeModelSpec(): trees(10), depth(8) {}
+    int trees;
+    int depth; // of the continuous splits, discrete splits grow one level
+};
+
+/**
+ * splitmix64, a small generator for per-row streams
+ */
+class SplitMix64
+{
+public:
+    explicit SplitMix64(uint64_t seed): mState(seed) {}
+    inline uint64_t next();
+    /**
+     * @brief uniform in [0, 1)
+     */
+    inline double uniform();
+    /**
+     * @brief uniform in [0, n)
+     */
+    inline uint32_t below(uint32_t n);
+    /**
+     * @brief the index-th of the independent streams of seed, so work split by
+     *        index draws the same numbers on any number of threads
+     */
+    static inline SplitMix64 stream(uint64_t seed, uint64_t index);
+private:
+    uint64_t mState;
+};
+
+/**
+ * Zipf distribution on [1, n], P(k) ~ 1 / k^exponent, sampled in O(1) by
+ * rejection-inversion (Hormann and Derflinger 1996).
+ */
+class ZipfDistribution
+{
+public:
+    ZipfDistribution(uint32_t n, double exponent);
+    template <class Random>
+    uint32_t operator()(Random& random) const;
+private:
+    double h(double x) const;
+    double hIntegral(double x) const;
+    double hIntegralInverse(double x) const;
+    uint32_t mN;
+    double mExponent;
+    double mHIntegralX1;
+    double mHIntegralN;
+    double mS;
+};
+
+class SyntheticDataGenerator
+{
+public:
+    SyntheticDataGenerator(uint64_t seed): mSeed(seed) {}
+    static void writeNames(const DenseDataSpec& spec, std::ostream& out);
+    /**
+     * @brief append rows [first, first + count) of a dense CSV dataset
+     */
+    void appendDenseRows(const DenseDataSpec& spec, uint64_t first, uint64_t count, std::string& out) const;
+    /**
+     * @brief append rows [first, first + count) of an svm-light dataset
+     */
+    void appendSparseRows(const SparseDataSpec& spec, uint64_t first, uint64_t count, std::string& out) const;
+    /**
+     * @brief a boosted C5 model over the attributes of a dense dataset, as read by
+     *        BoostDecisionTree::read
+     */
+    void writeBoostedTrees(const DenseDataSpec& spec, const TreeModelSpec& model, std::ostream& out) const;
+    /**
+     * @brief the generator of row r
+     */
+    inline SplitMix64 rowRandom(uint64_t row) const;
+private:
+    void writeTree(const DenseDataSpec& spec, SplitMix64& random, int depth, std::ostream& out) const;
+    uint64_t mSeed;
+};
+
+inline uint64_t SplitMix64::next()
+{
+    uint64_t z = (mState += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+inline double SplitMix64::uniform()
+{
+    return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+inline uint32_t SplitMix64::below(uint32_t n)
+{
+    return (uint32_t)(((next() >> 32) * n) >> 32);
+}
+
+inline SplitMix64 SplitMix64::stream(uint64_t seed, uint64_t index)
+{
+    SplitMix64 mix(seed ^ (index * 0xD1B54A32D192ED03ull));
+    return SplitMix64(mix.next());
+}
+
+template <class Random>
+uint32_t ZipfDistribution::operator()(Random& random) const
+{
+    for (;;)
+    {
+        double u = mHIntegralN + random.uniform() * (mHIntegralX1 - mHIntegralN);
+        double x = hIntegralInverse(u);
+        double k = floor(x + 0.5);
+        if (k < 1)
+        {
+            k = 1;
+        }
+        else if (k > mN)
+        {
+            k = mN;
+        }
+        if (k - x <= mS || u >= hIntegral(k + 0.5) - h(k))
+        {
+            return (uint32_t)k;
+        }
+    }
+}
+
+inline SplitMix64 SyntheticDataGenerator::rowRandom(uint64_t row) const
+{
+    return SplitMix64::stream(mSeed, row);
+}
+} // namespace mlplus
+#endif
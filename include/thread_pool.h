@@ -0,0 +1,222 @@
+#ifndef MLPLUS_THREAD_POOL_H
+#define MLPLUS_THREAD_POOL_H
+#include <pthread.h>
+#include <deque>
+#include <string>
+#include <vector>
+namespace mlplus
+{
+class Mutex
+{
+public:
+    Mutex();
+    ~Mutex();
+    inline void lock();
+    inline void unlock();
+    inline pthread_mutex_t* native();
+private:
+    Mutex(const Mutex&);
+    Mutex& operator=(const Mutex&);
+    pthread_mutex_t mMutex;
+};
+
+class ScopedLock
+{
+public:
+    explicit ScopedLock(Mutex& mutex): mMutex(mutex)
+    {
+        mMutex.lock();
+    }
+    ~ScopedLock()
+    {
+        mMutex.unlock();
+    }
+private:
+    ScopedLock(const ScopedLock&);
+    ScopedLock& operator=(const ScopedLock&);
+    Mutex& mMutex;
+};
+
+class Condition
+{
+public:
+    Condition();
+    ~Condition();
+    /**
+     * @brief wait on the condition, mutex must be held by the caller
+     */
+    inline void wait(Mutex& mutex);
+    inline void signal();
+    inline void broadcast();
+private:
+    Condition(const Condition&);
+    Condition& operator=(const Condition&);
+    pthread_cond_t mCond;
+};
+
+/**
+ * A blocking FIFO of at most capacity items for producer/consumer pipelines.
+ * After close() push() refuses new items and pop() drains the remaining ones,
+ * then returns false.
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(size_t capacity): mCapacity(capacity > 0 ? capacity : 1), mClosed(false) {}
+    /**
+     * @brief block while the queue is full
+     * @return false if the queue was closed
+     */
+    bool push(const T& item);
+    /**
+     * @brief block while the queue is empty and open
+     * @return false once the queue is closed and empty
+     */
+    bool pop(T& item);
+    void close();
+    size_t size();
+private:
+    BoundedQueue(const BoundedQueue&);
+    BoundedQueue& operator=(const BoundedQueue&);
+    std::deque<T> mItems;
+    size_t mCapacity;
+    bool mClosed;
+    Mutex mMutex;
+    Condition mNotFull;
+    Condition mNotEmpty;
+};
+
+class Runnable
+{
+public:
+    virtual ~Runnable() {}
+    virtual void run() = 0;
+};
+
+/**
+ * A fixed set of worker threads running submitted tasks in FIFO order.
+ *
+ * Tasks stay owned by the caller and must outlive wait(). An exception
+ * escaping a task is caught in the worker, and the first one is rethrown
+ * by wait() as std::runtime_error.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @param threads the number of workers, hardwareThreads() if < 1
+     */
+    explicit ThreadPool(int threads = 0);
+    /**
+     * @brief wait for the submitted tasks and join the workers
+     */
+    ~ThreadPool();
+    void submit(Runnable* task);
+    /**
+     * @brief block until every submitted task has finished
+     */
+    void wait();
+    inline int size() const;
+    /**
+     * @brief the number of online processors, at least 1
+     */
+    static int hardwareThreads();
+private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+    static void* workerMain(void* pool);
+    void work();
+
+    std::vector<pthread_t> mThreads;
+    std::deque<Runnable*> mTasks;
+    int mRunning; //tasks taken by a worker but not finished
+    bool mStop;
+    std::string mError;
+    Mutex mMutex;
+    Condition mHasTask;
+    Condition mIdle;
+};
+
+inline void Mutex::lock()
+{
+    pthread_mutex_lock(&mMutex);
+}
+inline void Mutex::unlock()
+{
+    pthread_mutex_unlock(&mMutex);
+}
+inline pthread_mutex_t* Mutex::native()
+{
+    return &mMutex;
+}
+inline void Condition::wait(Mutex& mutex)
+{
+    pthread_cond_wait(&mCond, mutex.native());
+}
+inline void Condition::signal()
+{
+    pthread_cond_signal(&mCond);
+}
+inline void Condition::broadcast()
+{
+    pthread_cond_broadcast(&mCond);
+}
+
+template <typename T>
+bool BoundedQueue<T>::push(const T& item)
+{
+    ScopedLock lock(mMutex);
+    while (!mClosed && mItems.size() >= mCapacity)
+    {
+        mNotFull.wait(mMutex);
+    }
+    if (mClosed)
+    {
+        return false;
+    }
+    mItems.push_back(item);
+    mNotEmpty.signal();
+    return true;
+}
+
+template <typename T>
+bool BoundedQueue<T>::pop(T& item)
+{
+    ScopedLock lock(mMutex);
+    while (!mClosed && mItems.empty())
+    {
+        mNotEmpty.wait(mMutex);
+    }
+    if (mItems.empty())
+    {
+        return false;
+    }
+    item = mItems.front();
+    mItems.pop_front();
+    mNotFull.signal();
+    return true;
+}
+
+template <typename T>
+void BoundedQueue<T>::close()
+{
+    ScopedLock lock(mMutex);
+    mClosed = true;
+    mNotFull.broadcast();
+    mNotEmpty.broadcast();
+}
+
+template <typename T>
+size_t BoundedQueue<T>::size()
+{
+    ScopedLock lock(mMutex);
+    return mItems.size();
+}
+
+inline int ThreadPool::size() const
+{
+    return mThreads.size();
+}
+} // namespace mlplus
+#endif
@@ -0,0 +1,124 @@
+#ifndef MLPLUS_VECTOR_MATH_H
+#define MLPLUS_VECTOR_MATH_H
+#include <cmath>
+#include <limits>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+namespace mlplus
+{
+/**
+ * Numerics shared by the classifiers' prediction paths.
+ *
+ * fastExp() is accurate to a relative error below 1e-9 on [-708, 709.78];
+ * smaller arguments flush to 0, larger ones give +inf and NaN propagates.
+ * fastLog() is accurate to an absolute error below 1e-10 on positive finite
+ * arguments and follows log() for 0, negatives, +inf and NaN.
+ *
+ * The array functions run two lanes at a time with SSE2 where available and
+ * give the same results as the scalar versions.
+ */
+const double FAST_EXP_MIN = -708.0;
+const double FAST_EXP_MAX = 709.78;
+
+inline double fastExp(double x);
+inline double fastLog(double x);
+/**
+ * @brief out[i] = fastExp(in[i]), in and out may be the same array
+ */
+void expArray(const double* in, double* out, int n);
+/**
+ * @brief log(sum(exp(x[i]))) without overflow, -inf for an empty array
+ */
+double logSumExp(const double* x, int n);
+/**
+ * @brief prob[i] = exp(score[i]) / sum(exp(score[j])) in O(n),
+ *        score and prob may be the same array
+ */
+void softmax(const double* score, double* prob, int n);
+/**
+ * @brief prob[i] = 1 / (1 + exp(-score[i])), stable for large |score|
+ */
+void sigmoid(const double* score, double* prob, int n);
+/**
+ * @brief p[i] /= sum(p[j])
+ */
+void normalize(double* p, int n);
+/**
+ * @brief the k largest scores as (index, score), best first, through a
+ *        bounded heap in O(n log k). Ties go to the lower index, NaN ranks
+ *        below every number.
+ */
+void selectTopK(const double* score, int n, int k, std::vector<std::pair<int, double> >& top);
+
+namespace detail
+{
+union DoubleBits
+{
+    double d;
+    uint64_t u;
+};
+const double LOG2E = 1.4426950408889634074;
+//ln(2) split in a part exact in double and the rest
+const double LN2_HI = 6.93145751953125e-1;
+const double LN2_LO = 1.42860682030941723212e-6;
+const double SQRT2 = 1.41421356237309504880;
+}
+
+inline double fastExp(double x)
+{
+    if (x != x)
+    {
+        return x;
+    }
+    if (x < FAST_EXP_MIN)
+    {
+        return 0;
+    }
+    if (x > FAST_EXP_MAX)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    //x = n * ln(2) + r with |r| <= ln(2) / 2
+    double n = rint(x * detail::LOG2E);
+    double r = x - n * detail::LN2_HI - n * detail::LN2_LO;
+    double p = 1.0 + r * (1.0 + r * (1.0 / 2 + r * (1.0 / 6 + r * (1.0 / 24 + r * (1.0 / 120
+        + r * (1.0 / 720 + r * (1.0 / 5040 + r * (1.0 / 40320))))))));
+    //2^(n - 1) * 2 keeps n = 1024 representable
+    detail::DoubleBits scale;
+    scale.u = (uint64_t)((int64_t)n - 1 + 1023) << 52;
+    return p * scale.d * 2.0;
+}
+
+inline double fastLog(double x)
+{
+    if (!(x > 0) || x == std::numeric_limits<double>::infinity())
+    {
+        return log(x);
+    }
+    detail::DoubleBits bits;
+    bits.d = x;
+    int e = 0;
+    if ((bits.u >> 52) == 0)
+    {
+        //subnormal, scale by 2^54 first
+        bits.d *= 18014398509481984.0;
+        e = -54;
+    }
+    e += (int)(bits.u >> 52) - 1023;
+    bits.u = (bits.u & ((1ULL << 52) - 1)) | (1023ULL << 52);
+    double m = bits.d;
+    if (m > detail::SQRT2)
+    {
+        m *= 0.5;
+        ++e;
+    }
+    //log(m) = 2 atanh(s) with |s| <= 0.172
+    double s = (m - 1) / (m + 1);
+    double s2 = s * s;
+    double logm = 2 * s * (1 + s2 * (1.0 / 3 + s2 * (1.0 / 5 + s2 * (1.0 / 7
+        + s2 * (1.0 / 9 + s2 * (1.0 / 11))))));
+    return e * detail::LN2_HI + (e * detail::LN2_LO + logm);
+}
+} // namespace mlplus
+#endif
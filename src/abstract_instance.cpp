@@ -47,7 +47,7 @@ AbstractInstance::AbstractInstance(const AbstractInstance& AbstractInstance) :
 AbstractInstance::AbstractInstance(const vector<ValueType>& values, ValueType weight):
     mDataset(NULL),
     mWeight(weight),
-    mGroupId(-1), mAttrValues(values)
+    mGroupId(-1), mAttrValues(values.begin(), values.end())
 {
 }
 AbstractInstance::~AbstractInstance()
@@ -147,7 +147,7 @@ void AbstractInstance::setTargetValue(const string& value)
         throw runtime_error("class is not set");
     setValue(targetIndex(), value);
 }
-const vector<ValueType>&  AbstractInstance::getValueArray() const
+const ValueArray&  AbstractInstance::getValueArray() const
 {
     return mAttrValues;
 }
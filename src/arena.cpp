@@ -0,0 +1,70 @@
+#include <cstdlib>
+#include "arena.h"
+namespace mlplus
+{
+Arena::Arena(size_t blockSize, memory::Tag tag):
+    mBlockSize(blockSize < 256 ? 256 : blockSize),
+    mTag(tag),
+    mPtr(NULL),
+    mEnd(NULL),
+    mBytesUsed(0),
+    mBytesReserved(0)
+{
+}
+
+Arena::~Arena()
+{
+    reset();
+}
+
+void Arena::reset()
+{
+    for (size_t i = 0; i < mBlocks.size(); ++i)
+    {
+        ::free(mBlocks[i]);
+    }
+    mBlocks.clear();
+    if (mTag != memory::UNTAGGED)
+    {
+        memory::release(mTag, mBytesReserved);
+    }
+    mPtr = mEnd = NULL;
+    mBytesUsed = 0;
+    mBytesReserved = 0;
+}
+
+void* Arena::allocSlow(size_t size, size_t align)
+{
+    if (size + align > mBlockSize / 4)
+    {
+        // a block of its own, the current block stays open for small requests
+        char* block = static_cast<char*>(malloc(size + align));
+        if (block == NULL)
+        {
+            throw std::bad_alloc();
+        }
+        mBlocks.push_back(block);
+        mBytesReserved += size + align;
+        if (mTag != memory::UNTAGGED)
+        {
+            memory::charge(mTag, size + align);
+        }
+        mBytesUsed += size;
+        return (void*)(((size_t)block + align - 1) & ~(align - 1));
+    }
+    char* block = static_cast<char*>(malloc(mBlockSize));
+    if (block == NULL)
+    {
+        throw std::bad_alloc();
+    }
+    mBlocks.push_back(block);
+    mBytesReserved += mBlockSize;
+    if (mTag != memory::UNTAGGED)
+    {
+        memory::charge(mTag, mBlockSize);
+    }
+    mPtr = block;
+    mEnd = block + mBlockSize;
+    return alloc(size, align);
+}
+} // namespace mlplus
@@ -46,9 +46,23 @@ void  Attribute::mapValue2Index()
         mValue2Index[mValues[i]] = i;
     }
 }
+size_t Attribute::memoryUsage() const
+{
+    size_t bytes = MemoryPool::allocatedSize(sizeof(*this)) + memory::stringBytes(mName) +
+                   mValue2Index.memoryUsage() - sizeof(mValue2Index) + memory::vectorBytes(mValues);
+    for (FlatHashMap<std::string, int>::const_iterator it = mValue2Index.begin(); it != mValue2Index.end(); ++it)
+    {
+        bytes += memory::stringBytes(it->first);
+    }
+    for (size_t i = 0; i < mValues.size(); ++i)
+    {
+        bytes += memory::stringBytes(mValues[i]);
+    }
+    return bytes;
+}
 int  Attribute::indexOfValue(const string& value) const
 {
-    std::map<std::string, int>::const_iterator it = mValue2Index.find(value);
+    FlatHashMap<std::string, int>::const_iterator it = mValue2Index.find(value);
     if (it != mValue2Index.end())
     {
         return it->second;
@@ -78,6 +78,18 @@ unsigned int VectorAttributeContainer::size()
 {
     return mAttributeVec.size();
 }
+size_t VectorAttributeContainer::memoryUsage() const
+{
+    size_t bytes = sizeof(*this) + memory::vectorBytes(mAttributeVec);
+    for (VectorContainer::const_iterator it = mAttributeVec.begin(); it != mAttributeVec.end(); ++it)
+    {
+        if (it->get() != NULL)
+        {
+            bytes += memory::SHARED_COUNT_BYTES + (*it)->memoryUsage();
+        }
+    }
+    return bytes;
+}
 IAttributeIterator* VectorAttributeContainer::newIterator()
 {
     return new VectorIterator(mAttributeVec);
@@ -151,6 +163,19 @@ unsigned int  MapAttributeContainer::size()
 {
     return mAttributeMap.size();
 }
+size_t MapAttributeContainer::memoryUsage() const
+{
+    size_t bytes = sizeof(*this);
+    for (MapContainer::const_iterator it = mAttributeMap.begin(); it != mAttributeMap.end(); ++it)
+    {
+        bytes += memory::treeNodeBytes(sizeof(*it));
+        if (it->second.get() != NULL)
+        {
+            bytes += memory::SHARED_COUNT_BYTES + it->second->memoryUsage();
+        }
+    }
+    return bytes;
+}
 IAttributeIterator* MapAttributeContainer::newIterator()
 {
     return new MapIterator(mAttributeMap);
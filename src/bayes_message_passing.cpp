@@ -5,7 +5,9 @@
 #include "iterator_interface.h"
 #include "attribute_value.h"
 #include "string_utility.h"
+#include "vector_math.h"
 #include <estimators/estimator_include.h>
+#include <estimators/concurrent_estimator.h>
 #include <stdexcept>
 #include <algorithm>
 using namespace std;
@@ -13,9 +15,18 @@ using namespace std;
 namespace mlplus
 {
 BayesMsgPassing::BayesMsgPassing(const string& name, int nClasses):
-    Classifier(name), mClassDistribution(NULL), mClassesCount(nClasses)
+    Classifier(name), mClassDistribution(NULL), mClassesCount(nClasses), mConcurrency(0),
+    mIndexComplete(true)
 {
 }
+BayesMsgPassing::EstimatorPtr BayesMsgPassing::newDiscreteEstimator(int nSymbols, bool laplace) const
+{
+    if (mConcurrency > 0)
+    {
+        return new ConcurrentDiscreteEstimator(nSymbols, laplace, mConcurrency);
+    }
+    return new DiscreteEstimator(nSymbols, laplace);
+}
 void BayesMsgPassing::release()
 {
     std::map<AttributeIndex,  PosteriorProbability>::iterator it = mDistributions.begin();
@@ -33,6 +44,44 @@ void BayesMsgPassing::release()
         delete mClassDistribution;
         mClassDistribution = NULL;
     }
+    mIndex.clear();
+    mIndexComplete = true;
+}
+size_t BayesMsgPassing::memoryUsage() const
+{
+    size_t bytes = sizeof(*this) + memory::vectorBytes(mIndex);
+    DistributionMapType::const_iterator it = mDistributions.begin();
+    for (; it != mDistributions.end(); ++it)
+    {
+        bytes += memory::treeNodeBytes(sizeof(*it));
+        bytes += it->second != NULL ? it->second->memoryUsage() : 0;
+    }
+    if (mClassDistribution != NULL)
+    {
+        bytes += mClassDistribution->memoryUsage();
+    }
+    return bytes;
+}
+void BayesMsgPassing::rebuildIndex()
+{
+    mIndex.clear();
+    mIndexComplete = true;
+    if (mDistributions.empty())
+    {
+        return;
+    }
+    int lowest = mDistributions.begin()->first;
+    int highest = mDistributions.rbegin()->first;
+    if (lowest < 0 || (size_t)highest >= 4 * mDistributions.size() + 1024)
+    {
+        mIndexComplete = false;
+        return;
+    }
+    mIndex.resize(highest + 1, NULL);
+    for (DistributionMapType::iterator it = mDistributions.begin(); it != mDistributions.end(); ++it)
+    {
+        mIndex[it->first] = it->second;
+    }
 }
 BayesMsgPassing::~BayesMsgPassing()
 {
@@ -44,7 +93,7 @@ void BayesMsgPassing::train(DataSet* dataset)
     assert(dataset != NULL);
     //mClassesCount = dataset->numTargets();
     //int attributeCount  = dataset->numAttributes();
-    setClassDistribution(new DiscreteEstimator(mClassesCount));
+    setClassDistribution(newDiscreteEstimator(mClassesCount, true));
     int attIndex = 0;
     AutoAttributeIteratorPtr  attrIt(dataset->newAttributeIterator());
     int targetIndex = dataset->targetIndex();
@@ -58,7 +107,7 @@ void BayesMsgPassing::train(DataSet* dataset)
         }
         if (mDistributions.find(attIndex) == mDistributions.end()) 
         {
-            mDistributions[attIndex] = new DiscreteEstimator(mClassesCount, false);//P(Class|word)
+            mDistributions[attIndex] = newDiscreteEstimator(mClassesCount, false);//P(Class|word)
         }
         /*
         PosteriorProbability& pp =  mDistributions[attIndex];
@@ -68,6 +117,7 @@ void BayesMsgPassing::train(DataSet* dataset)
         }
         */
     }
+    rebuildIndex();
     AutoInstanceIteratorPtr instanceIt(dataset->newInstanceIterator());
     while(instanceIt->hasMore())
     {
@@ -95,11 +145,11 @@ void  BayesMsgPassing::update(IInstance* instance)
         {
             continue;
         }
-        if (mDistributions.find(aIndex) == mDistributions.end()) 
+        PosteriorProbability pp = distributionAt(aIndex);
+        if (pp == NULL)
         {
             continue;
         }
-        PosteriorProbability& pp =  mDistributions[aIndex];
         ValueType value = instance->getValue(aIndex);
         if (!AttributeValue::isMissingValue(value))
         {
@@ -111,7 +161,7 @@ void  BayesMsgPassing::update(IInstance* instance)
     mClassDistribution->addValue(targetValue, tfAll);
 }
 
-std::vector<double> BayesMsgPassing::targetDistribution(IInstance* instance)
+std::vector<double> BayesMsgPassing::logScores(IInstance* instance)
 {
     vector<double> v(mClassesCount,0);
     for(int i = 0; i < mClassesCount; i++)
@@ -128,12 +178,11 @@ std::vector<double> BayesMsgPassing::targetDistribution(IInstance* instance)
         {
             continue;
         }
-        DistributionMapType::iterator it = mDistributions.find(aIndex);
-        if (it == mDistributions.end()) 
+        PosteriorProbability pp = distributionAt(aIndex);
+        if (pp == NULL)
         {
             continue;
         }
-        PosteriorProbability& pp = it->second;
         ValueType aValue = instance->getValue(aIndex);
         if(!AttributeValue::isMissingValue(aValue))
         {
@@ -145,26 +194,44 @@ std::vector<double> BayesMsgPassing::targetDistribution(IInstance* instance)
             }
         }
     }
-    return sigmoidProb(v);
+    return v;
 }
 
-vector<double> BayesMsgPassing::sigmoidProb(const vector<double>& score)
+std::vector<double> BayesMsgPassing::targetDistribution(IInstance* instance)
 {
-    int class_set_size = score.size();
-    vector<double> prb(class_set_size, 0);
-    for (int i = 0; i < class_set_size; i++) 
+    return sigmoidProb(logScores(instance));
+}
+
+vector<pair<int, double> > BayesMsgPassing::predictTopK(IInstance* instance, int k)
+{
+    vector<double> v = logScores(instance);
+    vector<pair<int, double> > top;
+    if (v.empty())
+    {
+        return top;
+    }
+    //the sigmoid is monotonic, so the raw scores rank the classes
+    selectTopK(&v[0], v.size(), k, top);
+    sigmoid(&v[0], &v[0], v.size());
+    double sum = 0;
+    for (unsigned i = 0; i < v.size(); ++i)
     {
-        prb[i] = 1/(1 + exp(-score[i]));
+        sum += v[i];
     }
-    //normalize
-    double sum;
-    for (int i = 0; i < class_set_size; ++i)
+    for (unsigned i = 0; i < top.size(); ++i)
     {
-        sum += prb[i];
+        top[i].second = v[top[i].first] / sum;
     }
-    for (int i = 0; i < class_set_size; ++i)
+    return top;
+}
+
+vector<double> BayesMsgPassing::sigmoidProb(const vector<double>& score)
+{
+    vector<double> prb(score);
+    if (!prb.empty())
     {
-        prb[i] /= sum;
+        sigmoid(&prb[0], &prb[0], prb.size());
+        normalize(&prb[0], prb.size());
     }
     return prb;
 }
@@ -178,7 +245,7 @@ void BayesMsgPassing::load(istream& input)
     {
         split(line,result,"=");
         mClassesCount = atoi(result[1].c_str());
-        setClassDistribution(new DiscreteEstimator(mClassesCount));
+        setClassDistribution(newDiscreteEstimator(mClassesCount, true));
     }
     //class distribution
     if (getline(input,line))
@@ -201,11 +268,12 @@ void BayesMsgPassing::load(istream& input)
             PosteriorProbability& pp =  mDistributions[attIndex];
             if (pp == NULL)
             {
-                pp = new DiscreteEstimator(mClassesCount);
+                pp = newDiscreteEstimator(mClassesCount, true);
                 pp->fromString(result[1]);
             }
         }
     }
+    rebuildIndex();
 }
 void BayesMsgPassing::save(ostream& output)
 {
@@ -226,9 +294,8 @@ void BayesMsgPassing::save(ostream& output)
 }
 pair<int, double> BayesMsgPassing::predict(IInstance* i) 
 {
-    vector<double> array = targetDistribution(i);
-    vector<double>::const_iterator it = max_element(array.begin(), array.end());
-    return make_pair(it - array.begin(), *it);
+    vector<pair<int, double> > top = predictTopK(i, 1);
+    return top.empty() ? make_pair(0, 0.0) : top[0];
 }
 } // namespace mlplus
 
@@ -28,6 +28,11 @@ BinaryEstimator::BinaryEstimator(bool laplace)
     mPositiveCount = laplace;
     mNegativeCount = laplace;
 }
+void BinaryEstimator::setCounts(double positive, double negative)
+{
+    mPositiveCount = positive;
+    mNegativeCount = negative;
+}
 double BinaryEstimator::getProbability(double data)
 {
     if(data > 0.9)
@@ -48,6 +53,10 @@ void BinaryEstimator::fromString(const std::string& str)
     istringstream iss(str);
     iss >> mPositiveCount >> mNegativeCount;
 }
+size_t BinaryEstimator::memoryUsage() const
+{
+    return MemoryPool::allocatedSize(sizeof(*this));
+}
 } // namespace estimators
 } // namespace mlplus
 
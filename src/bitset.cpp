@@ -0,0 +1,363 @@
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MLPLUS_BITSET_DISPATCH
+#include <immintrin.h>
+#define MLPLUS_TARGET(isa) __attribute__((target(isa)))
+#endif
+#include "bitset.h"
+namespace mlplus
+{
+namespace bitset
+{
+namespace
+{
+// the portable kernels, also inlined into the popcnt and AVX2 ones for the tails
+inline size_t popcountTail(const uint64_t* words, size_t i, size_t n)
+{
+    size_t count = 0;
+    for (; i < n; ++i)
+    {
+        count += __builtin_popcountll(words[i]);
+    }
+    return count;
+}
+
+inline size_t andCountTail(const uint64_t* a, const uint64_t* b, size_t i, size_t n)
+{
+    size_t count = 0;
+    for (; i < n; ++i)
+    {
+        count += __builtin_popcountll(a[i] & b[i]);
+    }
+    return count;
+}
+
+inline void andTail(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t i, size_t n)
+{
+    for (; i < n; ++i)
+    {
+        out[i] = a[i] & b[i];
+    }
+}
+
+inline void orTail(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t i, size_t n)
+{
+    for (; i < n; ++i)
+    {
+        out[i] = a[i] | b[i];
+    }
+}
+
+inline void andNotTail(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t i, size_t n)
+{
+    for (; i < n; ++i)
+    {
+        out[i] = a[i] & ~b[i];
+    }
+}
+
+size_t popcountScalar(const uint64_t* words, size_t n)
+{
+    return popcountTail(words, 0, n);
+}
+
+size_t andCountScalar(const uint64_t* a, const uint64_t* b, size_t n)
+{
+    return andCountTail(a, b, 0, n);
+}
+
+void andIntoScalar(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n)
+{
+    andTail(out, a, b, 0, n);
+}
+
+void orIntoScalar(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n)
+{
+    orTail(out, a, b, 0, n);
+}
+
+void andNotIntoScalar(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n)
+{
+    andNotTail(out, a, b, 0, n);
+}
+
+#ifdef MLPLUS_BITSET_DISPATCH
+// __builtin_popcountll is a libgcc call unless the function may use popcnt
+MLPLUS_TARGET("popcnt") size_t popcountPopcnt(const uint64_t* words, size_t n)
+{
+    return popcountTail(words, 0, n);
+}
+
+MLPLUS_TARGET("popcnt") size_t andCountPopcnt(const uint64_t* a, const uint64_t* b, size_t n)
+{
+    return andCountTail(a, b, 0, n);
+}
+
+// the bit counts of the bytes of v, summed into its four 64 bit lanes
+MLPLUS_TARGET("avx2") inline __m256i popcount256(__m256i v)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(v, low);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+    __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+}
+
+MLPLUS_TARGET("avx2") inline size_t sumLanes(__m256i v)
+{
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, v);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+MLPLUS_TARGET("avx2") inline __m256i load(const uint64_t* p)
+{
+    return _mm256_loadu_si256((const __m256i*)p);
+}
+
+MLPLUS_TARGET("avx2") inline void store(uint64_t* p, __m256i v)
+{
+    _mm256_storeu_si256((__m256i*)p, v);
+}
+
+MLPLUS_TARGET("avx2,popcnt") size_t popcountAvx2(const uint64_t* words, size_t n)
+{
+    size_t i = 0;
+    __m256i sum = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4)
+    {
+        sum = _mm256_add_epi64(sum, popcount256(load(words + i)));
+    }
+    return sumLanes(sum) + popcountTail(words, i, n);
+}
+
+MLPLUS_TARGET("avx2,popcnt") size_t andCountAvx2(const uint64_t* a, const uint64_t* b, size_t n)
+{
+    size_t i = 0;
+    __m256i sum = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4)
+    {
+        sum = _mm256_add_epi64(sum, popcount256(_mm256_and_si256(load(a + i), load(b + i))));
+    }
+    return sumLanes(sum) + andCountTail(a, b, i, n);
+}
+
+MLPLUS_TARGET("avx2") void andIntoAvx2(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        store(out + i, _mm256_and_si256(load(a + i), load(b + i)));
+    }
+    andTail(out, a, b, i, n);
+}
+
+MLPLUS_TARGET("avx2") void orIntoAvx2(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        store(out + i, _mm256_or_si256(load(a + i), load(b + i)));
+    }
+    orTail(out, a, b, i, n);
+}
+
+MLPLUS_TARGET("avx2") void andNotIntoAvx2(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        // andnot complements its first operand
+        store(out + i, _mm256_andnot_si256(load(b + i), load(a + i)));
+    }
+    andNotTail(out, a, b, i, n);
+}
+#endif
+
+struct Kernels
+{
+    size_t (*popcount)(const uint64_t*, size_t);
+    size_t (*andCount)(const uint64_t*, const uint64_t*, size_t);
+    void (*andInto)(uint64_t*, const uint64_t*, const uint64_t*, size_t);
+    void (*orInto)(uint64_t*, const uint64_t*, const uint64_t*, size_t);
+    void (*andNotInto)(uint64_t*, const uint64_t*, const uint64_t*, size_t);
+    bool avx2;
+};
+
+bool cpuHasAvx2()
+{
+#ifdef MLPLUS_BITSET_DISPATCH
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#else
+    return false;
+#endif
+}
+
+Kernels select(bool avx2)
+{
+    Kernels k = {popcountScalar, andCountScalar, andIntoScalar, orIntoScalar, andNotIntoScalar, false};
+#ifdef MLPLUS_BITSET_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("popcnt"))
+    {
+        k.popcount = popcountPopcnt;
+        k.andCount = andCountPopcnt;
+    }
+    if (avx2)
+    {
+        Kernels wide = {popcountAvx2, andCountAvx2, andIntoAvx2, orIntoAvx2, andNotIntoAvx2, true};
+        k = wide;
+    }
+#endif
+    return k;
+}
+
+Kernels& kernels()
+{
+    static Kernels k = select(cpuHasAvx2());
+    return k;
+}
+} // namespace
+
+size_t popcount(const uint64_t* words, size_t n)
+{
+    return kernels().popcount(words, n);
+}
+
+size_t andCount(const uint64_t* a, const uint64_t* b, size_t n)
+{
+    return kernels().andCount(a, b, n);
+}
+
+void andInto(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n)
+{
+    kernels().andInto(out, a, b, n);
+}
+
+void orInto(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n)
+{
+    kernels().orInto(out, a, b, n);
+}
+
+void andNotInto(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t n)
+{
+    kernels().andNotInto(out, a, b, n);
+}
+
+bool usingAvx2()
+{
+    return kernels().avx2;
+}
+
+bool useAvx2(bool enable)
+{
+    kernels() = select(enable && cpuHasAvx2());
+    return kernels().avx2 == enable;
+}
+} // namespace bitset
+
+const size_t DenseBitset::npos;
+
+DenseBitset::DenseBitset(size_t size, bool value):
+    mWords(bitset::numWords(size), value ? ~(uint64_t)0 : 0),
+    mSize(size)
+{
+    clearTail();
+}
+
+void DenseBitset::resize(size_t size, bool value)
+{
+    size_t old = mSize;
+    mWords.resize(bitset::numWords(size), value ? ~(uint64_t)0 : 0);
+    mSize = size;
+    if (value && old < size && (old & 63) != 0)
+    {
+        mWords[old >> 6] |= ~(uint64_t)0 << (old & 63);
+    }
+    clearTail();
+}
+
+void DenseBitset::setAll()
+{
+    std::fill(mWords.begin(), mWords.end(), ~(uint64_t)0);
+    clearTail();
+}
+
+void DenseBitset::resetAll()
+{
+    std::fill(mWords.begin(), mWords.end(), 0);
+}
+
+size_t DenseBitset::count() const
+{
+    return bitset::popcount(words(), mWords.size());
+}
+
+bool DenseBitset::any() const
+{
+    for (size_t i = 0; i < mWords.size(); ++i)
+    {
+        if (mWords[i] != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t DenseBitset::findNext(size_t from) const
+{
+    if (from >= mSize)
+    {
+        return npos;
+    }
+    size_t w = from >> 6;
+    uint64_t word = mWords[w] & (~(uint64_t)0 << (from & 63));
+    while (word == 0)
+    {
+        if (++w == mWords.size())
+        {
+            return npos;
+        }
+        word = mWords[w];
+    }
+    return (w << 6) + __builtin_ctzll(word);
+}
+
+DenseBitset& DenseBitset::operator&=(const DenseBitset& other)
+{
+    assert(mSize == other.mSize);
+    bitset::andInto(mutableWords(), words(), other.words(), mWords.size());
+    return *this;
+}
+
+DenseBitset& DenseBitset::operator|=(const DenseBitset& other)
+{
+    assert(mSize == other.mSize);
+    bitset::orInto(mutableWords(), words(), other.words(), mWords.size());
+    return *this;
+}
+
+DenseBitset& DenseBitset::andNot(const DenseBitset& other)
+{
+    assert(mSize == other.mSize);
+    bitset::andNotInto(mutableWords(), words(), other.words(), mWords.size());
+    return *this;
+}
+
+size_t DenseBitset::andCount(const DenseBitset& a, const DenseBitset& b)
+{
+    assert(a.mSize == b.mSize);
+    return bitset::andCount(a.words(), b.words(), a.mWords.size());
+}
+
+void DenseBitset::clearTail()
+{
+    if ((mSize & 63) != 0)
+    {
+        mWords.back() &= ((uint64_t)1 << (mSize & 63)) - 1;
+    }
+}
+} // namespace mlplus
@@ -0,0 +1,185 @@
+#include <cmath>
+#include <sstream>
+#include <vector>
+#include "estimators/concurrent_estimator.h"
+#include "special_functions.h"
+namespace mlplus
+{
+namespace estimators
+{
+
+using namespace std;
+
+ConcurrentDiscreteEstimator::ConcurrentDiscreteEstimator(int nSymbols, bool laplace, int stripes):
+    DiscreteEstimator(nSymbols, laplace), mPartials(nSymbols + 1, stripes)
+{
+}
+double ConcurrentDiscreteEstimator::getCount(int data) const
+{
+    if (data < 0 || data >= mNumOfClass)
+    {
+        return 0;
+    }
+    return mCounts[data] + mPartials.sum(data);
+}
+double ConcurrentDiscreteEstimator::getSumOfCounts(void) const
+{
+    return mSumOfCounts + mPartials.sum(mNumOfClass);
+}
+void ConcurrentDiscreteEstimator::addValue(double val, double weight)
+{
+    if(mNumOfClass <= val)
+    {
+        return;
+    }
+    mPartials.add((int)val, weight);
+    mPartials.add(mNumOfClass, weight);
+}
+double ConcurrentDiscreteEstimator::getProbability(double data)
+{
+    double sum = getSumOfCounts();
+    if(sum == 0)
+        return 0;
+    int id = (int)data;
+    if (id > -1 && id < mNumOfClass)
+    {
+        return getCount(id) / sum;
+    }
+    return 0;
+}
+std::string ConcurrentDiscreteEstimator::toString()
+{
+    vector<double> counts(mCounts, mCounts + mNumOfClass);
+    counts.push_back(mSumOfCounts);
+    mPartials.foldInto(&counts[0]);
+    ostringstream oss;
+    oss << counts[mNumOfClass] << "\t" << mNumOfClass << "\t";
+    for (int i = 0; i < mNumOfClass; ++i)
+    {
+        oss << counts[i] << "\t";
+    }
+    return oss.str();
+}
+void ConcurrentDiscreteEstimator::fromString(const std::string& str)
+{
+    DiscreteEstimator::fromString(str);
+    mPartials.reset(mNumOfClass + 1);
+}
+size_t ConcurrentDiscreteEstimator::memoryUsage() const
+{
+    return MemoryPool::allocatedSize(sizeof(*this)) + mNumOfClass * sizeof(double) + mPartials.memoryUsage();
+}
+/*----------------------------------------------------------------------------*/
+ConcurrentNormalEstimator::ConcurrentNormalEstimator(double precision, int stripes):
+    NormalEstimator(precision), mPartials(WIDTH, stripes)
+{
+}
+void ConcurrentNormalEstimator::moments(double& sumOfWeights, double& sumOfValues,
+        double& sumOfValuesSq, double& mean, double& stdDev) const
+{
+    sumOfWeights = mSumOfWeights + mPartials.sum(WEIGHTS);
+    sumOfValues = mSumOfValues + mPartials.sum(VALUES);
+    sumOfValuesSq = mSumOfValuesSq + mPartials.sum(SQUARES);
+    mean = mMean;
+    stdDev = mStardardDev;
+    if(sumOfWeights > 0)
+    {
+        mean = sumOfValues / sumOfWeights;
+        double sd = sqrt(fabs(sumOfValuesSq / sumOfWeights - mean * mean));
+        if(sd > 1e-10)
+        {
+            stdDev = max(mPrecision / (2.0 * 3.0), sd);
+        }
+    }
+}
+double ConcurrentNormalEstimator::getMean() const
+{
+    double w, v, sq, mean, sd;
+    moments(w, v, sq, mean, sd);
+    return mean;
+}
+double ConcurrentNormalEstimator::getStdDev() const
+{
+    double w, v, sq, mean, sd;
+    moments(w, v, sq, mean, sd);
+    return sd;
+}
+void ConcurrentNormalEstimator::addValue(double data, double weight)
+{
+    if(weight == 0)
+        return;
+    data = round(data);
+    mPartials.add(WEIGHTS, weight);
+    mPartials.add(VALUES, data * weight);
+    mPartials.add(SQUARES, data * data * weight);
+}
+double ConcurrentNormalEstimator::getProbability(double data)
+{
+    double w, v, sq, mean, sd;
+    moments(w, v, sq, mean, sd);
+    data = round(data);
+    double zLower = (data - mean - (mPrecision / 2.0)) / sd;
+    double zUpper = (data - mean + (mPrecision / 2.0)) / sd;
+    return phi(zUpper) - phi(zLower);
+}
+std::string ConcurrentNormalEstimator::toString()
+{
+    double w, v, sq, mean, sd;
+    moments(w, v, sq, mean, sd);
+    ostringstream oss;
+    oss << mPrecision << "\t" << w <<"\t" << v <<"\t" << sq << "\t" << mean <<"\t" << sd;
+    return oss.str();
+}
+void ConcurrentNormalEstimator::fromString(const std::string& str)
+{
+    NormalEstimator::fromString(str);
+    mPartials.clear();
+}
+size_t ConcurrentNormalEstimator::memoryUsage() const
+{
+    return MemoryPool::allocatedSize(sizeof(*this)) + mPartials.memoryUsage();
+}
+/*----------------------------------------------------------------------------*/
+ConcurrentBinaryEstimator::ConcurrentBinaryEstimator(bool laplace, int stripes):
+    BinaryEstimator(laplace), mPartials(WIDTH, stripes)
+{
+}
+double ConcurrentBinaryEstimator::getPostiveCount(void) const
+{
+    return mPositiveCount + mPartials.sum(POSITIVE);
+}
+double ConcurrentBinaryEstimator::getNegativeCount(void) const
+{
+    return mNegativeCount + mPartials.sum(NEGATIVE);
+}
+void ConcurrentBinaryEstimator::addValue(double val, double weight)
+{
+    mPartials.add(val > 0.99 ? POSITIVE : NEGATIVE, weight);
+}
+double ConcurrentBinaryEstimator::getProbability(double data)
+{
+    double pos = getPostiveCount();
+    double neg = getNegativeCount();
+    if(data > 0.9)
+    {
+        return pos / (pos + neg);
+    }
+    return neg / (pos + neg);
+}
+std::string ConcurrentBinaryEstimator::toString()
+{
+    ostringstream oss;
+    oss << getPostiveCount() << "\t" << getNegativeCount() << "\t";
+    return oss.str();
+}
+void ConcurrentBinaryEstimator::fromString(const std::string& str)
+{
+    BinaryEstimator::fromString(str);
+    mPartials.clear();
+}
+size_t ConcurrentBinaryEstimator::memoryUsage() const
+{
+    return MemoryPool::allocatedSize(sizeof(*this)) + mPartials.memoryUsage();
+}
+} // namespace estimators
+} // namespace mlplus
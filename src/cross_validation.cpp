@@ -0,0 +1,274 @@
+#include <time.h>
+#include <cmath>
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <stdexcept>
+#include "instance.h"
+#include "dataset.h"
+#include "classifier.h"
+#include "naive_bayes.h"
+#include "synthetic_data.h"
+#include "thread_pool.h"
+#include "cross_validation.h"
+using namespace std;
+namespace mlplus
+{
+void ParameterGrid::add(const string& name, const vector<string>& values)
+{
+    if (values.empty())
+    {
+        throw runtime_error("no values for parameter " + name);
+    }
+    mValues.push_back(make_pair(name, values));
+}
+
+void ParameterGrid::add(const string& name, const string& values)
+{
+    vector<string> split;
+    string::size_type begin = 0;
+    while (begin <= values.size())
+    {
+        string::size_type end = values.find(',', begin);
+        if (end == string::npos)
+        {
+            end = values.size();
+        }
+        split.push_back(values.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    add(name, split);
+}
+
+size_t ParameterGrid::size() const
+{
+    size_t size = 1;
+    for (size_t i = 0; i < mValues.size(); ++i)
+    {
+        size *= mValues[i].second.size();
+    }
+    return size;
+}
+
+Parameters ParameterGrid::at(size_t i) const
+{
+    Parameters parameters;
+    for (size_t k = mValues.size(); k-- > 0;)
+    {
+        const vector<string>& values = mValues[k].second;
+        parameters[mValues[k].first] = values[i % values.size()];
+        i /= values.size();
+    }
+    return parameters;
+}
+
+Classifier* NaiveBayesFactory::create(const Parameters& parameters, int numClasses)
+{
+    auto_ptr<NaiveBayes> bayes(new NaiveBayes("naive_bayes", numClasses));
+    for (Parameters::const_iterator it = parameters.begin(); it != parameters.end(); ++it)
+    {
+        if (it->first != "event_model")
+        {
+            throw runtime_error("unknown naive bayes parameter " + it->first);
+        }
+        if (it->second != "0" && it->second != "1")
+        {
+            throw runtime_error("event_model is 0 or 1, not " + it->second);
+        }
+        bayes->setEventModel(it->second == "1");
+    }
+    return bayes.release();
+}
+
+namespace
+{
+double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * trains on every fold but one and evaluates the held out fold
+ */
+class FoldTask : public Runnable
+{
+public:
+    FoldTask(const CrossValidation& folds, int fold, DataSet& data, ClassifierFactory& factory,
+             const Parameters& parameters, int numClasses):
+        mFolds(folds), mFold(fold), mData(data), mFactory(factory), mParameters(parameters),
+        mMetrics(numClasses), mTrainSeconds(0), mTestSeconds(0)
+    {
+    }
+    /*override*/ void run()
+    {
+        auto_ptr<Classifier> classifier(mFactory.create(mParameters, mMetrics.numClasses()));
+        vector<int> train;
+        mFolds.trainIndices(mFold, train);
+        auto_ptr<DataSet> view(mData.subset(train));
+        double start = now();
+        classifier->train(view.get());
+        double trained = now();
+        mMetrics = evaluate(*classifier, mData, mFolds.testIndices(mFold), mMetrics.numClasses(), 1);
+        mTrainSeconds = trained - start;
+        mTestSeconds = now() - trained;
+    }
+    const ClassificationMetrics& metrics() const {return mMetrics;}
+    double trainSeconds() const {return mTrainSeconds;}
+    double testSeconds() const {return mTestSeconds;}
+private:
+    const CrossValidation& mFolds;
+    int mFold;
+    DataSet& mData;
+    ClassifierFactory& mFactory;
+    const Parameters& mParameters;
+    ClassificationMetrics mMetrics;
+    double mTrainSeconds;
+    double mTestSeconds;
+};
+
+string format(const Parameters& parameters)
+{
+    string out;
+    for (Parameters::const_iterator it = parameters.begin(); it != parameters.end(); ++it)
+    {
+        out += (out.empty() ? "" : ",") + it->first + "=" + it->second;
+    }
+    return out.empty() ? "-" : out;
+}
+
+struct ByAccuracy
+{
+    explicit ByAccuracy(const vector<CrossValidationResult>& results): mResults(results) {}
+    bool operator()(size_t a, size_t b) const
+    {
+        return mResults[a].metrics.accuracy() > mResults[b].metrics.accuracy();
+    }
+    const vector<CrossValidationResult>& mResults;
+};
+} // namespace
+
+CrossValidation::CrossValidation(DataSet& data, int folds, uint64_t seed, bool stratified):
+    mData(data), mNumClasses(data.numTargets()), mFolds(max(folds, 2))
+{
+    // the instances of a class, or all of them, in a seeded random order
+    vector<vector<int> > groups(stratified ? mNumClasses + 1 : 1);
+    for (int i = 0; i < data.numInstances(); ++i)
+    {
+        int klass = stratified ? (int)data.instanceAt(i)->targetValue() : 0;
+        groups[klass >= 0 && klass < (int)groups.size() ? klass : groups.size() - 1].push_back(i);
+    }
+    SplitMix64 random(seed);
+    size_t next = 0;
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        vector<int>& group = groups[g];
+        for (size_t i = group.size(); i > 1; --i)
+        {
+            swap(group[i - 1], group[random.next() % i]);
+        }
+        // deal on from where the last class stopped, so the fold sizes differ by one at most
+        for (size_t i = 0; i < group.size(); ++i)
+        {
+            mFolds[next++ % mFolds.size()].push_back(group[i]);
+        }
+    }
+    for (size_t i = 0; i < mFolds.size(); ++i)
+    {
+        sort(mFolds[i].begin(), mFolds[i].end());
+    }
+}
+
+void CrossValidation::trainIndices(int fold, vector<int>& indices) const
+{
+    indices.clear();
+    indices.reserve(mData.numInstances() - mFolds[fold].size());
+    for (int k = 0; k < (int)mFolds.size(); ++k)
+    {
+        if (k != fold)
+        {
+            indices.insert(indices.end(), mFolds[k].begin(), mFolds[k].end());
+        }
+    }
+    sort(indices.begin(), indices.end());
+}
+
+void CrossValidation::run(ClassifierFactory& factory, const ParameterGrid& grid, int threads,
+                          vector<CrossValidationResult>& results)
+{
+    results.assign(grid.size(), CrossValidationResult(mNumClasses));
+    vector<FoldTask*> tasks;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        results[i].parameters = grid.at(i);
+    }
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        for (int k = 0; k < numFolds(); ++k)
+        {
+            tasks.push_back(new FoldTask(*this, k, mData, factory, results[i].parameters, mNumClasses));
+        }
+    }
+    try
+    {
+        ThreadPool pool(min(threads > 0 ? threads : ThreadPool::hardwareThreads(), (int)tasks.size()));
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            pool.submit(tasks[i]);
+        }
+        pool.wait();
+    }
+    catch (...)
+    {
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            delete tasks[i];
+        }
+        throw;
+    }
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        CrossValidationResult& result = results[i / numFolds()];
+        result.metrics.merge(tasks[i]->metrics());
+        result.foldAccuracy.push_back(tasks[i]->metrics().accuracy());
+        result.trainSeconds += tasks[i]->trainSeconds();
+        result.testSeconds += tasks[i]->testSeconds();
+        delete tasks[i];
+    }
+}
+
+void CrossValidation::print(ostream& out, const vector<CrossValidationResult>& results)
+{
+    vector<size_t> order;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        order.push_back(i);
+    }
+    stable_sort(order.begin(), order.end(), ByAccuracy(results));
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+    out << fixed << setprecision(5);
+    out << "accuracy\tstddev\tmacro_f1\tlog_loss\tauc\ttrain_s\ttest_s\tparameters\n";
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        const CrossValidationResult& result = results[order[i]];
+        double mean = 0, variance = 0;
+        for (size_t k = 0; k < result.foldAccuracy.size(); ++k)
+        {
+            mean += result.foldAccuracy[k] / result.foldAccuracy.size();
+        }
+        for (size_t k = 0; k < result.foldAccuracy.size(); ++k)
+        {
+            variance += (result.foldAccuracy[k] - mean) * (result.foldAccuracy[k] - mean);
+        }
+        variance /= result.foldAccuracy.size() > 1 ? result.foldAccuracy.size() - 1 : 1;
+        out << result.metrics.accuracy() << "\t" << sqrt(variance) << "\t" << result.metrics.macroF1() << "\t"
+            << result.metrics.logLoss() << "\t" << result.metrics.weightedAuc() << "\t"
+            << setprecision(3) << result.trainSeconds << "\t" << result.testSeconds << "\t"
+            << setprecision(5) << format(result.parameters) << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+} // namespace mlplus
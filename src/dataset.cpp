@@ -1,9 +1,11 @@
+#include <algorithm>
 #include <stdexcept>
 #include <vector>
 #include "dataset.h"
 #include "attribute_container.h"
 #include "attribute_value.h"
 #include "instance_container.h"
+#include "sampling.h"
 namespace mlplus
 {
 
@@ -35,6 +37,19 @@ DataSet::~DataSet()
         delete mInstances;
     }
 }
+size_t DataSet::memoryUsage() const
+{
+    size_t bytes = sizeof(*this) + memory::stringBytes(mName);
+    if (NULL != mAttributes)
+    {
+        bytes += mAttributes->memoryUsage();
+    }
+    if (NULL != mInstances)
+    {
+        bytes += mInstances->memoryUsage();
+    }
+    return bytes;
+}
 vector<ValueType> DataSet::attributeArray(int index)
 {
     vector <ValueType> v;
@@ -55,4 +70,93 @@ vector<ValueType> DataSet::attributeArray(int index)
     return v;
 }
 
+DenseBitset DataSet::missingMask(int attIndex)
+{
+    DenseBitset mask(numInstances());
+    for (int i = 0; i < numInstances(); ++i)
+    {
+        IInstance* ins = instanceAt(i);
+        if (NULL != ins && AttributeValue::isMissingValue(ins->getValue(attIndex)))
+        {
+            mask.set(i);
+        }
+    }
+    return mask;
+}
+
+DataSet* DataSet::subset(const vector<int>& indices)
+{
+    InstanceViewContainer* view = new InstanceViewContainer();
+    view->reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        view->add(instanceAt(indices[i]));
+    }
+    DataSet* data = new DataSet(mName, mAttributes->shallowCopy(), view);
+    data->mTagetIndex = mTagetIndex;
+    return data;
+}
+
+DataSet* DataSet::subset(const vector<int>& indices, const vector<double>& weights)
+{
+    assert(indices.size() == weights.size());
+    InstanceViewContainer* view = new InstanceViewContainer();
+    view->reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        view->add(instanceAt(indices[i]), weights[i]);
+    }
+    DataSet* data = new DataSet(mName, mAttributes->shallowCopy(), view);
+    data->mTagetIndex = mTagetIndex;
+    return data;
+}
+
+DataSet* DataSet::randomize(uint64_t seed)
+{
+    vector<int> indices(numInstances());
+    SplitMix64 random(seed);
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        indices[i] = i;
+    }
+    for (size_t i = indices.size(); i > 1; --i)
+    {
+        std::swap(indices[i - 1], indices[random.below(i)]);
+    }
+    return subset(indices);
+}
+
+DataSet* DataSet::resample(uint64_t seed)
+{
+    vector<int> indices;
+    SplitMix64 random(seed);
+    bootstrapIndices(numInstances(), numInstances(), random, indices);
+    // in row order the sample walks the container forward
+    sort(indices.begin(), indices.end());
+    return subset(indices);
+}
+
+DataSet* DataSet::resampleWithWeights(uint64_t seed)
+{
+    vector<double> weights(numInstances());
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        weights[i] = instanceAt(i)->getWeight();
+    }
+    return resampleWithWeights(weights, seed);
+}
+
+DataSet* DataSet::resampleWithWeights(const vector<double>& weights, uint64_t seed)
+{
+    if ((int)weights.size() != numInstances())
+    {
+        throw runtime_error("a weight is needed for every instance");
+    }
+    vector<int> indices;
+    SplitMix64 random(seed);
+    weightedIndices(AliasTable(weights), numInstances(), random, indices);
+    sort(indices.begin(), indices.end());
+    return subset(indices, vector<double>(indices.size(), 1.0));
+}
+
 }
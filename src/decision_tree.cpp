@@ -1,10 +1,14 @@
 #include <cstdlib>
+#include <new>
+#include "arena.h"
+#include "dataset.h"
 #include "log.h"
 #include "decision_tree.h"
 #include "attribute_spec.h"
 #include "instance_interface.h"
 #include "attribute_value.h"
 #include "string_utility.h"
+#include "profile.h"
 namespace
 {
 static char* Prop[] = {"null", "att", "class", "cut", "conds", "elts",
@@ -40,9 +44,25 @@ static const int INITP  = 23;
 }
 using namespace mlplus;
 using namespace std;
-DecisionTreePtr DecisionTree::newTree(AttributeSpec* spec)
+template <class T>
+T* DecisionTree::allocArray(int n)
 {
-    DecisionTreePtr dt = new DecisionTree();
+    return mArena ? mArena->allocArray<T>(n) : new T[n];
+}
+
+template <class T>
+void DecisionTree::freeArray(T* p)
+{
+    if (mArena == NULL)
+    {
+        delete[] p;
+    }
+}
+
+DecisionTreePtr DecisionTree::newTree(AttributeSpec* spec, Arena* arena)
+{
+    DecisionTreePtr dt = arena ? new (arena->alloc(sizeof(DecisionTree))) DecisionTree() : new DecisionTree();
+    dt->mArena = arena;
     dt->mNodeType = dtnGrowing;
     dt->mAttributeSpec = spec;
     dt->mGrowingData = 0;
@@ -54,10 +74,11 @@ DecisionTreePtr DecisionTree::newTree(AttributeSpec* spec)
     dt->mForks = 0;
     dt->mChildren = NULL;
     dt->mSubset = 0;
+    dt->mSubsetWords = 0;
     dt->mMyClass = 0;
     dt->mErrors = 0;
     dt->mCases = 0;
-    dt->mClassDist = new float[spec->numTarget()];
+    dt->mClassDist = dt->allocArray<float>(spec->numTarget());
     dt->zeroClassDistribution();
     return dt;
 }
@@ -66,49 +87,56 @@ void DecisionTree::free()
 {
     if(mChildren)
     {
-        if(mNodeType == dtnDiscrete || mNodeType == dtnContinuous)
+        if(mNodeType == dtnDiscrete || mNodeType == dtnContinuous || mNodeType == dtnSubset)
         {
             for(int i = 0 ; i < mForks ; ++i)
             {
                 mChildren[i]->free();
             }
-            delete[] mChildren;
+            freeArray(mChildren);
             mChildren = NULL;
         }
     }
     if (mClassDist)
     {
-        delete[] mClassDist;
+        freeArray(mClassDist);
         mClassDist = NULL;
     }
     if (mSubset)
     {
-        delete[] mSubset;
+        freeArray(mSubset);
         mSubset = NULL;
     }
-    delete this;
+    if (mArena == NULL)
+    {
+        delete this;
+    }
 }
 
 DecisionTreePtr DecisionTree::clone()
 {
     int i;
     DecisionTreePtr clone = newTree(mAttributeSpec);
+    delete[] clone->mClassDist;
     *clone = *this;
+    // a clone lives on the heap whatever the original was allocated from
+    clone->mArena = NULL;
+    clone->mClassDist = NULL;
     if (NULL != mChildren)
     {
         clone->mChildren = new DecisionTreePtr[mForks];
     }
     if (NULL != mSubset)
     {
-        clone->mSubset = new Set64[mForks];
-        memcpy(clone->mSubset, mSubset, sizeof(Set64) * mForks);
+        clone->mSubset = new uint64_t[mForks * mSubsetWords];
+        memcpy(clone->mSubset, mSubset, sizeof(uint64_t) * mForks * mSubsetWords);
     }
     if (NULL != mClassDist)
     {
         clone->mClassDist = new float[mAttributeSpec->numTarget()];
         memcpy(clone->mClassDist, mClassDist, sizeof(float) * mAttributeSpec->numTarget());
     }
-    if(mNodeType == dtnDiscrete || mNodeType == dtnContinuous)
+    if(mNodeType == dtnDiscrete || mNodeType == dtnContinuous || mNodeType == dtnSubset)
     {
         for(i = 0 ; i < mForks ; i++)
         {
@@ -132,10 +160,9 @@ int DecisionTree::isTreeGrowing()
         return 0;
     case dtnGrowing:
         return 1;
-    case dtnSubset:
-        return 0;
     case dtnContinuous:
     case dtnDiscrete:
+    case dtnSubset:
         for(i = 0 ; i < mForks ; i++)
         {
             if(mChildren[i]->isTreeGrowing())
@@ -217,7 +244,7 @@ void DecisionTree::splitOnDiscreteAttribute(int attNum)
     resetChild(attr->numValues());
     for(i = 0 ; i < mForks; i++)
     {
-        mChildren[i] = newTree(mAttributeSpec);
+        mChildren[i] = newTree(mAttributeSpec, mArena);
     }
 }
 void DecisionTree::resetChild(int childCount)
@@ -229,10 +256,10 @@ void DecisionTree::resetChild(int childCount)
     mForks = childCount;
     if (NULL != mChildren)
     {
-        delete[] mChildren;
+        freeArray(mChildren);
         mChildren = NULL;
     }
-    mChildren = new DecisionTreePtr[childCount];
+    mChildren = allocArray<DecisionTreePtr>(childCount);
 }
 void DecisionTree::splitOnContinuousAttribute(int attNum, float threshold)
 {
@@ -240,9 +267,9 @@ void DecisionTree::splitOnContinuousAttribute(int attNum, float threshold)
     mSplitAttribute = attNum;
     mSplitThreshold = threshold;
     resetChild(3);//default,<= , >
-    mChildren[0] = newTree(mAttributeSpec);//default
-    mChildren[1] = newTree(mAttributeSpec);
-    mChildren[2] = newTree(mAttributeSpec);
+    mChildren[0] = newTree(mAttributeSpec, mArena);//default
+    mChildren[1] = newTree(mAttributeSpec, mArena);
+    mChildren[2] = newTree(mAttributeSpec, mArena);
 }
 
 int DecisionTree::getChildCount()
@@ -259,60 +286,62 @@ void  DecisionTree::treeDebug(int att, float threshold, float value)
     Attribute* atr = mAttributeSpec->findAttribute(att);
     cout << atr->getName() << threshold << "\tgiven:" << value << endl;
 }
-DecisionTreePtr DecisionTree::oneStepClassify(IInstance* e)
+int DecisionTree::branch(IInstance* e)
 {
     if(mNodeType == dtnLeaf || mNodeType == dtnGrowing)
     {
-        return this;
+        return -1;
     }
     ValueType value = e->getValue(mSplitAttribute);
 #ifdef TREE_DEBUG
     treeDebug(mSplitAttribute, mSplitThreshold, value); 
 #endif
+    if(AttributeValue::isMissingValue(value))
+    {
+        /* HERE do something smarter */
+        return 0;
+    }
     if(mNodeType == dtnDiscrete)
     {
-        if(AttributeValue::isMissingValue(value))
-        {
-            /* HERE do something smarter */
-            return mChildren[0];
-        }
-        else
-        {
-            int disvalue = int(value) + 1;
-            return mChildren[disvalue];
-        }
+        return int(value) + 1;
     }
     else if(mNodeType == dtnContinuous)
     {
-        if(AttributeValue::isMissingValue(value))
-        {
-            /* HERE do something smarter */
-            return mChildren[0];
-        }
-        else if(value > mSplitThreshold)
-        {
-            return mChildren[2];
-        }
-        else     /* the value is < the threshold */
-        {
-            return mChildren[1];
-        }
+        /* the value is < the threshold goes to 1 */
+        return value > mSplitThreshold ? 2 : 1;
     }
     if(mNodeType == dtnSubset)
     {
-        int target = 0;
         int disvalue = int(value);
         for (int i = 0; i < mForks; ++i)
         {
-            if (testBit(mSubset[i], disvalue))
+            if (inSubset(i, disvalue))
             {
-                target = i;
-                break;
+                return i;
             }
         }
-        return mChildren[disvalue];
+        return 0;
+    }
+    return -1;
+}
+
+DecisionTreePtr DecisionTree::oneStepClassify(IInstance* e)
+{
+    int child = branch(e);
+    return child < 0 ? this : mChildren[child];
+}
+
+void DecisionTree::partition(DataSet* data, const DenseBitset& rows, vector<DenseBitset>& childRows)
+{
+    childRows.assign(mForks, DenseBitset(rows.size()));
+    for (size_t r = rows.findNext(0); r != DenseBitset::npos; r = rows.findNext(r + 1))
+    {
+        int child = branch(data->instanceAt(r));
+        if (child >= 0)
+        {
+            childRows[child].set(r);
+        }
     }
-    return this;
 }
 
 int DecisionTree::classify(IInstance* ins, float**i_confidence)
@@ -328,6 +357,7 @@ int DecisionTree::classify(IInstance* ins, float**i_confidence)
         current = last->oneStepClassify(ins);
         depth++;
     }
+    MLPLUS_PROFILE_COUNT("DecisionTree::classify nodes visited", depth);
     int klass = current->mMyClass;
     for (int i = 0; i <  mAttributeSpec->numTarget(); ++i)
     {
@@ -345,7 +375,7 @@ void DecisionTree::gatherLeaves(list<DecisionTreePtr>& list)
     {
         list.push_back(this);
     }
-    else if(mNodeType == dtnDiscrete || mNodeType == dtnContinuous)
+    else if(mNodeType == dtnDiscrete || mNodeType == dtnContinuous || mNodeType == dtnSubset)
     {
         for(i = 0 ; i < mForks; i++)
         {
@@ -361,7 +391,7 @@ void DecisionTree::gatherGrowingNodes(list<DecisionTreePtr>& list)
     {
         list.push_back(this);
     }
-    else if(mNodeType == dtnDiscrete || mNodeType == dtnContinuous)
+    else if(mNodeType == dtnDiscrete || mNodeType == dtnContinuous || mNodeType == dtnSubset)
     {
         for(i = 0 ; i < mForks; i++)
         {
@@ -378,7 +408,7 @@ int  DecisionTree::countNodes()
     {
         sum = 1;
     }
-    else if(mNodeType == dtnDiscrete || mNodeType == dtnContinuous)
+    else if(mNodeType == dtnDiscrete || mNodeType == dtnContinuous || mNodeType == dtnSubset)
     {
         sum = 1;
         for(i = 0 ; i < mForks ; i++)
@@ -396,6 +426,32 @@ int  DecisionTree::countNodes()
     return sum;
 }
 
+size_t DecisionTree::memoryUsage()
+{
+    if (mArena != NULL)
+    {
+        return 0;
+    }
+    size_t bytes = MemoryPool::allocatedSize(sizeof(*this));
+    if (mClassDist != NULL)
+    {
+        bytes += mAttributeSpec->numTarget() * sizeof(float);
+    }
+    if (mSubset != NULL)
+    {
+        bytes += mForks * mSubsetWords * sizeof(uint64_t);
+    }
+    if (mChildren != NULL)
+    {
+        bytes += mForks * sizeof(DecisionTreePtr);
+        for (int i = 0; i < mForks; ++i)
+        {
+            bytes += mChildren[i] != NULL ? mChildren[i]->memoryUsage() : 0;
+        }
+    }
+    return bytes;
+}
+
 void DecisionTree::getMostCommonClassHelper(DecisionTreePtr dt, long *counts)
 {
     int i;
@@ -565,26 +621,26 @@ void DecisionTree::printStats(ostream& out)
     out << "\n";
 }
 
-DecisionTreePtr DecisionTree::readC5(istream& in, AttributeSpec* spec)
+DecisionTreePtr DecisionTree::readC5(istream& in, AttributeSpec* spec, Arena* arena)
 {
     int tag;
     in.read((char*)&tag, sizeof(int));
     if (memcmp((char *)&tag, "id=", 3) == 0)
     {
         in.seekg (0, ios::beg);
-        return readC5Text(in, spec);
+        return readC5Text(in, spec, arena);
     }
     in.seekg(0, ios::beg);
-    return readC5Bin(in, spec);
+    return readC5Bin(in, spec, arena);
 }
-DecisionTreePtr DecisionTree::readC5Bin(istream& in, AttributeSpec* spec)
+DecisionTreePtr DecisionTree::readC5Bin(istream& in, AttributeSpec* spec, Arena* arena)
 {
     int i;
     DecisionTreePtr dt;
     short type, leaf, tested, forks;
     float items, errors, lower, upper, cut;
 
-    dt = newTree(spec);
+    dt = newTree(spec, arena);
     in.read((char *)(&type), sizeof(short));
     in.read((char *)(&leaf), sizeof(short));
     in.read((char *)(&items), sizeof(float));
@@ -617,9 +673,11 @@ DecisionTreePtr DecisionTree::readC5Bin(istream& in, AttributeSpec* spec)
             dt->mLower = lower;
             break;
         }
+        dt->mForks = forks;
+        dt->mChildren = dt->allocArray<DecisionTreePtr>(forks);
         for(i = 0 ; i < forks ; i++)
         {
-            dt->mChildren[i] = readC5Bin(in, spec);
+            dt->mChildren[i] = readC5Bin(in, spec, arena);
         }
 
     }
@@ -630,28 +688,31 @@ DecisionTreePtr DecisionTree::readC5Bin(istream& in, AttributeSpec* spec)
     return dt;
 }
 
-int DecisionTree::readProp(istream& is, char *delim, char* propName, char* propVal)
+int DecisionTree::readProp(istream& is, char *delim, char* propName, string& propVal)
 {
     int  c;
     char *p;
     bool Quote = false;
+    propVal.clear();
     for(p = propName ; (c = is.get()) != '=' ;)
     {
         if(p - propName >= 19 || c == EOF)
         {
             ERROR("%s", "prop name parse error");
-            propName[0] = propVal[0] = *delim = '\00';
+            propName[0] = *delim = '\00';
             return 0;
         }
         *p++ = c;
     }
     *p = '\00';
-    for(p = propVal ; ((c = is.get()) != ' ' && c != '\n') || Quote;)
+    // the values of a subset of a large nominal attribute have no bound
+    while(((c = is.get()) != ' ' && c != '\n') || Quote)
     {
         if(c == EOF)
         {
             //Error("get prop name error:%s", __FILE__);
-            propName[0] = propVal[0] = '\00';
+            propName[0] = '\00';
+            propVal.clear();
             return 0;
         }
         if(c == '"')
@@ -660,14 +721,13 @@ int DecisionTree::readProp(istream& is, char *delim, char* propName, char* propV
         }
         else if(c == '\\')//for \"
         {
-            *p++ = is.get();
+            propVal += (char)is.get();
         }
         else
         {
-            *p++ = c;
+            propVal += (char)c;
         }
     }
-    *p = '\00';
     *delim = c;
     return which(propName, ::Prop, 1, PROPS);
 }
@@ -678,18 +738,19 @@ int DecisionTree::which(char* val, char** list, int first, int last)
     return (n <= last ? n : first - 1);
 }
 
-DecisionTreePtr DecisionTree::readC5Text(istream& in, AttributeSpec* spec)
+DecisionTreePtr DecisionTree::readC5Text(istream& in, AttributeSpec* spec, Arena* arena)
 {
     int64_t v, subset = 0;
     char    delim, *p;
+    const char* q;
     int  c = 0;
     int     X;
     double  XD;
     int  classCount = spec->numTarget();
-    DecisionTreePtr pTree = newTree(spec);
+    DecisionTreePtr pTree = newTree(spec, arena);
     char propName[128]={0};
-    char propVal[256]={0};
-    string str(propVal);
+    string propVal;
+    string str;
     do
     {
         switch(readProp(in, &delim, propName, propVal))
@@ -698,11 +759,11 @@ DecisionTreePtr DecisionTree::readC5Text(istream& in, AttributeSpec* spec)
             pTree->free();
             return NULL;
         case TYPEP:
-            sscanf(propVal, "%d", &X);
+            sscanf(propVal.c_str(), "%d", &X);
             pTree->mNodeType = (TreeNodeType)X;
             break;
         case CLASSP:
-            pTree->mMyClass = spec->classNo(propVal);
+            pTree->mMyClass = spec->classNo(propVal.c_str());
             break;
         case ATTP:
             str = propVal;
@@ -715,43 +776,49 @@ DecisionTreePtr DecisionTree::readC5Text(istream& in, AttributeSpec* spec)
             }
             break;
         case CUTP:
-            sscanf(propVal, "%lf", &XD);
+            sscanf(propVal.c_str(), "%lf", &XD);
             pTree->mSplitThreshold = XD;
             pTree->mLower = pTree->mMid = pTree->mUpper = XD;
             break;
         case LOWP:
-            sscanf(propVal, "%lf", &XD);
+            sscanf(propVal.c_str(), "%lf", &XD);
             pTree->mLower = XD;
             break;
         case MIDP:
-            sscanf(propVal, "%lf", &XD);
+            sscanf(propVal.c_str(), "%lf", &XD);
             pTree->mMid = XD;
             break;
         case HIGHP:
-            sscanf(propVal, "%lf", &XD);
+            sscanf(propVal.c_str(), "%lf", &XD);
             pTree->mUpper = XD;
             break;
         case FORKSP:
-            sscanf(propVal, "%d", &pTree->mForks);
+            sscanf(propVal.c_str(), "%d", &pTree->mForks);
             break;
         case FREQP:
-            if (pTree->mClassDist) delete [] pTree->mClassDist;
-            pTree->mClassDist = new float[classCount];
-            p = propVal;
+            // newTree sized the distribution for the classes already
+            q = propVal.c_str();
             for(c = 0; c < classCount; ++c)
             {
-                pTree->mClassDist[c] = strtod(p, &p);
+                pTree->mClassDist[c] = strtod(q, &p);
                 pTree->mCases += pTree->mClassDist[c];
-                p++;
+                q = p + 1;
             }
             break;
         case ELTSP:
             if(NULL == pTree->mSubset)
             {
-                pTree->mSubset = new Set64[pTree->mForks];
+                // a word for each 64 values of the attribute
+                int words = bitset::numWords(spec->attributeAt(pTree->mSplitAttribute)->numValues());
+                pTree->mSubsetWords = words > 0 ? words : 1;
+                pTree->mSubset = pTree->allocArray<uint64_t>(pTree->mForks * pTree->mSubsetWords);
+                memset(pTree->mSubset, 0, sizeof(uint64_t) * pTree->mForks * pTree->mSubsetWords);
+            }
+            if(subset < pTree->mForks)
+            {
+                makeSubset(propVal, spec->attributeAt(pTree->mSplitAttribute),
+                           pTree->mSubset + subset++ * pTree->mSubsetWords);
             }
-            ++subset;
-            pTree->mSubset[subset] = makeSubset(propVal, spec->attributeAt(pTree->mSplitAttribute));
             break;
         case IDP:
         case ENTRIESP:
@@ -765,37 +832,39 @@ DecisionTreePtr DecisionTree::readC5Text(istream& in, AttributeSpec* spec)
     }
     else
     {
-        pTree->mClassDist = new float[1];
+        pTree->mClassDist = pTree->allocArray<float>(1);
         pTree->mClassDist[0]  = 1;
     }
     if(pTree->mNodeType != dtnLeaf)
     {
-        pTree->mChildren = new DecisionTreePtr[pTree->mForks];
+        pTree->mChildren = pTree->allocArray<DecisionTreePtr>(pTree->mForks);
         for(v = 0; v < pTree->mForks; ++v)
         {
-            pTree->mChildren[v] = readC5Text(in, spec);
+            pTree->mChildren[v] = readC5Text(in, spec, arena);
         }
     }
     return pTree;
 }
 
-DecisionTree::Set64 DecisionTree::makeSubset(char* propVal, Attribute* attr)
+void DecisionTree::makeSubset(const string& propVal, Attribute* attr, uint64_t* words)
 {
-    Set64    S = 0;
     vector<string> splitVec;
     split(propVal, splitVec, ",");
     for(unsigned int i = 0; i < splitVec.size(); ++i)
     {
         int b = attr->indexOfValue(splitVec[i]);
-        if(b < 0) ERROR("undefine attribute %s value:%s", attr->getName().c_str(), splitVec[i].c_str());
-        S |= (0x01 < b); //s.setbit at b
+        if(b < 0)
+        {
+            ERROR("undefine attribute %s value:%s", attr->getName().c_str(), splitVec[i].c_str());
+            continue;
+        }
+        bitset::set(words, b);
     }
-    return S;
 }
-DecisionTreePtr DecisionTree::read(istream& in,  AttributeSpec* spec)
+DecisionTreePtr DecisionTree::read(istream& in,  AttributeSpec* spec, Arena* arena)
 {
     int i, forks;
-    DecisionTreePtr dt = newTree(spec);
+    DecisionTreePtr dt = newTree(spec, arena);
     in.read((char*)&dt->mNodeType, sizeof(TreeNodeType));
     switch(dt->mNodeType)
     {
@@ -808,9 +877,11 @@ DecisionTreePtr DecisionTree::read(istream& in,  AttributeSpec* spec)
         in.read((char*)&dt->mSplitThreshold, sizeof(float));
         in.read((char*)&dt->mSplitAttribute, sizeof(int));
         in.read((char*)&forks, sizeof(int));
+        dt->mForks = forks;
+        dt->mChildren = dt->allocArray<DecisionTreePtr>(forks);
         for(i = 0 ; i < forks ; i++)
         {
-            dt->mChildren[i] = read(in, spec);
+            dt->mChildren[i] = read(in, spec, arena);
         }
         break;
     case dtnSubset:
@@ -847,6 +918,7 @@ void DecisionTree::write(ostream& out)
 }
 int  BoostDecisionTree::classify(IInstance* e, float**iconfidence)
 {
+    MLPLUS_PROFILE_SCOPE("BoostDecisionTree::classify");
     int best = 0;
     float* confidence = *iconfidence;
     for (int i = 0; i < mNumClasses; ++i)
@@ -855,16 +927,16 @@ int  BoostDecisionTree::classify(IInstance* e, float**iconfidence)
     }
 
     float sum = 0;
+    std::vector<float> tempBuffer(mNumClasses);
+    float *temp = &tempBuffer[0];
     for (int i = 0;i < mTreeCount; ++i)
     {
-        float *temp = new float[mNumClasses];
         mppTrees[i]->classify(e, &temp); 
         for (int j = 0; j < mNumClasses; ++j)
         {
             confidence[j] += temp[j];
             sum +=confidence[j];
         }
-        delete[] temp;
     }
     float largest = 0;
     for (int i = 0; i < mNumClasses; ++i)
@@ -883,11 +955,19 @@ bool BoostDecisionTree::read(std::istream& in, AttributeSpec* spec)
     if (readHead(in) && mTreeCount > 0)
     {
         mNumClasses = spec->numTarget();
-        mppTrees = new DecisionTreePtr[mTreeCount];
-        memset(mppTrees, 0, mTreeCount * sizeof(DecisionTreePtr));
+        mArena->reset();
+        mppTrees = mArena->allocArray<DecisionTreePtr>(mTreeCount);
         for (int i = 0; i < mTreeCount; ++i)
         {
-            mppTrees[i] = DecisionTree::readC5Text(in, spec);
+            mppTrees[i] = DecisionTree::readC5Text(in, spec, mArena);
+            if (mppTrees[i] == NULL)
+            {
+                ERROR("read tree %d of %d error", i, mTreeCount);
+                mppTrees = NULL;
+                mTreeCount = 0;
+                mArena->reset();
+                return false;
+            }
         }
         return true;
     }
@@ -897,24 +977,22 @@ bool BoostDecisionTree::read(std::istream& in, AttributeSpec* spec)
     }
     return false;
 }
-BoostDecisionTree::BoostDecisionTree():mTreeCount(0),mNumClasses(0),mppTrees(0)
+BoostDecisionTree::BoostDecisionTree():mTreeCount(0),mNumClasses(0),mppTrees(0),mArena(new Arena(256 * 1024, memory::TREE_NODES))
 {
 }
 BoostDecisionTree::~BoostDecisionTree()
 {
-    if (mppTrees != NULL)
-    {
-        for (int i = 0; i < mTreeCount; ++i)
-        {
-            mppTrees[i]->free();
-        }
-        delete []mppTrees;
-    }
+    // the trees and their arrays all live in the arena
+    delete mArena;
+}
+size_t BoostDecisionTree::memoryUsage() const
+{
+    return sizeof(*this) + sizeof(Arena) + mArena->bytesReserved();
 }
 bool BoostDecisionTree::readHead(std::istream& in)
 {
     char propName[128]={0};
-    char propVal[256]={0};
+    string propVal;
     char delim;
     while(true)
     {
@@ -933,7 +1011,7 @@ bool BoostDecisionTree::readHead(std::istream& in)
         case ELTSP:
             break;
         case ENTRIESP:
-            sscanf(propVal, "%d", &mTreeCount);
+            sscanf(propVal.c_str(), "%d", &mTreeCount);
             return true;
         default:
             break;
@@ -14,7 +14,7 @@ DiscreteEstimator::DiscreteEstimator(const DiscreteEstimator& other):
     IdentifiableEstimator<DiscreteEstimator>(other), mCounts(NULL),
     mSumOfCounts(other.mSumOfCounts), mNumOfClass(other.mNumOfClass)
 {
-    mCounts = new double[other.mNumOfClass];
+    mCounts = newCounts(other.mNumOfClass);
 }
 void DiscreteEstimator::addValue(double val, double weight)
 {
@@ -28,7 +28,7 @@ void DiscreteEstimator::addValue(double val, double weight)
 DiscreteEstimator::DiscreteEstimator(int nSymbols, bool laplace)
 {
     mNumOfClass = nSymbols;
-    mCounts = new double[nSymbols];
+    mCounts = newCounts(nSymbols);
     mSumOfCounts = 0;
     if(laplace)
     {
@@ -37,6 +37,15 @@ DiscreteEstimator::DiscreteEstimator(int nSymbols, bool laplace)
         mSumOfCounts = (double) nSymbols;
     }
 }
+void DiscreteEstimator::setCounts(const double* counts)
+{
+    mSumOfCounts = 0;
+    for (int i = 0; i < mNumOfClass; ++i)
+    {
+        mCounts[i] = counts[i];
+        mSumOfCounts += counts[i];
+    }
+}
 void DiscreteEstimator::smoothing(Estimator* prior, double strenth)
 {
     for (int i = 0; prior && i < mNumOfClass; ++i)
@@ -60,7 +69,7 @@ double DiscreteEstimator::getProbability(double data)
 DiscreteEstimator::DiscreteEstimator(int nSymbols, double fPrior)
 {
     mNumOfClass = nSymbols;
-    mCounts = new double[nSymbols];
+    mCounts = newCounts(nSymbols);
     for(int i = 0; i < nSymbols; ++i)
         mCounts[i] = fPrior;
     mSumOfCounts = fPrior * (double) nSymbols;
@@ -68,11 +77,28 @@ DiscreteEstimator::DiscreteEstimator(int nSymbols, double fPrior)
 
 DiscreteEstimator::~DiscreteEstimator()
 {
-    if(mCounts != NULL)
+    deleteCounts(mCounts, mNumOfClass);
+    mCounts = NULL;
+}
+
+double* DiscreteEstimator::newCounts(int n)
+{
+    memory::charge(memory::ESTIMATORS, n * sizeof(double));
+    return new double[n]();
+}
+
+void DiscreteEstimator::deleteCounts(double* counts, int n)
+{
+    if (counts != NULL)
     {
-        delete [] mCounts;
+        memory::release(memory::ESTIMATORS, n * sizeof(double));
+        delete[] counts;
     }
-    mCounts = NULL;
+}
+
+size_t DiscreteEstimator::memoryUsage() const
+{
+    return MemoryPool::allocatedSize(sizeof(*this)) + mNumOfClass * sizeof(double);
 }
 
 std::string DiscreteEstimator::toString()
@@ -88,12 +114,11 @@ std::string DiscreteEstimator::toString()
 void DiscreteEstimator::fromString(const std::string& str)
 {
     istringstream iss(str);
-    iss >> mSumOfCounts >> mNumOfClass;
-    if (NULL != mCounts)
-    {
-        delete mCounts;
-    }
-    mCounts = new double[mNumOfClass];
+    int numOfClass = 0;
+    iss >> mSumOfCounts >> numOfClass;
+    deleteCounts(mCounts, mNumOfClass);
+    mNumOfClass = numOfClass;
+    mCounts = newCounts(mNumOfClass);
     for (int i = 0; i < mNumOfClass; ++i)
     {
         iss >> mCounts[i];
@@ -0,0 +1,203 @@
+#include <cmath>
+#include <vector>
+#include "memory_accounting.h"
+#include "estimators/estimator_block.h"
+namespace mlplus
+{
+namespace estimators
+{
+
+using namespace std;
+
+EstimatorBlock<NormalEstimator>::EstimatorBlock(int numClasses):
+    mNumClasses(numClasses), mSize(0)
+{
+}
+void EstimatorBlock<NormalEstimator>::clear(int numClasses)
+{
+    mNumClasses = numClasses;
+    mSize = 0;
+    mPrecision.clear();
+    mSumOfWeights.clear();
+    mSumOfValues.clear();
+    mSumOfValuesSq.clear();
+    mMean.clear();
+    mStdDev.clear();
+}
+int EstimatorBlock<NormalEstimator>::add(Estimator** perClass)
+{
+    for (int c = 0; c < mNumClasses; ++c)
+    {
+        NormalEstimator* est = static_cast<NormalEstimator*>(perClass[c]);
+        mPrecision.push_back(est->mPrecision);
+        mSumOfWeights.push_back(est->mSumOfWeights);
+        mSumOfValues.push_back(est->mSumOfValues);
+        mSumOfValuesSq.push_back(est->mSumOfValuesSq);
+        mMean.push_back(est->mMean);
+        mStdDev.push_back(est->mStardardDev);
+    }
+    return mSize++;
+}
+void EstimatorBlock<NormalEstimator>::exportTo(int slot, Estimator** perClass) const
+{
+    for (int c = 0; c < mNumClasses; ++c)
+    {
+        int cell = slot * mNumClasses + c;
+        static_cast<NormalEstimator*>(perClass[c])->setSums(mSumOfWeights[cell],
+                mSumOfValues[cell], mSumOfValuesSq[cell]);
+    }
+}
+void EstimatorBlock<NormalEstimator>::compile()
+{
+    //mean and standard deviation follow the sums only when they were updated
+    for (size_t i = 0; i < mMean.size(); ++i)
+    {
+        if(mSumOfWeights[i] > 0)
+        {
+            double mean = mSumOfValues[i] / mSumOfWeights[i];
+            double stdDev = sqrt(fabs(mSumOfValuesSq[i] / mSumOfWeights[i] - mean * mean));
+            mMean[i] = mean;
+            if(stdDev > 1e-10)
+            {
+                mStdDev[i] = max(mPrecision[i] / (2.0 * 3.0), stdDev);
+            }
+        }
+    }
+    vector<double>().swap(mSumOfWeights);
+    vector<double>().swap(mSumOfValues);
+    vector<double>().swap(mSumOfValuesSq);
+}
+size_t EstimatorBlock<NormalEstimator>::memoryUsage() const
+{
+    return sizeof(*this) + memory::vectorBytes(mPrecision) + memory::vectorBytes(mSumOfWeights) +
+           memory::vectorBytes(mSumOfValues) + memory::vectorBytes(mSumOfValuesSq) +
+           memory::vectorBytes(mMean) + memory::vectorBytes(mStdDev);
+}
+/*----------------------------------------------------------------------------*/
+EstimatorBlock<DiscreteEstimator>::EstimatorBlock(int numClasses):
+    mNumClasses(numClasses)
+{
+}
+void EstimatorBlock<DiscreteEstimator>::clear(int numClasses)
+{
+    mNumClasses = numClasses;
+    mSymbols.clear();
+    mOffset.clear();
+    mCounts.clear();
+    mSums.clear();
+    mLogProb.clear();
+}
+int EstimatorBlock<DiscreteEstimator>::add(Estimator** perClass)
+{
+    //classes may disagree on the number of symbols after load(), the
+    //missing cells are zero counts exactly like getProbability() treats them
+    int symbols = 0;
+    for (int c = 0; c < mNumClasses; ++c)
+    {
+        symbols = max(symbols, static_cast<DiscreteEstimator*>(perClass[c])->getNumOfClass());
+    }
+    size_t offset = mCounts.size();
+    mSymbols.push_back(symbols);
+    mOffset.push_back(offset);
+    mCounts.resize(offset + (size_t)symbols * mNumClasses, 0);
+    for (int c = 0; c < mNumClasses; ++c)
+    {
+        DiscreteEstimator* est = static_cast<DiscreteEstimator*>(perClass[c]);
+        const double* counts = est->getCounts();
+        for (int v = 0; v < est->getNumOfClass(); ++v)
+        {
+            mCounts[offset + v * mNumClasses + c] = counts[v];
+        }
+        mSums.push_back(est->getSumOfCounts());
+    }
+    return mSymbols.size() - 1;
+}
+void EstimatorBlock<DiscreteEstimator>::exportTo(int slot, Estimator** perClass) const
+{
+    vector<double> counts;
+    for (int c = 0; c < mNumClasses; ++c)
+    {
+        DiscreteEstimator* est = static_cast<DiscreteEstimator*>(perClass[c]);
+        counts.resize(est->getNumOfClass());
+        for (int v = 0; v < est->getNumOfClass(); ++v)
+        {
+            counts[v] = mCounts[mOffset[slot] + v * mNumClasses + c];
+        }
+        est->setCounts(counts.empty() ? NULL : &counts[0]);
+    }
+}
+void EstimatorBlock<DiscreteEstimator>::compile()
+{
+    mLogProb.resize(mCounts.size());
+    for (size_t slot = 0; slot < mSymbols.size(); ++slot)
+    {
+        const double* sums = &mSums[slot * mNumClasses];
+        for (int v = 0; v < mSymbols[slot]; ++v)
+        {
+            size_t row = mOffset[slot] + v * mNumClasses;
+            for (int c = 0; c < mNumClasses; ++c)
+            {
+                mLogProb[row + c] = sums[c] == 0 ? log(0.0) : log(mCounts[row + c] / sums[c]);
+            }
+        }
+    }
+    vector<double>().swap(mCounts);
+    vector<double>().swap(mSums);
+}
+size_t EstimatorBlock<DiscreteEstimator>::memoryUsage() const
+{
+    return sizeof(*this) + memory::vectorBytes(mSymbols) + memory::vectorBytes(mOffset) +
+           memory::vectorBytes(mCounts) + memory::vectorBytes(mSums) + memory::vectorBytes(mLogProb);
+}
+/*----------------------------------------------------------------------------*/
+EstimatorBlock<BinaryEstimator>::EstimatorBlock(int numClasses):
+    mNumClasses(numClasses), mSize(0)
+{
+}
+void EstimatorBlock<BinaryEstimator>::clear(int numClasses)
+{
+    mNumClasses = numClasses;
+    mSize = 0;
+    mPositive.clear();
+    mNegative.clear();
+    mLogPositive.clear();
+    mLogNegative.clear();
+}
+int EstimatorBlock<BinaryEstimator>::add(Estimator** perClass)
+{
+    for (int c = 0; c < mNumClasses; ++c)
+    {
+        BinaryEstimator* est = static_cast<BinaryEstimator*>(perClass[c]);
+        mPositive.push_back(est->getPostiveCount());
+        mNegative.push_back(est->getNegativeCount());
+    }
+    return mSize++;
+}
+void EstimatorBlock<BinaryEstimator>::exportTo(int slot, Estimator** perClass) const
+{
+    for (int c = 0; c < mNumClasses; ++c)
+    {
+        int cell = slot * mNumClasses + c;
+        static_cast<BinaryEstimator*>(perClass[c])->setCounts(mPositive[cell], mNegative[cell]);
+    }
+}
+void EstimatorBlock<BinaryEstimator>::compile()
+{
+    mLogPositive.resize(mPositive.size());
+    mLogNegative.resize(mNegative.size());
+    for (size_t i = 0; i < mPositive.size(); ++i)
+    {
+        double total = mPositive[i] + mNegative[i];
+        mLogPositive[i] = log(mPositive[i] / total);
+        mLogNegative[i] = log(mNegative[i] / total);
+    }
+    vector<double>().swap(mPositive);
+    vector<double>().swap(mNegative);
+}
+size_t EstimatorBlock<BinaryEstimator>::memoryUsage() const
+{
+    return sizeof(*this) + memory::vectorBytes(mPositive) + memory::vectorBytes(mNegative) +
+           memory::vectorBytes(mLogPositive) + memory::vectorBytes(mLogNegative);
+}
+} // namespace estimators
+} // namespace mlplus
@@ -0,0 +1,332 @@
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <iomanip>
+#include "instance.h"
+#include "dataset.h"
+#include "classifier.h"
+#include "thread_pool.h"
+#include "evaluation.h"
+using namespace std;
+namespace mlplus
+{
+ClassificationMetrics::ClassificationMetrics(int numClasses, int aucBins):
+    mNumClasses(numClasses > 0 ? numClasses : 1),
+    mConfusion(mNumClasses * mNumClasses, 0),
+    mSkipped(0),
+    mLogLoss(0),
+    mLogLossWeight(0),
+    mRoc(mNumClasses, ScoreHistogram(aucBins))
+{
+}
+
+void ClassificationMetrics::add(int actual, const vector<double>& distribution, double weight)
+{
+    int size = min((int)distribution.size(), mNumClasses);
+    int predicted = 0;
+    for (int i = 1; i < size; ++i)
+    {
+        if (distribution[i] > distribution[predicted])
+        {
+            predicted = i;
+        }
+    }
+    add(actual, predicted, distribution, weight);
+}
+
+void ClassificationMetrics::add(int actual, int predicted, const vector<double>& distribution, double weight)
+{
+    if (actual < 0 || actual >= mNumClasses || predicted < 0 || predicted >= mNumClasses)
+    {
+        mSkipped += weight;
+        return;
+    }
+    int size = min((int)distribution.size(), mNumClasses);
+    double sum = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        sum += distribution[i];
+    }
+    mConfusion[actual * mNumClasses + predicted] += weight;
+    if (!(sum > 0))
+    {
+        return;
+    }
+    double p = actual < size ? distribution[actual] / sum : 0;
+    mLogLoss -= weight * log(p < 1e-15 ? 1e-15 : p);
+    mLogLossWeight += weight;
+    for (int i = 0; i < mNumClasses; ++i)
+    {
+        double score = i < size ? distribution[i] / sum : 0;
+        mRoc[i].add(score, i == actual ? weight : 0, i == actual ? 0 : weight);
+    }
+}
+
+void ClassificationMetrics::add(int actual, int predicted, double weight)
+{
+    if (actual < 0 || actual >= mNumClasses || predicted < 0 || predicted >= mNumClasses)
+    {
+        mSkipped += weight;
+        return;
+    }
+    mConfusion[actual * mNumClasses + predicted] += weight;
+}
+
+void ClassificationMetrics::merge(const ClassificationMetrics& other)
+{
+    assert(mNumClasses == other.mNumClasses);
+    for (size_t i = 0; i < mConfusion.size(); ++i)
+    {
+        mConfusion[i] += other.mConfusion[i];
+    }
+    mSkipped += other.mSkipped;
+    mLogLoss += other.mLogLoss;
+    mLogLossWeight += other.mLogLossWeight;
+    for (int i = 0; i < mNumClasses; ++i)
+    {
+        mRoc[i].merge(other.mRoc[i]);
+    }
+}
+
+double ClassificationMetrics::weight() const
+{
+    double sum = 0;
+    for (size_t i = 0; i < mConfusion.size(); ++i)
+    {
+        sum += mConfusion[i];
+    }
+    return sum;
+}
+
+double ClassificationMetrics::classWeight(int klass) const
+{
+    double sum = 0;
+    for (int i = 0; i < mNumClasses; ++i)
+    {
+        sum += confusion(klass, i);
+    }
+    return sum;
+}
+
+double ClassificationMetrics::predictedWeight(int klass) const
+{
+    double sum = 0;
+    for (int i = 0; i < mNumClasses; ++i)
+    {
+        sum += confusion(i, klass);
+    }
+    return sum;
+}
+
+double ClassificationMetrics::accuracy() const
+{
+    double correct = 0;
+    for (int i = 0; i < mNumClasses; ++i)
+    {
+        correct += confusion(i, i);
+    }
+    double total = weight();
+    return total > 0 ? correct / total : 0;
+}
+
+double ClassificationMetrics::precision(int klass) const
+{
+    double predicted = predictedWeight(klass);
+    return predicted > 0 ? confusion(klass, klass) / predicted : 0;
+}
+
+double ClassificationMetrics::recall(int klass) const
+{
+    double actual = classWeight(klass);
+    return actual > 0 ? confusion(klass, klass) / actual : 0;
+}
+
+double ClassificationMetrics::f1(int klass) const
+{
+    double p = precision(klass);
+    double r = recall(klass);
+    return p + r > 0 ? 2 * p * r / (p + r) : 0;
+}
+
+double ClassificationMetrics::macroF1() const
+{
+    double sum = 0;
+    for (int i = 0; i < mNumClasses; ++i)
+    {
+        sum += f1(i);
+    }
+    return sum / mNumClasses;
+}
+
+double ClassificationMetrics::logLoss() const
+{
+    return mLogLossWeight > 0 ? mLogLoss / mLogLossWeight : 0;
+}
+
+double ClassificationMetrics::auc(int klass) const
+{
+    return mRoc[klass].curve().auc;
+}
+
+double ClassificationMetrics::aucError(int klass) const
+{
+    return mRoc[klass].curve().aucError;
+}
+
+double ClassificationMetrics::weightedAuc() const
+{
+    double sum = 0;
+    double total = 0;
+    for (int i = 0; i < mNumClasses; ++i)
+    {
+        CurveMetrics curve = mRoc[i].curve();
+        double w = classWeight(i);
+        // a class never seen or always seen has no ROC area
+        if (w > 0 && w < weight())
+        {
+            sum += w * curve.auc;
+            total += w;
+        }
+    }
+    return total > 0 ? sum / total : 0.5;
+}
+
+void ClassificationMetrics::print(ostream& out, const vector<string>& classNames) const
+{
+    ios::fmtflags flags = out.flags();
+    streamsize precision = out.precision();
+    out << fixed << setprecision(5);
+    out << "instances: " << weight() << "\n";
+    if (mSkipped > 0)
+    {
+        out << "skipped: " << mSkipped << "\n";
+    }
+    out << "accuracy: " << accuracy() << "\n";
+    out << "macro F1: " << macroF1() << "\n";
+    //predictions added as labels only give no log loss or AUC
+    bool scored = mLogLossWeight > 0;
+    if (scored)
+    {
+        out << "log loss: " << logLoss() << "\n";
+        out << "weighted AUC: " << weightedAuc() << "\n";
+    }
+    out << "class\tprecision\trecall\tF1" << (scored ? "\tAUC" : "") << "\n";
+    for (int i = 0; i < mNumClasses; ++i)
+    {
+        if (i < (int)classNames.size())
+        {
+            out << classNames[i];
+        }
+        else
+        {
+            out << i;
+        }
+        out << "\t" << this->precision(i) << "\t" << recall(i) << "\t" << f1(i);
+        if (scored)
+        {
+            out << "\t" << auc(i);
+        }
+        out << "\n";
+    }
+    out << setprecision(0) << "confusion (actual x predicted):\n";
+    for (int i = 0; i < mNumClasses; ++i)
+    {
+        for (int j = 0; j < mNumClasses; ++j)
+        {
+            out << (j > 0 ? "\t" : "") << confusion(i, j);
+        }
+        out << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+namespace
+{
+/**
+ * predicts the chunks worker, worker + workers, ... of the evaluated list into
+ * its own accumulator, so the result does not depend on the thread timing
+ */
+class EvaluateWorker : public Runnable
+{
+public:
+    EvaluateWorker(Classifier& classifier, DataSet& data, const vector<int>* indices, int count,
+                   int chunkSize, int worker, int workers, int numClasses):
+        mClassifier(classifier), mData(data), mIndices(indices), mCount(count), mChunkSize(chunkSize),
+        mWorker(worker), mWorkers(workers), mMetrics(numClasses)
+    {
+    }
+    /*override*/ void run()
+    {
+        for (int begin = mWorker * mChunkSize; begin < mCount; begin += mWorkers * mChunkSize)
+        {
+            int end = min(mCount, begin + mChunkSize);
+            for (int i = begin; i < end; ++i)
+            {
+                IInstance* instance = mData.instanceAt(mIndices ? (*mIndices)[i] : i);
+                mMetrics.add((int)instance->targetValue(), mClassifier.targetDistribution(instance),
+                             instance->getWeight());
+            }
+        }
+    }
+    const ClassificationMetrics& metrics() const {return mMetrics;}
+private:
+    Classifier& mClassifier;
+    DataSet& mData;
+    const vector<int>* mIndices;
+    int mCount;
+    int mChunkSize;
+    int mWorker;
+    int mWorkers;
+    ClassificationMetrics mMetrics;
+};
+
+ClassificationMetrics evaluateRange(Classifier& classifier, DataSet& data, const vector<int>* indices,
+                                    int count, int numClasses, int threads, int chunkSize)
+{
+    chunkSize = chunkSize > 0 ? chunkSize : 1;
+    int chunks = (count + chunkSize - 1) / chunkSize;
+    int workers = min(threads > 0 ? threads : ThreadPool::hardwareThreads(), max(chunks, 1));
+    vector<EvaluateWorker*> tasks;
+    for (int i = 0; i < workers; ++i)
+    {
+        tasks.push_back(new EvaluateWorker(classifier, data, indices, count, chunkSize, i, workers, numClasses));
+    }
+    ClassificationMetrics metrics(numClasses);
+    try
+    {
+        ThreadPool pool(workers);
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            pool.submit(tasks[i]);
+        }
+        pool.wait();
+    }
+    catch (...)
+    {
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            delete tasks[i];
+        }
+        throw;
+    }
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        metrics.merge(tasks[i]->metrics());
+        delete tasks[i];
+    }
+    return metrics;
+}
+} // namespace
+
+ClassificationMetrics evaluate(Classifier& classifier, DataSet& data, int numClasses, int threads, int chunkSize)
+{
+    return evaluateRange(classifier, data, NULL, data.numInstances(), numClasses, threads, chunkSize);
+}
+
+ClassificationMetrics evaluate(Classifier& classifier, DataSet& data, const vector<int>& indices,
+                               int numClasses, int threads, int chunkSize)
+{
+    return evaluateRange(classifier, data, &indices, indices.size(), numClasses, threads, chunkSize);
+}
+} // namespace mlplus
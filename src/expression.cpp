@@ -1,6 +1,7 @@
 #include "expression.h"
 #include "variant.h"
 #include "scope.h"
+#include "profile.h"
 #include <stack>
 #include <map>
 #include <cmath>
@@ -198,6 +199,7 @@ bool Expression::isLogicExpression() const
 }
 double Expression::evaluate(std::vector<Token*>& postStack, const Scope& scope)
 {
+    MLPLUS_PROFILE_SCOPE("Expression::evaluate");
     std::vector<Token*>::const_iterator rb = postStack.begin();
     int var = 0;
     stack<Variant> variables; 
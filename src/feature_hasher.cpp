@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "feature_hasher.h"
+namespace mlplus
+{
+using namespace std;
+
+const int FeatureHasher::MAX_BITS;
+
+FeatureHasher::FeatureHasher(int bits, int numHashes, bool signedHash):
+    mBits(bits), mMask(0), mNumHashes(numHashes), mSigned(signedHash)
+{
+    if (bits < 1 || bits > MAX_BITS)
+    {
+        throw invalid_argument("feature hash bits out of range [1, 30]");
+    }
+    if (numHashes < 1)
+    {
+        throw invalid_argument("feature hasher needs at least one hash");
+    }
+    mMask = (1u << bits) - 1;
+}
+
+static inline uint32_t rotl32(uint32_t x, int r)
+{
+    return (x << r) | (x >> (32 - r));
+}
+
+uint32_t FeatureHasher::murmur3(const void* key, size_t len, uint32_t seed)
+{
+    const uint8_t* data = static_cast<const uint8_t*>(key);
+    const size_t nblocks = len / 4;
+    const uint32_t c1 = 0xcc9e2d51;
+    const uint32_t c2 = 0x1b873593;
+    uint32_t h = seed;
+    for (size_t i = 0; i < nblocks; ++i)
+    {
+        const uint8_t* b = data + i * 4;
+        uint32_t k = b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+        k *= c1;
+        k = rotl32(k, 15);
+        k *= c2;
+        h ^= k;
+        h = rotl32(h, 13);
+        h = h * 5 + 0xe6546b64;
+    }
+    const uint8_t* tail = data + nblocks * 4;
+    uint32_t k = 0;
+    switch (len & 3)
+    {
+    case 3:
+        k ^= tail[2] << 16;
+        //fall through
+    case 2:
+        k ^= tail[1] << 8;
+        //fall through
+    case 1:
+        k ^= tail[0];
+        k *= c1;
+        k = rotl32(k, 15);
+        k *= c2;
+        h ^= k;
+    }
+    h ^= (uint32_t)len;
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+void FeatureHasher::add(const char* key, size_t len, ValueType value, vector<HashedFeature>& out) const
+{
+    for (int i = 0; i < mNumHashes; ++i)
+    {
+        uint32_t h = murmur3(key, len, i);
+        //the top bit is independent of the bucket bits for bits <= 30
+        ValueType v = mSigned && (h >> 31) ? -value : value;
+        out.push_back(HashedFeature(h & mMask, v));
+    }
+}
+
+void FeatureHasher::add(int id, ValueType value, vector<HashedFeature>& out) const
+{
+    uint32_t u = (uint32_t)id;
+    char bytes[4] = {(char)(u & 0xFF), (char)((u >> 8) & 0xFF), (char)((u >> 16) & 0xFF), (char)(u >> 24)};
+    add(bytes, 4, value, out);
+}
+
+static bool byBucket(const FeatureHasher::HashedFeature& l, const FeatureHasher::HashedFeature& r)
+{
+    return l.first < r.first;
+}
+
+void FeatureHasher::finish(vector<HashedFeature>& features, vector<int>& indices,
+        vector<ValueType>& values, int offset)
+{
+    sort(features.begin(), features.end(), byBucket);
+    size_t i = 0;
+    while (i < features.size())
+    {
+        int bucket = features[i].first;
+        ValueType sum = 0;
+        for (; i < features.size() && features[i].first == bucket; ++i)
+        {
+            sum += features[i].second;
+        }
+        if (sum != 0)
+        {
+            indices.push_back(bucket + offset);
+            values.push_back(sum);
+        }
+    }
+}
+} // namespace mlplus
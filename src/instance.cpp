@@ -21,6 +21,10 @@ bool DenseInstance::isSparse()
 {
     return false;
 }
+size_t DenseInstance::memoryUsage() const
+{
+    return MemoryPool::allocatedSize(sizeof(*this)) + memory::vectorBytes(mAttrValues);
+}
 int DenseInstance::attributeIndex(int localIdx)
 {
     return localIdx;
@@ -55,13 +59,14 @@ SparseInstance::SparseInstance(const SparseInstance& instance):
     initGlobal2LocalMap();
 }
 SparseInstance::SparseInstance(const vector<ValueType>& values, const vector<int>& indices, ValueType weight):
-    AbstractInstance(values, weight), mIndices(indices)
+    AbstractInstance(values, weight), mIndices(indices.begin(), indices.end())
 {
     initGlobal2LocalMap();
 }
 void SparseInstance::initGlobal2LocalMap()
 {
     mGlobal2Local.clear();
+    mGlobal2Local.reserve(mIndices.size());
     for (int i = 0; i < (int)mIndices.size(); ++i)
     {
         mGlobal2Local[mIndices[i]] = i;
@@ -75,6 +80,11 @@ bool SparseInstance::isSparse()
 {
     return true;
 }
+size_t SparseInstance::memoryUsage() const
+{
+    return MemoryPool::allocatedSize(sizeof(*this)) + memory::vectorBytes(mAttrValues) +
+           memory::vectorBytes(mIndices) + mGlobal2Local.memoryUsage() - sizeof(mGlobal2Local);
+}
 
 int  SparseInstance::attributeIndex(int localIdx)
 {
@@ -82,7 +92,7 @@ int  SparseInstance::attributeIndex(int localIdx)
 }
 int  SparseInstance::findPosition(int globalIndex) const
 {
-     map<int,int>::const_iterator it = mGlobal2Local.find(globalIndex);
+     FlatHashMap<int, int>::const_iterator it = mGlobal2Local.find(globalIndex);
      if (it == mGlobal2Local.end())
      {
          return -1;
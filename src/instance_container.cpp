@@ -52,6 +52,18 @@ unsigned  DenseInstanceContainer::size() const
 {
     return mInnerContainer.size();
 }
+size_t DenseInstanceContainer::memoryUsage() const
+{
+    size_t bytes = sizeof(*this) + memory::vectorBytes(mInnerContainer);
+    for (size_t i = 0; i < mInnerContainer.size(); ++i)
+    {
+        if (mInnerContainer[i].get() != NULL)
+        {
+            bytes += memory::SHARED_COUNT_BYTES + mInnerContainer[i]->memoryUsage();
+        }
+    }
+    return bytes;
+}
 void DenseInstanceContainer::add(IInstance* pInstance)
 {
     mInnerContainer.push_back(SharedInstancePtr(pInstance));
@@ -134,6 +146,19 @@ unsigned  SparseInstanceContainer::size() const
 {
     return mInnerContainer.size();
 }
+size_t SparseInstanceContainer::memoryUsage() const
+{
+    size_t bytes = sizeof(*this);
+    for (InnerType::const_iterator it = mInnerContainer.begin(); it != mInnerContainer.end(); ++it)
+    {
+        bytes += memory::treeNodeBytes(sizeof(*it));
+        if (it->second.get() != NULL)
+        {
+            bytes += memory::SHARED_COUNT_BYTES + it->second->memoryUsage();
+        }
+    }
+    return bytes;
+}
 void  SparseInstanceContainer::add(IInstance* pInstance)
 {
     int sz = size();
@@ -164,3 +189,92 @@ IInstanceIterator*  SparseInstanceContainer::newIterator()
 {
     return new SparseInstanceIterator(*this);
 }
+/*----------------------------------------------------------------------------*/
+
+InstanceViewIterator::InstanceViewIterator(InstanceViewContainer& dit):
+    mContainer(dit), mCurrent(0)
+{
+}
+/*override*/bool InstanceViewIterator::hasMore() const
+{
+    return mCurrent < mContainer.mInnerContainer.size();
+}
+/*override*/void  InstanceViewIterator::reset()
+{
+    mCurrent = 0;
+}
+/*override*/IInstance* InstanceViewIterator::next()
+{
+    return mContainer.mInnerContainer[mCurrent++];
+}
+/*----------------------------------------------------------------------------*/
+InstanceViewContainer::InstanceViewContainer()
+{
+}
+InstanceViewContainer::~InstanceViewContainer()
+{
+}
+void InstanceViewContainer::clear()
+{
+    mInnerContainer.clear();
+    mRefs.clear();
+}
+DenseInstanceContainer* InstanceViewContainer::deepCopy()
+{
+    DenseInstanceContainer* p = new DenseInstanceContainer();
+    for (unsigned i = 0; i < mInnerContainer.size(); ++i)
+    {
+        p->add(mInnerContainer[i] ? mInnerContainer[i]->clone() : NULL);
+    }
+    return p;
+}
+unsigned  InstanceViewContainer::size() const
+{
+    return mInnerContainer.size();
+}
+size_t InstanceViewContainer::memoryUsage() const
+{
+    return sizeof(*this) + memory::vectorBytes(mInnerContainer) + mRefs.size() * sizeof(InstanceRef);
+}
+void  InstanceViewContainer::add(IInstance* pInstance)
+{
+    mInnerContainer.push_back(pInstance);
+}
+void  InstanceViewContainer::add(IInstance* pInstance, double weight)
+{
+    mRefs.push_back(InstanceRef(pInstance, weight));
+    mInnerContainer.push_back(&mRefs.back());
+}
+bool  InstanceViewContainer::set(int index, IInstance* pIns)
+{
+    if ((unsigned)index >= mInnerContainer.size())
+    {
+        return false;
+    }
+    mInnerContainer[index] = pIns;
+    return true;
+}
+IInstance*  InstanceViewContainer::at(int index)
+{
+    if ((unsigned)index >= mInnerContainer.size())
+    {
+        return NULL;
+    }
+    return mInnerContainer[index];
+}
+IInstance*  InstanceViewContainer::first()
+{
+    return at(0);
+}
+IInstance*  InstanceViewContainer::next(int index)
+{
+    return at(index + 1);
+}
+IInstanceIterator*  InstanceViewContainer::newIterator()
+{
+    return new InstanceViewIterator(*this);
+}
+void InstanceViewContainer::reserve(unsigned size)
+{
+    mInnerContainer.reserve(size);
+}
@@ -11,6 +11,8 @@
 #include "attribute_spec.h"
 #include "expression.h"
 #include "string_utility.h"
+#include "profile.h"
+#include "memory_accounting.h"
 using namespace std;
 namespace mlplus
 {
@@ -25,6 +27,7 @@ TextParser::~TextParser()
 }
 DataSet* TextParser::readData(const std::string& filename)
 {
+    MLPLUS_PROFILE_SCOPE("TextParser::readData");
     ifstream inFile(filename.c_str());
     if(!inFile.is_open())
     {
@@ -53,11 +56,15 @@ DataSet* TextParser::readData(const std::string& filename)
     decodeValue.reserve(512);
     Scope scope;
     string line;
+    memory::ScopedCharge buffers(memory::PARSER_BUFFERS);
 
     while(getline(inFile, line))
     {
         ++lineCount;
+        MLPLUS_PROFILE_COUNT("TextParser::readData rows", 1);
+        MLPLUS_PROFILE_COUNT("TextParser::readData bytes", line.size() + 1);
         mlplus::split(line, valuelist, mDelim);
+        buffers.set(line.capacity() + memory::vectorBytes(valuelist) + memory::vectorBytes(decodeValue));
         if(valuelist.size() != mpSpec->explictAttributeCount())
         {
             cerr << "\nERROR at line " << lineCount << " filename " << endl;
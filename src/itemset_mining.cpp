@@ -0,0 +1,439 @@
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include "itemset_mining.h"
+#include "dataset.h"
+#include "attribute_value.h"
+#include "thread_pool.h"
+namespace mlplus
+{
+const size_t ItemsetMiner::TIDSET_DENSE;
+const size_t ItemsetMiner::PAIR_TABLE_ITEMS;
+
+namespace
+{
+typedef ItemsetMiner::Tidset Tidset;
+
+size_t andCount(const Tidset& a, const Tidset& b)
+{
+    if (a.dense && b.dense)
+    {
+        return DenseBitset::andCount(a.bits, b.bits);
+    }
+    if (a.dense || b.dense)
+    {
+        return a.dense ? RoaringBitset::andCount(b.ids, a.bits) : RoaringBitset::andCount(a.ids, b.bits);
+    }
+    return RoaringBitset::andCount(a.ids, b.ids);
+}
+
+void intersect(const Tidset& a, const Tidset& b, size_t support, size_t numTransactions, Tidset& out)
+{
+    out.support = support;
+    out.dense = false;
+    if (a.dense && b.dense)
+    {
+        out.bits = a.bits;
+        out.bits &= b.bits;
+        if (support * ItemsetMiner::TIDSET_DENSE >= numTransactions)
+        {
+            out.dense = true;
+            return;
+        }
+        out.ids = RoaringBitset::fromDense(out.bits);
+        DenseBitset().swap(out.bits);
+    }
+    else if (a.dense || b.dense)
+    {
+        RoaringBitset::intersect(a.dense ? b.ids : a.ids, a.dense ? a.bits : b.bits, out.ids);
+    }
+    else
+    {
+        RoaringBitset::intersect(a.ids, b.ids, out.ids);
+    }
+}
+
+// the item at local of a transaction, -1 if it is not set
+inline int itemAt(IInstance* instance, const ValueArray& values, int local, int skipAttribute)
+{
+    int item = instance->attributeIndex(local);
+    if (item == skipAttribute || values[local] == 0 || AttributeValue::isMissingValue(values[local]))
+    {
+        return -1;
+    }
+    return item;
+}
+
+inline size_t pairIndex(int first, int second)
+{
+    return (size_t)second * (second - 1) / 2 + first;
+}
+
+struct Extension
+{
+    explicit Extension(int r): rank(r) {}
+    int rank;
+    Tidset tids;
+};
+
+bool itemsetLess(const FrequentItemset& a, const FrequentItemset& b)
+{
+    if (a.items.size() != b.items.size())
+    {
+        return a.items.size() < b.items.size();
+    }
+    return a.items < b.items;
+}
+
+/**
+ * the itemsets whose least frequent item is first, depth first
+ */
+class EclatTask: public Runnable
+{
+public:
+    EclatTask(const std::vector<Tidset>& tidsets, const std::vector<int>& items, const uint32_t* pairSupport,
+              int first, size_t minSupport, int maxLength, size_t numTransactions):
+        mTidsets(tidsets), mItems(items), mPairSupport(pairSupport), mFirst(first), mMinSupport(minSupport),
+        mMaxLength(maxLength), mNumTransactions(numTransactions)
+    {
+    }
+    /*override*/ void run()
+    {
+        const Tidset& first = mTidsets[mFirst];
+        std::vector<Extension> extensions;
+        extensions.reserve(mTidsets.size() - mFirst - 1);
+        for (size_t j = mFirst + 1; j < mTidsets.size(); ++j)
+        {
+            size_t support = mPairSupport ? mPairSupport[pairIndex(mFirst, j)] : andCount(first, mTidsets[j]);
+            if (support >= mMinSupport)
+            {
+                extensions.push_back(Extension(j));
+                intersect(first, mTidsets[j], support, mNumTransactions, extensions.back().tids);
+            }
+        }
+        std::vector<int> prefix(1, mFirst);
+        grow(prefix, extensions);
+    }
+    std::vector<FrequentItemset>& results()
+    {
+        return mResults;
+    }
+private:
+    void grow(std::vector<int>& prefix, const std::vector<Extension>& extensions)
+    {
+        for (size_t i = 0; i < extensions.size(); ++i)
+        {
+            prefix.push_back(extensions[i].rank);
+            record(prefix, extensions[i].tids.support);
+            if (mMaxLength < 1 || (int)prefix.size() < mMaxLength)
+            {
+                std::vector<Extension> next;
+                next.reserve(extensions.size() - i - 1);
+                for (size_t k = i + 1; k < extensions.size(); ++k)
+                {
+                    size_t support = andCount(extensions[i].tids, extensions[k].tids);
+                    if (support >= mMinSupport)
+                    {
+                        next.push_back(Extension(extensions[k].rank));
+                        intersect(extensions[i].tids, extensions[k].tids, support, mNumTransactions,
+                                  next.back().tids);
+                    }
+                }
+                grow(prefix, next);
+            }
+            prefix.pop_back();
+        }
+    }
+    void record(const std::vector<int>& ranks, size_t support)
+    {
+        mResults.push_back(FrequentItemset());
+        FrequentItemset& itemset = mResults.back();
+        itemset.support = support;
+        for (size_t i = 0; i < ranks.size(); ++i)
+        {
+            itemset.items.push_back(mItems[ranks[i]]);
+        }
+        std::sort(itemset.items.begin(), itemset.items.end());
+    }
+    const std::vector<Tidset>& mTidsets;
+    const std::vector<int>& mItems;
+    const uint32_t* mPairSupport; //NULL when not counted
+    int mFirst;
+    size_t mMinSupport;
+    int mMaxLength;
+    size_t mNumTransactions;
+    std::vector<FrequentItemset> mResults;
+};
+} // namespace
+
+void RuleWriter::add(const AssociationRule& rule)
+{
+    for (size_t i = 0; i < rule.antecedent.size(); ++i)
+    {
+        mOut << (i > 0 ? " " : "") << rule.antecedent[i];
+    }
+    mOut << " =>";
+    for (size_t i = 0; i < rule.consequent.size(); ++i)
+    {
+        mOut << " " << rule.consequent[i];
+    }
+    mOut << "\t" << rule.support << "\t" << rule.confidence << "\t" << rule.lift << "\n";
+}
+
+ItemsetMiner::ItemsetMiner(double minSupport, int maxLength, int threads):
+    mSupportFraction(minSupport),
+    mMinSupport(1),
+    mMaxLength(maxLength),
+    mThreads(threads),
+    mNumTransactions(0)
+{
+}
+
+void ItemsetMiner::load(DataSet* data, int skipAttribute)
+{
+    mNumTransactions = data->numInstances();
+    mMinSupport = mSupportFraction < 1 ? (size_t)ceil(mSupportFraction * mNumTransactions)
+                  : (size_t)mSupportFraction;
+    mMinSupport = std::max(mMinSupport, (size_t)1);
+    // the items of transaction t are its set attributes
+    std::vector<size_t> counts;
+    for (size_t t = 0; t < mNumTransactions; ++t)
+    {
+        IInstance* instance = data->instanceAt(t);
+        const ValueArray& values = instance->getValueArray();
+        for (int local = 0; local < instance->numValues(); ++local)
+        {
+            int item = itemAt(instance, values, local, skipAttribute);
+            if (item < 0)
+            {
+                continue;
+            }
+            if ((size_t)item >= counts.size())
+            {
+                counts.resize(item + 1, 0);
+            }
+            ++counts[item];
+        }
+    }
+    std::vector<int> rankOf(counts.size(), -1);
+    mItems.clear();
+    for (size_t item = 0; item < counts.size(); ++item)
+    {
+        if (counts[item] >= mMinSupport)
+        {
+            rankOf[item] = mItems.size();
+            mItems.push_back(item);
+        }
+    }
+    mTidsets.assign(mItems.size(), Tidset());
+    for (size_t r = 0; r < mItems.size(); ++r)
+    {
+        Tidset& tids = mTidsets[r];
+        tids.dense = counts[mItems[r]] * TIDSET_DENSE >= mNumTransactions;
+        if (tids.dense)
+        {
+            tids.bits.resize(mNumTransactions);
+        }
+    }
+    for (size_t t = 0; t < mNumTransactions; ++t)
+    {
+        IInstance* instance = data->instanceAt(t);
+        const ValueArray& values = instance->getValueArray();
+        for (int local = 0; local < instance->numValues(); ++local)
+        {
+            int item = itemAt(instance, values, local, skipAttribute);
+            if (item < 0 || rankOf[item] < 0)
+            {
+                continue;
+            }
+            Tidset& tids = mTidsets[rankOf[item]];
+            if (tids.dense)
+            {
+                tids.bits.set(t);
+            }
+            else
+            {
+                tids.ids.add(t);
+            }
+        }
+    }
+    // an item listed twice in a transaction was counted twice
+    std::vector<std::pair<size_t, int> > order;
+    for (size_t r = 0; r < mTidsets.size(); ++r)
+    {
+        Tidset& tids = mTidsets[r];
+        tids.support = tids.dense ? tids.bits.count() : tids.ids.cardinality();
+        if (tids.support >= mMinSupport)
+        {
+            order.push_back(std::make_pair(tids.support, (int)r));
+        }
+    }
+    // the rarest items first keep the tid sets of the deep prefixes small
+    std::sort(order.begin(), order.end());
+    std::vector<int> items(order.size());
+    std::vector<Tidset> tidsets(order.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        items[i] = mItems[order[i].second];
+        tidsets[i].dense = mTidsets[order[i].second].dense;
+        tidsets[i].support = mTidsets[order[i].second].support;
+        tidsets[i].bits.swap(mTidsets[order[i].second].bits);
+        tidsets[i].ids.swap(mTidsets[order[i].second].ids);
+    }
+    mItems.swap(items);
+    mTidsets.swap(tidsets);
+
+    // the pairs counted in a pass over the rows, instead of intersecting
+    // the tid sets of every two items
+    std::vector<uint32_t>().swap(mPairSupport);
+    if (mItems.size() < 2 || mItems.size() > PAIR_TABLE_ITEMS || mMaxLength == 1)
+    {
+        return;
+    }
+    mPairSupport.assign(pairIndex(0, mItems.size()), 0);
+    rankOf.assign(counts.size(), -1);
+    for (size_t r = 0; r < mItems.size(); ++r)
+    {
+        rankOf[mItems[r]] = r;
+    }
+    std::vector<int> ranks;
+    for (size_t t = 0; t < mNumTransactions; ++t)
+    {
+        IInstance* instance = data->instanceAt(t);
+        const ValueArray& values = instance->getValueArray();
+        ranks.clear();
+        for (int local = 0; local < instance->numValues(); ++local)
+        {
+            int item = itemAt(instance, values, local, skipAttribute);
+            if (item >= 0 && rankOf[item] >= 0)
+            {
+                ranks.push_back(rankOf[item]);
+            }
+        }
+        std::sort(ranks.begin(), ranks.end());
+        ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+        for (size_t j = 1; j < ranks.size(); ++j)
+        {
+            uint32_t* row = &mPairSupport[pairIndex(0, ranks[j])];
+            for (size_t i = 0; i < j; ++i)
+            {
+                ++row[ranks[i]];
+            }
+        }
+    }
+}
+
+void ItemsetMiner::mine(std::vector<FrequentItemset>& itemsets) const
+{
+    itemsets.clear();
+    for (size_t r = 0; r < mItems.size(); ++r)
+    {
+        itemsets.push_back(FrequentItemset());
+        itemsets.back().items.push_back(mItems[r]);
+        itemsets.back().support = mTidsets[r].support;
+    }
+    if (mMaxLength != 1 && mItems.size() > 1)
+    {
+        std::vector<EclatTask*> tasks;
+        {
+            ThreadPool pool(mThreads);
+            // the first items have the most extensions, they start first
+            for (size_t r = 0; r + 1 < mItems.size(); ++r)
+            {
+                tasks.push_back(new EclatTask(mTidsets, mItems, mPairSupport.empty() ? NULL : &mPairSupport[0],
+                                              r, mMinSupport, mMaxLength, mNumTransactions));
+                pool.submit(tasks.back());
+            }
+            pool.wait();
+        }
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            std::vector<FrequentItemset>& found = tasks[i]->results();
+            itemsets.insert(itemsets.end(), found.begin(), found.end());
+            delete tasks[i];
+        }
+    }
+    std::sort(itemsets.begin(), itemsets.end(), itemsetLess);
+}
+
+void ItemsetMiner::rules(const std::vector<FrequentItemset>& itemsets, double minConfidence, RuleSink& sink) const
+{
+    SupportMap supports;
+    for (size_t i = 0; i < itemsets.size(); ++i)
+    {
+        supports.insert(std::make_pair(itemsets[i].items, itemsets[i].support));
+    }
+    for (size_t i = 0; i < itemsets.size(); ++i)
+    {
+        if (itemsets[i].items.size() > 1)
+        {
+            ruleHelper(itemsets[i], supports, minConfidence, sink);
+        }
+    }
+}
+
+void ItemsetMiner::ruleHelper(const FrequentItemset& itemset, const SupportMap& supports,
+                              double minConfidence, RuleSink& sink) const
+{
+    const std::vector<int>& items = itemset.items;
+    std::vector<std::vector<int> > consequents;
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        consequents.push_back(std::vector<int>(1, items[i]));
+    }
+    AssociationRule rule;
+    rule.support = itemset.support;
+    // a larger consequent has a smaller antecedent and a lower confidence,
+    // so the consequents grow from those that passed, as in ap-genrules
+    while (!consequents.empty() && consequents[0].size() < items.size())
+    {
+        std::vector<std::vector<int> > passed;
+        for (size_t i = 0; i < consequents.size(); ++i)
+        {
+            rule.antecedent.clear();
+            std::set_difference(items.begin(), items.end(), consequents[i].begin(), consequents[i].end(),
+                                std::back_inserter(rule.antecedent));
+            SupportMap::const_iterator antecedent = supports.find(rule.antecedent);
+            SupportMap::const_iterator consequent = supports.find(consequents[i]);
+            if (antecedent == supports.end() || consequent == supports.end())
+            {
+                continue;
+            }
+            rule.confidence = double(itemset.support) / antecedent->second;
+            if (rule.confidence < minConfidence)
+            {
+                continue;
+            }
+            rule.consequent = consequents[i];
+            rule.lift = rule.confidence * mNumTransactions / consequent->second;
+            sink.add(rule);
+            passed.push_back(consequents[i]);
+        }
+        // join the passed consequents that differ in their last item
+        consequents.clear();
+        for (size_t a = 0; a < passed.size(); ++a)
+        {
+            for (size_t b = a + 1; b < passed.size(); ++b)
+            {
+                if (!std::equal(passed[a].begin(), passed[a].end() - 1, passed[b].begin()))
+                {
+                    break;
+                }
+                consequents.push_back(passed[a]);
+                consequents.back().push_back(passed[b].back());
+            }
+        }
+    }
+}
+
+size_t ItemsetMiner::memoryUsage() const
+{
+    size_t bytes = sizeof(*this) + mItems.capacity() * sizeof(int) + mPairSupport.capacity() * sizeof(uint32_t)
+                   + (mTidsets.capacity() - mTidsets.size()) * sizeof(Tidset);
+    for (size_t i = 0; i < mTidsets.size(); ++i)
+    {
+        bytes += mTidsets[i].bits.memoryUsage() + mTidsets[i].ids.memoryUsage();
+    }
+    return bytes;
+}
+} // namespace mlplus
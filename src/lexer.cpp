@@ -87,7 +87,7 @@ void Lexer::freeTokenList(Token*& head)
     while(head)
     {
         Token* t = head->next;
-        free(head);
+        delete head;
         head = t;
     }
 }
@@ -1,3 +1,5 @@
+#include <cstring>
+#include <sched.h>
 #include "log.h"
 using namespace std;
 
@@ -13,12 +15,37 @@ pthread_mutex_t Logger::mlog_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 const char* Logger::msg_psLevelName[] = { "LOG", "WARN", "ERROR"};
 
+const int Logger::RECORD_SIZE;
+
+Logger::LogRecord* Logger::mring = NULL;
+size_t Logger::mring_mask = 0;
+volatile size_t Logger::menqueue_pos = 0;
+size_t Logger::mdequeue_pos = 0;
+volatile int Logger::masync = 0;
+volatile int Logger::mactive_producers = 0;
+volatile unsigned long Logger::mdropped = 0;
+Logger::OverflowPolicy Logger::moverflow = Logger::DROP_WHEN_FULL;
+pthread_t Logger::mwriter;
+
+pthread_mutex_t Logger::mwriter_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t Logger::mwriter_cond = PTHREAD_COND_INITIALIZER;
+volatile int Logger::mwriter_sleeping = 0;
+
+//"YYYY-MM-DD hh:mm:ss" and room for any year localtime can give
+static const size_t TIME_SIZE = 64;
+
+//every thread formats its records here, and keeps the last formatted second
+static __thread char tRecord[Logger::RECORD_SIZE];
+static __thread time_t tCachedSecond = -1;
+static __thread char tCachedTime[TIME_SIZE];
+
 Logger::Logger() 
 {
 }
 
 Logger::~Logger()
 {
+	stopAsync();
 	pthread_mutex_lock(&mlog_mutex);
 	if (mfp_log != NULL && mfp_log != stderr && mfp_log != stdout) 
     {
@@ -155,13 +182,9 @@ void Logger::logDebug(const char* file, int line, const char* func, const char*
 {
 	va_list vap;
 	
-	pthread_mutex_lock(&mlog_mutex);
-
 	va_start(vap, fmt);
 	log_trace(file, line, (int)mlog_level, func, fmt, vap);
 	va_end(vap);
-
-	pthread_mutex_unlock(&mlog_mutex);
 	
 }
 
@@ -169,13 +192,9 @@ void Logger::logPure(const char* fmt, ...)
 {	
 	va_list vap;
 
-	pthread_mutex_lock(&mlog_mutex);
-
 	va_start(vap, fmt);
 	log_trace_pure((int)mlog_level, fmt, vap);
 	va_end(vap);
-
-	pthread_mutex_unlock(&mlog_mutex);
 	
 }
 
@@ -183,13 +202,9 @@ void Logger::printLog(const char* fmt, ...)
 {	
 	va_list vap;
 
-	pthread_mutex_lock(&mlog_mutex);
-
 	va_start(vap, fmt);
 	log_trace_pure((int)LOG_LEVEL, fmt, vap);
 	va_end(vap);
-
-	pthread_mutex_unlock(&mlog_mutex);
 	
 }
 
@@ -197,13 +212,9 @@ void Logger::printWarning(const char* fmt, ...)
 {	
 	va_list vap;
 
-	pthread_mutex_lock(&mlog_mutex);
-
 	va_start(vap, fmt);
 	log_trace_pure((int)WARN_LEVEL, fmt, vap);
 	va_end(vap);
-
-	pthread_mutex_unlock(&mlog_mutex);
 	
 }
 
@@ -211,55 +222,259 @@ void Logger::printError(const char* fmt, ...)
 {	
 	va_list vap;
 
-	pthread_mutex_lock(&mlog_mutex);
-
 	va_start(vap, fmt);
 	log_trace_pure((int)ERROR_LEVEL, fmt, vap);
 	va_end(vap);
-
-	pthread_mutex_unlock(&mlog_mutex);
 	
 }
 
 void Logger::get_cur_time(char cur[]) 
 {
 	time_t n = time(NULL);
-	struct tm* p = localtime(&n);
-	sprintf(cur, "%04d-%02d-%02d %02d:%02d:%02d", 
-			p->tm_year + 1900, p->tm_mon + 1, p->tm_mday,
-			p->tm_hour, p->tm_min, p->tm_sec);
+	if (n != tCachedSecond) 
+    {
+		struct tm p;
+		localtime_r(&n, &p);
+		if (strftime(tCachedTime, sizeof(tCachedTime), "%Y-%m-%d %H:%M:%S", &p) == 0) 
+        {
+			tCachedTime[0] = '\0';
+		}
+		tCachedSecond = n;
+	}
+	memcpy(cur, tCachedTime, TIME_SIZE);
 }
 
-void Logger::log_trace(const char* file, int line, int level, const char* func, const char* fmt, va_list vap) 
+void Logger::write_record(int level, const char* buffer, int len) 
 {
-	if(level < 0 || level < (int)mlog_level || level >= (int)(sizeof(msg_psLevelName)) / (int)sizeof(const char*)) 
+	//a producer announces itself before it checks the mode, so stopAsync can
+	//wait for the records already on their way into the ring
+	__sync_fetch_and_add(&mactive_producers, 1);
+	if (masync) 
     {
+		enqueue_record(level, buffer, len);
+		__sync_fetch_and_sub(&mactive_producers, 1);
 		return;
 	}
-	char buffer[1024];
-	char cur[20];
-	get_cur_time(cur);
+	__sync_fetch_and_sub(&mactive_producers, 1);
 
-	int len = snprintf(buffer, 1024, "%s:%d %s() %s (%d/%X) [%s] ", file, line, func, cur, getpid(), (int)pthread_self(), msg_psLevelName[level]);
-	if(len >= 1024)
+	pthread_mutex_lock(&mlog_mutex);
+	fwrite(buffer, 1, len, mfp_log);
+	if (level == ERROR_LEVEL && mfp_log != stderr && mfp_log != stdout) 
     {
-		buffer[1023] = '\n';
-		len = 1024;
-		//fwrite(buffer, 1, len, mfp_log);
-		if (level == ERROR_LEVEL) 
+		fwrite(buffer, 1, len, stderr);
+	}
+	fflush(mfp_log);
+	pthread_mutex_unlock(&mlog_mutex);
+}
+
+bool Logger::enqueue_record(int level, const char* buffer, int len) 
+{
+	size_t pos = menqueue_pos;
+	for (;;) 
+    {
+		LogRecord* record = &mring[pos & mring_mask];
+		size_t seq = record->sequence;
+		__sync_synchronize();
+		long diff = (long)seq - (long)pos;
+		if (diff == 0) 
         {
-			fwrite(buffer, 1, len, mfp_log);
-			if (mfp_log != stderr && mfp_log != stdout) 
+			if (__sync_bool_compare_and_swap(&menqueue_pos, pos, pos + 1)) 
             {
-				fwrite(buffer, 1, len, stderr);
+				record->level = level;
+				record->length = len;
+				memcpy(record->text, buffer, len);
+				__sync_synchronize();
+				record->sequence = pos + 1;
+				wake_writer();
+				return true;
 			}
 		} 
-        else 
+        else if (diff < 0) 
+        {
+			//the slot still holds a record from the previous lap: the ring is full
+			if (moverflow == DROP_WHEN_FULL) 
+            {
+				__sync_fetch_and_add(&mdropped, 1);
+				wake_writer();
+				return false;
+			}
+			sched_yield();
+		}
+		pos = menqueue_pos;
+	}
+}
+
+void Logger::wake_writer() 
+{
+	//pairs with the barrier the writer puts between raising the flag and
+	//looking at the ring, so either it sees the record or we see the flag
+	__sync_synchronize();
+	if (mwriter_sleeping) 
+    {
+		pthread_mutex_lock(&mwriter_mutex);
+		pthread_cond_signal(&mwriter_cond);
+		pthread_mutex_unlock(&mwriter_mutex);
+	}
+}
+
+bool Logger::record_ready() 
+{
+	size_t seq = mring[mdequeue_pos & mring_mask].sequence;
+	__sync_synchronize();
+	return seq == mdequeue_pos + 1;
+}
+
+bool Logger::dequeue_record() 
+{
+	if (!record_ready()) 
+    {
+		return false;
+	}
+	LogRecord* record = &mring[mdequeue_pos & mring_mask];
+	fwrite(record->text, 1, record->length, mfp_log);
+	if (record->level == ERROR_LEVEL && mfp_log != stderr && mfp_log != stdout) 
+    {
+		fwrite(record->text, 1, record->length, stderr);
+	}
+	__sync_synchronize();
+	record->sequence = mdequeue_pos + mring_mask + 1;
+	++mdequeue_pos;
+	return true;
+}
+
+void* Logger::async_writer(void*) 
+{
+	unsigned long reported = 0;
+	for (;;) 
+    {
+		bool stopping = !masync && mactive_producers == 0;
+		int written = 0;
+		while (dequeue_record()) 
+        {
+			++written;
+		}
+		unsigned long dropped = mdropped;
+		if (dropped != reported) 
+        {
+			char cur[TIME_SIZE];
+			get_cur_time(cur);
+			fprintf(mfp_log, "[%s] [%s] %5d %lu log records dropped\n", cur, msg_psLevelName[WARN_LEVEL], getpid(), dropped - reported);
+			reported = dropped;
+			++written;
+		}
+		if (written > 0) 
+        {
+			fflush(mfp_log);
+		}
+		if (stopping) 
+        {
+			return NULL;
+		}
+		if (written > 0) 
+        {
+			continue;
+		}
+		if (!masync) 
+        {
+			//stopping: the last producers are leaving write_record
+			sched_yield();
+			continue;
+		}
+		pthread_mutex_lock(&mwriter_mutex);
+		mwriter_sleeping = 1;
+		__sync_synchronize();
+		if (masync && !record_ready() && mdropped == reported) 
         {
-			fwrite(buffer, 1, len, mfp_log);
+			pthread_cond_wait(&mwriter_cond, &mwriter_mutex);
 		}
+		mwriter_sleeping = 0;
+		pthread_mutex_unlock(&mwriter_mutex);
+	}
+}
+
+bool Logger::startAsync(size_t capacity, OverflowPolicy policy) 
+{
+	pthread_mutex_lock(&mlog_mutex);
+	if (masync) 
+    {
+		pthread_mutex_unlock(&mlog_mutex);
+		return true;
+	}
+	size_t size = 2;
+	while (size < capacity) 
+    {
+		size <<= 1;
+	}
+	mring = new LogRecord[size];
+	for (size_t i = 0; i < size; ++i) 
+    {
+		mring[i].sequence = i;
+	}
+	mring_mask = size - 1;
+	menqueue_pos = 0;
+	mdequeue_pos = 0;
+	mdropped = 0;
+	moverflow = policy;
+	__sync_synchronize();
+	masync = 1;
+	if (pthread_create(&mwriter, NULL, async_writer, NULL) != 0) 
+    {
+		masync = 0;
+		delete [] mring;
+		mring = NULL;
+		pthread_mutex_unlock(&mlog_mutex);
+		return false;
+	}
+	pthread_mutex_unlock(&mlog_mutex);
+	return true;
+}
+
+void Logger::stopAsync() 
+{
+	pthread_mutex_lock(&mlog_mutex);
+	if (!masync) 
+    {
+		pthread_mutex_unlock(&mlog_mutex);
+		return;
+	}
+	masync = 0;
+	__sync_synchronize();
+	pthread_mutex_lock(&mwriter_mutex);
+	pthread_cond_signal(&mwriter_cond);
+	pthread_mutex_unlock(&mwriter_mutex);
+	//the writer drains the ring once no producer is inside write_record
+	pthread_join(mwriter, NULL);
+	delete [] mring;
+	mring = NULL;
+	pthread_mutex_unlock(&mlog_mutex);
+}
+
+bool Logger::isAsync() 
+{
+	return masync != 0;
+}
+
+unsigned long Logger::droppedRecords() 
+{
+	return mdropped;
+}
+
+void Logger::log_trace(const char* file, int line, int level, const char* func, const char* fmt, va_list vap) 
+{
+	if(level < 0 || level < (int)mlog_level || level >= (int)(sizeof(msg_psLevelName)) / (int)sizeof(const char*)) 
+    {
+		return;
+	}
+	char* buffer = tRecord;
+	char cur[TIME_SIZE];
+	get_cur_time(cur);
 
-		fflush(mfp_log);
+	int len = snprintf(buffer, 1024, "%s:%d %s() %s (%d/%X) [%s] ", file, line, func, cur, getpid(), (int)pthread_self(), msg_psLevelName[level]);
+	if(len >= 1024)
+    {
+		buffer[1023] = '\n';
+		len = 1024;
+		write_record(level, buffer, len);
 		return ;
 	}
 	len += vsnprintf(buffer + len, 1024 - len, fmt, vap);
@@ -273,20 +488,7 @@ void Logger::log_trace(const char* file, int line, int level, const char* func,
 		buffer[1024 - 1] = '\n';
 		len = 1024;
 	}
-	//fwrite(buffer, 1, len, mfp_log);
-	if (level == ERROR_LEVEL) 
-    {
-		fwrite(buffer, 1, len, mfp_log);
-		if (mfp_log != stderr && mfp_log != stdout) 
-        {
-			fwrite(buffer, 1, len, stderr);
-		}
-	} 
-    else 
-    {
-		fwrite(buffer, 1, len, mfp_log);
-	}
-	fflush(mfp_log);
+	write_record(level, buffer, len);
 }
 
 void Logger::log_trace_pure(int level, const char* fmt, va_list vap) 
@@ -296,31 +498,15 @@ void Logger::log_trace_pure(int level, const char* fmt, va_list vap)
 		return;
 	}
 
-	char buffer[1024];
-	char cur[20];
+	char* buffer = tRecord;
+	char cur[TIME_SIZE];
 	get_cur_time(cur);
-	static int abcdef = 0;
-	abcdef++;
 	int len = snprintf(buffer, 1024, "[%s] [%s] %5d ", cur, msg_psLevelName[level],  getpid());
 	if(len >= 1024)
     {
 		buffer[1023] = '\n';
 		len = 1024;
-		//fwrite(buffer, 1, len, mfp_log);
-		if (level == ERROR_LEVEL) 
-        {
-			fwrite(buffer, 1, len, mfp_log);
-			if (mfp_log != stderr && mfp_log != stdout) 
-            {
-				fwrite(buffer, 1, len, stderr);
-			}
-		} 
-        else 
-        {
-			fwrite(buffer, 1, len, mfp_log);
-		}
-
-		fflush(mfp_log);
+		write_record(level, buffer, len);
 		return;
 	}
 	len += vsnprintf(buffer + len, 1024 - len, fmt, vap);
@@ -334,21 +520,7 @@ void Logger::log_trace_pure(int level, const char* fmt, va_list vap)
 		buffer[1024 - 1] = '\n';
 		len = 1024;
 	}
-	//fwrite(buffer, 1, len, mfp_log);
-	if (level == ERROR_LEVEL) 
-    {
-		fwrite(buffer, 1, len, mfp_log);
-		if (mfp_log != stderr && mfp_log != stdout) 
-        {
-			fwrite(buffer, 1, len, stderr);
-		}
-	} 
-    else 
-    {
-		fwrite(buffer, 1, len, mfp_log);
-	}
-
-	fflush(mfp_log);
+	write_record(level, buffer, len);
 }
 
 void Logger::trace_pure(const char* fmt, va_list vap) 
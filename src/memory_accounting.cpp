@@ -0,0 +1,314 @@
+#include <cstdlib>
+#include <cstring>
+#include <time.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include "memory_accounting.h"
+namespace mlplus
+{
+namespace memory
+{
+namespace detail
+{
+__thread int64_t tPending[NUM_TAGS];
+__thread int64_t tFlushBytes = 0;
+}
+
+namespace
+{
+const char* sTagNames[NUM_TAGS] =
+{
+    "dataset_values",
+    "attributes",
+    "estimators",
+    "tree_nodes",
+    "parser_buffers"
+};
+int64_t sInUse[NUM_TAGS];
+int64_t sPeak[NUM_TAGS];
+int64_t sTotal = 0;
+int64_t sTotalPeak = 0;
+// the peak of the innermost phase running
+int64_t sPhasePeak = 0;
+
+pthread_once_t sOnce = PTHREAD_ONCE_INIT;
+pthread_key_t sThreadKey;
+pthread_mutex_t sMutex = PTHREAD_MUTEX_INITIALIZER;
+std::vector<PhaseRecord>* sPhases = NULL;
+
+void raisePeak(int64_t* peak, int64_t value)
+{
+    int64_t old = *peak;
+    while (value > old)
+    {
+        int64_t seen = __sync_val_compare_and_swap(peak, old, value);
+        if (seen == old)
+        {
+            break;
+        }
+        old = seen;
+    }
+}
+
+void exitThread(void*)
+{
+    flushThread();
+}
+
+void init()
+{
+    pthread_key_create(&sThreadKey, exitThread);
+    sPhases = new std::vector<PhaseRecord>();
+}
+
+double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void writeJsonString(FILE* out, const char* s)
+{
+    fputc('"', out);
+    for (; *s != '\0'; ++s)
+    {
+        if (*s == '"' || *s == '\\')
+        {
+            fputc('\\', out);
+        }
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+void reportAtExit()
+{
+    const char* output = getenv("MLPLUS_MEMORY_OUTPUT");
+    if (output == NULL || *output == '\0')
+    {
+        return;
+    }
+    const char* format = getenv("MLPLUS_MEMORY_FORMAT");
+    bool json = format != NULL && strcmp(format, "json") == 0;
+    FILE* out = stderr;
+    if (strcmp(output, "-") != 0)
+    {
+        size_t length = strlen(output);
+        json = json || (length > 5 && strcmp(output + length - 5, ".json") == 0);
+        out = fopen(output, "w");
+        if (out == NULL)
+        {
+            fprintf(stderr, "cannot open memory output %s\n", output);
+            return;
+        }
+    }
+    report(out, json);
+    if (out != stderr)
+    {
+        fclose(out);
+    }
+}
+
+void initPhases()
+{
+    pthread_once(&sOnce, init);
+    atexit(reportAtExit);
+}
+} // namespace
+
+void detail::flush(Tag tag)
+{
+    if (tFlushBytes == 0)
+    {
+        pthread_once(&sOnce, init);
+        // a thread's pending bytes are added to the totals as it exits
+        pthread_setspecific(sThreadKey, &tFlushBytes);
+        tFlushBytes = FLUSH_BYTES;
+    }
+    int64_t delta = tPending[tag];
+    if (delta == 0)
+    {
+        return;
+    }
+    tPending[tag] = 0;
+    raisePeak(&sPeak[tag], __sync_add_and_fetch(&sInUse[tag], delta));
+    int64_t total = __sync_add_and_fetch(&sTotal, delta);
+    raisePeak(&sTotalPeak, total);
+    raisePeak(&sPhasePeak, total);
+}
+
+const char* tagName(Tag tag)
+{
+    return tag >= 0 && tag < NUM_TAGS ? sTagNames[tag] : "unknown";
+}
+
+void flushThread()
+{
+    for (int tag = 0; tag < NUM_TAGS; ++tag)
+    {
+        detail::flush((Tag)tag);
+    }
+}
+
+int64_t bytesInUse(Tag tag)
+{
+    return __sync_fetch_and_add(&sInUse[tag], 0);
+}
+
+int64_t peakBytes(Tag tag)
+{
+    return __sync_fetch_and_add(&sPeak[tag], 0);
+}
+
+int64_t totalBytesInUse()
+{
+    return __sync_fetch_and_add(&sTotal, 0);
+}
+
+int64_t totalPeakBytes()
+{
+    return __sync_fetch_and_add(&sTotalPeak, 0);
+}
+
+size_t peakResidentBytes()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+    // kilobytes on linux
+    return (size_t)usage.ru_maxrss * 1024;
+}
+
+Phase::Phase(const std::string& name): mOuterPeak(0), mStart(now()), mEnded(false)
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, initPhases);
+    flushThread();
+    mRecord.name = name;
+    mRecord.startBytes = totalBytesInUse();
+    int64_t outer = sPhasePeak;
+    while (true)
+    {
+        int64_t seen = __sync_val_compare_and_swap(&sPhasePeak, outer, mRecord.startBytes);
+        if (seen == outer)
+        {
+            break;
+        }
+        outer = seen;
+    }
+    mOuterPeak = outer;
+}
+
+Phase::~Phase()
+{
+    end();
+}
+
+void Phase::end()
+{
+    if (mEnded)
+    {
+        return;
+    }
+    mEnded = true;
+    flushThread();
+    mRecord.endBytes = totalBytesInUse();
+    raisePeak(&sPhasePeak, mRecord.endBytes);
+    mRecord.peakBytes = __sync_fetch_and_add(&sPhasePeak, 0);
+    for (int tag = 0; tag < NUM_TAGS; ++tag)
+    {
+        mRecord.endBytesByTag[tag] = bytesInUse((Tag)tag);
+    }
+    mRecord.peakResidentBytes = peakResidentBytes();
+    mRecord.seconds = now() - mStart;
+    raisePeak(&sPhasePeak, mOuterPeak);
+    pthread_mutex_lock(&sMutex);
+    sPhases->push_back(mRecord);
+    pthread_mutex_unlock(&sMutex);
+}
+
+std::vector<PhaseRecord> phases()
+{
+    pthread_once(&sOnce, init);
+    pthread_mutex_lock(&sMutex);
+    std::vector<PhaseRecord> copy(*sPhases);
+    pthread_mutex_unlock(&sMutex);
+    return copy;
+}
+
+void report(FILE* out, bool json)
+{
+    flushThread();
+    std::vector<PhaseRecord> records = phases();
+    if (json)
+    {
+        fprintf(out, "{\"tags\":[");
+    }
+    else
+    {
+        fprintf(out, "%-24s %16s %16s\n", "tag", "bytes", "peak_bytes");
+    }
+    for (int tag = 0; tag < NUM_TAGS; ++tag)
+    {
+        long long inUse = bytesInUse((Tag)tag);
+        long long peak = peakBytes((Tag)tag);
+        if (json)
+        {
+            fprintf(out, "%s{\"name\":\"%s\",\"bytes\":%lld,\"peak_bytes\":%lld}",
+                    tag > 0 ? "," : "", sTagNames[tag], inUse, peak);
+        }
+        else
+        {
+            fprintf(out, "%-24s %16lld %16lld\n", sTagNames[tag], inUse, peak);
+        }
+    }
+    if (json)
+    {
+        fprintf(out, "],\"bytes\":%lld,\"peak_bytes\":%lld,\"peak_resident_bytes\":%llu,\"phases\":[",
+                (long long)totalBytesInUse(), (long long)totalPeakBytes(),
+                (unsigned long long)peakResidentBytes());
+    }
+    else
+    {
+        fprintf(out, "%-24s %16lld %16lld\n", "total", (long long)totalBytesInUse(),
+                (long long)totalPeakBytes());
+        fprintf(out, "%-24s %16s %16llu\n", "resident", "", (unsigned long long)peakResidentBytes());
+        fprintf(out, "\n%-24s %16s %16s %16s %18s %10s\n", "phase", "start_bytes", "end_bytes",
+                "peak_bytes", "peak_resident", "seconds");
+    }
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        const PhaseRecord& r = records[i];
+        if (json)
+        {
+            fprintf(out, "%s{\"name\":", i > 0 ? "," : "");
+            writeJsonString(out, r.name.c_str());
+            fprintf(out, ",\"start_bytes\":%lld,\"end_bytes\":%lld,\"peak_bytes\":%lld,"
+                    "\"peak_resident_bytes\":%llu,\"seconds\":%.3f,\"end_bytes_by_tag\":{",
+                    (long long)r.startBytes, (long long)r.endBytes, (long long)r.peakBytes,
+                    (unsigned long long)r.peakResidentBytes, r.seconds);
+            for (int tag = 0; tag < NUM_TAGS; ++tag)
+            {
+                fprintf(out, "%s\"%s\":%lld", tag > 0 ? "," : "", sTagNames[tag],
+                        (long long)r.endBytesByTag[tag]);
+            }
+            fprintf(out, "}}");
+        }
+        else
+        {
+            fprintf(out, "%-24s %16lld %16lld %16lld %18llu %10.3f\n", r.name.c_str(),
+                    (long long)r.startBytes, (long long)r.endBytes, (long long)r.peakBytes,
+                    (unsigned long long)r.peakResidentBytes, r.seconds);
+        }
+    }
+    if (json)
+    {
+        fprintf(out, "]}\n");
+    }
+    fflush(out);
+}
+} // namespace memory
+} // namespace mlplus
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <stdexcept>
+#include "aho_corasick.h"
+using namespace std;
+
+const int32_t AhoCorasick::ROOT;
+const int32_t AhoCorasick::FREE;
+
+namespace
+{
+struct PatternLess
+{
+    const vector<string>& patterns;
+    PatternLess(const vector<string>& p): patterns(p) {}
+    bool operator()(uint32_t l, uint32_t r) const
+    {
+        return patterns[l] < patterns[r];
+    }
+};
+struct PendingState
+{
+    int32_t state;
+    size_t lo;
+    size_t hi;
+    size_t depth;
+    PendingState(int32_t s, size_t l, size_t h, size_t d): state(s), lo(l), hi(h), depth(d) {}
+};
+}
+
+AhoCorasick::AhoCorasick(): mNextCheckPos(0), mStates(0)
+{
+}
+
+void AhoCorasick::Load(const std::string& filename)
+{
+    ifstream ifs(filename.c_str());
+    if(!ifs)
+    {
+        throw std::runtime_error(string("Cannot open pattern list file: ") + filename);
+    }
+    vector<string> patternList;
+    string line;
+    while(getline(ifs, line))
+    {
+        size_t b = line.find_first_not_of(" \t\r\n");
+        if(b == string::npos || line[b] == '#')
+        {
+            continue;
+        }
+        size_t e = line.find_first_of(" \t\r\n", b);
+        patternList.push_back(line.substr(b, e == string::npos ? string::npos : e - b));
+    }
+    Init(patternList);
+}
+
+void AhoCorasick::Reserve(size_t size)
+{
+    if(size <= mCheck.size())
+    {
+        return;
+    }
+    size = max(size, mCheck.size() * 2);
+    mBase.resize(size, 0);
+    mCheck.resize(size, FREE);
+    mFail.resize(size, ROOT);
+    mOutput.resize(size, -1);
+    mOutLink.resize(size, -1);
+}
+
+int32_t AhoCorasick::FindBase(const uint8_t* labels, size_t count)
+{
+    size_t pos = max(mNextCheckPos, (size_t)labels[0] + 1);
+    size_t occupied = 0;
+    size_t first = pos;
+    for(;; ++pos)
+    {
+        Reserve(pos + 256 + 1);
+        if(mCheck[pos] != FREE)
+        {
+            ++occupied;
+            continue;
+        }
+        size_t base = pos - labels[0];
+        size_t i = 1;
+        for(; i < count && mCheck[base + labels[i]] == FREE; ++i)
+        {
+        }
+        if(i == count)
+        {
+            break;
+        }
+    }
+    //skip the densely packed head on later searches
+    if(occupied >= 0.95 * (pos - first + 1))
+    {
+        mNextCheckPos = pos;
+    }
+    return pos - labels[0];
+}
+
+void AhoCorasick::Init(const vector<string>& patternList)
+{
+    mPatternList = patternList;
+    mPatternIsAscii.assign(mPatternList.size(), true);
+    vector<uint32_t> sorted;
+    sorted.reserve(mPatternList.size());
+    for(size_t i = 0; i < mPatternList.size(); ++i)
+    {
+        const string& s = mPatternList[i];
+        for(size_t j = 0; j < s.size(); ++j)
+        {
+            if(s[j] & 0x80)
+            {
+                mPatternIsAscii[i] = false;
+                break;
+            }
+        }
+        if(!s.empty())
+        {
+            sorted.push_back(i);
+        }
+    }
+    //the stable order keeps the first id of a duplicated pattern in front
+    stable_sort(sorted.begin(), sorted.end(), PatternLess(mPatternList));
+
+    mBase.clear();
+    mCheck.clear();
+    mFail.clear();
+    mOutput.clear();
+    mOutLink.clear();
+    mNextCheckPos = 0;
+    Reserve(256 + 1);
+    mCheck[ROOT] = -2;
+
+    vector<PendingState> queue;
+    queue.push_back(PendingState(ROOT, 0, sorted.size(), 0));
+    vector<int32_t> order;
+    vector<uint32_t> childStart;
+    vector<uint8_t> childLabels;
+    vector<size_t> groupStart;
+    size_t used = ROOT + 1;
+    for(size_t head = 0; head < queue.size(); ++head)
+    {
+        PendingState node = queue[head];
+        order.push_back(node.state);
+        childStart.push_back(childLabels.size());
+        size_t i = node.lo;
+        if(i < node.hi && mPatternList[sorted[i]].size() == node.depth)
+        {
+            mOutput[node.state] = sorted[i];
+            while(i < node.hi && mPatternList[sorted[i]].size() == node.depth)
+            {
+                ++i;
+            }
+        }
+        if(i == node.hi)
+        {
+            continue;
+        }
+        //the patterns in [i, hi) share node.depth bytes and are sorted, so the
+        //children are runs of equal bytes at node.depth
+        size_t labelBegin = childLabels.size();
+        groupStart.clear();
+        for(; i < node.hi; ++i)
+        {
+            uint8_t c = static_cast<uint8_t>(mPatternList[sorted[i]][node.depth]);
+            if(childLabels.size() == labelBegin || childLabels.back() != c)
+            {
+                childLabels.push_back(c);
+                groupStart.push_back(i);
+            }
+        }
+        groupStart.push_back(node.hi);
+        size_t count = childLabels.size() - labelBegin;
+        int32_t base = FindBase(&childLabels[labelBegin], count);
+        mBase[node.state] = base;
+        for(size_t k = 0; k < count; ++k)
+        {
+            int32_t t = base + childLabels[labelBegin + k];
+            mCheck[t] = node.state;
+            used = max(used, (size_t)t + 1);
+            queue.push_back(PendingState(t, groupStart[k], groupStart[k + 1], node.depth + 1));
+        }
+    }
+    childStart.push_back(childLabels.size());
+    mStates = order.size();
+    BuildFailureLinks(order, childStart, childLabels);
+
+    mBase.resize(used);
+    mCheck.resize(used);
+    mFail.resize(used);
+    mOutput.resize(used);
+    mOutLink.resize(used);
+}
+
+void AhoCorasick::BuildFailureLinks(const vector<int32_t>& order,
+                                    const vector<uint32_t>& childStart,
+                                    const vector<uint8_t>& childLabels)
+{
+    mFail[ROOT] = ROOT;
+    mOutLink[ROOT] = -1;
+    //order is breadth first, so every failure target is final before it is used
+    for(size_t k = 0; k < order.size(); ++k)
+    {
+        int32_t s = order[k];
+        for(uint32_t j = childStart[k]; j < childStart[k + 1]; ++j)
+        {
+            uint8_t c = childLabels[j];
+            int32_t t = mBase[s] + c;
+            int32_t f = ROOT;
+            if(s != ROOT)
+            {
+                for(f = mFail[s];; f = mFail[f])
+                {
+                    int32_t n = Next(f, c);
+                    if(n != FREE)
+                    {
+                        f = n;
+                        break;
+                    }
+                    if(f == ROOT)
+                    {
+                        break;
+                    }
+                }
+            }
+            mFail[t] = f;
+            mOutLink[t] = mOutput[f] >= 0 ? f : mOutLink[f];
+        }
+    }
+}
+
+bool AhoCorasick::WordBoundaryNotMatch(const string& text, uint32_t id, size_t end) const
+{
+    if(!mPatternIsAscii[id])
+    {
+        return false;
+    }
+    size_t start = end - mPatternList[id].size();
+    bool startok = start == 0 || isspace(static_cast<unsigned char>(text[start - 1]));
+    bool endok = end >= text.size() || isspace(static_cast<unsigned char>(text[end]));
+    return !startok || !endok;
+}
+
+int AhoCorasick::Scan(const string& text, vector<uint32_t>& matchedIds, uint32_t threshold) const
+{
+    int result = 0;
+    if(mStates <= 1)
+    {
+        return 0;
+    }
+    int32_t s = ROOT;
+    for(size_t i = 0; i < text.size(); ++i)
+    {
+        uint8_t c = static_cast<uint8_t>(text[i]);
+        int32_t t;
+        while((t = Next(s, c)) == FREE && s != ROOT)
+        {
+            s = mFail[s];
+        }
+        s = t == FREE ? ROOT : t;
+        for(int32_t o = mOutput[s] >= 0 ? s : mOutLink[s]; o != -1; o = mOutLink[o])
+        {
+            uint32_t id = mOutput[o];
+            if(WordBoundaryNotMatch(text, id, i + 1))
+            {
+                continue;
+            }
+            matchedIds.push_back(id);
+            if((uint32_t)++result >= threshold)
+            {
+                return result;
+            }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,90 @@
+#ifndef UTILITY_AHOCORASICK_H
+#define UTILITY_AHOCORASICK_H
+#include <stdint.h>
+#include <vector>
+#include <string>
+/**
+ * An Aho-Corasick automaton over UTF-8 bytes, stored as a double array.
+ *
+ * The goto function of state s on byte c is t = base[s] + c when check[t] == s,
+ * so a transition is two array reads and the whole automaton is a handful of
+ * int32 arrays however many patterns it holds. Failure links and dictionary
+ * suffix links are precomputed, Scan() finds every occurrence of every pattern
+ * in one pass over the text.
+ *
+ * Patterns are reported by id, the index of the pattern in the list given to
+ * Init(); a pattern listed twice is reported under its first id. Patterns made
+ * only of ASCII bytes follow the word boundary rule of PatternScan: they match
+ * only between whitespace or the ends of the text.
+ */
+class AhoCorasick
+{
+public:
+    AhoCorasick();
+    ~AhoCorasick(){}
+    void Init(const std::vector<std::string>& patternList);
+    void Load(const std::string& filename);
+    inline size_t PatternCount() const;
+    inline const std::string& Pattern(uint32_t id) const;
+    inline size_t StateCount() const;
+    /**
+     * @brief  scan a text for all the matched patterns
+     * @param  text a text to be scanned
+     * @param  matchedIds the id of every match is appended, once per occurrence
+     * @param  threshold stop as soon as this many matches were appended
+     * @return the number of matches appended
+     */
+    int Scan(const std::string& text, std::vector<uint32_t>& matchedIds,
+             uint32_t threshold = 0xFFFFFFFF) const;
+private:
+    static const int32_t ROOT = 0;
+    static const int32_t FREE = -1;
+
+    inline int32_t Next(int32_t state, uint8_t c) const;
+    int32_t FindBase(const uint8_t* labels, size_t count);
+    void Reserve(size_t size);
+    void BuildFailureLinks(const std::vector<int32_t>& order,
+                           const std::vector<uint32_t>& childStart,
+                           const std::vector<uint8_t>& childLabels);
+    bool WordBoundaryNotMatch(const std::string& text, uint32_t id, size_t end) const;
+
+    std::vector<int32_t> mBase;
+    std::vector<int32_t> mCheck;
+    std::vector<int32_t> mFail;
+    std::vector<int32_t> mOutput;  // pattern id ending in the state, -1 for none
+    std::vector<int32_t> mOutLink; // next state on the failure chain with an output
+    size_t mNextCheckPos;
+    size_t mStates;
+
+    std::vector<std::string> mPatternList;
+    std::vector<bool> mPatternIsAscii;
+
+    AhoCorasick(const AhoCorasick&);
+    AhoCorasick& operator=(const AhoCorasick&);
+};
+
+inline size_t AhoCorasick::PatternCount() const
+{
+    return mPatternList.size();
+}
+
+inline const std::string& AhoCorasick::Pattern(uint32_t id) const
+{
+    return mPatternList[id];
+}
+
+inline size_t AhoCorasick::StateCount() const
+{
+    return mStates;
+}
+
+inline int32_t AhoCorasick::Next(int32_t state, uint8_t c) const
+{
+    size_t t = (size_t)mBase[state] + c;
+    if (t < mCheck.size() && mCheck[t] == state)
+    {
+        return t;
+    }
+    return FREE;
+}
+#endif
@@ -0,0 +1,48 @@
+#include <sys/time.h>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include "pattern_scan.h"
+using namespace std;
+
+/**
+ * Compiles a tosvm feature file, one "word [weight]" per line, into a pattern
+ * dictionary that PatternScan::LoadCompiled maps without parsing anything.
+ *
+ *   compile_dict feature_file output_file [prefix_size]
+ */
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 3)
+    {
+        cerr << "usage: " << argv[0] << " feature_file output_file [prefix_size]" << endl;
+        return 1;
+    }
+    int prefixSize = argc > 3 ? atoi(argv[3]) : 3;
+    try
+    {
+        double t = now();
+        PatternScan scanner(prefixSize);
+        scanner.LoadWeighted(argv[1]);
+        double built = now() - t;
+        scanner.SaveCompiled(argv[2]);
+        t = now();
+        PatternScan loaded;
+        loaded.LoadCompiled(argv[2]);
+        cerr << "compiled " << argv[1] << " into " << argv[2] << " in " << built
+             << "s, it loads in " << now() - t << "s" << endl;
+    }
+    catch(std::exception& e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
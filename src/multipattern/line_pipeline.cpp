@@ -0,0 +1,193 @@
+#include <map>
+#include <stdexcept>
+#include "line_pipeline.h"
+#include "thread_pool.h"
+using namespace std;
+
+namespace
+{
+typedef mlplus::BoundedQueue<LineBatch*> BatchQueue;
+
+/**
+ * the queues between the stages: free batches to the reader, read batches to
+ * the scanners, scanned batches to the writer
+ */
+struct Queues
+{
+    explicit Queues(size_t capacity): free(capacity), scan(capacity), write(capacity)
+    {
+    }
+    void closeAll()
+    {
+        free.close();
+        scan.close();
+        write.close();
+    }
+    BatchQueue free;
+    BatchQueue scan;
+    BatchQueue write;
+};
+
+//pointers rather than references, so the stages fit in a vector
+class ScanStage : public mlplus::Runnable
+{
+public:
+    ScanStage(LineBatchProcessor* processor, Queues* queues): mProcessor(processor), mQueues(queues)
+    {
+    }
+    /*override*/ void run()
+    {
+        try
+        {
+            LineBatch* batch = NULL;
+            while (mQueues->scan.pop(batch))
+            {
+                mProcessor->process(*batch);
+                if (!mQueues->write.push(batch))
+                {
+                    return;
+                }
+            }
+        }
+        catch (...)
+        {
+            mQueues->closeAll();
+            throw;
+        }
+    }
+private:
+    LineBatchProcessor* mProcessor;
+    Queues* mQueues;
+};
+
+class WriteStage : public mlplus::Runnable
+{
+public:
+    WriteStage(LineBatchWriter& writer, Queues& queues): mWriter(writer), mQueues(queues)
+    {
+    }
+    /*override*/ void run()
+    {
+        try
+        {
+            map<size_t, LineBatch*> pending;
+            size_t next = 0;
+            LineBatch* batch = NULL;
+            while (mQueues.write.pop(batch))
+            {
+                pending[batch->seq] = batch;
+                map<size_t, LineBatch*>::iterator it;
+                while ((it = pending.find(next)) != pending.end())
+                {
+                    mWriter.write(*it->second);
+                    mQueues.free.push(it->second);
+                    pending.erase(it);
+                    ++next;
+                }
+            }
+        }
+        catch (...)
+        {
+            mQueues.closeAll();
+            throw;
+        }
+    }
+private:
+    LineBatchWriter& mWriter;
+    Queues& mQueues;
+};
+}
+
+void runLinePipeline(istream& input, const vector<LineBatchProcessor*>& processors,
+                     LineBatchWriter& writer, size_t batchLines)
+{
+    if (processors.empty())
+    {
+        throw invalid_argument("line pipeline without processors");
+    }
+    if (batchLines == 0)
+    {
+        batchLines = 1;
+    }
+    mlplus::ThreadPool scanners(processors.size());
+    mlplus::ThreadPool writerThread(1);
+    vector<LineBatch> batches(processors.size() * 4);
+    Queues queues(batches.size());
+    for (size_t i = 0; i < batches.size(); ++i)
+    {
+        batches[i].lines.resize(batchLines);
+        queues.free.push(&batches[i]);
+    }
+    WriteStage writeStage(writer, queues);
+    writerThread.submit(&writeStage);
+    vector<ScanStage> scanStages;
+    for (size_t i = 0; i < processors.size(); ++i)
+    {
+        scanStages.push_back(ScanStage(processors[i], &queues));
+    }
+    for (size_t i = 0; i < scanStages.size(); ++i)
+    {
+        scanners.submit(&scanStages[i]);
+    }
+
+    string error;
+    try
+    {
+        size_t seq = 0;
+        size_t linen = 0;
+        LineBatch* batch = NULL;
+        while (queues.free.pop(batch))
+        {
+            size_t count = 0;
+            while (count < batchLines && getline(input, batch->lines[count]))
+            {
+                ++count;
+            }
+            if (count == 0)
+            {
+                break;
+            }
+            batch->seq = seq++;
+            batch->firstLine = linen;
+            batch->count = count;
+            linen += count;
+            if (!queues.scan.push(batch) || count < batchLines)
+            {
+                break;
+            }
+        }
+    }
+    catch (exception& e)
+    {
+        error = e.what();
+        queues.closeAll();
+    }
+    queues.scan.close();
+    try
+    {
+        scanners.wait();
+    }
+    catch (exception& e)
+    {
+        if (error.empty())
+        {
+            error = e.what();
+        }
+    }
+    queues.write.close();
+    try
+    {
+        writerThread.wait();
+    }
+    catch (exception& e)
+    {
+        if (error.empty())
+        {
+            error = e.what();
+        }
+    }
+    if (!error.empty())
+    {
+        throw runtime_error(error);
+    }
+}
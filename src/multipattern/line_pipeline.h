@@ -0,0 +1,58 @@
+#ifndef MULTIPATTERN_LINEPIPELINE_H
+#define MULTIPATTERN_LINEPIPELINE_H
+#include <stdint.h>
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * A batch of input lines and the output featurized from them, svm light text
+ * or csr rows. The pipeline reuses batches, so the buffers keep their size.
+ */
+struct LineBatch
+{
+    size_t seq;
+    size_t firstLine;
+    size_t count;
+    std::vector<std::string> lines;
+    std::string text;              // svm light rows
+    std::vector<uint32_t> rowSizes; // csr rows
+    std::vector<int32_t> indices;
+    std::vector<float> values;
+};
+
+class LineBatchProcessor
+{
+public:
+    virtual ~LineBatchProcessor() {}
+    /**
+     * @brief fill the output of the batch from its first count lines, called
+     *        from the scanner thread that owns this processor
+     */
+    virtual void process(LineBatch& batch) = 0;
+};
+
+class LineBatchWriter
+{
+public:
+    virtual ~LineBatchWriter() {}
+    /**
+     * @brief called from the writer thread with the batches in input order
+     */
+    virtual void write(const LineBatch& batch) = 0;
+};
+
+/**
+ * @brief featurize input on one scanner thread per processor. The calling
+ *        thread reads batches of batchLines lines, the scanners process whole
+ *        batches, and one writer thread hands them to the writer in input
+ *        order. A fixed set of batches circulates between the stages.
+ *
+ * A stage that throws closes every queue, so the others stop instead of
+ * blocking on a queue nobody serves.
+ * @throw std::runtime_error with the first error, once every thread has stopped
+ */
+void runLinePipeline(std::istream& input, const std::vector<LineBatchProcessor*>& processors,
+                     LineBatchWriter& writer, size_t batchLines);
+#endif
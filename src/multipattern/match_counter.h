@@ -0,0 +1,106 @@
+#ifndef UTILITY_MATCHCOUNTER_H
+#define UTILITY_MATCHCOUNTER_H
+#include <stdint.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+/**
+ * A reusable (pattern id, count) buffer for scanners.
+ *
+ * The matches are kept in a flat vector in first seen order and a dense slot
+ * array indexed by pattern id points into it, so counting a match is two array
+ * accesses and Clear() only touches the ids seen since the last Clear(). Once
+ * the buffers have grown to the largest document no scan allocates memory.
+ */
+class MatchCounter
+{
+public:
+    typedef std::pair<uint32_t, uint32_t> Match; //(pattern id, count)
+    MatchCounter() {}
+    /**
+     * @brief make room for pattern ids in [0, idCount)
+     */
+    inline void Reserve(size_t idCount);
+    /**
+     * @brief count one match of id, which must be below the reserved id count
+     * @return the number of distinct ids counted
+     */
+    inline size_t Add(uint32_t id);
+    inline void Clear();
+    /**
+     * @brief order the matches by pattern id
+     */
+    inline void Sort();
+    inline size_t Size() const;
+    inline bool Empty() const;
+    inline const Match& operator[](size_t i) const;
+    inline const std::vector<Match>& Matches() const;
+private:
+    std::vector<uint32_t> mSlots; // 1 + position of the id in mMatches, 0 when unseen
+    std::vector<Match> mMatches;
+
+    MatchCounter(const MatchCounter&);
+    MatchCounter& operator=(const MatchCounter&);
+};
+
+inline void MatchCounter::Reserve(size_t idCount)
+{
+    if(mSlots.size() < idCount)
+    {
+        mSlots.resize(idCount, 0);
+    }
+}
+
+inline size_t MatchCounter::Add(uint32_t id)
+{
+    uint32_t& slot = mSlots[id];
+    if(slot == 0)
+    {
+        mMatches.push_back(Match(id, 1));
+        slot = mMatches.size();
+    }
+    else
+    {
+        ++mMatches[slot - 1].second;
+    }
+    return mMatches.size();
+}
+
+inline void MatchCounter::Clear()
+{
+    for(size_t i = 0; i < mMatches.size(); ++i)
+    {
+        mSlots[mMatches[i].first] = 0;
+    }
+    mMatches.clear();
+}
+
+inline void MatchCounter::Sort()
+{
+    std::sort(mMatches.begin(), mMatches.end());
+    for(size_t i = 0; i < mMatches.size(); ++i)
+    {
+        mSlots[mMatches[i].first] = i + 1;
+    }
+}
+
+inline size_t MatchCounter::Size() const
+{
+    return mMatches.size();
+}
+
+inline bool MatchCounter::Empty() const
+{
+    return mMatches.empty();
+}
+
+inline const MatchCounter::Match& MatchCounter::operator[](size_t i) const
+{
+    return mMatches[i];
+}
+
+inline const std::vector<MatchCounter::Match>& MatchCounter::Matches() const
+{
+    return mMatches;
+}
+#endif
@@ -1,7 +1,21 @@
 #include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 #include "pattern_scan.h"
+#include "profile.h"
 using namespace std;
 using namespace boost;
 const uint8_t PatternScan::sCharTable[256] =
@@ -18,8 +32,65 @@ const uint8_t PatternScan::sCharTable[256] =
 const uint8_t PatternScan::sCharMask[7] = {0, 0x7F, 0x1F, 0x0F, 0x07, 0x03, 0x01};
 const uint64_t PatternScan::sPatternMask[4] = {0xFFFFull, 0xFFFFFFFFull, 0xFFFFFFFFFFFFull, 0xFFFFFFFFFFFFFFFFull};
 
-PatternScan::PatternScan(uint8_t prefixSize): mPrefixSize(prefixSize)
+/*
+ * The compiled dictionary is one block of native endian data.  Every section
+ * starts on an 8 byte boundary at the offset recorded in the header:
+ *
+ *   CompiledHeader
+ *   uint64_t patternOffsets[patternCount + 1]  pattern i is patternBytes[offsets[i], offsets[i + 1])
+ *   char     patternBytes[byteCount]           the sorted patterns, pattern 0 is ""
+ *   uint32_t suffixStart[patternCount]
+ *   uint32_t patternIds[patternCount]
+ *   uint8_t  patternAscii[patternCount]
+ *   uint32_t idIndex[idCount]
+ *   float    weights[idCount]
+ *   Slot     tables[t][tableCapacity[t]]       for t in [0, prefixSize)
+ *
+ * Table t holds the patterns of t + 1 chars when t + 1 < prefixSize, and the
+ * patterns sharing a prefixSize char prefix otherwise.
+ */
+struct PatternScan::CompiledHeader
 {
+    char magic[8];
+    uint32_t version;
+    uint32_t prefixSize;
+    uint64_t size;
+    uint64_t patternCount;
+    uint64_t idCount;
+    uint64_t byteCount;
+    uint64_t patternOffsets;
+    uint64_t patternBytes;
+    uint64_t suffixStart;
+    uint64_t patternIds;
+    uint64_t patternAscii;
+    uint64_t idIndex;
+    uint64_t weights;
+    uint64_t tables[4];
+    uint64_t tableCapacity[4];
+};
+
+static const char sCompiledMagic[8] = {'P', 'S', 'C', 'A', 'N', 'D', 'I', 'C'};
+static const uint32_t COMPILED_VERSION = 1;
+
+static inline uint64_t Align8(uint64_t n)
+{
+    return (n + 7) & ~7ull;
+}
+
+// A section starts 8 byte aligned and ends inside the image.
+static inline bool Within(uint64_t offset, uint64_t count, uint64_t width, uint64_t size)
+{
+    return (offset & 7) == 0 && offset <= size && count <= (size - offset) / width;
+}
+
+PatternScan::PatternScan(uint8_t prefixSize): mPrefixSize(prefixSize), mMapped(NULL), mMappedSize(0)
+{
+    Release();
+}
+
+PatternScan::~PatternScan()
+{
+    Release();
 }
 
 void PatternScan::Load(const std::string& filename)
@@ -44,17 +115,99 @@ void PatternScan::Load(const std::string& filename)
     }
     Init(vecString);
 }
+void PatternScan::LoadWeighted(const std::string& filename)
+{
+    ifstream ifs(filename.c_str());
+    if(!ifs)
+    {
+        throw std::runtime_error(string("Cannot open feature file: ") + filename);
+    }
+    std::string line;
+    std::vector<std::string> words;
+    std::vector<uint32_t> ids;
+    std::vector<float> weights;
+    vector<string> keys;
+    uint32_t id = 0;
+    while(getline(ifs, line))
+    {
+        ++id;
+        boost::split(keys, line, is_any_of("\t "));
+        if(keys[0].empty())
+        {
+            continue;
+        }
+        words.push_back(keys[0]);
+        ids.push_back(id);
+        weights.push_back(keys.size() > 1 ? boost::lexical_cast<float>(keys[1]) : 1.0f);
+    }
+    Init(words, ids, weights);
+}
+
+namespace
+{
+struct PatternLess
+{
+    const vector<string>& patterns;
+    PatternLess(const vector<string>& p): patterns(p) {}
+    bool operator()(size_t l, size_t r) const
+    {
+        return patterns[l] < patterns[r];
+    }
+};
+}
+
 void PatternScan::Init(const vector<string>& patternList)
 {
-    mPatternList = patternList;
-    mPatternList.push_back(""); // Put an empty string first so that the index of patterns are not 0.
-    mPatternSurfixList.push_back("");
-    sort(mPatternList.begin() , mPatternList.end());
-    mPatternSurfixList.reserve(mPatternList.size());
-    mSmallPatternMaps.resize(mPrefixSize - 1);
-    for(size_t i = 1; i < mPatternList.size(); ++i)
+    vector<uint32_t> ids(patternList.size());
+    for(size_t i = 0; i < ids.size(); ++i)
+    {
+        ids[i] = i;
+    }
+    Init(patternList, ids, vector<float>(patternList.size(), 1.0f));
+}
+
+void PatternScan::Init(const vector<string>& patternList, const vector<uint32_t>& ids,
+                       const vector<float>& weights)
+{
+    if(mPrefixSize < 1 || mPrefixSize > 4)
+    {
+        throw std::runtime_error("Invalid block size specified.");
+    }
+    if(ids.size() != patternList.size() || weights.size() != patternList.size())
+    {
+        throw std::runtime_error("Pattern ids or weights do not match the pattern list.");
+    }
+    vector<size_t> order(patternList.size());
+    uint32_t maxId = 0;
+    for(size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+        maxId = max(maxId, ids[i]);
+    }
+    // The stable order keeps the first id of a duplicated pattern in front.
+    stable_sort(order.begin(), order.end(), PatternLess(patternList));
+    vector<size_t> kept;
+    kept.push_back(0); // Put an empty string first so that the index of patterns are not 0.
+    uint64_t byteCount = 0;
+    for(size_t i = 0; i < order.size(); ++i)
+    {
+        if(i > 0 && patternList[order[i]] == patternList[order[i - 1]])
+        {
+            continue;
+        }
+        kept.push_back(order[i]);
+        byteCount += patternList[order[i]].size();
+    }
+    size_t patternCount = kept.size();
+    size_t idCount = patternList.empty() ? 0 : (size_t)maxId + 1;
+
+    vector<uint64_t> keys(patternCount, 0);
+    vector<uint8_t> prefixLengths(patternCount, 0);
+    vector<uint32_t> suffixStart(patternCount, 0);
+    uint64_t tableEntries[4] = {0, 0, 0, 0};
+    for(size_t i = 1; i < patternCount; ++i)
     {
-        const string& s = mPatternList[i];
+        const string& s = patternList[kept[i]];
         size_t start;
         int len;
         uint64_t pattern = 0;
@@ -68,26 +221,276 @@ void PatternScan::Init(const vector<string>& patternList)
             }
             pattern = (pattern << 16) | unicode;
         }
-        if(len == 0)
+        keys[i] = pattern;
+        prefixLengths[i] = len;
+        suffixStart[i] = len < mPrefixSize ? s.size() : start;
+        if(len > 0)
         {
-            mPatternSurfixList.push_back("");
+            ++tableEntries[len - 1];
         }
-        else if(len < mPrefixSize)
+    }
+
+    CompiledHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, sCompiledMagic, sizeof(header.magic));
+    header.version = COMPILED_VERSION;
+    header.prefixSize = mPrefixSize;
+    header.patternCount = patternCount;
+    header.idCount = idCount;
+    header.byteCount = byteCount;
+    uint64_t offset = Align8(sizeof(CompiledHeader));
+    header.patternOffsets = offset;
+    offset = Align8(offset + (patternCount + 1) * sizeof(uint64_t));
+    header.patternBytes = offset;
+    offset = Align8(offset + byteCount);
+    header.suffixStart = offset;
+    offset = Align8(offset + patternCount * sizeof(uint32_t));
+    header.patternIds = offset;
+    offset = Align8(offset + patternCount * sizeof(uint32_t));
+    header.patternAscii = offset;
+    offset = Align8(offset + patternCount);
+    header.idIndex = offset;
+    offset = Align8(offset + idCount * sizeof(uint32_t));
+    header.weights = offset;
+    offset = Align8(offset + idCount * sizeof(float));
+    for(int t = 0; t < mPrefixSize; ++t)
+    {
+        uint64_t capacity = 2;
+        while(capacity < 2 * tableEntries[t])
         {
-            mSmallPatternMaps[len - 1][pattern] = i;
-            mPatternSurfixList.push_back("");
+            capacity <<= 1;
         }
-        else
+        header.tables[t] = offset;
+        header.tableCapacity[t] = capacity;
+        offset += capacity * sizeof(Slot);
+    }
+    header.size = offset;
+
+    Release();
+    mImage.assign(offset / sizeof(uint64_t), 0);
+    char* base = reinterpret_cast<char*>(&mImage[0]);
+    memcpy(base, &header, sizeof(header));
+    uint64_t* patternOffsets = reinterpret_cast<uint64_t*>(base + header.patternOffsets);
+    char* patternBytes = base + header.patternBytes;
+    uint32_t* patternIds = reinterpret_cast<uint32_t*>(base + header.patternIds);
+    uint8_t* patternAscii = reinterpret_cast<uint8_t*>(base + header.patternAscii);
+    uint32_t* idIndex = reinterpret_cast<uint32_t*>(base + header.idIndex);
+    float* idWeights = reinterpret_cast<float*>(base + header.weights);
+    memcpy(base + header.suffixStart, &suffixStart[0], patternCount * sizeof(uint32_t));
+    patternOffsets[0] = 0;
+    patternIds[0] = 0;
+    patternAscii[0] = 1;
+    patternOffsets[1] = 0;
+    for(size_t i = 1; i < patternCount; ++i)
+    {
+        patternOffsets[i + 1] = patternOffsets[i] + patternList[kept[i]].size();
+    }
+    for(size_t i = 1; i < patternCount; ++i)
+    {
+        const string& s = patternList[kept[i]];
+        memcpy(patternBytes + patternOffsets[i], s.data(), s.size());
+        uint32_t id = ids[kept[i]];
+        patternIds[i] = id;
+        patternAscii[i] = IsAscii(s);
+        idIndex[id] = i;
+        idWeights[id] = weights[kept[i]];
+        if(prefixLengths[i] == 0)
+        {
+            continue;
+        }
+        int t = prefixLengths[i] - 1;
+        Slot* slots = reinterpret_cast<Slot*>(base + header.tables[t]);
+        uint64_t mask = header.tableCapacity[t] - 1;
+        uint64_t h = (keys[i] * 0x9E3779B97F4A7C15ull) >> 32;
+        while(slots[h & mask].key != 0 && slots[h & mask].key != keys[i])
+        {
+            ++h;
+        }
+        Slot& slot = slots[h & mask];
+        if(slot.key == 0 || t < mPrefixSize - 1)
         {
-            pair<size_t, size_t>& entry = mPrefixMap[pattern];
-            if(entry.first == 0)
+            slot.key = keys[i];
+            slot.first = i;
+        }
+        slot.last = i + 1;
+    }
+    Attach(base, offset);
+}
+
+void PatternScan::Attach(const char* base, size_t size)
+{
+    const CompiledHeader* header = reinterpret_cast<const CompiledHeader*>(base);
+    if(size < sizeof(CompiledHeader) || memcmp(header->magic, sCompiledMagic, sizeof(sCompiledMagic)) != 0
+       || header->version != COMPILED_VERSION)
+    {
+        throw std::runtime_error("Not a compiled pattern dictionary.");
+    }
+    bool valid = header->size <= size && header->prefixSize >= 1 && header->prefixSize <= 4
+        && Within(header->patternOffsets, header->patternCount + 1, sizeof(uint64_t), header->size)
+        && Within(header->patternBytes, header->byteCount, 1, header->size)
+        && Within(header->suffixStart, header->patternCount, sizeof(uint32_t), header->size)
+        && Within(header->patternIds, header->patternCount, sizeof(uint32_t), header->size)
+        && Within(header->patternAscii, header->patternCount, 1, header->size)
+        && Within(header->idIndex, header->idCount, sizeof(uint32_t), header->size)
+        && Within(header->weights, header->idCount, sizeof(float), header->size);
+    for(uint32_t t = 0; valid && t < header->prefixSize; ++t)
+    {
+        uint64_t capacity = header->tableCapacity[t];
+        valid = capacity > 0 && (capacity & (capacity - 1)) == 0
+            && Within(header->tables[t], capacity, sizeof(Slot), header->size);
+    }
+    if(!valid || !ValidContents(base))
+    {
+        throw std::runtime_error("Corrupted compiled pattern dictionary.");
+    }
+    mPrefixSize = header->prefixSize;
+    mBase = base;
+    mPatternCount = header->patternCount;
+    mIdCount = header->idCount;
+    mPatternOffsets = reinterpret_cast<const uint64_t*>(base + header->patternOffsets);
+    mPatternBytes = base + header->patternBytes;
+    mSuffixStart = reinterpret_cast<const uint32_t*>(base + header->suffixStart);
+    mPatternIds = reinterpret_cast<const uint32_t*>(base + header->patternIds);
+    mPatternIsAscii = reinterpret_cast<const uint8_t*>(base + header->patternAscii);
+    mIdIndex = reinterpret_cast<const uint32_t*>(base + header->idIndex);
+    mWeights = reinterpret_cast<const float*>(base + header->weights);
+    for(uint32_t t = 0; t < mPrefixSize; ++t)
+    {
+        mTables[t] = reinterpret_cast<const Slot*>(base + header->tables[t]);
+        mTableMask[t] = header->tableCapacity[t] - 1;
+    }
+}
+
+bool PatternScan::ValidContents(const char* base)
+{
+    const CompiledHeader* header = reinterpret_cast<const CompiledHeader*>(base);
+    uint64_t patternCount = header->patternCount;
+    uint64_t idCount = header->idCount;
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>(base + header->patternOffsets);
+    const uint32_t* suffixStart = reinterpret_cast<const uint32_t*>(base + header->suffixStart);
+    const uint32_t* patternIds = reinterpret_cast<const uint32_t*>(base + header->patternIds);
+    const uint32_t* idIndex = reinterpret_cast<const uint32_t*>(base + header->idIndex);
+    // Pattern 0 is "", the others are slices of the pattern bytes in order.
+    if(patternCount == 0 || offsets[0] != 0 || offsets[patternCount] > header->byteCount)
+    {
+        return false;
+    }
+    for(uint64_t i = 0; i < patternCount; ++i)
+    {
+        if(offsets[i + 1] < offsets[i] || suffixStart[i] > offsets[i + 1] - offsets[i]
+           || (i > 0 && patternIds[i] >= idCount))
+        {
+            return false;
+        }
+    }
+    for(uint64_t id = 0; id < idCount; ++id)
+    {
+        if(idIndex[id] >= patternCount)
+        {
+            return false;
+        }
+    }
+    // Find() stops at an empty slot, so every table needs one.
+    for(uint32_t t = 0; t < header->prefixSize; ++t)
+    {
+        const Slot* slots = reinterpret_cast<const Slot*>(base + header->tables[t]);
+        bool empty = false;
+        for(uint64_t s = 0; s < header->tableCapacity[t]; ++s)
+        {
+            if(slots[s].key == 0)
             {
-                entry.first = i;
+                empty = true;
             }
-            entry.second = i + 1;
-            mPatternSurfixList.push_back(s.substr(start));
+            else if(slots[s].first == 0 || slots[s].first >= slots[s].last || slots[s].last > patternCount)
+            {
+                return false;
+            }
+        }
+        if(!empty)
+        {
+            return false;
         }
     }
+    return true;
+}
+
+void PatternScan::Release()
+{
+    if(mMapped != NULL)
+    {
+        munmap(mMapped, mMappedSize);
+    }
+    mMapped = NULL;
+    mMappedSize = 0;
+    mBase = NULL;
+    mPatternCount = 0;
+    mIdCount = 0;
+    mPatternOffsets = NULL;
+    mPatternBytes = NULL;
+    mSuffixStart = NULL;
+    mPatternIds = NULL;
+    mPatternIsAscii = NULL;
+    mIdIndex = NULL;
+    mWeights = NULL;
+    for(int t = 0; t < 4; ++t)
+    {
+        mTables[t] = NULL;
+        mTableMask[t] = 0;
+    }
+}
+
+void PatternScan::SaveCompiled(const std::string& filename) const
+{
+    if(mBase == NULL)
+    {
+        throw std::runtime_error("No pattern dictionary to save.");
+    }
+    ofstream ofs(filename.c_str(), ios::binary);
+    ofs.write(mBase, reinterpret_cast<const CompiledHeader*>(mBase)->size);
+    if(!ofs)
+    {
+        throw std::runtime_error(string("Cannot write compiled pattern dictionary: ") + filename);
+    }
+}
+
+void PatternScan::LoadCompiled(const std::string& filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        throw std::runtime_error(string("Cannot open compiled pattern dictionary: ") + filename);
+    }
+    struct stat st;
+    void* mapped = MAP_FAILED;
+    if(fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        mapped = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if(mapped == MAP_FAILED)
+    {
+        throw std::runtime_error(string("Cannot map compiled pattern dictionary: ") + filename);
+    }
+    Release();
+    vector<uint64_t>().swap(mImage);
+    mMapped = mapped;
+    mMappedSize = st.st_size;
+    try
+    {
+        Attach(static_cast<const char*>(mapped), st.st_size);
+    }
+    catch(...)
+    {
+        Release();
+        throw;
+    }
+}
+
+bool PatternScan::IsCompiled(const std::string& filename)
+{
+    char magic[sizeof(sCompiledMagic)];
+    ifstream ifs(filename.c_str(), ios::binary);
+    return ifs.read(magic, sizeof(magic)) && memcmp(magic, sCompiledMagic, sizeof(magic)) == 0;
 }
 void PatternScan::Init(const string& fileName)
 {
@@ -104,8 +507,10 @@ void PatternScan::Init(const string& fileName)
     }
     Init(patternList);
 }
-PatternScan::PatternScan(const char* fileName, uint8_t prefixSize) : mPrefixSize(prefixSize)
+PatternScan::PatternScan(const char* fileName, uint8_t prefixSize):
+    mPrefixSize(prefixSize), mMapped(NULL), mMappedSize(0)
 {
+    Release();
     if(prefixSize < 1 || prefixSize > 4)
     {
         throw std::runtime_error("Invalid block size specified.");
@@ -162,68 +567,186 @@ inline uint16_t PatternScan::GetNextUtf8Char(const std::string& s, size_t& start
     }
 }
 
-bool PatternScan::EnglishWordNotMatch(const string& text, const string& astr, size_t start)
+size_t PatternScan::DecodeBlock(const std::string& s, size_t& start, uint16_t* codes, size_t* ends,
+                                size_t capacity)
 {
-    bool isAscii = IsAscii(astr);
+    const char* p = s.data();
+    size_t size = s.size();
+    size_t n = 0;
+    while(n < capacity && start < size)
+    {
+        // Runs of ASCII bytes are widened to code points a vector at a time,
+        // the first byte with the top bit set falls through to the table decoder.
+#ifdef __AVX2__
+        while(capacity - n >= 32 && size - start >= 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + start));
+            if(_mm256_movemask_epi8(v) != 0)
+            {
+                break;
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(codes + n),
+                                _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(codes + n + 16),
+                                _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+            for(size_t i = 0; i < 32; ++i)
+            {
+                ends[n + i] = start + i + 1;
+            }
+            n += 32;
+            start += 32;
+        }
+#endif
+#ifdef __SSE2__
+        const __m128i zero = _mm_setzero_si128();
+        while(capacity - n >= 16 && size - start >= 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + start));
+            if(_mm_movemask_epi8(v) != 0)
+            {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + n), _mm_unpacklo_epi8(v, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(codes + n + 8), _mm_unpackhi_epi8(v, zero));
+            for(size_t i = 0; i < 16; ++i)
+            {
+                ends[n + i] = start + i + 1;
+            }
+            n += 16;
+            start += 16;
+        }
+#endif
+        if(n == capacity || start == size)
+        {
+            break;
+        }
+        uint8_t ch = static_cast<uint8_t>(p[start]);
+        if(ch < 0x80)
+        {
+            codes[n] = ch;
+            ++start;
+        }
+        else
+        {
+            codes[n] = GetNextUtf8Char(s, start);
+        }
+        ends[n++] = start;
+    }
+    return n;
+}
+
+bool PatternScan::EnglishWordNotMatch(const string& text, bool isAscii, size_t length, int start)
+{
+    if(!isAscii)
+    {
+        return false;
+    }
     int st = start - 1;
     bool startok = st >= 0 ? isspace(text[st]) : true;
-    int ed = start + astr.size();
+    int ed = start + length;
     bool endok = ed < (int)text.size() ? isspace(text[ed]) : true;
-    return (isAscii && (!startok || !endok));
+    return !startok || !endok;
+}
+
+namespace
+{
+struct StringSink
+{
+    map<string, uint32_t>& matches;
+    const uint64_t* offsets;
+    const char* bytes;
+    StringSink(map<string, uint32_t>& m, const uint64_t* o, const char* b): matches(m), offsets(o), bytes(b) {}
+    size_t Add(size_t i)
+    {
+        ++matches[string(bytes + offsets[i], offsets[i + 1] - offsets[i])];
+        return matches.size();
+    }
+};
+struct IdSink
+{
+    MatchCounter& matches;
+    const uint32_t* ids;
+    IdSink(MatchCounter& m, const uint32_t* i): matches(m), ids(i) {}
+    size_t Add(size_t i)
+    {
+        return matches.Add(ids[i]);
+    }
+};
 }
 
 int PatternScan::Scan(const string& text, map<string, uint32_t>& matches, uint32_t threshold) const
 {
-    //matches.clear();
+    StringSink sink(matches, mPatternOffsets, mPatternBytes);
+    return ScanInto(text, sink, threshold);
+}
+
+int PatternScan::Scan(const string& text, MatchCounter& matches, uint32_t threshold) const
+{
+    matches.Reserve(mIdCount);
+    IdSink sink(matches, mPatternIds);
+    return ScanInto(text, sink, threshold);
+}
+
+template <class Sink>
+int PatternScan::ScanInto(const string& text, Sink& sink, uint32_t threshold) const
+{
+    MLPLUS_PROFILE_SCOPE("PatternScan::Scan");
+    MLPLUS_PROFILE_COUNT("PatternScan::Scan bytes", text.size());
     int result = 0;
-    if(mSmallPatternMaps.empty()) return 0;
+    if(mBase == NULL) return 0;
     uint64_t pattern = 0;
-    size_t start = 0;
-    while(start < text.size())
+    uint16_t codes[DECODE_BLOCK];
+    size_t ends[DECODE_BLOCK];
+    size_t next = 0;
+    while(next < text.size())
     {
-        pattern = ((pattern << 16) & sPatternMask[mPrefixSize - 1]) | GetNextUtf8Char(text, start);
-        for(uint8_t len = 0; len < mPrefixSize - 1; ++len)
+        size_t count = DecodeBlock(text, next, codes, ends, DECODE_BLOCK);
+        for(size_t k = 0; k < count; ++k)
         {
-            map<uint64_t, size_t>::const_iterator iter = mSmallPatternMaps[len].find(pattern & sPatternMask[len]);
-            if(iter != mSmallPatternMaps[len].end())
+            size_t start = ends[k];
+            pattern = ((pattern << 16) & sPatternMask[mPrefixSize - 1]) | codes[k];
+            for(uint8_t len = 0; len < mPrefixSize - 1; ++len)
             {
-                int posSt = start - len;
-                if(EnglishWordNotMatch(text, mPatternList[iter->second], posSt))
-                {
-                    continue;
-                }
-                ++matches[mPatternList[iter->second]];
-                result++;
-                if(matches.size() >= threshold)
+                const Slot* slot = Find(len, pattern & sPatternMask[len]);
+                if(slot != NULL)
                 {
-                    return result;
-                }
-            }
-        }
-        map<uint64_t, pair<size_t, size_t> >::const_iterator iter = mPrefixMap.find(pattern);
-        if(iter != mPrefixMap.end())
-        {
-            for(size_t i = iter->second.first; i < iter->second.second; ++i)
-            {
-
-                if(text.compare(start, mPatternSurfixList[i].size(), mPatternSurfixList[i]) == 0)
-                {
-                    //for english
-                    int posSt = start - mPrefixSize;
-                    if(EnglishWordNotMatch(text, mPatternList[i], posSt))
+                    size_t i = slot->first;
+                    int posSt = start - len - 1;
+                    if(EnglishWordNotMatch(text, mPatternIsAscii[i], mPatternOffsets[i + 1] - mPatternOffsets[i], posSt))
                     {
                         continue;
                     }
-                    ++matches[mPatternList[i]];
                     result++;
-                    if(matches.size() >= threshold)
+                    if(sink.Add(i) >= threshold)
                     {
                         return result;
                     }
                 }
             }
+            const Slot* slot = Find(mPrefixSize - 1, pattern);
+            if(slot != NULL)
+            {
+                for(size_t i = slot->first; i < slot->last; ++i)
+                {
+                    const char* suffix = mPatternBytes + mPatternOffsets[i] + mSuffixStart[i];
+                    size_t suffixLength = mPatternOffsets[i + 1] - mPatternOffsets[i] - mSuffixStart[i];
+                    if(start + suffixLength <= text.size() && memcmp(text.data() + start, suffix, suffixLength) == 0)
+                    {
+                        //for english
+                        int posSt = start - mPrefixSize;
+                        if(EnglishWordNotMatch(text, mPatternIsAscii[i], mPatternOffsets[i + 1] - mPatternOffsets[i], posSt))
+                        {
+                            continue;
+                        }
+                        result++;
+                        if(sink.Add(i) >= threshold)
+                        {
+                            return result;
+                        }
+                    }
+                }
+            }
         }
     }
     return result;
 }
-
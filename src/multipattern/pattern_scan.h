@@ -1,16 +1,29 @@
 #ifndef UTILITY_PATTERNSCAN_H
 #define UTILITY_PATTERNSCAN_H
+#include <stdint.h>
 #include <vector>
 #include <string>
 #include <map>
+#include "match_counter.h"
 class PatternScan
 {
 public:
     PatternScan(uint8_t prefixSize = 3);
-    ~PatternScan(){}
+    ~PatternScan();
     void Load(const std::string& filename);
     void Init(const std::string& patternFileName);
     void Init(const std::vector<std::string>& patternList);
+    /**
+     * @brief  load a feature file, one "word [weight]" per line.  The id of a word is its
+     *         line number counted from 1, the weight defaults to 1.
+     */
+    void LoadWeighted(const std::string& filename);
+    /**
+     * @brief  init with the id and the weight of every pattern.  A pattern listed more than
+     *         once keeps its first id.  Init(patternList) uses the list index as id.
+     */
+    void Init(const std::vector<std::string>& patternList, const std::vector<uint32_t>& ids,
+              const std::vector<float>& weights);
     /**
      * @brief  constructor, it may throw exceptions
      * @param  fileName the file name of pattern list
@@ -18,6 +31,22 @@ public:
      *         the default value is 3, the allowed values are 1, 2, 3 or 4.
      */
     PatternScan(const char* fileName, uint8_t prefixSize = 3);
+    /**
+     * @brief  write the built matcher to a compiled dictionary file.  The file holds flat,
+     *         offset based tables only, so it can be mapped at any address.
+     */
+    void SaveCompiled(const std::string& filename) const;
+    /**
+     * @brief  mmap a file written by SaveCompiled read-only and scan straight from it.  The
+     *         pages are shared by every process mapping the same file.  Loading checks every
+     *         section and table once, so a truncated or corrupt file throws instead of
+     *         crashing or hanging a later scan; that check reads the whole file.
+     */
+    void LoadCompiled(const std::string& filename);
+    /**
+     * @brief  whether a file starts like a compiled dictionary
+     */
+    static bool IsCompiled(const std::string& filename);
     /**
      * @brief  scan a text to find all the matched pattern within it
      * @param  text a text to be scanned
@@ -28,7 +57,42 @@ public:
      */
     int Scan(const std::string& text, std::map<std::string, uint32_t>& matches,
              uint32_t threshold = 0xFFFFFFFF) const;
+    /**
+     * @brief  scan a text and count the matches by pattern id, nothing is allocated once
+     *         the counter has grown to the text.  The counter is not cleared.
+     */
+    int Scan(const std::string& text, MatchCounter& matches,
+             uint32_t threshold = 0xFFFFFFFF) const;
+    /**
+     * @brief  one more than the largest pattern id
+     */
+    inline size_t IdCount() const;
+    inline std::string Pattern(uint32_t id) const;
+    /**
+     * @brief  the UTF-8 bytes of a pattern without copying them, not 0 terminated
+     */
+    inline const char* PatternBytes(uint32_t id, size_t& length) const;
+    inline float Weight(uint32_t id) const;
 private:
+    struct CompiledHeader;
+    struct Slot
+    {
+        uint64_t key; // 0 for an empty slot
+        uint32_t first;
+        uint32_t last;
+    };
+    inline const Slot* Find(uint8_t table, uint64_t key) const;
+    void Attach(const char* base, size_t size);
+    /**
+     * @brief  whether the tables of an image with valid sections index inside it: pattern
+     *         offsets rise within the pattern bytes, ids and slot ranges stay in bounds and
+     *         every hash table has an empty slot to end a probe
+     */
+    static bool ValidContents(const char* base);
+    void Release();
+
+    template <class Sink>
+    int ScanInto(const std::string& text, Sink& sink, uint32_t threshold) const;
 
     /**
      * @brief  get the unicode codepoint of the next UTF-8 character.  If there are invalid UTF-9
@@ -43,21 +107,92 @@ private:
      */
     static inline uint16_t GetNextUtf8Char(const std::string& s, size_t& start);
 
+    /**
+     * @brief  decode up to capacity chars starting at byte start, which is advanced past them.
+     *         Runs of ASCII bytes are converted 16 (SSE2) or 32 (AVX2) bytes at a time, other
+     *         bytes go through GetNextUtf8Char.
+     * @param  codes receives the code point of every char
+     * @param  ends receives the byte offset just past every char
+     * @return the number of decoded chars
+     */
+    static size_t DecodeBlock(const std::string& s, size_t& start, uint16_t* codes, size_t* ends,
+                              size_t capacity);
+
     static inline bool IsAscii(const std::string& s);
-    static bool EnglishWordNotMatch(const std::string& text, const std::string& astr, size_t start);
+    static bool EnglishWordNotMatch(const std::string& text, bool isAscii, size_t length, int start);
+
+    static const size_t DECODE_BLOCK = 256;
 
     static const uint8_t sCharTable[256];
     static const uint8_t sCharMask[7];
     static const uint64_t sPatternMask[4];
 
     uint8_t mPrefixSize;
-    std::vector<std::string> mPatternList; // The list of all the pattern words
-    std::vector<std::string> mPatternSurfixList; // The list of pattern surfixes for check use
-    std::vector<std::map<uint64_t, size_t> > mSmallPatternMaps; // The map for short patterns
-    std::map<uint64_t, std::pair<size_t, size_t> > mPrefixMap; // The prefix map
+    std::vector<uint64_t> mImage; // The compiled dictionary built by Init
+    void* mMapped; // The compiled dictionary mapped by LoadCompiled
+    size_t mMappedSize;
+    // Views into the compiled dictionary, see pattern_scan.cpp for its layout
+    const char* mBase;
+    size_t mPatternCount;
+    size_t mIdCount;
+    const uint64_t* mPatternOffsets; // pattern i is mPatternBytes[mPatternOffsets[i], mPatternOffsets[i + 1])
+    const char* mPatternBytes;
+    const uint32_t* mSuffixStart; // The byte offset of the suffix after the prefix
+    const uint32_t* mPatternIds;
+    const uint8_t* mPatternIsAscii; // Whether the pattern is plain ASCII, see EnglishWordNotMatch
+    const uint32_t* mIdIndex; // The pattern index of every id, 0 for unused ids
+    const float* mWeights; // The weight of every id
+    const Slot* mTables[4]; // Open addressing tables keyed by the first 1 .. mPrefixSize chars
+    uint64_t mTableMask[4];
 
     PatternScan(const PatternScan &);
     PatternScan& operator=(const PatternScan &);
 
 };
+
+inline size_t PatternScan::IdCount() const
+{
+    return mIdCount;
+}
+
+inline const char* PatternScan::PatternBytes(uint32_t id, size_t& length) const
+{
+    uint32_t i = mIdIndex[id];
+    length = mPatternOffsets[i + 1] - mPatternOffsets[i];
+    return mPatternBytes + mPatternOffsets[i];
+}
+
+inline std::string PatternScan::Pattern(uint32_t id) const
+{
+    size_t length;
+    const char* bytes = PatternBytes(id, length);
+    return std::string(bytes, length);
+}
+
+inline float PatternScan::Weight(uint32_t id) const
+{
+    return mWeights[id];
+}
+
+inline const PatternScan::Slot* PatternScan::Find(uint8_t table, uint64_t key) const
+{
+    if(key == 0)
+    {
+        return NULL;
+    }
+    const Slot* slots = mTables[table];
+    uint64_t mask = mTableMask[table];
+    for(uint64_t h = (key * 0x9E3779B97F4A7C15ull) >> 32;; ++h)
+    {
+        const Slot& slot = slots[h & mask];
+        if(slot.key == key)
+        {
+            return &slot;
+        }
+        if(slot.key == 0)
+        {
+            return NULL;
+        }
+    }
+}
 #endif
@@ -0,0 +1,200 @@
+#include <sys/time.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "pattern_scan.h"
+#include "aho_corasick.h"
+using namespace std;
+
+/**
+ * Compares PatternScan::Scan with AhoCorasick::Scan on the same patterns and
+ * texts, checks both report the same match counts and prints the time each
+ * took.
+ *
+ *   scan_benchmark [pattern_file text_file [rounds]]
+ *
+ * Without files a synthetic dictionary of ASCII and CJK words and random
+ * lines built from them are used.
+ */
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static string randomWord(bool cjk)
+{
+    string w;
+    int len = 2 + rand() % 6;
+    for(int i = 0; i < len; ++i)
+    {
+        if(cjk)
+        {
+            //U+4E00 .. U+4EFF, three UTF-8 bytes
+            unsigned int cp = 0x4E00 + rand() % 0x100;
+            w += (char)(0xE0 | (cp >> 12));
+            w += (char)(0x80 | ((cp >> 6) & 0x3F));
+            w += (char)(0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            w += (char)('a' + rand() % 26);
+        }
+    }
+    return w;
+}
+
+static void synthesize(vector<string>& patterns, vector<string>& texts)
+{
+    srand(20130601);
+    set<string> words;
+    while(words.size() < 100000)
+    {
+        words.insert(randomWord(words.size() % 2 == 0));
+    }
+    patterns.assign(words.begin(), words.end());
+    for(int i = 0; i < 20000; ++i)
+    {
+        string line;
+        int n = 10 + rand() % 40;
+        for(int j = 0; j < n; ++j)
+        {
+            line += j % 3 == 0 ? patterns[rand() % patterns.size()] : randomWord(rand() % 2 == 0);
+            line += ' ';
+        }
+        texts.push_back(line);
+    }
+}
+
+static void readLines(const char* filename, vector<string>& lines, bool firstToken)
+{
+    ifstream ifs(filename);
+    if(!ifs)
+    {
+        cerr << "cannot open " << filename << endl;
+        exit(1);
+    }
+    string line;
+    while(getline(ifs, line))
+    {
+        if(!firstToken)
+        {
+            lines.push_back(line);
+            continue;
+        }
+        size_t b = line.find_first_not_of(" \t\r\n");
+        if(b == string::npos || line[b] == '#')
+        {
+            continue;
+        }
+        lines.push_back(line.substr(b, line.find_first_of(" \t\r\n", b) - b));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    vector<string> patterns;
+    vector<string> texts;
+    int rounds = 3;
+    if(argc >= 3)
+    {
+        readLines(argv[1], patterns, true);
+        readLines(argv[2], texts, false);
+        if(argc > 3)
+        {
+            rounds = atoi(argv[3]);
+        }
+    }
+    else
+    {
+        synthesize(patterns, texts);
+    }
+    size_t bytes = 0;
+    for(size_t i = 0; i < texts.size(); ++i)
+    {
+        bytes += texts[i].size();
+    }
+
+    double t = now();
+    PatternScan scanner;
+    scanner.Init(patterns);
+    double prefixBuild = now() - t;
+    t = now();
+    AhoCorasick automaton;
+    automaton.Init(patterns);
+    double acBuild = now() - t;
+    cout << patterns.size() << " patterns, " << automaton.StateCount() << " states, "
+         << texts.size() << " lines, " << bytes << " bytes" << endl;
+    cout << "build   PatternScan " << prefixBuild << "s  AhoCorasick " << acBuild << "s" << endl;
+
+    size_t prefixMatches = 0;
+    t = now();
+    for(int r = 0; r < rounds; ++r)
+    {
+        for(size_t i = 0; i < texts.size(); ++i)
+        {
+            map<string, uint32_t> matches;
+            prefixMatches += scanner.Scan(texts[i], matches);
+        }
+    }
+    double prefixScan = now() - t;
+
+    MatchCounter counter;
+    t = now();
+    for(int r = 0; r < rounds; ++r)
+    {
+        for(size_t i = 0; i < texts.size(); ++i)
+        {
+            counter.Clear();
+            scanner.Scan(texts[i], counter);
+        }
+    }
+    double prefixIdScan = now() - t;
+
+    size_t acMatches = 0;
+    vector<uint32_t> ids;
+    t = now();
+    for(int r = 0; r < rounds; ++r)
+    {
+        for(size_t i = 0; i < texts.size(); ++i)
+        {
+            ids.clear();
+            acMatches += automaton.Scan(texts[i], ids);
+        }
+    }
+    double acScan = now() - t;
+    double mb = bytes * rounds / 1048576.0;
+    cout << "scan    PatternScan " << prefixScan << "s (" << mb / prefixScan << " MB/s, "
+         << prefixMatches << " matches)  PatternScan ids " << prefixIdScan << "s ("
+         << mb / prefixIdScan << " MB/s)  AhoCorasick " << acScan << "s (" << mb / acScan
+         << " MB/s, " << acMatches << " matches)" << endl;
+
+    size_t mismatches = 0;
+    for(size_t i = 0; i < texts.size(); ++i)
+    {
+        map<string, uint32_t> expected;
+        scanner.Scan(texts[i], expected);
+        ids.clear();
+        automaton.Scan(texts[i], ids);
+        map<string, uint32_t> actual;
+        for(size_t j = 0; j < ids.size(); ++j)
+        {
+            ++actual[automaton.Pattern(ids[j])];
+        }
+        if(expected != actual && mismatches++ < 5)
+        {
+            cerr << "match mismatch on line " << i + 1 << ": " << texts[i] << endl;
+        }
+    }
+    if(mismatches > 0)
+    {
+        cerr << mismatches << " lines differ" << endl;
+        return 1;
+    }
+    return 0;
+}
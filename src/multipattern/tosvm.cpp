@@ -1,55 +1,167 @@
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
-#include <algorithm> 
+#include <algorithm>
 #include <vector>
+#include <memory>
 #include "pattern_scan.h"
-#include <boost/foreach.hpp>
-#include <boost/unordered_map.hpp>
-#include <boost/lexical_cast.hpp>
-#include <boost/algorithm/string.hpp>
+#include "feature_hasher.h"
+#include "thread_pool.h"
+#include "line_pipeline.h"
 #define STRIP_FLAG_HELP 1
 #include <gflags/gflags.h>
 using namespace std;
-using namespace boost;
-DEFINE_string(feature, "", "feature file name");
+DEFINE_string(feature, "", "feature file name, or a dictionary compiled from it by compile_dict");
 DEFINE_string(input, "", "input file name");
-struct WordInfo
+DEFINE_int32(hash_bits, 0, "hash the matched words into 2^hash_bits feature ids, 0 keeps the word ids");
+DEFINE_int32(hash_count, 1, "number of feature ids every word is hashed to");
+DEFINE_bool(hash_signed, false, "let the hash pick the sign of every hashed value; the naive Bayes tools need unsigned counts");
+DEFINE_int32(threads, 0, "number of scanner threads, 0 uses every processor");
+DEFINE_int32(batch_lines, 4096, "number of input lines handed to a scanner at a time");
+DEFINE_string(csr, "", "write a binary CSR dataset to <csr>.indptr (uint64 row offsets), "
+    "<csr>.indices (int32 feature ids) and <csr>.values (float) instead of text");
+
+class Featurizer
 {
-  float weight;
-  int id;
-  friend bool operator < (const WordInfo& l, const WordInfo& r)
-  {
-      return l.id < r.id;
-  }
-  friend bool operator > (const WordInfo& l, const WordInfo& r)
-  {
-      return l.id > r.id;
-  }
+public:
+    Featurizer(const PatternScan& scanner, const mlplus::FeatureHasher* hasher):
+        mScanner(scanner), mHasher(hasher)
+    {
+    }
+    /**
+     * @brief the features of one line ordered by feature id
+     */
+    void featurize(const string& line, vector<int>& ids, vector<float>& values)
+    {
+        ids.clear();
+        values.clear();
+        mMatches.Clear();
+        mScanner.Scan(line, mMatches);
+        if (mHasher != NULL)
+        {
+            //feature ids start at 1 like the word ids
+            mHashed.clear();
+            for (size_t i = 0; i < mMatches.Size(); ++i)
+            {
+                size_t length;
+                const char* word = mScanner.PatternBytes(mMatches[i].first, length);
+                mHasher->add(word, length,
+                    mMatches[i].second * mScanner.Weight(mMatches[i].first), mHashed);
+            }
+            mlplus::FeatureHasher::finish(mHashed, ids, values, 1);
+            return;
+        }
+        mMatches.Sort();
+        for (size_t i = 0; i < mMatches.Size(); ++i)
+        {
+            ids.push_back(mMatches[i].first);
+            values.push_back(mMatches[i].second * mScanner.Weight(mMatches[i].first));
+        }
+    }
+private:
+    const PatternScan& mScanner;
+    const mlplus::FeatureHasher* mHasher;
+    MatchCounter mMatches;
+    vector<mlplus::FeatureHasher::HashedFeature> mHashed;
 };
-bool load(const string& filename, vector<string>& features,
-    unordered_map<string, WordInfo>& featureWeight)
+
+/**
+ * featurizes the batches of one scanner thread with its own scratch buffers
+ * and the shared read-only PatternScan
+ */
+class ScanWorker : public LineBatchProcessor
 {
-    ifstream ifs(filename.c_str());
-    string line;
-    vector<string> keys;
-    int wordid = 1;
-    while(getline(ifs, line))
-    {
-        boost::split(keys, line, boost::is_any_of("\t "));
-        string& word = keys[0]; 
-        float weight = 1;
-        if (keys.size() > 1)
+public:
+    ScanWorker(const PatternScan& scanner, const mlplus::FeatureHasher* hasher, bool csr):
+        mFeaturizer(scanner, hasher), mCsr(csr)
+    {
+    }
+    /*override*/ void process(LineBatch& batch)
+    {
+        batch.text.clear();
+        batch.rowSizes.clear();
+        batch.indices.clear();
+        batch.values.clear();
+        for (size_t i = 0; i < batch.count; ++i)
         {
-            weight = boost::lexical_cast<float>(keys[1]);
+            mFeaturizer.featurize(batch.lines[i], mIds, mValues);
+            if (mCsr)
+            {
+                batch.rowSizes.push_back(mIds.size());
+                batch.indices.insert(batch.indices.end(), mIds.begin(), mIds.end());
+                batch.values.insert(batch.values.end(), mValues.begin(), mValues.end());
+                continue;
+            }
+            char buffer[64];
+            int len = snprintf(buffer, sizeof(buffer), "%lu\t", (unsigned long)(batch.firstLine + i + 1));
+            batch.text.append(buffer, len);
+            for (size_t j = 0; j < mIds.size(); ++j)
+            {
+                len = snprintf(buffer, sizeof(buffer), "%d:%g ", mIds[j], mValues[j]);
+                batch.text.append(buffer, len);
+            }
+            batch.text += '\n';
         }
-        WordInfo info;
-        info.weight = weight;
-        info.id = wordid++;
-        features.push_back(word); 
-        featureWeight[word] = info;
     }
-    return true;
+private:
+    Featurizer mFeaturizer;
+    bool mCsr;
+    vector<int> mIds;
+    vector<float> mValues;
+};
+
+class OutputWriter : public LineBatchWriter
+{
+public:
+    OutputWriter(FILE* text, FILE* indptr, FILE* indices, FILE* values):
+        mText(text), mIndptr(indptr), mIndices(indices), mValues(values), mNnz(0)
+    {
+        if (mIndptr != NULL)
+        {
+            fwrite(&mNnz, sizeof(mNnz), 1, mIndptr);
+        }
+    }
+    /*override*/ void write(const LineBatch& batch)
+    {
+        if (mText != NULL)
+        {
+            fwrite(batch.text.data(), 1, batch.text.size(), mText);
+            return;
+        }
+        for (size_t i = 0; i < batch.rowSizes.size(); ++i)
+        {
+            mNnz += batch.rowSizes[i];
+            fwrite(&mNnz, sizeof(mNnz), 1, mIndptr);
+        }
+        if (!batch.indices.empty())
+        {
+            fwrite(&batch.indices[0], sizeof(int32_t), batch.indices.size(), mIndices);
+            fwrite(&batch.values[0], sizeof(float), batch.values.size(), mValues);
+        }
+    }
+private:
+    FILE* mText;
+    FILE* mIndptr;
+    FILE* mIndices;
+    FILE* mValues;
+    uint64_t mNnz;
+};
+
+static const size_t OUTPUT_BUFFER_SIZE = 1 << 20;
+
+static FILE* openOutput(const string& name)
+{
+    FILE* file = fopen(name.c_str(), "wb");
+    if (file == NULL)
+    {
+        cerr << "cannot open " << name << endl;
+        exit(1);
+    }
+    setvbuf(file, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+    return file;
 }
+
 int main(int argc, char** argv)
 {
     //FLAGS_feature;
@@ -64,38 +176,72 @@ int main(int argc, char** argv)
         cerr << usage << endl;
         exit(0);
     }
-    //FLAGS_input;
-    vector<string> features;
-    unordered_map<string, WordInfo> weighted;
-    load(FLAGS_feature, features, weighted);
     PatternScan scanner;
-    scanner.Init(features);
-
+    if (PatternScan::IsCompiled(FLAGS_feature))
+    {
+        scanner.LoadCompiled(FLAGS_feature);
+    }
+    else
+    {
+        scanner.LoadWeighted(FLAGS_feature);
+    }
     ifstream is(FLAGS_input.c_str());
-    string line;
-    int linen = 0;
-    std::vector<WordInfo> wfeature;
-    wfeature.reserve(10000);
-    while(getline(is, line))
-    {
-        wfeature.clear();
-        std::map<std::string, uint32_t> matches;
-        scanner.Scan(line, matches);
-		pair<string,size_t> record;
-        cout << ++linen << "\t"; 
-        BOOST_FOREACH(record, matches)
+    std::auto_ptr<mlplus::FeatureHasher> hasher(FLAGS_hash_bits > 0 ?
+        new mlplus::FeatureHasher(FLAGS_hash_bits, FLAGS_hash_count, FLAGS_hash_signed) : NULL);
+
+    FILE* text = NULL;
+    FILE* indptr = NULL;
+    FILE* indices = NULL;
+    FILE* values = NULL;
+    bool csr = !FLAGS_csr.empty();
+    if (csr)
+    {
+        indptr = openOutput(FLAGS_csr + ".indptr");
+        indices = openOutput(FLAGS_csr + ".indices");
+        values = openOutput(FLAGS_csr + ".values");
+    }
+    else
+    {
+        text = stdout;
+        setvbuf(text, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+    }
+
+    int threads = FLAGS_threads > 0 ? FLAGS_threads : mlplus::ThreadPool::hardwareThreads();
+    vector<ScanWorker*> workers;
+    vector<LineBatchProcessor*> processors;
+    for (int i = 0; i < threads; ++i)
+    {
+        workers.push_back(new ScanWorker(scanner, hasher.get(), csr));
+        processors.push_back(workers.back());
+    }
+    OutputWriter writer(text, indptr, indices, values);
+    int status = 0;
+    try
+    {
+        runLinePipeline(is, processors, writer, FLAGS_batch_lines > 0 ? FLAGS_batch_lines : 1);
+    }
+    catch (exception& e)
+    {
+        cerr << e.what() << endl;
+        status = 1;
+    }
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        delete workers[i];
+    }
+
+    FILE* outputs[] = {text, indptr, indices, values};
+    for (size_t i = 0; i < sizeof(outputs) / sizeof(outputs[0]); ++i)
+    {
+        if (outputs[i] != NULL && (fflush(outputs[i]) != 0 || ferror(outputs[i])))
         {
-            WordInfo info = weighted[record.first];
-            info.weight = record.second * info.weight;
-            wfeature.push_back(info);
+            cerr << "error writing the output" << endl;
+            status = 1;
         }
-        std::sort (wfeature.begin(), wfeature.end()); 
-        WordInfo info;
-        BOOST_FOREACH(info, wfeature)
+        if (outputs[i] != NULL && outputs[i] != stdout)
         {
-            cout << info.id << ":" << info.weight << " ";
+            fclose(outputs[i]);
         }
-        cout << endl;
     }
-    return 0;
+    return status;
 }
@@ -6,17 +6,46 @@
 #include "iterator_interface.h"
 #include "attribute_value.h"
 #include "string_utility.h"
+#include "vector_math.h"
+#include "profile.h"
 #include <estimators/estimator_include.h>
+#include <estimators/concurrent_estimator.h>
 #include <stdexcept>
 #include <algorithm>
 namespace mlplus
 {
 using namespace std;
 NaiveBayes::NaiveBayes(const string& name, int nClasses):
-    Classifier(name), mClassDistribution(NULL), mClassesCount(nClasses),mEventModel(false)
+    Classifier(name), mClassDistribution(NULL), mClassesCount(nClasses),mEventModel(false),
+    mConcurrency(0), mKernelReady(false)
 {
 }
 
+NaiveBayes::EstimatorPtr NaiveBayes::newDiscreteEstimator(int nSymbols) const
+{
+    if (mConcurrency > 0)
+    {
+        return new ConcurrentDiscreteEstimator(nSymbols, true, mConcurrency);
+    }
+    return new DiscreteEstimator(nSymbols);
+}
+NaiveBayes::EstimatorPtr NaiveBayes::newNormalEstimator(double precision) const
+{
+    if (mConcurrency > 0)
+    {
+        return new ConcurrentNormalEstimator(precision, mConcurrency);
+    }
+    return new NormalEstimator(precision);
+}
+NaiveBayes::EstimatorPtr NaiveBayes::newBinaryEstimator() const
+{
+    if (mConcurrency > 0)
+    {
+        return new ConcurrentBinaryEstimator(true, mConcurrency);
+    }
+    return new BinaryEstimator();
+}
+
 void NaiveBayes::release()
 {
     std::map<AttributeIndex,  PosteriorProbability>::iterator it = mDistributions.begin();
@@ -48,12 +77,35 @@ NaiveBayes::~NaiveBayes()
     release();
 }
 
+size_t NaiveBayes::memoryUsage() const
+{
+    size_t bytes = sizeof(*this) + mKernel.memoryUsage() - sizeof(mKernel);
+    DistributionMapType::const_iterator it = mDistributions.begin();
+    for (; it != mDistributions.end(); ++it)
+    {
+        bytes += memory::treeNodeBytes(sizeof(*it));
+        if (it->second != NULL)
+        {
+            bytes += mClassesCount * sizeof(EstimatorPtr);
+            for (int i = 0; i < mClassesCount; ++i)
+            {
+                bytes += it->second[i] != NULL ? it->second[i]->memoryUsage() : 0;
+            }
+        }
+    }
+    if (mClassDistribution != NULL)
+    {
+        bytes += mClassDistribution->memoryUsage();
+    }
+    return bytes;
+}
+
 void NaiveBayes::trainBernoulli(DataSet* dataset)
 {
     assert(dataset != NULL);
     //mClassesCount = dataset->numTargets();
     //int attributeCount  = dataset->numAttributes();
-    setClassDistribution(new DiscreteEstimator(mClassesCount));
+    setClassDistribution(newDiscreteEstimator(mClassesCount));
     int attIndex = 0;
     float numPrecision = DEFAULT_PRECISION;
     AutoAttributeIteratorPtr  attrIt(dataset->newAttributeIterator());
@@ -102,33 +154,29 @@ void NaiveBayes::trainBernoulli(DataSet* dataset)
             switch(attr->getType())
             {
             case Attribute::NUMERIC:
-                pp[j] = new NormalEstimator(numPrecision);
+                pp[j] = newNormalEstimator(numPrecision);
                 break;
             case Attribute::BINARY:
-                pp[j] = new  BinaryEstimator();
+                pp[j] = newBinaryEstimator();
                 break;
             case Attribute::COMPACTNOMINAL:
             case Attribute::NAMEDNOMINAL:
             case Attribute::STRING:
-                pp[j] = new DiscreteEstimator(attr->numValues());
+                pp[j] = newDiscreteEstimator(attr->numValues());
                 break;
             default:
                 throw runtime_error("unknown attribute type:" + attr->toString());
             }
         }
     }
-    AutoInstanceIteratorPtr instanceIt(dataset->newInstanceIterator());
-    while(instanceIt->hasMore())
-    {
-        update(instanceIt->next());
-    }
+    accumulate(dataset);
 }
 void NaiveBayes::trainMultinomial(DataSet* dataset)
 {
     assert(dataset != NULL);
     //mClassesCount = dataset->numTargets();
     //int attributeCount  = dataset->numAttributes();
-    setClassDistribution(new DiscreteEstimator(mClassesCount));
+    setClassDistribution(newDiscreteEstimator(mClassesCount));
     AutoAttributeIteratorPtr  attrIt(dataset->newAttributeIterator());
     PosteriorProbability& pp =  mDistributions[0];//only one "training attribute" with
     if (pp == NULL)
@@ -138,17 +186,35 @@ void NaiveBayes::trainMultinomial(DataSet* dataset)
     }
     for(int j = 0; j < mClassesCount; j++)
     {
-        pp[j] = new DiscreteEstimator(dataset->numAttributes());
+        pp[j] = newDiscreteEstimator(dataset->numAttributes());
     }
+    accumulate(dataset);
+}
+
+void NaiveBayes::accumulate(DataSet* dataset)
+{
     AutoInstanceIteratorPtr instanceIt(dataset->newInstanceIterator());
+    NaiveBayesKernel kernel;
+    if (mConcurrency == 0 && kernel.import(mDistributions, mClassDistribution, mClassesCount, mEventModel))
+    {
+        while(instanceIt->hasMore())
+        {
+            kernel.update(instanceIt->next());
+            MLPLUS_PROFILE_COUNT("NaiveBayes instances", 1);
+        }
+        kernel.exportTo(mDistributions, mClassDistribution);
+        return;
+    }
     while(instanceIt->hasMore())
     {
         update(instanceIt->next());
+        MLPLUS_PROFILE_COUNT("NaiveBayes instances", 1);
     }
 }
 
 void NaiveBayes::train(DataSet* dataset)
 {
+    MLPLUS_PROFILE_SCOPE("NaiveBayes::train");
     if (mEventModel)
     {
         trainMultinomial(dataset);
@@ -157,6 +223,18 @@ void NaiveBayes::train(DataSet* dataset)
     {
         trainBernoulli(dataset);
     }
+    compile();
+}
+
+bool NaiveBayes::compile()
+{
+    mKernelReady = mConcurrency == 0 &&
+        mKernel.import(mDistributions, mClassDistribution, mClassesCount, mEventModel);
+    if (mKernelReady)
+    {
+        mKernel.compile();
+    }
+    return mKernelReady;
 }
 
 void  NaiveBayes::updateBernoulli(IInstance* instance)
@@ -218,6 +296,11 @@ void  NaiveBayes::updateMultinomial(IInstance* instance)
 }
 void  NaiveBayes::update(IInstance* instance)
 {
+    //concurrent models are never compiled, so ingest threads leave the flag alone
+    if (mConcurrency == 0)
+    {
+        mKernelReady = false;
+    }
     if (mEventModel)
     {
         updateMultinomial(instance);
@@ -228,7 +311,7 @@ void  NaiveBayes::update(IInstance* instance)
     }
 }
 
-std::vector<double> NaiveBayes::predictBernoulli(IInstance* instance)
+std::vector<double> NaiveBayes::scoreBernoulli(IInstance* instance)
 {
     vector<double> v(mClassesCount,0);
     for(int i = 0; i < mClassesCount; i++)
@@ -236,7 +319,7 @@ std::vector<double> NaiveBayes::predictBernoulli(IInstance* instance)
         v[i] = log(mClassDistribution->getProbability(i));
     }
     int attIndex = 0;
-    const vector<ValueType>& valueArray = instance->getValueArray();
+    const ValueArray& valueArray = instance->getValueArray();
     for (unsigned i = 0; i < valueArray.size(); ++i)
     {
         if(!AttributeValue::isMissingValue(valueArray[i]))
@@ -255,9 +338,9 @@ std::vector<double> NaiveBayes::predictBernoulli(IInstance* instance)
         }
         attIndex++;
     }
-    return scoreToProb(v);
+    return v;
 }
-std::vector<double> NaiveBayes::predictMultinomial(IInstance* instance)
+std::vector<double> NaiveBayes::scoreMultinomial(IInstance* instance)
 {
     vector<double> v(mClassesCount,0);
     for(int i = 0; i < mClassesCount; i++)
@@ -285,42 +368,55 @@ std::vector<double> NaiveBayes::predictMultinomial(IInstance* instance)
             }
         }
     }
-    return scoreToProb(v);
+    return v;
 }
 
 vector<double> NaiveBayes::scoreToProb(const vector<double>& score)
 {
-    int class_set_size = score.size();
-    vector<double> prb(class_set_size, 0);
-    for (int i = 0; i < class_set_size; i++) 
+    vector<double> prb(score);
+    if (!prb.empty())
     {
-        double delta_prb_sum = 0.0;
-        for (int j = 0; j < class_set_size; j++) 
-        {
-            delta_prb_sum += exp(score[j] - score[i]);
-        }
-        prb[i] = 1/delta_prb_sum;
+        softmax(&prb[0], &prb[0], prb.size());
     }
-    //normalize
-    double sum;
-    for (int i = 0; i < class_set_size; ++i)
+    return prb;
+}
+
+vector<double> NaiveBayes::logScores(IInstance* instance)
+{
+    if (mKernelReady)
     {
-        sum += prb[i];
+        vector<double> v(mClassesCount, 0);
+        mKernel.score(instance, &v[0]);
+        return v;
     }
-    for (int i = 0; i < class_set_size; ++i)
+    if (mEventModel)
     {
-        prb[i] /= sum;
+        return scoreMultinomial(instance);
     }
-    return prb;
+    return scoreBernoulli(instance);
 }
 
 vector<double> NaiveBayes::targetDistribution(IInstance* instance)
 {
-    if (mEventModel)
+    return scoreToProb(logScores(instance));
+}
+
+vector<pair<int, double> > NaiveBayes::predictTopK(IInstance* instance, int k)
+{
+    vector<double> v = logScores(instance);
+    vector<pair<int, double> > top;
+    if (v.empty())
+    {
+        return top;
+    }
+    selectTopK(&v[0], v.size(), k, top);
+    //P(c) = exp(score[c] - log(sum(exp(score))))
+    double lse = logSumExp(&v[0], v.size());
+    for (unsigned i = 0; i < top.size(); ++i)
     {
-        return predictMultinomial(instance);
+        top[i].second = fastExp(top[i].second - lse);
     }
-    return predictBernoulli(instance);
+    return top;
 }
 void NaiveBayes::load(istream& input)
 {
@@ -337,7 +433,7 @@ void NaiveBayes::load(istream& input)
     {
         split(line,result,"=");
         mClassesCount = atoi(result[1].c_str());
-        setClassDistribution(new DiscreteEstimator(mClassesCount));
+        setClassDistribution(newDiscreteEstimator(mClassesCount));
     }
     //class distribution
     if (getline(input,line))
@@ -369,7 +465,7 @@ void NaiveBayes::load(istream& input)
             {
                 if (NULL == pp[classid])
                 {
-                    pp[classid] = new NormalEstimator(0.1);
+                    pp[classid] = newNormalEstimator(0.1);
                 }
                 pp[classid]->fromString(result[3]);
             }
@@ -377,7 +473,7 @@ void NaiveBayes::load(istream& input)
             {
                 if (NULL == pp[classid])
                 {
-                    pp[classid] = new DiscreteEstimator(1);
+                    pp[classid] = newDiscreteEstimator(1);
                 }
                 pp[classid]->fromString(result[3]);
             }
@@ -385,12 +481,13 @@ void NaiveBayes::load(istream& input)
             {
                 if (NULL == pp[classid])
                 {
-                    pp[classid] = new BinaryEstimator();
+                    pp[classid] = newBinaryEstimator();
                 }
                 pp[classid]->fromString(result[3]);
             }
         }
     }
+    compile();
 }
 void NaiveBayes::save(ostream& output)
 {
@@ -419,9 +516,8 @@ void NaiveBayes::save(ostream& output)
 }
 pair<int, double> NaiveBayes::predict(IInstance* i) 
 {
-    vector<double> array = targetDistribution(i);
-    vector<double>::const_iterator it = max_element(array.begin(), array.end());
-    return make_pair(it - array.begin(), *it);
+    vector<pair<int, double> > top = predictTopK(i, 1);
+    return top.empty() ? make_pair(0, 0.0) : top[0];
 }
 } // namespace mlplus
 
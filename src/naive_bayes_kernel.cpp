@@ -0,0 +1,301 @@
+#include <cmath>
+#include <stdexcept>
+#include <typeinfo>
+#include "memory_accounting.h"
+#include "naive_bayes_kernel.h"
+#include "attribute_value.h"
+namespace mlplus
+{
+using namespace std;
+using namespace mlplus::estimators;
+
+NaiveBayesKernel::NaiveBayesKernel():
+    mNumClasses(0), mEventModel(false), mCompiled(false)
+{
+}
+size_t NaiveBayesKernel::memoryUsage() const
+{
+    return sizeof(*this) + memory::vectorBytes(mSlots) + memory::vectorBytes(mAttributes) +
+           mNormal.memoryUsage() - sizeof(mNormal) + mDiscrete.memoryUsage() - sizeof(mDiscrete) +
+           mBinary.memoryUsage() - sizeof(mBinary) + memory::vectorBytes(mClassCounts) +
+           memory::vectorBytes(mLogPrior);
+}
+void NaiveBayesKernel::clear()
+{
+    mNumClasses = 0;
+    mCompiled = false;
+    mSlots.clear();
+    mAttributes.clear();
+    mNormal.clear(0);
+    mDiscrete.clear(0);
+    mBinary.clear(0);
+    mClassCounts.clear();
+    mLogPrior.clear();
+}
+bool NaiveBayesKernel::import(const DistributionMapType& dists, Estimator* classDist,
+        int numClasses, bool eventModel)
+{
+    clear();
+    if (numClasses <= 0 || classDist == NULL || typeid(*classDist) != typeid(DiscreteEstimator))
+    {
+        return false;
+    }
+    mNormal.clear(numClasses);
+    mDiscrete.clear(numClasses);
+    mBinary.clear(numClasses);
+    if (eventModel && dists.find(0) == dists.end())
+    {
+        return false;
+    }
+    for (DistributionMapType::const_iterator it = dists.begin(); it != dists.end(); ++it)
+    {
+        Estimator** pp = it->second;
+        if (pp == NULL || it->first < 0)
+        {
+            clear();
+            return false;
+        }
+        int kind = NONE;
+        for (int c = 0; c < numClasses; ++c)
+        {
+            if (pp[c] == NULL)
+            {
+                clear();
+                return false;
+            }
+            int k = NONE;
+            if (typeid(*pp[c]) == typeid(NormalEstimator))
+            {
+                k = NORMAL;
+            }
+            else if (typeid(*pp[c]) == typeid(DiscreteEstimator))
+            {
+                k = DISCRETE;
+            }
+            else if (typeid(*pp[c]) == typeid(BinaryEstimator))
+            {
+                k = BINARY;
+            }
+            if (k == NONE || (c > 0 && k != kind) || (eventModel && k != DISCRETE))
+            {
+                clear();
+                return false;
+            }
+            kind = k;
+        }
+        if (eventModel && it->first != 0)
+        {
+            continue;
+        }
+        Slot s(kind);
+        switch(kind)
+        {
+        case NORMAL:
+            s.slot = mNormal.add(pp);
+            break;
+        case DISCRETE:
+            s.slot = mDiscrete.add(pp);
+            break;
+        default:
+            s.slot = mBinary.add(pp);
+            break;
+        }
+        if ((unsigned)it->first >= mSlots.size())
+        {
+            mSlots.resize(it->first + 1);
+        }
+        mSlots[it->first] = s;
+        mAttributes.push_back(it->first);
+    }
+    //the class counts followed by their sum, as the class estimator keeps them
+    DiscreteEstimator* cd = static_cast<DiscreteEstimator*>(classDist);
+    mClassCounts.assign(cd->getCounts(), cd->getCounts() + cd->getNumOfClass());
+    mClassCounts.push_back(cd->getSumOfCounts());
+    mNumClasses = numClasses;
+    mEventModel = eventModel;
+    return true;
+}
+void NaiveBayesKernel::update(IInstance* instance)
+{
+    if (mCompiled)
+    {
+        throw logic_error("update on a compiled naive bayes kernel");
+    }
+    if (mEventModel)
+    {
+        updateMultinomial(instance);
+    }
+    else
+    {
+        updateBernoulli(instance);
+    }
+}
+void NaiveBayesKernel::updateBernoulli(IInstance* instance)
+{
+    if(instance->targetIsMissing())
+        throw runtime_error("missing class in instance");
+    int targetValue = (int)instance->targetValue();
+    int targetIndex = instance->targetIndex();
+    double weight = instance->getWeight();
+    const ValueArray& values = instance->getValueArray();
+    bool dense = !instance->isSparse();
+    for (size_t i = 0; i < mAttributes.size(); ++i)
+    {
+        int attr = mAttributes[i];
+        if (attr == targetIndex)
+        {
+            continue;
+        }
+        ValueType value = dense && (unsigned)attr < values.size() ? values[attr] : instance->getValue(attr);
+        if (!AttributeValue::isMissingValue(value))
+        {
+            updateSlot(mSlots[attr], targetValue, value, value * weight);
+        }
+        else
+        {
+            updateSlot(mSlots[attr], targetValue, 0, weight);
+        }
+    }
+    if (targetValue < (int)mClassCounts.size() - 1)
+    {
+        mClassCounts[targetValue] += weight;
+        mClassCounts.back() += weight;
+    }
+}
+void NaiveBayesKernel::updateMultinomial(IInstance* instance)
+{
+    if(instance->targetIsMissing())
+        throw runtime_error("missing class in instance");
+    int targetValue = (int)instance->targetValue();
+    int targetIndex = instance->targetIndex();
+    double weight = instance->getWeight();
+    const ValueArray& values = instance->getValueArray();
+    float tfAll = 0;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        int aIndex = instance->attributeIndex(i);
+        if (aIndex == targetIndex)
+        {
+            continue;
+        }
+        ValueType value = values[i];
+        if (!AttributeValue::isMissingValue(value))
+        {
+            mDiscrete.update(0, targetValue, aIndex, value * weight);
+            tfAll += value * weight;
+        }
+    }
+    if (targetValue < (int)mClassCounts.size() - 1)
+    {
+        mClassCounts[targetValue] += tfAll;
+        mClassCounts.back() += tfAll;
+    }
+}
+void NaiveBayesKernel::exportTo(DistributionMapType& dists, Estimator* classDist) const
+{
+    if (mCompiled)
+    {
+        throw logic_error("export from a compiled naive bayes kernel");
+    }
+    for (size_t i = 0; i < mAttributes.size(); ++i)
+    {
+        const Slot& s = mSlots[mAttributes[i]];
+        Estimator** pp = dists[mAttributes[i]];
+        switch(s.kind)
+        {
+        case NORMAL:
+            mNormal.exportTo(s.slot, pp);
+            break;
+        case DISCRETE:
+            mDiscrete.exportTo(s.slot, pp);
+            break;
+        case BINARY:
+            mBinary.exportTo(s.slot, pp);
+            break;
+        default:
+            break;
+        }
+    }
+    static_cast<DiscreteEstimator*>(classDist)->setCounts(&mClassCounts[0]);
+}
+void NaiveBayesKernel::compile()
+{
+    mNormal.compile();
+    mDiscrete.compile();
+    mBinary.compile();
+    double sum = mClassCounts.back();
+    mLogPrior.resize(mNumClasses);
+    for (int c = 0; c < mNumClasses; ++c)
+    {
+        double count = c < (int)mClassCounts.size() - 1 ? mClassCounts[c] : 0;
+        mLogPrior[c] = log(sum == 0 ? 0 : count / sum);
+    }
+    vector<double>().swap(mClassCounts);
+    mCompiled = true;
+}
+void NaiveBayesKernel::score(IInstance* instance, double* scores) const
+{
+    if (!mCompiled)
+    {
+        throw logic_error("score on a naive bayes kernel that is not compiled");
+    }
+    for (int c = 0; c < mNumClasses; ++c)
+    {
+        scores[c] = mLogPrior[c];
+    }
+    if (mEventModel)
+    {
+        scoreMultinomial(instance, scores);
+    }
+    else
+    {
+        scoreBernoulli(instance, scores);
+    }
+}
+void NaiveBayesKernel::scoreBernoulli(IInstance* instance, double* scores) const
+{
+    const ValueArray& values = instance->getValueArray();
+    bool dense = !instance->isSparse();
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        if (AttributeValue::isMissingValue(values[i]))
+        {
+            continue;
+        }
+        int attr = dense ? i : instance->attributeIndex(i);
+        if (attr < 0 || (unsigned)attr >= mSlots.size())
+        {
+            continue;
+        }
+        const Slot& s = mSlots[attr];
+        switch(s.kind)
+        {
+        case NORMAL:
+            mNormal.score(s.slot, values[i], scores);
+            break;
+        case DISCRETE:
+            mDiscrete.score(s.slot, values[i], scores);
+            break;
+        case BINARY:
+            mBinary.score(s.slot, values[i], scores);
+            break;
+        default:
+            break;
+        }
+    }
+}
+void NaiveBayesKernel::scoreMultinomial(IInstance* instance, double* scores) const
+{
+    const ValueArray& values = instance->getValueArray();
+    int targetIndex = instance->targetIndex();
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        int aIndex = instance->attributeIndex(i);
+        if (aIndex == targetIndex || AttributeValue::isMissingValue(values[i]))
+        {
+            continue;
+        }
+        mDiscrete.scoreWeighted(0, aIndex, values[i], scores);
+    }
+}
+} // namespace mlplus
@@ -32,6 +32,10 @@ void  NormalEstimator::fromString(const string& str)
     istringstream iss(str,istringstream::in);
     iss >> mPrecision >> mSumOfWeights >> mSumOfValues >> mSumOfValuesSq >> mMean >> mStardardDev;
 }
+size_t NormalEstimator::memoryUsage() const
+{
+    return MemoryPool::allocatedSize(sizeof(*this));
+}
 void NormalEstimator::addValue(double data, double weight)
 {
     if(weight == 0)
@@ -58,6 +62,22 @@ void NormalEstimator::addValue(double data, double weight)
     }
 }
 
+void NormalEstimator::setSums(double sumOfWeights, double sumOfValues, double sumOfValuesSq)
+{
+    mSumOfWeights = sumOfWeights;
+    mSumOfValues = sumOfValues;
+    mSumOfValuesSq = sumOfValuesSq;
+    if(mSumOfWeights > 0)
+    {
+        mMean = mSumOfValues / mSumOfWeights;
+        double stdDev = sqrt(fabs(mSumOfValuesSq/mSumOfWeights - mMean * mMean));
+        if(stdDev > 1e-10)
+        {
+            mStardardDev = max(mPrecision / (2.0 * 3.0), stdDev);
+        }
+    }
+}
+
 double NormalEstimator::getProbability(double data)
 {
     data = round(data);
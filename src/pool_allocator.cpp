@@ -0,0 +1,294 @@
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+#include <pthread.h>
+#include "thread_pool.h"
+#include "flat_hash_map.h"
+#include "pool_allocator.h"
+namespace mlplus
+{
+namespace
+{
+struct Batch
+{
+    void* head;
+    uint32_t count;
+};
+
+/**
+ * The objects of one size class not held by a thread, and its blocks.
+ * New objects are carved from the current block a batch at a time.
+ */
+struct Depot
+{
+    Mutex mutex;
+    std::vector<Batch> batches;
+    std::vector<char*> blocks;
+    char* carve;
+    char* carveEnd;
+    Depot(): carve(NULL), carveEnd(NULL) {}
+};
+
+pthread_once_t sOnce = PTHREAD_ONCE_INIT;
+pthread_key_t sCacheKey;
+// never freed, threads may still return objects while the process exits
+Depot* sDepots = NULL;
+size_t sBytesReserved = 0;
+
+/**
+ * @brief objects moved between a thread and the depot at once, about 8KB
+ */
+uint32_t batchSize(size_t size)
+{
+    size_t n = 8192 / size;
+    return n < 4 ? 4 : n > 64 ? 64 : n;
+}
+} // namespace
+
+__thread MemoryPool::ThreadCache* MemoryPool::tCache = NULL;
+
+namespace
+{
+void exitThread(void*)
+{
+    MemoryPool::releaseThreadCache();
+}
+
+void init()
+{
+    sDepots = new Depot[MemoryPool::NUM_CLASSES];
+    pthread_key_create(&sCacheKey, exitThread);
+}
+
+Depot& depot(size_t sizeClass)
+{
+    pthread_once(&sOnce, init);
+    return sDepots[sizeClass];
+}
+
+/**
+ * @brief the first n objects of list as a batch, list is left at the rest
+ */
+Batch split(void*& list, uint32_t n)
+{
+    Batch batch = {list, 0};
+    void* last = NULL;
+    while (list != NULL && batch.count < n)
+    {
+        last = list;
+        list = *static_cast<void**>(list);
+        ++batch.count;
+    }
+    if (last != NULL)
+    {
+        *static_cast<void**>(last) = NULL;
+    }
+    return batch;
+}
+
+/**
+ * @brief a batch of fresh objects from the current block, under the lock
+ */
+Batch carve(Depot& d, size_t size, uint32_t n)
+{
+    if (d.carve == NULL || d.carve + size > d.carveEnd)
+    {
+        void* block = NULL;
+        if (posix_memalign(&block, MemoryPool::BLOCK_SIZE, MemoryPool::BLOCK_SIZE) != 0)
+        {
+            throw std::bad_alloc();
+        }
+        d.blocks.push_back(static_cast<char*>(block));
+        d.carve = static_cast<char*>(block);
+        d.carveEnd = d.carve + MemoryPool::BLOCK_SIZE / size * size;
+        __sync_fetch_and_add(&sBytesReserved, (size_t)MemoryPool::BLOCK_SIZE);
+    }
+    Batch batch = {d.carve, 0};
+    void* last = NULL;
+    for (; batch.count < n && d.carve < d.carveEnd; ++batch.count)
+    {
+        if (last != NULL)
+        {
+            *static_cast<void**>(last) = d.carve;
+        }
+        last = d.carve;
+        d.carve += size;
+    }
+    *static_cast<void**>(last) = NULL;
+    return batch;
+}
+
+void give(size_t sizeClass, const Batch& batch)
+{
+    if (batch.count != 0)
+    {
+        Depot& d = depot(sizeClass);
+        ScopedLock lock(d.mutex);
+        d.batches.push_back(batch);
+    }
+}
+} // namespace
+
+void* MemoryPool::allocateSlow(size_t sizeClass)
+{
+    size_t size = classSize(sizeClass);
+    Depot& d = depot(sizeClass);
+    if (tCache == NULL)
+    {
+        tCache = new ThreadCache();
+        for (size_t c = 0; c < NUM_CLASSES; ++c)
+        {
+            tCache->limit[c] = 2 * batchSize(classSize(c));
+        }
+        pthread_setspecific(sCacheKey, tCache);
+    }
+    Batch batch;
+    {
+        ScopedLock lock(d.mutex);
+        if (d.batches.empty())
+        {
+            batch = carve(d, size, batchSize(size));
+        }
+        else
+        {
+            batch = d.batches.back();
+            d.batches.pop_back();
+        }
+    }
+    FreeObject* object = static_cast<FreeObject*>(batch.head);
+    tCache->head[sizeClass] = object->next;
+    tCache->count[sizeClass] = batch.count - 1;
+    return object;
+}
+
+void MemoryPool::deallocateSlow(void* p, size_t sizeClass)
+{
+    FreeObject* object = static_cast<FreeObject*>(p);
+    if (tCache == NULL)
+    {
+        // a thread that never allocated, or one that is exiting
+        object->next = NULL;
+        Batch batch = {object, 1};
+        give(sizeClass, batch);
+        return;
+    }
+    void* list = tCache->head[sizeClass];
+    Batch batch = split(list, tCache->limit[sizeClass] / 2);
+    tCache->count[sizeClass] -= batch.count;
+    give(sizeClass, batch);
+    object->next = static_cast<FreeObject*>(list);
+    tCache->head[sizeClass] = object;
+    ++tCache->count[sizeClass];
+}
+
+void MemoryPool::flushThreadCache()
+{
+    if (tCache == NULL)
+    {
+        return;
+    }
+    for (size_t c = 0; c < NUM_CLASSES; ++c)
+    {
+        Batch batch = {tCache->head[c], tCache->count[c]};
+        give(c, batch);
+        tCache->head[c] = NULL;
+        tCache->count[c] = 0;
+    }
+}
+
+void MemoryPool::releaseThreadCache()
+{
+    if (tCache == NULL)
+    {
+        return;
+    }
+    flushThreadCache();
+    delete tCache;
+    tCache = NULL;
+    pthread_setspecific(sCacheKey, NULL);
+}
+
+size_t MemoryPool::releaseFreeBlocks()
+{
+    flushThreadCache();
+    size_t released = 0;
+    for (size_t c = 0; c < NUM_CLASSES; ++c)
+    {
+        size_t size = classSize(c);
+        size_t perBlock = BLOCK_SIZE / size;
+        Depot& d = depot(c);
+        ScopedLock lock(d.mutex);
+        // blocks are aligned to their size, so an object finds its block by masking
+        FlatHashMap<uintptr_t, size_t> freeCount;
+        for (size_t b = 0; b < d.batches.size(); ++b)
+        {
+            for (void* p = d.batches[b].head; p != NULL; p = *static_cast<void**>(p))
+            {
+                ++freeCount[(uintptr_t)p & ~(uintptr_t)(BLOCK_SIZE - 1)];
+            }
+        }
+        if (d.carve != NULL)
+        {
+            freeCount[(uintptr_t)(d.carveEnd - 1) & ~(uintptr_t)(BLOCK_SIZE - 1)] +=
+                (d.carveEnd - d.carve) / size;
+        }
+        std::vector<char*> kept;
+        FlatHashMap<uintptr_t, bool> freed;
+        for (size_t i = 0; i < d.blocks.size(); ++i)
+        {
+            FlatHashMap<uintptr_t, size_t>::const_iterator it = freeCount.find((uintptr_t)d.blocks[i]);
+            if (it != freeCount.end() && it->second == perBlock)
+            {
+                freed[(uintptr_t)d.blocks[i]] = true;
+            }
+            else
+            {
+                kept.push_back(d.blocks[i]);
+            }
+        }
+        if (freed.empty())
+        {
+            continue;
+        }
+        // the objects left, as full batches again
+        void* list = NULL;
+        for (size_t b = 0; b < d.batches.size(); ++b)
+        {
+            void* p = d.batches[b].head;
+            while (p != NULL)
+            {
+                void* next = *static_cast<void**>(p);
+                if (freed.count((uintptr_t)p & ~(uintptr_t)(BLOCK_SIZE - 1)) == 0)
+                {
+                    *static_cast<void**>(p) = list;
+                    list = p;
+                }
+                p = next;
+            }
+        }
+        d.batches.clear();
+        while (list != NULL)
+        {
+            d.batches.push_back(split(list, batchSize(size)));
+        }
+        if (d.carve != NULL && freed.count((uintptr_t)(d.carveEnd - 1) & ~(uintptr_t)(BLOCK_SIZE - 1)))
+        {
+            d.carve = NULL;
+            d.carveEnd = NULL;
+        }
+        for (FlatHashMap<uintptr_t, bool>::iterator it = freed.begin(); it != freed.end(); ++it)
+        {
+            free(reinterpret_cast<void*>(it->first));
+            released += BLOCK_SIZE;
+        }
+        d.blocks.swap(kept);
+    }
+    __sync_fetch_and_sub(&sBytesReserved, released);
+    return released;
+}
+
+size_t MemoryPool::bytesReserved()
+{
+    return __sync_fetch_and_add(&sBytesReserved, 0);
+}
+} // namespace mlplus
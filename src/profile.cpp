@@ -0,0 +1,183 @@
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include "profile.h"
+namespace mlplus
+{
+namespace profile
+{
+namespace
+{
+pthread_mutex_t sMutex = PTHREAD_MUTEX_INITIALIZER;
+const char* sNames[MAX_PROBES];
+int sProbeCount = 0;
+// the slots of every thread that ever hit a probe, kept after the thread
+// exits so its totals still show up in the report
+std::vector<ProbeSlot*>* sThreadSlots = NULL;
+__thread ProbeSlot* tSlots = NULL;
+uint64_t sStartTicks = 0;
+struct timespec sStartTime;
+
+double elapsedNanos(const struct timespec& start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1e9 + (now.tv_nsec - start.tv_nsec);
+}
+
+/**
+ * @brief the nanoseconds per tick measured since the first probe registered
+ */
+double nanosPerTick()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t ticksSpent = ticks() - sStartTicks;
+    double nanos = elapsedNanos(sStartTime);
+    return ticksSpent > 0 && nanos > 1e6 ? nanos / ticksSpent : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+void writeJsonString(FILE* out, const char* s)
+{
+    fputc('"', out);
+    for (; *s != '\0'; ++s)
+    {
+        if (*s == '"' || *s == '\\')
+        {
+            fputc('\\', out);
+        }
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+void reportAtExit()
+{
+    const char* output = getenv("MLPLUS_PROFILE_OUTPUT");
+    const char* format = getenv("MLPLUS_PROFILE_FORMAT");
+    bool json = format != NULL && strcmp(format, "json") == 0;
+    FILE* out = stderr;
+    if (output != NULL && *output != '\0')
+    {
+        size_t length = strlen(output);
+        json = json || (length > 5 && strcmp(output + length - 5, ".json") == 0);
+        out = fopen(output, "w");
+        if (out == NULL)
+        {
+            fprintf(stderr, "cannot open profile output %s\n", output);
+            return;
+        }
+    }
+    report(out, json);
+    if (out != stderr)
+    {
+        fclose(out);
+    }
+}
+} // namespace
+
+int registerProbe(const char* name)
+{
+    pthread_mutex_lock(&sMutex);
+    if (sProbeCount == 0)
+    {
+        sStartTicks = ticks();
+        clock_gettime(CLOCK_MONOTONIC, &sStartTime);
+        sThreadSlots = new std::vector<ProbeSlot*>();
+        atexit(reportAtExit);
+    }
+    int probe = 0;
+    while (probe < sProbeCount && strcmp(sNames[probe], name) != 0)
+    {
+        ++probe;
+    }
+    if (probe == sProbeCount)
+    {
+        if (sProbeCount < MAX_PROBES)
+        {
+            sNames[sProbeCount++] = name;
+        }
+        else
+        {
+            probe = -1;
+        }
+    }
+    pthread_mutex_unlock(&sMutex);
+    return probe;
+}
+
+ProbeSlot* threadSlots()
+{
+    if (tSlots == NULL)
+    {
+        tSlots = static_cast<ProbeSlot*>(calloc(MAX_PROBES, sizeof(ProbeSlot)));
+        pthread_mutex_lock(&sMutex);
+        sThreadSlots->push_back(tSlots);
+        pthread_mutex_unlock(&sMutex);
+    }
+    return tSlots;
+}
+
+void report(FILE* out, bool json)
+{
+    pthread_mutex_lock(&sMutex);
+    double scale = nanosPerTick() / 1e6;
+    if (json)
+    {
+        fprintf(out, "{\"probes\":[");
+    }
+    else
+    {
+        fprintf(out, "%-40s %12s %14s %12s %12s\n", "probe", "calls", "count", "total_ms", "avg_us");
+    }
+    for (int probe = 0; probe < sProbeCount; ++probe)
+    {
+        ProbeSlot total = {0, 0, 0};
+        for (size_t i = 0; i < sThreadSlots->size(); ++i)
+        {
+            const ProbeSlot& slot = (*sThreadSlots)[i][probe];
+            total.calls += slot.calls;
+            total.count += slot.count;
+            total.ticks += slot.ticks;
+        }
+        double ms = total.ticks * scale;
+        double avgUs = total.calls > 0 ? ms * 1e3 / total.calls : 0.0;
+        if (json)
+        {
+            fprintf(out, "%s{\"name\":", probe > 0 ? "," : "");
+            writeJsonString(out, sNames[probe]);
+            fprintf(out, ",\"calls\":%llu,\"count\":%llu,\"total_ms\":%.3f,\"avg_us\":%.3f}",
+                    (unsigned long long)total.calls, (unsigned long long)total.count, ms, avgUs);
+        }
+        else
+        {
+            fprintf(out, "%-40s %12llu %14llu %12.3f %12.3f\n", sNames[probe],
+                    (unsigned long long)total.calls, (unsigned long long)total.count, ms, avgUs);
+        }
+    }
+    if (json)
+    {
+        fprintf(out, "]}\n");
+    }
+    pthread_mutex_unlock(&sMutex);
+    fflush(out);
+}
+
+void reset()
+{
+    pthread_mutex_lock(&sMutex);
+    if (sThreadSlots != NULL)
+    {
+        for (size_t i = 0; i < sThreadSlots->size(); ++i)
+        {
+            memset((*sThreadSlots)[i], 0, MAX_PROBES * sizeof(ProbeSlot));
+        }
+    }
+    pthread_mutex_unlock(&sMutex);
+}
+} // namespace profile
+} // namespace mlplus
@@ -0,0 +1,164 @@
+#include <cmath>
+#include <cstring>
+#include <pthread.h>
+#include "synthetic_data.h"
+#include "vector_math.h"
+#include "rng.h"
+namespace mlplus
+{
+namespace
+{
+const uint64_t JUMP[4] =
+{
+    0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull
+};
+const uint64_t LONG_JUMP[4] =
+{
+    0x76e15d3efefdcbbfull, 0xc5004e441c522fb3ull, 0x77710069854ee241ull, 0x39109bb02acbe635ull
+};
+const double TWO_PI = 6.283185307179586476925;
+
+/**
+ * @brief the uniform pairs of u in place to normal pairs, n even
+ */
+void boxMuller(double* u, size_t n, double mean, double stdev)
+{
+    for (size_t i = 0; i + 1 < n; i += 2)
+    {
+        double r = stdev * std::sqrt(-2.0 * fastLog(1.0 - u[i]));
+        double theta = TWO_PI * u[i + 1];
+        u[i] = mean + r * std::cos(theta);
+        u[i + 1] = mean + r * std::sin(theta);
+    }
+}
+
+const uint64_t THREAD_SEED = 0x2545F4914F6CDD1Dull;
+pthread_mutex_t sThreadMutex = PTHREAD_MUTEX_INITIALIZER;
+uint64_t sThreadStreams = 0;
+// never freed, like the profile slots, a generator is a few bytes per thread
+__thread Xoshiro256* tRandom = NULL;
+} // namespace
+
+Xoshiro256::Xoshiro256(uint64_t seed): mSpare(0), mHasSpare(false)
+{
+    SplitMix64 mix(seed);
+    for (int i = 0; i < 4; ++i)
+    {
+        mState[i] = mix.next();
+    }
+}
+
+double Xoshiro256::gaussian()
+{
+    if (mHasSpare)
+    {
+        mHasSpare = false;
+        return mSpare;
+    }
+    double pair[2] = {uniform(), uniform()};
+    boxMuller(pair, 2, 0, 1);
+    mSpare = pair[1];
+    mHasSpare = true;
+    return pair[0];
+}
+
+void Xoshiro256::jump(const uint64_t* polynomial)
+{
+    uint64_t s[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int b = 0; b < 64; ++b)
+        {
+            if (polynomial[i] & (1ull << b))
+            {
+                for (int k = 0; k < 4; ++k)
+                {
+                    s[k] ^= mState[k];
+                }
+            }
+            next();
+        }
+    }
+    memcpy(mState, s, sizeof(mState));
+    mHasSpare = false;
+}
+
+void Xoshiro256::jump()
+{
+    jump(JUMP);
+}
+
+void Xoshiro256::longJump()
+{
+    jump(LONG_JUMP);
+}
+
+Xoshiro256 Xoshiro256::stream(uint64_t seed, uint64_t index)
+{
+    Xoshiro256 random(seed);
+    for (uint64_t i = 0; i < index; ++i)
+    {
+        random.jump();
+    }
+    return random;
+}
+
+void Xoshiro256::uniforms(double* out, size_t n)
+{
+    // the state in locals lets the compiler keep it in registers
+    uint64_t s0 = mState[0], s1 = mState[1], s2 = mState[2], s3 = mState[3];
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t result = rotl(s0 + s3, 23) + s0;
+        uint64_t t = s1 << 17;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = rotl(s3, 45);
+        out[i] = (result >> 11) * (1.0 / 9007199254740992.0);
+    }
+    mState[0] = s0;
+    mState[1] = s1;
+    mState[2] = s2;
+    mState[3] = s3;
+}
+
+void Xoshiro256::gaussians(double* out, size_t n, double mean, double stdev)
+{
+    if (n == 0)
+    {
+        return;
+    }
+    uniforms(out, n & ~(size_t)1);
+    boxMuller(out, n & ~(size_t)1, mean, stdev);
+    if (n & 1)
+    {
+        double pair[2] = {uniform(), uniform()};
+        boxMuller(pair, 2, mean, stdev);
+        out[n - 1] = pair[0];
+    }
+}
+
+Xoshiro256& threadRandom()
+{
+    if (tRandom == NULL)
+    {
+        pthread_mutex_lock(&sThreadMutex);
+        uint64_t stream = sThreadStreams++;
+        pthread_mutex_unlock(&sThreadMutex);
+        tRandom = new Xoshiro256(Xoshiro256::stream(THREAD_SEED, stream));
+    }
+    return *tRandom;
+}
+
+void seedThreadRandom(uint64_t seed, uint64_t stream)
+{
+    if (tRandom == NULL)
+    {
+        tRandom = new Xoshiro256(seed);
+    }
+    *tRandom = Xoshiro256::stream(seed, stream);
+}
+} // namespace mlplus
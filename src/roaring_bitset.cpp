@@ -0,0 +1,495 @@
+#include <algorithm>
+#include <iterator>
+#include "roaring_bitset.h"
+namespace mlplus
+{
+namespace
+{
+struct KeyLess
+{
+    template <class C>
+    bool operator()(const C& c, uint16_t key) const
+    {
+        return c.key < key;
+    }
+};
+} // namespace
+
+const size_t RoaringBitset::ARRAY_MAX;
+const size_t RoaringBitset::BITMAP_WORDS;
+
+bool RoaringBitset::Container::contains(uint16_t low) const
+{
+    if (isBitmap())
+    {
+        return bitset::test(&bitmap[0], low);
+    }
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void RoaringBitset::Container::add(uint16_t low)
+{
+    if (isBitmap())
+    {
+        if (!bitset::test(&bitmap[0], low))
+        {
+            bitset::set(&bitmap[0], low);
+            ++cardinality;
+        }
+        return;
+    }
+    std::vector<uint16_t>::iterator it = std::lower_bound(array.begin(), array.end(), low);
+    if (it == array.end() || *it != low)
+    {
+        array.insert(it, low);
+        ++cardinality;
+        normalize();
+    }
+}
+
+void RoaringBitset::Container::normalize()
+{
+    if (isBitmap() && cardinality <= ARRAY_MAX)
+    {
+        array.clear();
+        array.reserve(cardinality);
+        for (size_t w = 0; w < BITMAP_WORDS; ++w)
+        {
+            for (uint64_t word = bitmap[w]; word != 0; word &= word - 1)
+            {
+                array.push_back((uint16_t)((w << 6) + __builtin_ctzll(word)));
+            }
+        }
+        std::vector<uint64_t>().swap(bitmap);
+    }
+    else if (!isBitmap() && cardinality > ARRAY_MAX)
+    {
+        bitmap.assign(BITMAP_WORDS, 0);
+        for (size_t i = 0; i < array.size(); ++i)
+        {
+            bitset::set(&bitmap[0], array[i]);
+        }
+        std::vector<uint16_t>().swap(array);
+    }
+}
+
+void RoaringBitset::intersect(const Container& a, const Container& b, Container& out)
+{
+    out.key = a.key;
+    if (a.isBitmap() && b.isBitmap())
+    {
+        out.bitmap.resize(BITMAP_WORDS);
+        bitset::andInto(&out.bitmap[0], &a.bitmap[0], &b.bitmap[0], BITMAP_WORDS);
+        out.cardinality = bitset::popcount(&out.bitmap[0], BITMAP_WORDS);
+    }
+    else if (a.isBitmap() || b.isBitmap())
+    {
+        const Container& sparse = a.isBitmap() ? b : a;
+        const Container& dense = a.isBitmap() ? a : b;
+        for (size_t i = 0; i < sparse.array.size(); ++i)
+        {
+            if (bitset::test(&dense.bitmap[0], sparse.array[i]))
+            {
+                out.array.push_back(sparse.array[i]);
+            }
+        }
+        out.cardinality = out.array.size();
+    }
+    else
+    {
+        std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                              std::back_inserter(out.array));
+        out.cardinality = out.array.size();
+    }
+    out.normalize();
+}
+
+void RoaringBitset::unite(const Container& a, const Container& b, Container& out)
+{
+    out.key = a.key;
+    if (a.isBitmap() && b.isBitmap())
+    {
+        out.bitmap.resize(BITMAP_WORDS);
+        bitset::orInto(&out.bitmap[0], &a.bitmap[0], &b.bitmap[0], BITMAP_WORDS);
+        out.cardinality = bitset::popcount(&out.bitmap[0], BITMAP_WORDS);
+    }
+    else if (a.isBitmap() || b.isBitmap())
+    {
+        const Container& sparse = a.isBitmap() ? b : a;
+        out.bitmap = a.isBitmap() ? a.bitmap : b.bitmap;
+        for (size_t i = 0; i < sparse.array.size(); ++i)
+        {
+            bitset::set(&out.bitmap[0], sparse.array[i]);
+        }
+        out.cardinality = bitset::popcount(&out.bitmap[0], BITMAP_WORDS);
+    }
+    else
+    {
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                       std::back_inserter(out.array));
+        out.cardinality = out.array.size();
+    }
+    out.normalize();
+}
+
+void RoaringBitset::subtract(const Container& a, const Container& b, Container& out)
+{
+    out.key = a.key;
+    if (!a.isBitmap())
+    {
+        for (size_t i = 0; i < a.array.size(); ++i)
+        {
+            if (!b.contains(a.array[i]))
+            {
+                out.array.push_back(a.array[i]);
+            }
+        }
+        out.cardinality = out.array.size();
+    }
+    else if (b.isBitmap())
+    {
+        out.bitmap.resize(BITMAP_WORDS);
+        bitset::andNotInto(&out.bitmap[0], &a.bitmap[0], &b.bitmap[0], BITMAP_WORDS);
+        out.cardinality = bitset::popcount(&out.bitmap[0], BITMAP_WORDS);
+    }
+    else
+    {
+        out.bitmap = a.bitmap;
+        for (size_t i = 0; i < b.array.size(); ++i)
+        {
+            bitset::reset(&out.bitmap[0], b.array[i]);
+        }
+        out.cardinality = bitset::popcount(&out.bitmap[0], BITMAP_WORDS);
+    }
+    out.normalize();
+}
+
+size_t RoaringBitset::andCount(const Container& a, const Container& b)
+{
+    if (a.isBitmap() && b.isBitmap())
+    {
+        return bitset::andCount(&a.bitmap[0], &b.bitmap[0], BITMAP_WORDS);
+    }
+    if (a.isBitmap() || b.isBitmap())
+    {
+        const Container& sparse = a.isBitmap() ? b : a;
+        const Container& dense = a.isBitmap() ? a : b;
+        size_t count = 0;
+        for (size_t i = 0; i < sparse.array.size(); ++i)
+        {
+            count += bitset::test(&dense.bitmap[0], sparse.array[i]);
+        }
+        return count;
+    }
+    size_t count = 0;
+    std::vector<uint16_t>::const_iterator i = a.array.begin();
+    std::vector<uint16_t>::const_iterator j = b.array.begin();
+    while (i != a.array.end() && j != b.array.end())
+    {
+        if (*i < *j)
+        {
+            ++i;
+        }
+        else if (*j < *i)
+        {
+            ++j;
+        }
+        else
+        {
+            ++count;
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+const RoaringBitset::Container* RoaringBitset::find(uint16_t key) const
+{
+    std::vector<Container>::const_iterator it = std::lower_bound(mContainers.begin(),
+            mContainers.end(), key, KeyLess());
+    return it != mContainers.end() && it->key == key ? &*it : NULL;
+}
+
+RoaringBitset RoaringBitset::fromDense(const DenseBitset& bits)
+{
+    RoaringBitset result;
+    for (size_t i = bits.findNext(0); i != DenseBitset::npos; i = bits.findNext(i + 1))
+    {
+        result.add((uint32_t)i);
+    }
+    return result;
+}
+
+void RoaringBitset::add(uint32_t value)
+{
+    uint16_t key = (uint16_t)(value >> 16);
+    std::vector<Container>::iterator it;
+    // values mostly come in ascending order
+    if (mContainers.empty() || mContainers.back().key < key)
+    {
+        mContainers.push_back(Container(key));
+        it = mContainers.end() - 1;
+    }
+    else
+    {
+        it = std::lower_bound(mContainers.begin(), mContainers.end(), key, KeyLess());
+        if (it->key != key)
+        {
+            it = mContainers.insert(it, Container(key));
+        }
+    }
+    it->add((uint16_t)value);
+}
+
+bool RoaringBitset::contains(uint32_t value) const
+{
+    const Container* c = find((uint16_t)(value >> 16));
+    return c != NULL && c->contains((uint16_t)value);
+}
+
+size_t RoaringBitset::cardinality() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < mContainers.size(); ++i)
+    {
+        count += mContainers[i].cardinality;
+    }
+    return count;
+}
+
+void RoaringBitset::intersect(const RoaringBitset& a, const RoaringBitset& b, RoaringBitset& out)
+{
+    out.clear();
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.mContainers.size() && j < b.mContainers.size())
+    {
+        const Container& x = a.mContainers[i];
+        const Container& y = b.mContainers[j];
+        if (x.key < y.key)
+        {
+            ++i;
+        }
+        else if (y.key < x.key)
+        {
+            ++j;
+        }
+        else
+        {
+            out.mContainers.push_back(Container());
+            intersect(x, y, out.mContainers.back());
+            if (out.mContainers.back().cardinality == 0)
+            {
+                out.mContainers.pop_back();
+            }
+            ++i;
+            ++j;
+        }
+    }
+}
+
+void RoaringBitset::unite(const RoaringBitset& a, const RoaringBitset& b, RoaringBitset& out)
+{
+    out.clear();
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.mContainers.size() || j < b.mContainers.size())
+    {
+        if (j == b.mContainers.size() || (i < a.mContainers.size() && a.mContainers[i].key < b.mContainers[j].key))
+        {
+            out.mContainers.push_back(a.mContainers[i++]);
+        }
+        else if (i == a.mContainers.size() || b.mContainers[j].key < a.mContainers[i].key)
+        {
+            out.mContainers.push_back(b.mContainers[j++]);
+        }
+        else
+        {
+            out.mContainers.push_back(Container());
+            unite(a.mContainers[i++], b.mContainers[j++], out.mContainers.back());
+        }
+    }
+}
+
+void RoaringBitset::subtract(const RoaringBitset& a, const RoaringBitset& b, RoaringBitset& out)
+{
+    out.clear();
+    for (size_t i = 0; i < a.mContainers.size(); ++i)
+    {
+        const Container& x = a.mContainers[i];
+        const Container* y = b.find(x.key);
+        if (y == NULL)
+        {
+            out.mContainers.push_back(x);
+            continue;
+        }
+        out.mContainers.push_back(Container());
+        subtract(x, *y, out.mContainers.back());
+        if (out.mContainers.back().cardinality == 0)
+        {
+            out.mContainers.pop_back();
+        }
+    }
+}
+
+size_t RoaringBitset::andCount(const RoaringBitset& a, const RoaringBitset& b)
+{
+    size_t count = 0;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.mContainers.size() && j < b.mContainers.size())
+    {
+        const Container& x = a.mContainers[i];
+        const Container& y = b.mContainers[j];
+        if (x.key < y.key)
+        {
+            ++i;
+        }
+        else if (y.key < x.key)
+        {
+            ++j;
+        }
+        else
+        {
+            count += andCount(x, y);
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+void RoaringBitset::intersect(const RoaringBitset& a, const DenseBitset& bits, RoaringBitset& out)
+{
+    out.clear();
+    const uint64_t* words = bits.words();
+    for (size_t i = 0; i < a.mContainers.size(); ++i)
+    {
+        const Container& c = a.mContainers[i];
+        size_t offset = (size_t)c.key * BITMAP_WORDS;
+        if (offset >= bits.numWords())
+        {
+            break;
+        }
+        size_t n = std::min(BITMAP_WORDS, bits.numWords() - offset);
+        Container result(c.key);
+        if (c.isBitmap())
+        {
+            result.bitmap.assign(BITMAP_WORDS, 0);
+            bitset::andInto(&result.bitmap[0], &c.bitmap[0], words + offset, n);
+            result.cardinality = bitset::popcount(&result.bitmap[0], n);
+        }
+        else
+        {
+            for (size_t k = 0; k < c.array.size(); ++k)
+            {
+                if (c.array[k] < n * 64 && bitset::test(words + offset, c.array[k]))
+                {
+                    result.array.push_back(c.array[k]);
+                }
+            }
+            result.cardinality = result.array.size();
+        }
+        if (result.cardinality > 0)
+        {
+            result.normalize();
+            out.mContainers.push_back(result);
+        }
+    }
+}
+
+size_t RoaringBitset::andCount(const RoaringBitset& a, const DenseBitset& bits)
+{
+    size_t count = 0;
+    const uint64_t* words = bits.words();
+    for (size_t i = 0; i < a.mContainers.size(); ++i)
+    {
+        const Container& c = a.mContainers[i];
+        size_t offset = (size_t)c.key * BITMAP_WORDS;
+        if (offset >= bits.numWords())
+        {
+            break;
+        }
+        size_t n = std::min(BITMAP_WORDS, bits.numWords() - offset);
+        if (c.isBitmap())
+        {
+            count += bitset::andCount(&c.bitmap[0], words + offset, n);
+            continue;
+        }
+        for (size_t k = 0; k < c.array.size(); ++k)
+        {
+            count += c.array[k] < n * 64 && bitset::test(words + offset, c.array[k]);
+        }
+    }
+    return count;
+}
+
+void RoaringBitset::toVector(std::vector<uint32_t>& out) const
+{
+    out.clear();
+    out.reserve(cardinality());
+    for (size_t i = 0; i < mContainers.size(); ++i)
+    {
+        const Container& c = mContainers[i];
+        uint32_t base = (uint32_t)c.key << 16;
+        if (!c.isBitmap())
+        {
+            for (size_t k = 0; k < c.array.size(); ++k)
+            {
+                out.push_back(base | c.array[k]);
+            }
+            continue;
+        }
+        for (size_t w = 0; w < BITMAP_WORDS; ++w)
+        {
+            for (uint64_t word = c.bitmap[w]; word != 0; word &= word - 1)
+            {
+                out.push_back(base | (uint32_t)((w << 6) + __builtin_ctzll(word)));
+            }
+        }
+    }
+}
+
+DenseBitset RoaringBitset::toDense(size_t size) const
+{
+    DenseBitset result(size);
+    std::vector<uint32_t> values;
+    toVector(values);
+    for (size_t i = 0; i < values.size() && values[i] < size; ++i)
+    {
+        result.set(values[i]);
+    }
+    return result;
+}
+
+bool RoaringBitset::operator==(const RoaringBitset& other) const
+{
+    // normalized containers have one layout for a set of values
+    if (mContainers.size() != other.mContainers.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < mContainers.size(); ++i)
+    {
+        const Container& x = mContainers[i];
+        const Container& y = other.mContainers[i];
+        if (x.key != y.key || x.cardinality != y.cardinality || x.array != y.array || x.bitmap != y.bitmap)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t RoaringBitset::memoryUsage() const
+{
+    size_t bytes = sizeof(*this) + mContainers.capacity() * sizeof(Container);
+    for (size_t i = 0; i < mContainers.size(); ++i)
+    {
+        bytes += mContainers[i].array.capacity() * sizeof(uint16_t)
+                 + mContainers[i].bitmap.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+} // namespace mlplus
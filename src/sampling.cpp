@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <stdexcept>
+#include "dataset.h"
+#include "thread_pool.h"
+#include "sampling.h"
+using namespace std;
+namespace mlplus
+{
+AliasTable::AliasTable(const vector<double>& weights):
+    mProbability(weights.size()), mAlias(weights.size())
+{
+    double sum = 0;
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        sum += weights[i] > 0 ? weights[i] : 0;
+    }
+    if (!(sum > 0))
+    {
+        throw runtime_error("alias table without a positive weight");
+    }
+    // scaled so the mean is 1, then every short column is topped up from a long one
+    vector<int> small, large;
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        mProbability[i] = (weights[i] > 0 ? weights[i] : 0) * weights.size() / sum;
+        mAlias[i] = i;
+        (mProbability[i] < 1 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty())
+    {
+        int s = small.back();
+        int l = large.back();
+        small.pop_back();
+        mAlias[s] = l;
+        mProbability[l] -= 1 - mProbability[s];
+        if (mProbability[l] < 1)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // what is left over is 1 up to rounding
+    for (size_t i = 0; i < small.size(); ++i)
+    {
+        mProbability[small[i]] = 1;
+    }
+    for (size_t i = 0; i < large.size(); ++i)
+    {
+        mProbability[large[i]] = 1;
+    }
+}
+
+void bootstrapIndices(int rows, int draws, SplitMix64& random, vector<int>& indices)
+{
+    indices.resize(draws > 0 && rows > 0 ? draws : 0);
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        indices[i] = random.below(rows);
+    }
+}
+
+void weightedIndices(const AliasTable& table, int draws, SplitMix64& random, vector<int>& indices)
+{
+    indices.resize(draws > 0 ? draws : 0);
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        indices[i] = table(random);
+    }
+}
+
+namespace
+{
+class BagTask : public Runnable
+{
+public:
+    BagTask(DataSet& data, uint64_t seed, int bag, int bags, vector<DataSet*>& views):
+        mData(data), mSeed(seed), mBag(bag), mBags(bags), mViews(views)
+    {
+    }
+    /*override*/ void run()
+    {
+        for (int b = mBag; b < (int)mViews.size(); b += mBags)
+        {
+            mViews[b] = mData.resample(SplitMix64::stream(mSeed, b).next());
+        }
+    }
+private:
+    DataSet& mData;
+    uint64_t mSeed;
+    int mBag;
+    int mBags;
+    vector<DataSet*>& mViews;
+};
+} // namespace
+
+void bootstrapBags(DataSet& data, int bags, uint64_t seed, int threads, vector<DataSet*>& views)
+{
+    views.assign(bags > 0 ? bags : 0, (DataSet*)NULL);
+    if (views.empty())
+    {
+        return;
+    }
+    int workers = min(threads > 0 ? threads : ThreadPool::hardwareThreads(), (int)views.size());
+    vector<BagTask*> tasks;
+    for (int i = 0; i < workers; ++i)
+    {
+        tasks.push_back(new BagTask(data, seed, i, workers, views));
+    }
+    try
+    {
+        ThreadPool pool(workers);
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            pool.submit(tasks[i]);
+        }
+        pool.wait();
+    }
+    catch (...)
+    {
+        for (size_t i = 0; i < tasks.size(); ++i)
+        {
+            delete tasks[i];
+        }
+        for (size_t i = 0; i < views.size(); ++i)
+        {
+            delete views[i];
+        }
+        views.clear();
+        throw;
+    }
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        delete tasks[i];
+    }
+}
+} // namespace mlplus
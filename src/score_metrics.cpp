@@ -0,0 +1,517 @@
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+#include <unistd.h>
+#include "score_metrics.h"
+using namespace std;
+namespace mlplus
+{
+BinaryMetrics::BinaryMetrics(double threshold):
+    mThreshold(threshold),
+    mPositive(0),
+    mNegative(0),
+    mScoreSum(0),
+    mSquaredError(0),
+    mLogLoss(0),
+    mCorrect(0)
+{
+}
+
+void BinaryMetrics::merge(const BinaryMetrics& other)
+{
+    mPositive += other.mPositive;
+    mNegative += other.mNegative;
+    mScoreSum += other.mScoreSum;
+    mSquaredError += other.mSquaredError;
+    mLogLoss += other.mLogLoss;
+    mCorrect += other.mCorrect;
+}
+
+double BinaryMetrics::accuracy() const
+{
+    return weight() > 0 ? mCorrect / weight() : 0;
+}
+
+double BinaryMetrics::rmse() const
+{
+    return weight() > 0 ? sqrt(mSquaredError / weight()) : 0;
+}
+
+double BinaryMetrics::logLoss() const
+{
+    return weight() > 0 ? mLogLoss / weight() : 0;
+}
+
+double BinaryMetrics::meanScore() const
+{
+    return weight() > 0 ? mScoreSum / weight() : 0;
+}
+
+double BinaryMetrics::meanOutcome() const
+{
+    return weight() > 0 ? mPositive / weight() : 0;
+}
+
+CurveMetrics CurveSweep::metrics() const
+{
+    CurveMetrics metrics;
+    double pairs = mTruePositive * mFalsePositive;
+    // without both outcomes any order is as good as another
+    metrics.auc = pairs > 0 ? mArea / pairs : 0.5;
+    metrics.aucError = pairs > 0 ? 0.5 * mTies / pairs : 0.5;
+    metrics.prAuc = mTruePositive > 0 ? mPrecisionSum / mTruePositive : 0;
+    return metrics;
+}
+
+ScoreHistogram::ScoreHistogram(int bins, double low, double high):
+    mLow(low),
+    mHigh(high),
+    mBins(bins > 0 ? bins : 1)
+{
+    assert(high > low);
+    mScale = mBins.size() / (high - low);
+}
+
+void ScoreHistogram::merge(const ScoreHistogram& other)
+{
+    assert(mBins.size() == other.mBins.size() && mLow == other.mLow && mHigh == other.mHigh);
+    for (size_t i = 0; i < mBins.size(); ++i)
+    {
+        mBins[i].merge(other.mBins[i]);
+    }
+}
+
+CurveMetrics ScoreHistogram::curve() const
+{
+    CurveSweep sweep;
+    for (size_t i = mBins.size(); i > 0; --i)
+    {
+        const ScoreBin& bin = mBins[i - 1];
+        if (bin.positive != 0 || bin.negative != 0)
+        {
+            sweep.add(bin.positive, bin.negative);
+        }
+    }
+    return sweep.metrics();
+}
+
+void ScoreHistogram::calibration(int buckets, vector<ScoreBin>& out) const
+{
+    out.assign(buckets > 0 ? buckets : 1, ScoreBin());
+    for (size_t i = 0; i < mBins.size(); ++i)
+    {
+        out[(uint64_t)i * out.size() / mBins.size()].merge(mBins[i]);
+    }
+}
+
+/**
+ * reads a run back, from memory or from its file
+ */
+class ScoreSorter::RunCursor
+{
+public:
+    RunCursor(const vector<Record>* records): mRecords(records), mFile(NULL), mPos(0), mSize(records->size()) {}
+    RunCursor(FILE* file): mRecords(NULL), mFile(file), mPos(0), mSize(0)
+    {
+        rewind(mFile);
+        fill();
+    }
+    bool done() const {return mPos >= mSize;}
+    const Record& top() const {return mRecords ? (*mRecords)[mPos] : mBuffer[mPos];}
+    void next()
+    {
+        if (++mPos >= mSize && mFile != NULL)
+        {
+            fill();
+        }
+    }
+private:
+    void fill()
+    {
+        mBuffer.resize(4096);
+        mSize = fread(&mBuffer[0], sizeof(Record), mBuffer.size(), mFile);
+        mPos = 0;
+    }
+    const vector<Record>* mRecords;
+    FILE* mFile;
+    vector<Record> mBuffer;
+    size_t mPos;
+    size_t mSize;
+};
+
+struct ScoreSorter::CursorOrder
+{
+    bool operator()(const RunCursor* a, const RunCursor* b) const
+    {
+        return a->top().score < b->top().score;
+    }
+};
+
+ScoreSorter::ScoreSorter(size_t memoryLimit, size_t runRecords, const string& tempDir):
+    mMemoryLimit(memoryLimit),
+    mRunRecords(runRecords > 0 ? runRecords : 1),
+    mTempDir(tempDir),
+    mMemoryUsed(0)
+{
+}
+
+ScoreSorter::~ScoreSorter()
+{
+    for (size_t i = 0; i < mMemoryRuns.size(); ++i)
+    {
+        delete mMemoryRuns[i];
+    }
+    for (size_t i = 0; i < mFileRuns.size(); ++i)
+    {
+        fclose(mFileRuns[i]);
+    }
+}
+
+bool ScoreSorter::higherScore(const Record& a, const Record& b)
+{
+    return a.score > b.score;
+}
+
+FILE* ScoreSorter::openTemp()
+{
+    if (mTempDir.empty())
+    {
+        return tmpfile();
+    }
+    string name = mTempDir + "/mlplus_scores_XXXXXX";
+    int fd = mkstemp(&name[0]);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    // the file goes away with the last descriptor
+    unlink(name.c_str());
+    return fdopen(fd, "w+b");
+}
+
+void ScoreSorter::addRun(vector<Record>& records)
+{
+    sort(records.begin(), records.end(), higherScore);
+    size_t out = 0;
+    for (size_t i = 1; i < records.size(); ++i)
+    {
+        if (records[i].score == records[out].score)
+        {
+            records[out].positive += records[i].positive;
+            records[out].negative += records[i].negative;
+        }
+        else
+        {
+            records[++out] = records[i];
+        }
+    }
+    records.resize(out + 1);
+    size_t bytes = records.size() * sizeof(Record);
+
+    ScopedLock lock(mMutex);
+    if (mMemoryUsed + bytes <= mMemoryLimit)
+    {
+        mMemoryRuns.push_back(new vector<Record>());
+        mMemoryRuns.back()->swap(records);
+        mMemoryUsed += bytes;
+        return;
+    }
+    FILE* file = openTemp();
+    if (file == NULL || fwrite(&records[0], sizeof(Record), records.size(), file) != records.size())
+    {
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+        throw runtime_error("cannot spill sorted scores to a temporary file");
+    }
+    mFileRuns.push_back(file);
+    records.clear();
+}
+
+CurveMetrics ScoreSorter::curve()
+{
+    vector<RunCursor*> cursors;
+    for (size_t i = 0; i < mMemoryRuns.size(); ++i)
+    {
+        cursors.push_back(new RunCursor(mMemoryRuns[i]));
+    }
+    for (size_t i = 0; i < mFileRuns.size(); ++i)
+    {
+        fflush(mFileRuns[i]);
+        cursors.push_back(new RunCursor(mFileRuns[i]));
+    }
+    priority_queue<RunCursor*, vector<RunCursor*>, CursorOrder> heap;
+    for (size_t i = 0; i < cursors.size(); ++i)
+    {
+        if (!cursors[i]->done())
+        {
+            heap.push(cursors[i]);
+        }
+    }
+    CurveSweep sweep;
+    bool first = true;
+    double score = 0;
+    double positive = 0;
+    double negative = 0;
+    while (!heap.empty())
+    {
+        RunCursor* cursor = heap.top();
+        heap.pop();
+        const Record& record = cursor->top();
+        if (!first && record.score != score)
+        {
+            sweep.add(positive, negative);
+            positive = negative = 0;
+        }
+        first = false;
+        score = record.score;
+        positive += record.positive;
+        negative += record.negative;
+        cursor->next();
+        if (!cursor->done())
+        {
+            heap.push(cursor);
+        }
+    }
+    if (!first)
+    {
+        sweep.add(positive, negative);
+    }
+    for (size_t i = 0; i < cursors.size(); ++i)
+    {
+        delete cursors[i];
+    }
+    return sweep.metrics();
+}
+
+ScoreSorter::Writer::Writer(ScoreSorter& sorter): mSorter(sorter)
+{
+    mRecords.reserve(mSorter.mRunRecords);
+}
+
+ScoreSorter::Writer::~Writer()
+{
+    flush();
+}
+
+void ScoreSorter::Writer::flush()
+{
+    if (!mRecords.empty())
+    {
+        mSorter.addRun(mRecords);
+        mRecords.clear();
+    }
+}
+
+GroupMetrics::GroupMetrics(int bins, double threshold):
+    mBins(bins > 0 ? bins : 1),
+    mThreshold(threshold)
+{
+}
+
+GroupMetrics::Group& GroupMetrics::group(const string& key)
+{
+    GroupMap::iterator it = mGroups.find(key);
+    if (it == mGroups.end())
+    {
+        it = mGroups.insert(make_pair(key, Group(mThreshold))).first;
+    }
+    return it->second;
+}
+
+void GroupMetrics::addBin(SparseBins& bins, int index, const ScoreBin& bin)
+{
+    // bins mostly arrive in order when groups are merged, append without a search
+    if (bins.empty() || bins.back().first < index)
+    {
+        bins.push_back(make_pair(index, bin));
+        return;
+    }
+    SparseBins::iterator it = lower_bound(bins.begin(), bins.end(), make_pair(index, ScoreBin()), binBefore);
+    if (it != bins.end() && it->first == index)
+    {
+        it->second.merge(bin);
+    }
+    else
+    {
+        bins.insert(it, make_pair(index, bin));
+    }
+}
+
+bool GroupMetrics::binBefore(const pair<int, ScoreBin>& a, const pair<int, ScoreBin>& b)
+{
+    return a.first < b.first;
+}
+
+CurveMetrics GroupMetrics::curve(const SparseBins& bins)
+{
+    CurveSweep sweep;
+    for (size_t i = bins.size(); i > 0; --i)
+    {
+        sweep.add(bins[i - 1].second.positive, bins[i - 1].second.negative);
+    }
+    return sweep.metrics();
+}
+
+void GroupMetrics::merge(const GroupMetrics& other)
+{
+    assert(mBins == other.mBins);
+    for (GroupMap::const_iterator it = other.mGroups.begin(); it != other.mGroups.end(); ++it)
+    {
+        Group& g = group(it->first);
+        g.metrics.merge(it->second.metrics);
+        for (size_t i = 0; i < it->second.bins.size(); ++i)
+        {
+            addBin(g.bins, it->second.bins[i].first, it->second.bins[i].second);
+        }
+    }
+}
+
+double GroupMetrics::groupAuc(double* error) const
+{
+    double weight = 0;
+    double auc = 0;
+    double bound = 0;
+    for (GroupMap::const_iterator it = mGroups.begin(); it != mGroups.end(); ++it)
+    {
+        const BinaryMetrics& metrics = it->second.metrics;
+        if (metrics.positives() > 0 && metrics.negatives() > 0)
+        {
+            CurveMetrics c = curve(it->second.bins);
+            weight += metrics.weight();
+            auc += metrics.weight() * c.auc;
+            bound += metrics.weight() * c.aucError;
+        }
+    }
+    if (error != NULL)
+    {
+        *error = weight > 0 ? bound / weight : 0.5;
+    }
+    return weight > 0 ? auc / weight : 0.5;
+}
+
+void GroupMetrics::write(FILE* out) const
+{
+    vector<const GroupMap::value_type*> groups;
+    for (GroupMap::const_iterator it = mGroups.begin(); it != mGroups.end(); ++it)
+    {
+        groups.push_back(&*it);
+    }
+    sort(groups.begin(), groups.end(), keyBefore);
+    for (size_t i = 0; i < groups.size(); ++i)
+    {
+        const BinaryMetrics& metrics = groups[i]->second.metrics;
+        fprintf(out, "%s\t%.0f\t%.0f\t%.6f\t%.6f\t%.6f\t%.6f\n", groups[i]->first.c_str(),
+                metrics.weight(), metrics.positives(), curve(groups[i]->second.bins).auc,
+                metrics.logLoss(), metrics.meanScore(), metrics.meanOutcome());
+    }
+}
+
+bool GroupMetrics::keyBefore(const GroupMap::value_type* a, const GroupMap::value_type* b)
+{
+    return a->first < b->first;
+}
+
+namespace
+{
+const double POWERS_OF_TEN[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                                1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+                                1e21, 1e22};
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+} // namespace
+
+const char* parseDouble(const char* p, const char* end, double& value)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+    {
+        ++p;
+    }
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p++ == '-';
+    }
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for (; p < end && isDigit(*p); ++p, any = true)
+    {
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+        }
+        else
+        {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && isDigit(*p); ++p, any = true)
+        {
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+                --exponent;
+            }
+        }
+    }
+    if (!any)
+    {
+        // nan, inf, hexadecimal and the like
+        char buffer[64];
+        size_t length = min((size_t)(end - start), sizeof(buffer) - 1);
+        memcpy(buffer, start, length);
+        buffer[length] = '\0';
+        char* stop = NULL;
+        value = strtod(buffer, &stop);
+        return stop == buffer ? NULL : start + (stop - buffer);
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char* e = p + 1;
+        bool negativeExponent = false;
+        if (e < end && (*e == '-' || *e == '+'))
+        {
+            negativeExponent = *e++ == '-';
+        }
+        if (e < end && isDigit(*e))
+        {
+            int x = 0;
+            for (; e < end && isDigit(*e); ++e)
+            {
+                x = x < 10000 ? x * 10 + (*e - '0') : x;
+            }
+            exponent += negativeExponent ? -x : x;
+            p = e;
+        }
+    }
+    double v = (double)mantissa;
+    if (exponent < 0 && exponent >= -22)
+    {
+        v /= POWERS_OF_TEN[-exponent];
+    }
+    else if (exponent > 0 && exponent <= 22)
+    {
+        v *= POWERS_OF_TEN[exponent];
+    }
+    else if (exponent != 0)
+    {
+        v *= pow(10.0, exponent);
+    }
+    value = negative ? -v : v;
+    return p;
+}
+} // namespace mlplus
@@ -0,0 +1,100 @@
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include "memory_accounting.h"
+#include "estimators/striped_counter.h"
+namespace mlplus
+{
+namespace estimators
+{
+
+__thread int StripedCounter::tThreadStripe = -1;
+
+static int sThreadStripeCounter = 0;
+
+int StripedCounter::nextThreadStripe()
+{
+    return __sync_fetch_and_add(&sThreadStripeCounter, 1) & 0x7FFFFFFF;
+}
+
+StripedCounter::StripedCounter(int width, int numStripes):
+    mData(NULL), mWidth(0), mStride(0), mNumStripes(numStripes > 0 ? numStripes : 1)
+{
+    allocate(width);
+}
+
+StripedCounter::~StripedCounter()
+{
+    deallocate();
+}
+
+void StripedCounter::allocate(int width)
+{
+    if (width < 0)
+    {
+        throw std::invalid_argument("negative striped counter width");
+    }
+    const int perLine = CACHE_LINE_SIZE / sizeof(double);
+    mWidth = width;
+    mStride = (width + perLine - 1) / perLine * perLine;
+    if (mStride == 0)
+    {
+        mStride = perLine;
+    }
+    void* p = NULL;
+    if (posix_memalign(&p, CACHE_LINE_SIZE, sizeof(double) * mStride * mNumStripes) != 0)
+    {
+        throw std::bad_alloc();
+    }
+    mData = static_cast<double*>(p);
+    memory::charge(memory::ESTIMATORS, memoryUsage());
+    clear();
+}
+
+void StripedCounter::deallocate()
+{
+    if (mData != NULL)
+    {
+        memory::release(memory::ESTIMATORS, memoryUsage());
+        free(mData);
+        mData = NULL;
+    }
+}
+
+void StripedCounter::reset(int width)
+{
+    deallocate();
+    allocate(width);
+}
+
+void StripedCounter::clear()
+{
+    memset(mData, 0, sizeof(double) * mStride * mNumStripes);
+}
+
+double StripedCounter::sum(int slot) const
+{
+    double total = 0;
+    const volatile double* p = mData + slot;
+    for (int i = 0; i < mNumStripes; ++i, p += mStride)
+    {
+        total += *p;
+    }
+    return total;
+}
+
+void StripedCounter::foldInto(double* out) const
+{
+    for (int i = 0; i < mNumStripes; ++i)
+    {
+        const volatile double* stripe = mData + i * mStride;
+        for (int j = 0; j < mWidth; ++j)
+        {
+            out[j] += stripe[j];
+        }
+    }
+}
+
+} // namespace estimators
+} // namespace mlplus
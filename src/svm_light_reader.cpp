@@ -0,0 +1,169 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "svm_light_reader.h"
+#include "attribute.h"
+#include "attribute_container.h"
+#include "dataset.h"
+#include "feature_hasher.h"
+#include "instance.h"
+#include "instance_container.h"
+namespace mlplus
+{
+using namespace std;
+
+static inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static void badField(size_t lineNo, const char* field, const char* end)
+{
+    ostringstream message;
+    message << "svm-light line " << lineNo << ": bad field '" << string(field, end) << "'";
+    throw runtime_error(message.str());
+}
+
+/**
+ * @brief add the attribute of index, named by [name, nameEnd), the first time
+ *        it is seen
+ */
+static void addAttribute(IAttributeContainer* attributes, vector<bool>& seen, int index,
+                         const char* name, const char* nameEnd)
+{
+    if (index < 0)
+    {
+        throw runtime_error("svm-light feature id below the first attribute");
+    }
+    if ((size_t)index >= seen.size())
+    {
+        seen.resize(index + 1, false);
+    }
+    if (!seen[index])
+    {
+        seen[index] = true;
+        Attribute* attribute = new Attribute(string(name, nameEnd), Attribute::BINARY);
+        attribute->setIndex(index);
+        attributes->add(attribute);
+    }
+}
+
+DataSet* readSvmLight(const string& path, int idShift, const FeatureHasher* hasher)
+{
+    ifstream in(path.c_str());
+    if (!in.is_open())
+    {
+        return NULL;
+    }
+    IAttributeContainer* attributes = new MapAttributeContainer();
+    IInstanceContainer* instances = new SparseInstanceContainer();
+    DataSet* dataset = new DataSet("sparse_classify", attributes, instances);
+    vector<bool> seen;
+    vector<FeatureHasher::HashedFeature> hashed;
+    vector<ValueType> values;
+    vector<int> indices;
+    string line;
+    size_t lineNo = 0;
+    try
+    {
+        while (getline(in, line))
+        {
+            ++lineNo;
+            const char* p = line.c_str();
+            while (isBlank(*p))
+            {
+                ++p;
+            }
+            if (*p == '\0')
+            {
+                continue;
+            }
+            values.clear();
+            indices.clear();
+            const char* field = p;
+            while (*p != '\0' && !isBlank(*p))
+            {
+                ++p;
+            }
+            char* end = NULL;
+            ValueType label = strtod(field, &end);
+            if (end != p)
+            {
+                badField(lineNo, field, p);
+            }
+            addAttribute(attributes, seen, 0, field, p);
+            indices.push_back(0);
+            values.push_back(label - 1);
+            while (*p != '\0')
+            {
+                while (isBlank(*p))
+                {
+                    ++p;
+                }
+                if (*p == '\0')
+                {
+                    break;
+                }
+                field = p;
+                while (*p != '\0' && !isBlank(*p))
+                {
+                    ++p;
+                }
+                long id = strtol(field, &end, 10);
+                if (end == field || *end != ':')
+                {
+                    badField(lineNo, field, p);
+                }
+                const char* valueText = end + 1;
+                ValueType value = strtod(valueText, &end);
+                if (end == valueText || end != p)
+                {
+                    badField(lineNo, field, p);
+                }
+                if (hasher != NULL)
+                {
+                    hasher->add((int)id, value, hashed);
+                    continue;
+                }
+                int index = (int)id + idShift;
+                if (index == 0)
+                {
+                    continue;
+                }
+                addAttribute(attributes, seen, index, field, valueText - 1);
+                indices.push_back(index);
+                values.push_back(value);
+            }
+            if (hasher != NULL)
+            {
+                size_t first = indices.size();
+                FeatureHasher::finish(hashed, indices, values, 1);
+                hashed.clear();
+                for (size_t j = first; j < indices.size(); ++j)
+                {
+                    if ((size_t)indices[j] < seen.size() && seen[indices[j]])
+                    {
+                        continue;
+                    }
+                    char name[16];
+                    int length = snprintf(name, sizeof(name), "%d", indices[j]);
+                    addAttribute(attributes, seen, indices[j], name, name + length);
+                }
+            }
+            IInstance* instance = new SparseInstance(values, indices, 1);
+            instance->setDataset(dataset);
+            instances->add(instance);
+        }
+    }
+    catch (...)
+    {
+        delete dataset;
+        throw;
+    }
+    dataset->setTargetIndex(0);
+    return dataset;
+}
+} // namespace mlplus
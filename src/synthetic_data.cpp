@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <sstream>
+#include <vector>
+#include "synthetic_data.h"
+namespace mlplus
+{
+namespace
+{
+const char* const EXPRESSION_OPERATORS[] = {" + ", " * ", " - ", " / "};
+
+double helper1(double x)
+{
+    // log1p(x) / x
+    return fabs(x) > 1e-8 ? log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+}
+
+double helper2(double x)
+{
+    // expm1(x) / x
+    return fabs(x) > 1e-8 ? expm1(x) / x : 1 + x * 0.5 * (1 + x / 3 * (1 + 0.25 * x));
+}
+
+void appendUint(std::string& out, uint64_t v)
+{
+    char buffer[24];
+    char* p = buffer + sizeof(buffer);
+    do
+    {
+        *--p = '0' + v % 10;
+        v /= 10;
+    } while (v != 0);
+    out.append(p, buffer + sizeof(buffer) - p);
+}
+
+/**
+ * @brief v with 4 decimals, much faster than printf for the bulk of a dense row
+ */
+void appendFixed4(std::string& out, double v)
+{
+    if (v < 0)
+    {
+        out += '-';
+        v = -v;
+    }
+    uint64_t scaled = (uint64_t)(v * 10000 + 0.5);
+    appendUint(out, scaled / 10000);
+    char fraction[5] = {'.', 0, 0, 0, 0};
+    uint64_t f = scaled % 10000;
+    for (int i = 4; i > 0; --i)
+    {
+        fraction[i] = '0' + f % 10;
+        f /= 10;
+    }
+    out.append(fraction, 5);
+}
+
+/**
+ * @brief the class counts of a node, whose class is the largest count
+ */
+int writeFrequencies(int classes, SplitMix64& random, std::ostream& out)
+{
+    int best = 0;
+    uint32_t bestCount = 0;
+    out << " freq=\"";
+    for (int c = 0; c < classes; ++c)
+    {
+        uint32_t count = random.below(1000);
+        if (count > bestCount)
+        {
+            best = c;
+            bestCount = count;
+        }
+        out << (c > 0 ? "," : "") << count;
+    }
+    out << "\"";
+    return best;
+}
+} // namespace
+
+ZipfDistribution::ZipfDistribution(uint32_t n, double exponent): mN(n < 1 ? 1 : n), mExponent(exponent)
+{
+    mHIntegralX1 = hIntegral(1.5) - 1;
+    mHIntegralN = hIntegral(mN + 0.5);
+    mS = 2 - hIntegralInverse(hIntegral(2.5) - h(2));
+}
+
+double ZipfDistribution::h(double x) const
+{
+    return exp(-mExponent * log(x));
+}
+
+double ZipfDistribution::hIntegral(double x) const
+{
+    double logX = log(x);
+    return helper2((1 - mExponent) * logX) * logX;
+}
+
+double ZipfDistribution::hIntegralInverse(double x) const
+{
+    double t = x * (1 - mExponent);
+    if (t < -1)
+    {
+        // only rounding errors get here
+        t = -1;
+    }
+    return exp(helper1(t) * x);
+}
+
+void SyntheticDataGenerator::writeNames(const DenseDataSpec& spec, std::ostream& out)
+{
+    out << "class.                         | the target attribute\n\nclass: ";
+    for (int c = 0; c < spec.classes; ++c)
+    {
+        out << (c > 0 ? ", c" : "c") << c;
+    }
+    out << ".\n";
+    for (int i = 0; i < spec.numeric; ++i)
+    {
+        out << "n" << i << ": continuous.\n";
+    }
+    for (int i = 0; i < spec.nominal; ++i)
+    {
+        out << "s" << i << ": ";
+        for (int v = 0; v < spec.nominalValues; ++v)
+        {
+            out << (v > 0 ? ", v" : "v") << v;
+        }
+        out << ".\n";
+    }
+    for (int i = 0; spec.numeric > 0 && i < spec.implicit; ++i)
+    {
+        // division by (n + 1) keeps away from 0, the numeric values are positive
+        const char* op = EXPRESSION_OPERATORS[i % 4];
+        int a = i % spec.numeric;
+        int b = (i + 1) % spec.numeric;
+        if (op[1] == '/')
+        {
+            out << "x" << i << ":= n" << a << " / (n" << b << " + 1).\n";
+        }
+        else
+        {
+            out << "x" << i << ":= n" << a << op << "n" << b << ".\n";
+        }
+    }
+}
+
+void SyntheticDataGenerator::appendDenseRows(const DenseDataSpec& spec, uint64_t first, uint64_t count,
+                                             std::string& out) const
+{
+    for (uint64_t row = first; row < first + count; ++row)
+    {
+        SplitMix64 random = rowRandom(row);
+        uint32_t klass = random.below(spec.classes);
+        out += 'c';
+        appendUint(out, klass);
+        for (int i = 0; i < spec.numeric; ++i)
+        {
+            out += ',';
+            appendFixed4(out, klass * 0.5 + random.uniform() * 4);
+        }
+        for (int i = 0; i < spec.nominal; ++i)
+        {
+            uint32_t v = random.below(3) == 0 ? klass % spec.nominalValues : random.below(spec.nominalValues);
+            out += ",v";
+            appendUint(out, v);
+        }
+        out += '\n';
+    }
+}
+
+void SyntheticDataGenerator::appendSparseRows(const SparseDataSpec& spec, uint64_t first, uint64_t count,
+                                              std::string& out) const
+{
+    ZipfDistribution zipf(spec.features, spec.zipfExponent);
+    std::vector<uint32_t> ids;
+    for (uint64_t row = first; row < first + count; ++row)
+    {
+        SplitMix64 random = rowRandom(row);
+        uint32_t klass = random.below(spec.classes);
+        uint32_t offset = (uint32_t)((uint64_t)spec.features * klass / spec.classes);
+        int draws = 1 + random.below(2 * std::max(spec.featuresPerRow, 1) - 1);
+        ids.clear();
+        for (int i = 0; i < draws; ++i)
+        {
+            uint32_t id = zipf(random) - 1;
+            if (random.below(2) == 0)
+            {
+                id = (id + offset) % spec.features;
+            }
+            ids.push_back(id + 1);
+        }
+        std::sort(ids.begin(), ids.end());
+        appendUint(out, klass + 1);
+        for (size_t i = 0; i < ids.size();)
+        {
+            size_t j = i + 1;
+            while (j < ids.size() && ids[j] == ids[i])
+            {
+                ++j;
+            }
+            out += ' ';
+            appendUint(out, ids[i]);
+            out += ':';
+            appendUint(out, j - i);
+            i = j;
+        }
+        out += '\n';
+    }
+}
+
+void SyntheticDataGenerator::writeBoostedTrees(const DenseDataSpec& spec, const TreeModelSpec& model,
+                                               std::ostream& out) const
+{
+    out << "id=\"mlplus gen_data\"\n";
+    out << "entries=\"" << model.trees << "\"\n";
+    for (int t = 0; t < model.trees; ++t)
+    {
+        // the trees use the streams after the ones of the rows
+        SplitMix64 random = rowRandom(~(uint64_t)t);
+        writeTree(spec, random, model.depth, out);
+    }
+}
+
+/**
+ * A node is a line of C5 properties followed by its forks. Continuous splits
+ * have the forks missing, <= cut and > cut, discrete splits missing and one
+ * per value. The missing fork and all but one value fork are leaves.
+ * Every node carries class counts, which classify() reads as confidences.
+ */
+void SyntheticDataGenerator::writeTree(const DenseDataSpec& spec, SplitMix64& random, int depth,
+                                       std::ostream& out) const
+{
+    int attributes = spec.numeric + spec.nominal;
+    std::ostringstream frequencies;
+    int klass = writeFrequencies(spec.classes, random, frequencies);
+    if (depth <= 0 || attributes == 0)
+    {
+        out << "type=\"0\" class=\"c" << klass << "\"" << frequencies.str() << "\n";
+        return;
+    }
+    int attribute = random.below(attributes);
+    if (attribute < spec.numeric)
+    {
+        double cut = random.uniform() * (4 + 0.5 * (spec.classes - 1));
+        out << "type=\"2\" class=\"c" << klass << "\"" << frequencies.str() << " att=\"n" << attribute
+            << "\" forks=\"3\" cut=\"" << cut << "\"\n";
+        writeTree(spec, random, 0, out);
+        writeTree(spec, random, depth - 1, out);
+        writeTree(spec, random, depth - 1, out);
+    }
+    else
+    {
+        out << "type=\"1\" class=\"c" << klass << "\"" << frequencies.str() << " att=\"s"
+            << attribute - spec.numeric << "\" forks=\"" << spec.nominalValues + 1 << "\"\n";
+        writeTree(spec, random, 0, out);
+        uint32_t grown = random.below(spec.nominalValues);
+        for (int v = 0; v < spec.nominalValues; ++v)
+        {
+            writeTree(spec, random, v == (int)grown ? depth - 1 : 0, out);
+        }
+    }
+}
+} // namespace mlplus
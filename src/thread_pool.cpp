@@ -0,0 +1,145 @@
+#include <unistd.h>
+#include <exception>
+#include <stdexcept>
+#include "thread_pool.h"
+namespace mlplus
+{
+Mutex::Mutex()
+{
+    pthread_mutex_init(&mMutex, NULL);
+}
+
+Mutex::~Mutex()
+{
+    pthread_mutex_destroy(&mMutex);
+}
+
+Condition::Condition()
+{
+    pthread_cond_init(&mCond, NULL);
+}
+
+Condition::~Condition()
+{
+    pthread_cond_destroy(&mCond);
+}
+
+int ThreadPool::hardwareThreads()
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+ThreadPool::ThreadPool(int threads): mRunning(0), mStop(false)
+{
+    if (threads < 1)
+    {
+        threads = hardwareThreads();
+    }
+    mThreads.reserve(threads);
+    for (int i = 0; i < threads; ++i)
+    {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, workerMain, this) != 0)
+        {
+            break;
+        }
+        mThreads.push_back(thread);
+    }
+    if (mThreads.empty())
+    {
+        throw std::runtime_error("cannot start thread pool workers");
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        ScopedLock lock(mMutex);
+        while (!mTasks.empty() || mRunning > 0)
+        {
+            mIdle.wait(mMutex);
+        }
+        mStop = true;
+        mHasTask.broadcast();
+    }
+    for (size_t i = 0; i < mThreads.size(); ++i)
+    {
+        pthread_join(mThreads[i], NULL);
+    }
+}
+
+void ThreadPool::submit(Runnable* task)
+{
+    ScopedLock lock(mMutex);
+    mTasks.push_back(task);
+    mHasTask.signal();
+}
+
+void ThreadPool::wait()
+{
+    std::string error;
+    {
+        ScopedLock lock(mMutex);
+        while (!mTasks.empty() || mRunning > 0)
+        {
+            mIdle.wait(mMutex);
+        }
+        error.swap(mError);
+    }
+    if (!error.empty())
+    {
+        throw std::runtime_error(error);
+    }
+}
+
+void* ThreadPool::workerMain(void* pool)
+{
+    static_cast<ThreadPool*>(pool)->work();
+    return NULL;
+}
+
+void ThreadPool::work()
+{
+    for (;;)
+    {
+        Runnable* task = NULL;
+        {
+            ScopedLock lock(mMutex);
+            while (!mStop && mTasks.empty())
+            {
+                mHasTask.wait(mMutex);
+            }
+            if (mTasks.empty())
+            {
+                return;
+            }
+            task = mTasks.front();
+            mTasks.pop_front();
+            ++mRunning;
+        }
+        std::string error;
+        try
+        {
+            task->run();
+        }
+        catch (std::exception& e)
+        {
+            error = e.what();
+        }
+        catch (...)
+        {
+            error = "unknown exception in thread pool task";
+        }
+        ScopedLock lock(mMutex);
+        if (mError.empty() && !error.empty())
+        {
+            mError = error;
+        }
+        if (--mRunning == 0 && mTasks.empty())
+        {
+            mIdle.broadcast();
+        }
+    }
+}
+} // namespace mlplus
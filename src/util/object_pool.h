@@ -1,112 +1,32 @@
 #ifndef MLPLUS_OBJECT_POOL_H
 #define MLPLUS_OBJECT_POOL_H
 #include <cstddef>
-#include <vector>
+#include "pool_allocator.h"
 
 namespace mlplus
 {
 
+/**
+ * Objects of type T from the size class of MemoryPool that fits them.  Pools
+ * of types of about the same size share their free lists, every thread has
+ * its own, and memory outlives the pool; see MemoryPool::releaseFreeBlocks().
+ * Classes allocated one at a time use MLPLUS_POOL_ALLOCATED instead.
+ */
 template <typename T>
 class ObjectPool
 {
 public:
-    ObjectPool(int blockSize = 512);
-    ~ObjectPool();
+    // the block size is chosen by MemoryPool now
+    ObjectPool(int blockSize = 512) {}
 public:
-    void * alloc(size_t size);
-    void free(void *mem, size_t size);
-
-private:
-    //make sure allocated memory can hold a pointer
-    union AllocateElement
+    void * alloc(size_t size)
     {
-        char mPlacehodler[sizeof(T)];
-        AllocateElement *mNext;
-    };
-    int mBlockSize;
-    AllocateElement *mHeadOfFreeList;
-    std::vector<void *> mBlockMem;
-};
-
-template <typename T>
-ObjectPool<T>::ObjectPool(int blockSize)
-{
-    mBlockSize = blockSize;
-    mHeadOfFreeList = NULL;
-}
-
-template <typename T>
-ObjectPool<T>::~ObjectPool()
-{
-    std::vector<void *>::iterator it = mBlockMem.begin();
-    for(; it != mBlockMem.end(); it++)
-    {
-        ::operator delete(*it);
+        return MemoryPool::allocate(sizeof(T));
     }
-}
-
-template <typename T>
-void * ObjectPool<T>::alloc(size_t size)
-{
-    AllocateElement *p = mHeadOfFreeList;
-    if(p != NULL)
+    void free(void *mem, size_t size)
     {
-        mHeadOfFreeList = p->mNext;
+        MemoryPool::deallocate(mem, sizeof(T));
     }
-    else
-    {
-        void *blockMem = ::operator new(mBlockSize * sizeof(AllocateElement));
-        AllocateElement *newMem = static_cast<AllocateElement *>(blockMem);
-
-        //record begin address of block
-        mBlockMem.push_back(blockMem);
-
-        //create free list
-        for(int i = 1; i < (mBlockSize - 1); i++)
-        {
-            newMem[i].mNext = newMem + i + 1;
-        }
-
-        newMem[mBlockSize - 1].mNext = NULL;
-
-        p = newMem;
-        mHeadOfFreeList = newMem + 1;
-    }
-    return static_cast<void *>(p);
-}
-
-template <typename T>
-void ObjectPool<T>::free(void *mem, size_t size)
-{
-    if(mem == NULL)
-    {
-        return;
-    }
-    AllocateElement *objMem = static_cast<AllocateElement *>(mem);
-    objMem->mNext = mHeadOfFreeList;
-    mHeadOfFreeList = objMem;
-}
-
-/*
-#define DECLARE_MEMORY_POOL(Cls) \
-  public: \
-  static void* operator new(size_t s) \
-  { \
-          assert(s == sizeof(Cls)); \
-          return MemoryPool<sizeof(Cls)> \
-                 ::instance().allocate(); \
-        } \
-  static void operator delete(void* p) \
-  { \
-          if (p != NULL) \
-            MemoryPool<sizeof(Cls)> \
-            ::instance().deallocate(p); \
-  }
-
-class Obj {
-      ...
-      DECLARE_MEMORY_POOL(Obj)
 };
-*/
 }
 #endif
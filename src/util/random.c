@@ -1,34 +1,102 @@
+#include <stdio.h>
 #include "sysdefines.h"
-#include "Debug.h"
+#include "debug.h"
 #include "random.h"
 #include "memory.h"
 #include <time.h>
 #include <math.h>
+#include <stdint.h>
+#include <string.h>
 
 #if defined(WIN32)
-#define srandom srand
-#define random rand 
 #define M_PI 3.14159265358979323846264338327
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
 #endif
 
-void RandomInit(void) {
-   srandom(time(NULL));
+/* xoshiro256++, the same generator and seeding as mlplus::Xoshiro256 in
+   include/rng.h, so a seed gives the same numbers from C and C++. Every
+   thread has its own current state, so threads never share or lock one. */
+
+typedef struct _RandomState_ {
+   uint64_t s[4];
+} RandomState;
+
+static THREAD_LOCAL RandomState _threadState;
+static THREAD_LOCAL RandomState *_currentState = 0;
+static THREAD_LOCAL int _threadSeeded = 0;
+
+static uint64_t _SplitMix64(uint64_t *x) {
+   uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+   return z ^ (z >> 31);
 }
 
-static long _SysGetRandom(void) {
-   return random();
+static void _StateSeed(RandomState *state, uint64_t seed) {
+   int i;
+   for(i = 0 ; i < 4 ; i++) {
+      state->s[i] = _SplitMix64(&seed);
+   }
+}
+
+static uint64_t _Rotl(uint64_t x, int k) {
+   return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t _StateNext(RandomState *state) {
+   uint64_t *s = state->s;
+   uint64_t result = _Rotl(s[0] + s[3], 23) + s[0];
+   uint64_t t = s[1] << 17;
+   s[2] ^= s[0];
+   s[3] ^= s[1];
+   s[1] ^= s[2];
+   s[0] ^= s[3];
+   s[2] ^= t;
+   s[3] = _Rotl(s[3], 45);
+   return result;
+}
+
+/* advances by 2^128 draws, Xoshiro256::jump() */
+static void _StateJump(RandomState *state) {
+   static const uint64_t jump[4] = { 0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull,
+                                     0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+   uint64_t s[4] = { 0, 0, 0, 0 };
+   int i, b, k;
+   for(i = 0 ; i < 4 ; i++) {
+      for(b = 0 ; b < 64 ; b++) {
+         if(jump[i] & (1ull << b)) {
+            for(k = 0 ; k < 4 ; k++) {
+               s[k] ^= state->s[k];
+            }
+         }
+         _StateNext(state);
+      }
+   }
+   memcpy(state->s, s, sizeof(s));
+}
+
+static RandomState *_State(void) {
+   if(_currentState == 0) {
+      _currentState = &_threadState;
+   }
+   if(!_threadSeeded && _currentState == &_threadState) {
+      /* unseeded threads start from the same state, like srandom(1) did */
+      _StateSeed(&_threadState, 1);
+      _threadSeeded = 1;
+   }
+   return _currentState;
 }
 
-static void _SysRandomSeed(unsigned int seed) {
-   srandom(seed);
+void RandomInit(void) {
+   RandomSeed(time(NULL));
 }
 
 int RandomRange(int min, int max) {
-   int tmpNum;
    if (min < max) {
-      tmpNum = _SysGetRandom();
-      tmpNum = min + (int)(((float)((max - min) + 1) * tmpNum) / (RAND_MAX + 1.0));
-      return tmpNum;
+      uint64_t span = (uint64_t)((int64_t)max - min) + 1;
+      return min + (int)(((_StateNext(_State()) >> 32) * span) >> 32);
    } else if (min == max) {
       return (min);
    } else {
@@ -38,59 +106,55 @@ int RandomRange(int min, int max) {
 }
 
 void RandomSeed(unsigned int seed) {
-   _SysRandomSeed(seed);
+   _StateSeed(_State(), seed);
+}
+
+void RandomSeedStream(unsigned int seed, unsigned int stream) {
+   RandomState *state = _State();
+   unsigned int i;
+   _StateSeed(state, seed);
+   for(i = 0 ; i < stream ; i++) {
+      _StateJump(state);
+   }
 }
 
 long RandomLong(void) {
-   return _SysGetRandom();
+   /* non negative like random() */
+   return (long)(_StateNext(_State()) >> 33);
 }
 
 double RandomDouble(void) {
-   return ((double)RandomRange(0, 30000)) / 30000.0;
+   return (_StateNext(_State()) >> 11) * (1.0 / 9007199254740992.0);
 }
 
 double RandomStandardNormal(void) {
-   /* Generates a number according to a standard normal distribution using
-         the Box-Mulder method */
-   double u1, u2;
-   u1 = u2 = 0;
-
-   while(u1 * u2 == 0) {
-      u1 = RandomDouble();
-      u2 = RandomDouble();
-   }
-   return sqrt(-2. * log(u1)) * cos(2 * M_PI * u2);
+   /* Box-Muller, 1 - u keeps the logarithm finite */
+   double u1 = RandomDouble();
+   double u2 = RandomDouble();
+   return sqrt(-2. * log(1. - u1)) * cos(2 * M_PI * u2);
 }
 
 double RandomGaussian(double mean, double stdev) {
    return stdev * RandomStandardNormal() + 1. * mean;
 }
 
+void *RandomSetState(void *state) {
+   RandomState *previous = _State();
+   _currentState = state ? (RandomState *)state : &_threadState;
+   return previous;
+}
 
-#if defined(WIN32)
- /* WIN32 doesn't support this state stuff, HERE I better do something! */
- void *RandomSetState(void *state) {
-    return 0;
- }
-
- void *RandomNewState(unsigned int seed) {
-    return 0;
- }
-
- void RandomFreeState(void *state) {
- }
-
-#else
-
- void *RandomSetState(void *state) {
-    return (void *)setstate(state);
- }
-
- void *RandomNewState(unsigned int seed) {
-   return (void *)initstate(seed, MNewPtr(300), 16);
- }
+void *RandomNewState(unsigned int seed) {
+   /* the new state becomes current, as initstate made it */
+   RandomState *state = (RandomState *)MNewPtr(sizeof(RandomState));
+   _StateSeed(state, seed);
+   _currentState = state;
+   return state;
+}
 
- void RandomFreeState(void *state) {
+void RandomFreeState(void *state) {
+   if(state == _currentState) {
+      _currentState = &_threadState;
+   }
    MFreePtr(state);
- }
-#endif
+}
@@ -30,14 +30,22 @@ double RandomGaussian(double mean, double stdev);
 /** \brief Samples from the standard normal distribution. */
 double RandomStandardNormal(void);
 
-/** \brief Seeds the random number generator. */
+/** \brief Seeds the random number generator of the calling thread. */
 void RandomSeed(unsigned int seed);
 
+/** \brief Seeds the calling thread with stream number stream of seed.
+
+Streams of one seed do not overlap, so the workers of a parallel job seeded
+with their task numbers draw the same numbers however the tasks are spread
+over threads. The same as mlplus::Xoshiro256::stream(seed, stream).
+*/
+void RandomSeedStream(unsigned int seed, unsigned int stream);
+
 /** \brief Creates a new random state to use with RandomSetState. 
 
 Each state represents a separate stream of repeatable random numbers.
-This is implemented with initstate and setstate on Unix and is
-currently not supported on windows.
+The new state becomes the current state of the calling thread, as it did
+with initstate.
 */
 void *RandomNewState(unsigned int seed);
 
@@ -45,11 +53,15 @@ void *RandomNewState(unsigned int seed);
 
 The state parameter should have been made by RandomNewState. This
 allows you to have multiple repeatable random number sequences at
-once.  Returns the previous state.
+once.  The current state belongs to the calling thread.  Returns the
+previous state.
 */
 void *RandomSetState(void *state);
 
-/** \brief Use this to free any state made with RandomNewState */
+/** \brief Use this to free any state made with RandomNewState.
+
+Freeing the current state puts the calling thread back on its own state.
+*/
 void RandomFreeState(void *state);
 
 #endif
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "vector_math.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+namespace mlplus
+{
+using namespace std;
+
+#ifdef __SSE2__
+namespace
+{
+/**
+ * fastExp() on two lanes, same constants and same rounding
+ */
+inline __m128d expPd(__m128d x)
+{
+    const __m128d lo = _mm_set1_pd(FAST_EXP_MIN);
+    const __m128d hi = _mm_set1_pd(FAST_EXP_MAX);
+    __m128d nan = _mm_cmpunord_pd(x, x);
+    __m128d under = _mm_cmplt_pd(x, lo);
+    __m128d over = _mm_cmpgt_pd(x, hi);
+    __m128d xc = _mm_min_pd(_mm_max_pd(x, lo), hi);
+
+    //rounds to nearest like rint() under the default MXCSR mode
+    __m128i ni = _mm_cvtpd_epi32(_mm_mul_pd(xc, _mm_set1_pd(detail::LOG2E)));
+    __m128d n = _mm_cvtepi32_pd(ni);
+    __m128d r = _mm_sub_pd(xc, _mm_mul_pd(n, _mm_set1_pd(detail::LN2_HI)));
+    r = _mm_sub_pd(r, _mm_mul_pd(n, _mm_set1_pd(detail::LN2_LO)));
+
+    __m128d p = _mm_set1_pd(1.0 / 40320);
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 5040));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 720));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 120));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 24));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 6));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0 / 2));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0));
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(1.0));
+
+    //2^(n - 1): the biased exponent moved to bits 52..62 of each 64 bit lane
+    __m128i e = _mm_add_epi32(ni, _mm_set1_epi32(1023 - 1));
+    e = _mm_shuffle_epi32(e, _MM_SHUFFLE(1, 1, 0, 0));
+    e = _mm_slli_epi64(e, 52);
+    __m128d y = _mm_mul_pd(_mm_mul_pd(p, _mm_castsi128_pd(e)), _mm_set1_pd(2.0));
+
+    y = _mm_andnot_pd(under, y);
+    y = _mm_or_pd(_mm_andnot_pd(over, y),
+            _mm_and_pd(over, _mm_set1_pd(numeric_limits<double>::infinity())));
+    return _mm_or_pd(_mm_andnot_pd(nan, y), _mm_and_pd(nan, x));
+}
+}
+#endif
+
+static double maxOf(const double* x, int n)
+{
+    double m = -numeric_limits<double>::infinity();
+    for (int i = 0; i < n; ++i)
+    {
+        if (x[i] > m || x[i] != x[i])
+        {
+            m = x[i];
+            if (m != m)
+            {
+                break;
+            }
+        }
+    }
+    return m;
+}
+
+/**
+ * @brief out[i] = fastExp(in[i] - shift), returns the sum of out
+ */
+static double shiftedExp(const double* in, double shift, double* out, int n)
+{
+    int i = 0;
+    double sum = 0;
+#ifdef __SSE2__
+    __m128d s = _mm_set1_pd(shift);
+    __m128d acc = _mm_setzero_pd();
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128d y = expPd(_mm_sub_pd(_mm_loadu_pd(in + i), s));
+        acc = _mm_add_pd(acc, y);
+        if (out != NULL)
+        {
+            _mm_storeu_pd(out + i, y);
+        }
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    sum = lanes[0] + lanes[1];
+#endif
+    for (; i < n; ++i)
+    {
+        double y = fastExp(in[i] - shift);
+        sum += y;
+        if (out != NULL)
+        {
+            out[i] = y;
+        }
+    }
+    return sum;
+}
+
+void expArray(const double* in, double* out, int n)
+{
+    shiftedExp(in, 0, out, n);
+}
+
+double logSumExp(const double* x, int n)
+{
+    double m = maxOf(x, n);
+    if (m != m || m == numeric_limits<double>::infinity()
+            || m == -numeric_limits<double>::infinity())
+    {
+        return m;
+    }
+    return m + fastLog(shiftedExp(x, m, NULL, n));
+}
+
+void softmax(const double* score, double* prob, int n)
+{
+    double m = maxOf(score, n);
+    double sum = shiftedExp(score, m, prob, n);
+    double inv = 1.0 / sum;
+    for (int i = 0; i < n; ++i)
+    {
+        prob[i] *= inv;
+    }
+}
+
+void sigmoid(const double* score, double* prob, int n)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d one = _mm_set1_pd(1.0);
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128d x = _mm_loadu_pd(score + i);
+        //e = exp(-|x|) never overflows
+        __m128d e = expPd(_mm_or_pd(x, sign));
+        __m128d inv = _mm_div_pd(one, _mm_add_pd(one, e));
+        __m128d negative = _mm_cmplt_pd(x, _mm_setzero_pd());
+        __m128d y = _mm_or_pd(_mm_andnot_pd(negative, inv), _mm_and_pd(negative, _mm_mul_pd(e, inv)));
+        _mm_storeu_pd(prob + i, y);
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        double e = fastExp(-fabs(score[i]));
+        double inv = 1.0 / (1.0 + e);
+        prob[i] = score[i] < 0 ? e * inv : inv;
+    }
+}
+
+void normalize(double* p, int n)
+{
+    double sum = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        sum += p[i];
+    }
+    double inv = 1.0 / sum;
+    for (int i = 0; i < n; ++i)
+    {
+        p[i] *= inv;
+    }
+}
+namespace
+{
+/**
+ * strict "ranks before", the heap keeps the worst of the current top on front
+ */
+struct RanksBefore
+{
+    bool operator()(const pair<int, double>& a, const pair<int, double>& b) const
+    {
+        bool aNan = a.second != a.second;
+        bool bNan = b.second != b.second;
+        if (aNan != bNan)
+        {
+            return bNan;
+        }
+        if (!aNan && a.second != b.second)
+        {
+            return a.second > b.second;
+        }
+        return a.first < b.first;
+    }
+};
+}
+
+void selectTopK(const double* score, int n, int k, vector<pair<int, double> >& top)
+{
+    top.clear();
+    k = min(k, n);
+    if (k <= 0)
+    {
+        return;
+    }
+    RanksBefore before;
+    top.reserve(k);
+    for (int i = 0; i < n; ++i)
+    {
+        pair<int, double> candidate(i, score[i]);
+        if ((int)top.size() < k)
+        {
+            top.push_back(candidate);
+            push_heap(top.begin(), top.end(), before);
+        }
+        else if (before(candidate, top.front()))
+        {
+            pop_heap(top.begin(), top.end(), before);
+            top.back() = candidate;
+            push_heap(top.begin(), top.end(), before);
+        }
+    }
+    sort_heap(top.begin(), top.end(), before);
+}
+} // namespace mlplus
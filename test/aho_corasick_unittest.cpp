@@ -0,0 +1,119 @@
+#include <multipattern/aho_corasick.h>
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <vector>
+#include <string>
+#include "gtest/gtest.h"
+using namespace std;
+static map<string, int> scanCounts(const AhoCorasick& ac, const string& text)
+{
+    vector<uint32_t> ids;
+    int n = ac.Scan(text, ids);
+    EXPECT_EQ((int)ids.size(), n);
+    map<string, int> counts;
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+        ++counts[ac.Pattern(ids[i])];
+    }
+    return counts;
+}
+TEST(AhoCorasick, OverlappingUtf8Patterns){
+    vector<string> patterns;
+    patterns.push_back("\xe4\xb8\xad\xe5\x9b\xbd");                 //zhongguo
+    patterns.push_back("\xe4\xb8\xad\xe5\x9b\xbd\xe4\xba\xba");     //zhongguoren
+    patterns.push_back("\xe5\x9b\xbd\xe4\xba\xba");                 //guoren
+    patterns.push_back("\xe4\xba\xba");                             //ren
+    AhoCorasick ac;
+    ac.Init(patterns);
+    EXPECT_EQ(4u, ac.PatternCount());
+    vector<uint32_t> ids;
+    EXPECT_EQ(4, ac.Scan("x\xe4\xb8\xad\xe5\x9b\xbd\xe4\xba\xba" "y", ids));
+    vector<uint32_t> expected;
+    expected.push_back(0);
+    expected.push_back(1);
+    expected.push_back(2);
+    expected.push_back(3);
+    sort(ids.begin(), ids.end());
+    EXPECT_EQ(expected, ids);
+    map<string, int> counts = scanCounts(ac, "\xe4\xba\xba\xe4\xba\xba");
+    EXPECT_EQ(1u, counts.size());
+    EXPECT_EQ(2, counts["\xe4\xba\xba"]);
+}
+TEST(AhoCorasick, EnglishWordBoundary){
+    vector<string> patterns;
+    patterns.push_back("he");
+    patterns.push_back("she");
+    patterns.push_back("hers");
+    patterns.push_back("a b");
+    AhoCorasick ac;
+    ac.Init(patterns);
+    map<string, int> counts = scanCounts(ac, "she said hers he ushers a b");
+    EXPECT_EQ(1, counts["she"]);
+    EXPECT_EQ(1, counts["hers"]);
+    EXPECT_EQ(1, counts["he"]);
+    EXPECT_EQ(1, counts["a b"]);
+    EXPECT_EQ(4u, counts.size());
+    EXPECT_TRUE(scanCounts(ac, "ushe").empty());
+    EXPECT_EQ(1, scanCounts(ac, "he")["he"]);
+}
+TEST(AhoCorasick, DuplicatesEmptyAndThreshold){
+    vector<string> patterns;
+    patterns.push_back("ab");
+    patterns.push_back("");
+    patterns.push_back("ab");
+    patterns.push_back("cd");
+    AhoCorasick ac;
+    ac.Init(patterns);
+    vector<uint32_t> ids;
+    EXPECT_EQ(3, ac.Scan("ab cd ab", ids));
+    EXPECT_EQ(0u, ids[0]);
+    EXPECT_EQ(3u, ids[1]);
+    EXPECT_EQ(0u, ids[2]);
+    ids.clear();
+    EXPECT_EQ(2, ac.Scan("ab cd ab", ids, 2));
+    EXPECT_EQ(2u, ids.size());
+    AhoCorasick empty;
+    empty.Init(vector<string>());
+    EXPECT_EQ(0, empty.Scan("ab", ids));
+}
+TEST(AhoCorasick, MatchesNaiveSearch){
+    vector<string> patterns;
+    srand(7);
+    for (int i = 0; i < 300; ++i)
+    {
+        string p;
+        int len = 1 + rand() % 4;
+        for (int j = 0; j < len; ++j)
+        {
+            p += rand() % 2 ? (char)('a' + rand() % 3) : (char)(0xC0 + rand() % 3);
+        }
+        patterns.push_back(p);
+    }
+    sort(patterns.begin(), patterns.end());
+    patterns.erase(unique(patterns.begin(), patterns.end()), patterns.end());
+    AhoCorasick ac;
+    ac.Init(patterns);
+    string text;
+    for (int i = 0; i < 2000; ++i)
+    {
+        text += rand() % 2 ? (char)(0xC0 + rand() % 3) : (char)('a' + rand() % 3);
+    }
+    map<string, int> counts = scanCounts(ac, text);
+    for (size_t i = 0; i < patterns.size(); ++i)
+    {
+        const string& p = patterns[i];
+        bool ascii = true;
+        for (size_t j = 0; j < p.size(); ++j)
+        {
+            ascii = ascii && !(p[j] & 0x80);
+        }
+        int expected = 0;
+        for (size_t pos = text.find(p); pos != string::npos; pos = text.find(p, pos + 1))
+        {
+            //the text has no whitespace, an ASCII pattern must cover all of it
+            expected += !ascii || p.size() == text.size();
+        }
+        EXPECT_EQ(expected, counts.count(p) ? counts[p] : 0) << i;
+    }
+}
@@ -0,0 +1,87 @@
+#include <arena.h>
+#include <stdint.h>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include "decision_tree.h"
+#include "attribute_spec.h"
+#include "dataset.h"
+#include "io/text_parser.h"
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+TEST(arenaTest, alignedAndDisjoint)
+{
+    Arena arena(1024);
+    char* c = static_cast<char*>(arena.alloc(3, 1));
+    double* d = arena.allocArray<double>(4);
+    int64_t* s = arena.allocArray<int64_t>(2);
+    EXPECT_EQ((size_t)d % __alignof__(double), 0u);
+    EXPECT_EQ((size_t)s % __alignof__(int64_t), 0u);
+    EXPECT_GE((char*)d, c + 3);
+    EXPECT_GE((char*)s, (char*)(d + 4));
+    // arrays are value initialized
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ(d[i], 0.0);
+    }
+    EXPECT_EQ(arena.numBlocks(), 1u);
+    EXPECT_EQ(arena.bytesUsed(), 3u + 4 * sizeof(double) + 2 * sizeof(int64_t));
+}
+TEST(arenaTest, growsAndResets)
+{
+    Arena arena(1024);
+    for (int i = 0; i < 100; ++i)
+    {
+        int* p = arena.allocArray<int>(16);
+        p[15] = i;
+    }
+    EXPECT_GT(arena.numBlocks(), 1u);
+    EXPECT_GE(arena.bytesReserved(), arena.bytesUsed());
+    // a large request gets its own block and the current one stays open
+    size_t blocks = arena.numBlocks();
+    char* big = static_cast<char*>(arena.alloc(100000));
+    big[99999] = 1;
+    EXPECT_EQ(arena.numBlocks(), blocks + 1);
+    arena.reset();
+    EXPECT_EQ(arena.numBlocks(), 0u);
+    EXPECT_EQ(arena.bytesUsed(), 0u);
+    EXPECT_TRUE(arena.alloc(8) != NULL);
+}
+TEST(arenaTest, decisionTree)
+{
+    std::auto_ptr<TextParser> p(new TextParser("example.names"));
+    std::auto_ptr<DataSet> pData(p->readData("example.cases"));
+    AttributeSpec* spec = p->getAttributeSpec();
+    ifstream heapIn("example.tree");
+    BoostDecisionTree heapTree;
+    ASSERT_TRUE(heapTree.read(heapIn, spec));
+    Arena arena(4096);
+    ifstream arenaIn("example.tree");
+    string header;
+    getline(arenaIn, header);
+    getline(arenaIn, header);
+    DecisionTreePtr arenaTree = DecisionTree::readC5Text(arenaIn, spec, &arena);
+    ASSERT_TRUE(arenaTree != NULL);
+    EXPECT_GT(arena.bytesUsed(), arenaTree->countNodes() * sizeof(DecisionTree));
+    // a heap copy of an arena tree outlives the arena
+    DecisionTreePtr copy = arenaTree->clone();
+    vector<float> heapConfidence(spec->numTarget());
+    vector<float> arenaConfidence(spec->numTarget());
+    vector<float> copyConfidence(spec->numTarget());
+    float* heapPtr = &heapConfidence[0];
+    float* arenaPtr = &arenaConfidence[0];
+    float* copyPtr = &copyConfidence[0];
+    for (int i = 0; i < pData->numInstances(); ++i)
+    {
+        IInstance* instance = pData->instanceAt(i);
+        int klass = arenaTree->classify(instance, &arenaPtr);
+        EXPECT_EQ(heapTree.classify(instance, &heapPtr), klass);
+        EXPECT_EQ(copy->classify(instance, &copyPtr), klass);
+        EXPECT_EQ(copyConfidence, arenaConfidence);
+    }
+    arenaTree->free();
+    arena.reset();
+    EXPECT_EQ(copy->classify(pData->instanceAt(0), &copyPtr), heapTree.classify(pData->instanceAt(0), &heapPtr));
+    copy->free();
+}
@@ -0,0 +1,238 @@
+#include <bitset.h>
+#include <roaring_bitset.h>
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <vector>
+#include "rng.h"
+#include "dataset.h"
+#include "instance.h"
+#include "instance_container.h"
+#include "attribute_container.h"
+#include "attribute_value.h"
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+static DenseBitset randomBits(Xoshiro256& rng, size_t size, double density)
+{
+    DenseBitset bits(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        bits.set(i, rng.uniform() < density);
+    }
+    return bits;
+}
+/**
+ * @brief run check on the portable kernels and, where the processor has it,
+ *        on AVX2, then go back to the kernels chosen at startup
+ */
+static void onEveryKernel(void (*check)())
+{
+    bool avx2 = bitset::usingAvx2();
+    for (int wide = 0; wide < 2; ++wide)
+    {
+        if (bitset::useAvx2(wide))
+        {
+            SCOPED_TRACE(wide ? "avx2" : "portable");
+            check();
+        }
+    }
+    bitset::useAvx2(avx2);
+}
+TEST(DenseBitset, dispatch)
+{
+    __builtin_cpu_init();
+    EXPECT_EQ(bitset::usingAvx2(), __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"));
+    EXPECT_TRUE(bitset::useAvx2(false));
+    EXPECT_FALSE(bitset::usingAvx2());
+    bitset::useAvx2(true);
+}
+TEST(DenseBitset, basic)
+{
+    DenseBitset empty;
+    EXPECT_EQ(empty.size(), 0u);
+    EXPECT_EQ(empty.count(), 0u);
+    EXPECT_FALSE(empty.any());
+    EXPECT_EQ(empty.findNext(0), DenseBitset::npos);
+
+    size_t sizes[] = {1, 63, 64, 65, 200, 1000};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        size_t size = sizes[s];
+        DenseBitset bits(size, true);
+        EXPECT_EQ(bits.count(), size);
+        EXPECT_EQ(bits.numWords(), (size + 63) / 64);
+        bits.reset(size - 1);
+        EXPECT_FALSE(bits.test(size - 1));
+        EXPECT_EQ(bits.count(), size - 1);
+        bits.resetAll();
+        EXPECT_FALSE(bits.any());
+        bits.set(size - 1);
+        EXPECT_EQ(bits.findNext(0), size - 1);
+        EXPECT_EQ(bits.findNext(size - 1), size - 1);
+        EXPECT_EQ(bits.findNext(size), DenseBitset::npos);
+        bits.setAll();
+        EXPECT_EQ(bits.count(), size);
+    }
+
+    // growing with ones sets the new bits only
+    DenseBitset bits(70);
+    bits.set(3);
+    bits.resize(130, true);
+    EXPECT_EQ(bits.count(), 1u + 60u);
+    EXPECT_FALSE(bits.test(69));
+    EXPECT_TRUE(bits.test(70));
+    bits.resize(10);
+    EXPECT_EQ(bits.count(), 1u);
+    bits.resize(128);
+    EXPECT_EQ(bits.count(), 1u);
+}
+static void checkKernels()
+{
+    Xoshiro256 rng(49);
+    // sizes around the 256 bit blocks and their tails
+    size_t sizes[] = {64, 255, 256, 257, 1000, 4096 + 64 * 3};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        size_t size = sizes[s];
+        DenseBitset a = randomBits(rng, size, 0.3);
+        DenseBitset b = randomBits(rng, size, 0.6);
+        size_t countA = 0, both = 0, either = 0, onlyA = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            countA += a.test(i);
+            both += a.test(i) && b.test(i);
+            either += a.test(i) || b.test(i);
+            onlyA += a.test(i) && !b.test(i);
+        }
+        EXPECT_EQ(a.count(), countA);
+        EXPECT_EQ(DenseBitset::andCount(a, b), both);
+        DenseBitset x(a);
+        x &= b;
+        EXPECT_EQ(x.count(), both);
+        x = a;
+        x |= b;
+        EXPECT_EQ(x.count(), either);
+        x = a;
+        x.andNot(b);
+        EXPECT_EQ(x.count(), onlyA);
+        for (size_t i = 0; i < size; ++i)
+        {
+            ASSERT_EQ(x.test(i), a.test(i) && !b.test(i));
+        }
+        size_t seen = 0;
+        for (size_t i = a.findNext(0); i != DenseBitset::npos; i = a.findNext(i + 1))
+        {
+            ASSERT_TRUE(a.test(i));
+            ++seen;
+        }
+        EXPECT_EQ(seen, countA);
+    }
+}
+TEST(DenseBitset, kernels)
+{
+    onEveryKernel(checkKernels);
+}
+static void checkRoaring()
+{
+    Xoshiro256 rng(7);
+    // sparse sets, containers past ARRAY_MAX and values across many keys
+    uint32_t ranges[] = {1000, 1 << 16, 1 << 20, 1 << 16};
+    size_t counts[] = {300, 20000, 30000, 60000};
+    for (size_t t = 0; t < 4; ++t)
+    {
+        set<uint32_t> sa, sb;
+        RoaringBitset a, b;
+        for (size_t i = 0; i < counts[t]; ++i)
+        {
+            uint32_t x = rng.below(ranges[t]);
+            uint32_t y = rng.below(ranges[t] / 2);
+            sa.insert(x);
+            a.add(x);
+            sb.insert(y);
+            b.add(y);
+        }
+        EXPECT_EQ(a.cardinality(), sa.size());
+        EXPECT_EQ(b.cardinality(), sb.size());
+        for (uint32_t v = 0; v < 2000; ++v)
+        {
+            ASSERT_EQ(a.contains(v), sa.count(v) > 0);
+        }
+        vector<uint32_t> values;
+        a.toVector(values);
+        EXPECT_TRUE(vector<uint32_t>(sa.begin(), sa.end()) == values);
+
+        set<uint32_t> expected;
+        RoaringBitset out;
+        RoaringBitset::intersect(a, b, out);
+        set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(), inserter(expected, expected.end()));
+        out.toVector(values);
+        EXPECT_TRUE(vector<uint32_t>(expected.begin(), expected.end()) == values);
+        EXPECT_EQ(RoaringBitset::andCount(a, b), expected.size());
+
+        expected.clear();
+        RoaringBitset::unite(a, b, out);
+        set_union(sa.begin(), sa.end(), sb.begin(), sb.end(), inserter(expected, expected.end()));
+        out.toVector(values);
+        EXPECT_TRUE(vector<uint32_t>(expected.begin(), expected.end()) == values);
+
+        expected.clear();
+        RoaringBitset::subtract(a, b, out);
+        set_difference(sa.begin(), sa.end(), sb.begin(), sb.end(), inserter(expected, expected.end()));
+        out.toVector(values);
+        EXPECT_TRUE(vector<uint32_t>(expected.begin(), expected.end()) == values);
+
+        // the same set has the same layout however it was built
+        RoaringBitset rebuilt;
+        for (set<uint32_t>::iterator it = expected.begin(); it != expected.end(); ++it)
+        {
+            rebuilt.add(*it);
+        }
+        EXPECT_TRUE(rebuilt == out);
+    }
+}
+TEST(RoaringBitset, matchesStdSet)
+{
+    onEveryKernel(checkRoaring);
+}
+static void checkRoaringDense()
+{
+    Xoshiro256 rng(11);
+    DenseBitset bits = randomBits(rng, 200000, 0.05);
+    RoaringBitset roaring = RoaringBitset::fromDense(bits);
+    EXPECT_EQ(roaring.cardinality(), bits.count());
+    EXPECT_TRUE(roaring.toDense(bits.size()) == bits);
+    // two bytes a value against a bit of every row
+    EXPECT_LT(roaring.memoryUsage(), 2 * bits.memoryUsage());
+
+    DenseBitset full(200000, true);
+    RoaringBitset all = RoaringBitset::fromDense(full);
+    EXPECT_EQ(RoaringBitset::andCount(all, roaring), bits.count());
+    // full containers are bitmaps, no bigger than the dense words
+    EXPECT_LT(all.memoryUsage(), 2 * full.memoryUsage());
+}
+TEST(RoaringBitset, dense)
+{
+    onEveryKernel(checkRoaringDense);
+}
+TEST(DenseBitset, missingMask)
+{
+    DataSet data("missing", new VectorAttributeContainer(), new DenseInstanceContainer());
+    data.getAttributeContainer()->add(new Attribute("a"));
+    data.getAttributeContainer()->add(new Attribute("b"));
+    for (int i = 0; i < 100; ++i)
+    {
+        vector<ValueType> values(2, i);
+        if (i % 7 == 0)
+        {
+            values[1] = AttributeValue::missingValue<ValueType>();
+        }
+        data.add(new DenseInstance(values));
+    }
+    EXPECT_FALSE(data.missingMask(0).any());
+    DenseBitset missing = data.missingMask(1);
+    EXPECT_EQ(missing.size(), 100u);
+    EXPECT_EQ(missing.count(), 15u);
+    EXPECT_TRUE(missing.test(98));
+    EXPECT_FALSE(missing.test(99));
+}
@@ -0,0 +1,81 @@
+#include <estimators/discrete_estimator.h>
+#include <estimators/normal_estimator.h>
+#include <estimators/concurrent_estimator.h>
+#include <pthread.h>
+#include <vector>
+#include <string>
+#include "gtest/gtest.h"
+using namespace std;
+using namespace mlplus::estimators;
+namespace
+{
+const int kThreads = 16;
+const int kUpdates = 20000;
+void* feedDiscrete(void* arg)
+{
+    Estimator* est = static_cast<Estimator*>(arg);
+    for (int i = 0; i < kUpdates; ++i)
+    {
+        est->addValue(i % 3, 1);
+    }
+    return NULL;
+}
+void* feedNormal(void* arg)
+{
+    Estimator* est = static_cast<Estimator*>(arg);
+    for (int i = 0; i < kUpdates; ++i)
+    {
+        est->addValue(i % 2 ? 1 : -1, 1);
+    }
+    return NULL;
+}
+void runThreads(void* (*fn)(void*), Estimator* est)
+{
+    pthread_t threads[kThreads];
+    for (int i = 0; i < kThreads; ++i)
+    {
+        pthread_create(&threads[i], NULL, fn, est);
+    }
+    for (int i = 0; i < kThreads; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+}
+}
+TEST(ConcurrentEstimator, DiscreteMatchesSerial){
+    ConcurrentDiscreteEstimator est(3, true, 4);
+    DiscreteEstimator serial(3, true);
+    runThreads(feedDiscrete, &est);
+    for (int t = 0; t < kThreads; ++t)
+    {
+        feedDiscrete(&serial);
+    }
+    EXPECT_EQ(serial.getSumOfCounts(), est.getSumOfCounts());
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(serial.getCount(i), est.getCount(i));
+        EXPECT_DOUBLE_EQ(serial.getProbability(i), est.getProbability(i));
+    }
+    EXPECT_EQ(serial.toString(), est.toString());
+    EXPECT_EQ(serial.getID(), est.getID());
+}
+TEST(ConcurrentEstimator, NormalMatchesSerial){
+    ConcurrentNormalEstimator est(1);
+    NormalEstimator serial(1);
+    runThreads(feedNormal, &est);
+    for (int t = 0; t < kThreads; ++t)
+    {
+        feedNormal(&serial);
+    }
+    EXPECT_DOUBLE_EQ(serial.getMean(), est.getMean());
+    EXPECT_DOUBLE_EQ(serial.getStdDev(), est.getStdDev());
+    EXPECT_DOUBLE_EQ(serial.getProbability(1), est.getProbability(1));
+}
+TEST(ConcurrentEstimator, FromStringDropsPartials){
+    ConcurrentDiscreteEstimator est(2);
+    est.addValue(0, 5);
+    DiscreteEstimator plain(2);
+    est.fromString(plain.toString());
+    EXPECT_EQ(plain.toString(), est.toString());
+    EXPECT_EQ(0.5, est.getProbability(0));
+}
@@ -0,0 +1,127 @@
+#include "io/text_parser.h"
+#include "dataset.h"
+#include "iterator_interface.h"
+#include "naive_bayes.h"
+#include "cross_validation.h"
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+TEST(CrossValidation, grid)
+{
+    ParameterGrid grid;
+    EXPECT_EQ(grid.size(), 1u);
+    EXPECT_TRUE(grid.at(0).empty());
+    grid.add("a", "1,2,3");
+    vector<string> b;
+    b.push_back("x");
+    b.push_back("y");
+    grid.add("b", b);
+    ASSERT_EQ(grid.size(), 6u);
+    Parameters p = grid.at(3);
+    EXPECT_EQ(p["a"], "2");
+    EXPECT_EQ(p["b"], "y");
+    EXPECT_EQ(grid.at(4)["a"], "3");
+    EXPECT_EQ(grid.at(4)["b"], "x");
+}
+TEST(CrossValidation, subsetShares)
+{
+    auto_ptr<TextParser> p(new TextParser("example.names"));
+    auto_ptr<DataSet> data(p->readData("example.cases"));
+    vector<int> indices;
+    indices.push_back(5);
+    indices.push_back(2);
+    indices.push_back(5);
+    auto_ptr<DataSet> subset(data->subset(indices));
+    ASSERT_EQ(subset->numInstances(), 3);
+    EXPECT_EQ(subset->targetIndex(), data->targetIndex());
+    EXPECT_EQ(subset->numTargets(), data->numTargets());
+    EXPECT_EQ(subset->attributeAt(0), data->attributeAt(0));
+    EXPECT_EQ(subset->instanceAt(0), data->instanceAt(5));
+    EXPECT_EQ(subset->instanceAt(1), data->instanceAt(2));
+    EXPECT_EQ(subset->instanceAt(2), data->instanceAt(5));
+    AutoInstanceIteratorPtr it(subset->newInstanceIterator());
+    int count = 0;
+    for (; it->hasMore(); it->next())
+    {
+        ++count;
+    }
+    EXPECT_EQ(count, 3);
+}
+TEST(CrossValidation, stratifiedFolds)
+{
+    auto_ptr<TextParser> p(new TextParser("example.names"));
+    auto_ptr<DataSet> data(p->readData("example.cases"));
+    CrossValidation cv(*data, 7, 3);
+    ASSERT_EQ(cv.numFolds(), 7);
+    vector<int> seen(data->numInstances(), 0);
+    int classes = data->numTargets();
+    vector<int> lowest(classes, data->numInstances()), highest(classes, 0);
+    for (int k = 0; k < cv.numFolds(); ++k)
+    {
+        const vector<int>& test = cv.testIndices(k);
+        vector<int> perClass(classes, 0);
+        for (size_t i = 0; i < test.size(); ++i)
+        {
+            ++seen[test[i]];
+            int klass = (int)data->instanceAt(test[i])->targetValue();
+            if (klass >= 0 && klass < classes)
+            {
+                ++perClass[klass];
+            }
+        }
+        for (int c = 0; c < classes; ++c)
+        {
+            lowest[c] = min(lowest[c], perClass[c]);
+            highest[c] = max(highest[c], perClass[c]);
+        }
+        vector<int> train;
+        cv.trainIndices(k, train);
+        EXPECT_EQ(train.size() + test.size(), (size_t)data->numInstances());
+    }
+    EXPECT_EQ(count(seen.begin(), seen.end(), 1), data->numInstances());
+    for (int c = 0; c < classes; ++c)
+    {
+        EXPECT_LE(highest[c] - lowest[c], 1);
+    }
+}
+TEST(CrossValidation, runMatchesSequential)
+{
+    auto_ptr<TextParser> p(new TextParser("example.names"));
+    auto_ptr<DataSet> data(p->readData("example.cases"));
+    CrossValidation cv(*data, 4, 9);
+    NaiveBayesFactory factory;
+    ParameterGrid grid;
+    grid.add("event_model", "0");
+    vector<CrossValidationResult> single, parallel;
+    cv.run(factory, grid, 1, single);
+    cv.run(factory, grid, 3, parallel);
+    ASSERT_EQ(single.size(), 1u);
+    ASSERT_EQ(parallel.size(), 1u);
+    ASSERT_EQ(parallel[0].foldAccuracy.size(), 4u);
+    EXPECT_EQ(parallel[0].parameters["event_model"], "0");
+    EXPECT_DOUBLE_EQ(single[0].metrics.accuracy(), parallel[0].metrics.accuracy());
+    EXPECT_DOUBLE_EQ(single[0].metrics.logLoss(), parallel[0].metrics.logLoss());
+
+    // the first fold by hand
+    NaiveBayes bayes("fold", data->numTargets());
+    vector<int> train;
+    cv.trainIndices(0, train);
+    auto_ptr<DataSet> view(data->subset(train));
+    bayes.train(view.get());
+    ClassificationMetrics fold = evaluate(bayes, *data, cv.testIndices(0), data->numTargets(), 1);
+    EXPECT_DOUBLE_EQ(fold.accuracy(), parallel[0].foldAccuracy[0]);
+
+    ostringstream out;
+    CrossValidation::print(out, parallel);
+    EXPECT_NE(out.str().find("event_model=0"), string::npos);
+
+    ParameterGrid unknown;
+    unknown.add("depth", "3");
+    EXPECT_THROW(cv.run(factory, unknown, 2, parallel), runtime_error);
+}
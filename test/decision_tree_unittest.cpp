@@ -5,6 +5,8 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <sstream>
+#include <cstdio>
 #include "io/text_parser.h"
 #include "dataset.h"
 #include "gtest/gtest.h"
@@ -30,3 +32,66 @@ TEST(decisionTreeTest, smock) {
     delete confidence;
     delete pData;
 }
+static void writeText(const string& path, const string& text)
+{
+    ofstream out(path.c_str(), ios::binary);
+    out.write(text.data(), text.size());
+}
+static string valueList(int first, int last)
+{
+    ostringstream out;
+    for (int i = first; i <= last; ++i)
+    {
+        out << (i > first ? "," : "") << "c" << i;
+    }
+    return out.str();
+}
+TEST(decisionTreeTest, largeSubset)
+{
+    // a nominal attribute of 100 values, past one 64 bit word
+    writeText("subset.names", "klass.\nklass: a, b.\ncolour: " + valueList(0, 99) + ".\n");
+    writeText("subset.cases", "a,c0\nb,c5\nb,c65\na,c70\na,c99\n");
+    // the middle subset is longer than any fixed property buffer
+    writeText("subset.tree", "id=\"test\"\nentries=\"1\"\n"
+              "type=\"3\" class=\"a\" freq=\"4,2\" att=\"colour\" forks=\"3\" elts=\"c0\" elts=\""
+              + valueList(1, 69) + "\" elts=\"" + valueList(70, 99) + "\"\n"
+              "type=\"0\" class=\"a\" freq=\"2,0\"\n"
+              "type=\"0\" class=\"b\" freq=\"0,2\"\n"
+              "type=\"0\" class=\"a\" freq=\"2,0\"\n");
+    TextParser parser("subset.names");
+    std::auto_ptr<DataSet> data(parser.readData("subset.cases"));
+    ASSERT_EQ(data->numInstances(), 5);
+    ifstream in("subset.tree");
+    BoostDecisionTree tree;
+    ASSERT_TRUE(tree.read(in, parser.getAttributeSpec()));
+    float confidence[2];
+    float* pConfidence = confidence;
+    for (int i = 0; i < data->numInstances(); ++i)
+    {
+        IInstance* instance = data->instanceAt(i);
+        EXPECT_EQ(tree.classify(instance, &pConfidence), (int)instance->targetValue()) << i;
+    }
+
+    // the node masks of the children split the rows
+    ifstream again("subset.tree");
+    string header;
+    getline(again, header);
+    getline(again, header);
+    DecisionTreePtr root = DecisionTree::readC5Text(again, parser.getAttributeSpec());
+    ASSERT_TRUE(root != NULL);
+    vector<DenseBitset> children;
+    root->partition(data.get(), DenseBitset(data->numInstances(), true), children);
+    ASSERT_EQ(children.size(), 3u);
+    EXPECT_EQ(children[0].count(), 1u);
+    EXPECT_TRUE(children[0].test(0));
+    EXPECT_EQ(children[1].count(), 2u);
+    EXPECT_TRUE(children[1].test(2));
+    EXPECT_EQ(children[2].count(), 2u);
+    DecisionTreePtr copy = root->clone();
+    EXPECT_EQ(copy->countNodes(), 4);
+    copy->free();
+    root->free();
+    remove("subset.names");
+    remove("subset.cases");
+    remove("subset.tree");
+}
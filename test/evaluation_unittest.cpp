@@ -0,0 +1,123 @@
+#include "io/text_parser.h"
+#include "dataset.h"
+#include "naive_bayes.h"
+#include "evaluation.h"
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+namespace
+{
+void expectSameMetrics(const ClassificationMetrics& expected, const ClassificationMetrics& actual)
+{
+    ASSERT_EQ(expected.numClasses(), actual.numClasses());
+    EXPECT_DOUBLE_EQ(expected.weight(), actual.weight());
+    for (int i = 0; i < expected.numClasses(); ++i)
+    {
+        for (int j = 0; j < expected.numClasses(); ++j)
+        {
+            EXPECT_DOUBLE_EQ(expected.confusion(i, j), actual.confusion(i, j));
+        }
+        EXPECT_NEAR(expected.auc(i), actual.auc(i), 1e-12);
+    }
+    EXPECT_NEAR(expected.logLoss(), actual.logLoss(), 1e-9);
+}
+}
+TEST(Evaluation, counts)
+{
+    ClassificationMetrics metrics(3);
+    metrics.add(0, 0);
+    metrics.add(0, 1);
+    metrics.add(1, 1, 2);
+    metrics.add(2, 1);
+    metrics.add(3, 1);
+    EXPECT_DOUBLE_EQ(metrics.weight(), 5);
+    EXPECT_DOUBLE_EQ(metrics.skipped(), 1);
+    EXPECT_DOUBLE_EQ(metrics.accuracy(), 3.0 / 5);
+    EXPECT_DOUBLE_EQ(metrics.precision(1), 2.0 / 4);
+    EXPECT_DOUBLE_EQ(metrics.recall(0), 1.0 / 2);
+    EXPECT_DOUBLE_EQ(metrics.recall(2), 0);
+    EXPECT_DOUBLE_EQ(metrics.f1(1), 2 * 0.5 * 1 / 1.5);
+    EXPECT_DOUBLE_EQ(metrics.macroF1(), (2 * 1 * 0.5 / 1.5 + 2 * 0.5 * 1 / 1.5 + 0) / 3);
+}
+TEST(Evaluation, distributions)
+{
+    ClassificationMetrics metrics(2);
+    ClassificationMetrics other(2);
+    vector<double> dist(2);
+    // unnormalized, the probabilities are 0.8 / 0.2
+    dist[0] = 4;
+    dist[1] = 1;
+    metrics.add(0, dist);
+    dist[0] = 0.3;
+    dist[1] = 0.7;
+    other.add(0, dist);
+    other.add(1, dist, 2);
+    metrics.merge(other);
+    EXPECT_DOUBLE_EQ(metrics.confusion(0, 0), 1);
+    EXPECT_DOUBLE_EQ(metrics.confusion(0, 1), 1);
+    EXPECT_DOUBLE_EQ(metrics.confusion(1, 1), 2);
+    EXPECT_NEAR(metrics.logLoss(), -(log(0.8) + log(0.3) + 2 * log(0.7)) / 4, 1e-12);
+    // the class 1 row outranks one class 0 row and loses to none
+    EXPECT_NEAR(metrics.auc(1), 0.75, 1e-12);
+    EXPECT_NEAR(metrics.weightedAuc(), 0.75, 1e-12);
+    ostringstream out;
+    vector<string> names;
+    names.push_back("w");
+    names.push_back("b");
+    metrics.print(out, names);
+    EXPECT_NE(out.str().find("accuracy: 0.75000"), string::npos);
+    EXPECT_NE(out.str().find("\nb\t"), string::npos);
+    EXPECT_NE(out.str().find("log loss"), string::npos);
+
+    // hard labels have no probabilities to report
+    ClassificationMetrics labels(2);
+    labels.add(0, 0);
+    labels.add(1, 0);
+    ostringstream labelOut;
+    labels.print(labelOut);
+    EXPECT_NE(labelOut.str().find("accuracy: 0.50000"), string::npos);
+    EXPECT_EQ(labelOut.str().find("log loss"), string::npos);
+    EXPECT_EQ(labelOut.str().find("AUC"), string::npos);
+
+    // the predicted class given apart from tied probabilities
+    ClassificationMetrics ranked(2);
+    dist[0] = 0.5;
+    dist[1] = 0.5;
+    ranked.add(1, 1, dist);
+    EXPECT_DOUBLE_EQ(ranked.confusion(1, 1), 1);
+    EXPECT_NEAR(ranked.logLoss(), -log(0.5), 1e-12);
+}
+TEST(Evaluation, parallelMatchesLoop)
+{
+    auto_ptr<TextParser> p(new TextParser("example.names"));
+    auto_ptr<DataSet> data(p->readData("example.cases"));
+    NaiveBayes nb("nb", data->numTargets());
+    nb.train(data.get());
+
+    ClassificationMetrics expected(data->numTargets());
+    for (int i = 0; i < data->numInstances(); ++i)
+    {
+        IInstance* instance = data->instanceAt(i);
+        expected.add((int)instance->targetValue(), nb.targetDistribution(instance), instance->getWeight());
+    }
+    ClassificationMetrics single = evaluate(nb, *data, data->numTargets(), 1);
+    ClassificationMetrics parallel = evaluate(nb, *data, data->numTargets(), 4, 100);
+    expectSameMetrics(expected, single);
+    expectSameMetrics(expected, parallel);
+    EXPECT_GT(parallel.weight(), 0);
+
+    vector<int> odd;
+    ClassificationMetrics expectedOdd(data->numTargets());
+    for (int i = 1; i < data->numInstances(); i += 2)
+    {
+        odd.push_back(i);
+        IInstance* instance = data->instanceAt(i);
+        expectedOdd.add((int)instance->targetValue(), nb.targetDistribution(instance), instance->getWeight());
+    }
+    expectSameMetrics(expectedOdd, evaluate(nb, *data, odd, data->numTargets(), 3, 64));
+}
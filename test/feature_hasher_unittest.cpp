@@ -0,0 +1,57 @@
+#include <feature_hasher.h>
+#include <cmath>
+#include <vector>
+#include <string>
+#include "gtest/gtest.h"
+using namespace std;
+using namespace mlplus;
+TEST(FeatureHasher, Murmur3){
+    EXPECT_EQ(0u, FeatureHasher::murmur3("", 0, 0));
+    EXPECT_EQ(0x248bfa47u, FeatureHasher::murmur3("hello", 5, 0));
+    EXPECT_EQ(0x2e4ff723u, FeatureHasher::murmur3("The quick brown fox jumps over the lazy dog", 43, 0));
+}
+TEST(FeatureHasher, BucketsAndSigns){
+    FeatureHasher hasher(4, 3, true);
+    EXPECT_EQ(16, hasher.numBuckets());
+    vector<FeatureHasher::HashedFeature> out;
+    hasher.add("word", 2, out);
+    ASSERT_EQ(3u, out.size());
+    for (unsigned i = 0; i < out.size(); ++i)
+    {
+        EXPECT_GE(out[i].first, 0);
+        EXPECT_LT(out[i].first, 16);
+        EXPECT_EQ(2, fabs(out[i].second));
+    }
+    vector<FeatureHasher::HashedFeature> again;
+    hasher.add(string("word"), 2, again);
+    EXPECT_EQ(out, again);
+    FeatureHasher unsignedHasher(4);
+    out.clear();
+    for (int id = 0; id < 100; ++id)
+    {
+        unsignedHasher.add(id, 1, out);
+    }
+    for (unsigned i = 0; i < out.size(); ++i)
+    {
+        EXPECT_EQ(1, out[i].second);
+    }
+    EXPECT_THROW(FeatureHasher(0), std::invalid_argument);
+    EXPECT_THROW(FeatureHasher(31), std::invalid_argument);
+}
+TEST(FeatureHasher, FinishSumsCollisions){
+    vector<FeatureHasher::HashedFeature> features;
+    features.push_back(make_pair(5, 1.0f));
+    features.push_back(make_pair(2, 2.0f));
+    features.push_back(make_pair(5, 3.0f));
+    features.push_back(make_pair(7, 1.0f));
+    features.push_back(make_pair(7, -1.0f));
+    vector<int> indices(1, 0);
+    vector<ValueType> values(1, 9);
+    FeatureHasher::finish(features, indices, values, 1);
+    ASSERT_EQ(3u, indices.size());
+    EXPECT_EQ(0, indices[0]);
+    EXPECT_EQ(3, indices[1]);
+    EXPECT_EQ(2, values[1]);
+    EXPECT_EQ(6, indices[2]);
+    EXPECT_EQ(4, values[2]);
+}
@@ -0,0 +1,94 @@
+#include "flat_hash_map.h"
+#include <map>
+#include <string>
+#include <sstream>
+#include "rng.h"
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+TEST(FlatHashMap, basic)
+{
+    FlatHashMap<string, int> values;
+    EXPECT_TRUE(values.empty());
+    EXPECT_EQ(values.capacity(), 0u);
+    EXPECT_TRUE(values.find("a") == values.end());
+    EXPECT_TRUE(values.insert(make_pair(string("a"), 1)).second);
+    EXPECT_FALSE(values.insert(make_pair(string("a"), 2)).second);
+    values["b"] = 2;
+    ++values["c"];
+    EXPECT_EQ(values.size(), 3u);
+    EXPECT_EQ(values.find("a")->second, 1);
+    EXPECT_EQ(values["b"], 2);
+    EXPECT_EQ(values.count("c"), 1u);
+    EXPECT_EQ(values.erase("a"), 1u);
+    EXPECT_EQ(values.erase("a"), 0u);
+    EXPECT_EQ(values.count("a"), 0u);
+
+    FlatHashMap<string, int> copy(values);
+    values.clear();
+    EXPECT_TRUE(values.empty());
+    EXPECT_EQ(copy.size(), 2u);
+    int sum = 0;
+    for (FlatHashMap<string, int>::const_iterator it = copy.begin(); it != copy.end(); ++it)
+    {
+        sum += it->second;
+    }
+    EXPECT_EQ(sum, 3);
+}
+TEST(FlatHashMap, matchesStdMap)
+{
+    // random inserts and erases over a small key range leave many tombstones
+    FlatHashMap<int, int> flat;
+    map<int, int> reference;
+    Xoshiro256 random(5);
+    for (int i = 0; i < 200000; ++i)
+    {
+        int key = (int)random.below(5000) * 16;
+        if (random.below(3) == 0)
+        {
+            EXPECT_EQ(flat.erase(key), reference.erase(key));
+        }
+        else
+        {
+            flat[key] += i;
+            reference[key] += i;
+        }
+    }
+    ASSERT_EQ(flat.size(), reference.size());
+    EXPECT_LE(flat.capacity(), 16384u);
+    for (map<int, int>::iterator it = reference.begin(); it != reference.end(); ++it)
+    {
+        FlatHashMap<int, int>::iterator found = flat.find(it->first);
+        ASSERT_TRUE(found != flat.end());
+        EXPECT_EQ(found->second, it->second);
+    }
+    size_t visited = 0;
+    for (FlatHashMap<int, int>::iterator it = flat.begin(); it != flat.end(); ++it)
+    {
+        ++visited;
+        EXPECT_EQ(reference[it->first], it->second);
+    }
+    EXPECT_EQ(visited, reference.size());
+}
+TEST(FlatHashMap, reserve)
+{
+    FlatHashMap<int, string> names;
+    names.reserve(1000);
+    size_t capacity = names.capacity();
+    EXPECT_GE(capacity * 7 / 8, 1000u);
+    for (int i = 0; i < 1000; ++i)
+    {
+        ostringstream os;
+        os << i;
+        names[i] = os.str();
+    }
+    EXPECT_EQ(names.capacity(), capacity);
+    EXPECT_EQ(names[999], "999");
+    FlatHashMap<int, string>::iterator it = names.find(17);
+    names.erase(it);
+    EXPECT_EQ(names.size(), 999u);
+    FlatHashMap<int, string> other;
+    other = names;
+    EXPECT_EQ(other[500], "500");
+    EXPECT_EQ(other.count(17), 0u);
+}
@@ -0,0 +1,180 @@
+#include <itemset_mining.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+#include "dataset.h"
+#include "instance.h"
+#include "instance_container.h"
+#include "rng.h"
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+static DataSet* baskets(const vector<vector<int> >& transactions)
+{
+    DataSet* data = new DataSet("baskets", new SparseInstanceContainer());
+    for (size_t t = 0; t < transactions.size(); ++t)
+    {
+        vector<ValueType> values(transactions[t].size(), 1);
+        IInstance* instance = new SparseInstance(values, transactions[t], 1);
+        instance->setDataset(data);
+        data->add(instance);
+    }
+    return data;
+}
+static size_t supportOf(const vector<vector<int> >& transactions, const vector<int>& items)
+{
+    size_t support = 0;
+    for (size_t t = 0; t < transactions.size(); ++t)
+    {
+        bool all = true;
+        for (size_t k = 0; k < items.size() && all; ++k)
+        {
+            all = binary_search(transactions[t].begin(), transactions[t].end(), items[k]);
+        }
+        support += all;
+    }
+    return support;
+}
+class RuleCollector: public RuleSink
+{
+public:
+    /*override*/ void add(const AssociationRule& rule)
+    {
+        rules.push_back(rule);
+    }
+    vector<AssociationRule> rules;
+};
+TEST(ItemsetMiner, textbook)
+{
+    // Agrawal and Srikant's example database
+    int rows[4][4] = {{1, 3, 4, -1}, {2, 3, 5, -1}, {1, 2, 3, 5}, {2, 5, -1, -1}};
+    vector<vector<int> > transactions(4);
+    for (int t = 0; t < 4; ++t)
+    {
+        for (int k = 0; k < 4 && rows[t][k] >= 0; ++k)
+        {
+            transactions[t].push_back(rows[t][k]);
+        }
+    }
+    auto_ptr<DataSet> data(baskets(transactions));
+    ItemsetMiner miner(2, 0, 2);
+    miner.load(data.get());
+    EXPECT_EQ(miner.numTransactions(), 4u);
+    EXPECT_EQ(miner.numFrequentItems(), 4);
+    vector<FrequentItemset> itemsets;
+    miner.mine(itemsets);
+    ASSERT_EQ(itemsets.size(), 9u);
+    EXPECT_EQ(itemsets.back().items.size(), 3u);
+    EXPECT_EQ(itemsets.back().items[0], 2);
+    EXPECT_EQ(itemsets.back().items[2], 5);
+    EXPECT_EQ(itemsets.back().support, 2u);
+
+    RuleCollector collector;
+    miner.rules(itemsets, 1.0, collector);
+    EXPECT_EQ(collector.rules.size(), 5u);
+    for (size_t i = 0; i < collector.rules.size(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(collector.rules[i].confidence, 1.0);
+        EXPECT_DOUBLE_EQ(collector.rules[i].lift, 4.0 / 3);
+    }
+}
+TEST(ItemsetMiner, matchesBruteForce)
+{
+    // a few common items kept as bitmaps, many rare ones as roaring sets
+    Xoshiro256 rng(50);
+    vector<vector<int> > transactions(3000);
+    for (size_t t = 0; t < transactions.size(); ++t)
+    {
+        for (int item = 0; item < 30; ++item)
+        {
+            double p = item < 6 ? 0.5 : 0.04;
+            if (rng.uniform() < p)
+            {
+                transactions[t].push_back(item);
+            }
+        }
+    }
+    auto_ptr<DataSet> data(baskets(transactions));
+    size_t minSupport = 30;
+    vector<FrequentItemset> itemsets;
+    vector<FrequentItemset> serial;
+    {
+        ItemsetMiner miner(minSupport, 0, 4);
+        miner.load(data.get());
+        miner.mine(itemsets);
+    }
+    {
+        ItemsetMiner miner(0.01, 0, 1);
+        miner.load(data.get());
+        EXPECT_EQ(miner.minSupport(), minSupport);
+        miner.mine(serial);
+    }
+    ASSERT_EQ(itemsets.size(), serial.size());
+    map<vector<int>, size_t> found;
+    for (size_t i = 0; i < itemsets.size(); ++i)
+    {
+        EXPECT_TRUE(itemsets[i].items == serial[i].items);
+        found[itemsets[i].items] = itemsets[i].support;
+    }
+    ASSERT_GT(found.size(), 30u);
+    // every itemset of up to three items counted over the rows
+    size_t frequent = 0;
+    vector<vector<int> > candidates;
+    for (int a = 0; a < 30; ++a)
+    {
+        candidates.push_back(vector<int>(1, a));
+        for (int b = a + 1; b < 30; ++b)
+        {
+            int items[] = {a, b, 0};
+            candidates.push_back(vector<int>(items, items + 2));
+            for (items[2] = b + 1; items[2] < 30; ++items[2])
+            {
+                candidates.push_back(vector<int>(items, items + 3));
+            }
+        }
+    }
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        size_t support = supportOf(transactions, candidates[i]);
+        if (support >= minSupport)
+        {
+            ++frequent;
+            ASSERT_EQ(found.count(candidates[i]), 1u);
+            EXPECT_EQ(found[candidates[i]], support);
+        }
+        else
+        {
+            EXPECT_EQ(found.count(candidates[i]), 0u);
+        }
+    }
+    size_t small = 0;
+    for (size_t i = 0; i < itemsets.size(); ++i)
+    {
+        small += itemsets[i].items.size() <= 3;
+    }
+    EXPECT_EQ(small, frequent);
+
+    ItemsetMiner pairs(minSupport, 2, 2);
+    pairs.load(data.get());
+    vector<FrequentItemset> upToPairs;
+    pairs.mine(upToPairs);
+    EXPECT_EQ(upToPairs.back().items.size(), 2u);
+
+    ItemsetMiner miner(minSupport, 0, 2);
+    miner.load(data.get());
+    RuleCollector collector;
+    miner.rules(itemsets, 0.6, collector);
+    ASSERT_GT(collector.rules.size(), 0u);
+    for (size_t i = 0; i < collector.rules.size(); ++i)
+    {
+        const AssociationRule& rule = collector.rules[i];
+        vector<int> all(rule.antecedent);
+        all.insert(all.end(), rule.consequent.begin(), rule.consequent.end());
+        sort(all.begin(), all.end());
+        EXPECT_EQ(found[all], rule.support);
+        EXPECT_DOUBLE_EQ(rule.confidence, double(rule.support) / found[rule.antecedent]);
+        EXPECT_GE(rule.confidence, 0.6);
+        EXPECT_DOUBLE_EQ(rule.lift, rule.confidence * transactions.size() / found[rule.consequent]);
+    }
+}
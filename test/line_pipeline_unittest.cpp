@@ -0,0 +1,108 @@
+#include <multipattern/line_pipeline.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+using namespace std;
+namespace
+{
+//copies every line with its number, throws on line failAt
+class CopyLines : public LineBatchProcessor
+{
+public:
+    explicit CopyLines(size_t failAt = (size_t)-1): mFailAt(failAt) {}
+    /*override*/ void process(LineBatch& batch)
+    {
+        batch.text.clear();
+        for (size_t i = 0; i < batch.count; ++i)
+        {
+            if (batch.firstLine + i == mFailAt)
+            {
+                throw runtime_error("scanner failed");
+            }
+            ostringstream row;
+            row << batch.firstLine + i << " " << batch.lines[i] << "\n";
+            batch.text += row.str();
+        }
+    }
+private:
+    size_t mFailAt;
+};
+class Collect : public LineBatchWriter
+{
+public:
+    explicit Collect(size_t failAfter = (size_t)-1): mFailAfter(failAfter), mBatches(0) {}
+    /*override*/ void write(const LineBatch& batch)
+    {
+        if (mBatches++ == mFailAfter)
+        {
+            throw runtime_error("writer failed");
+        }
+        mText += batch.text;
+    }
+    string mText;
+private:
+    size_t mFailAfter;
+    size_t mBatches;
+};
+string numbered(int lines, string& expected)
+{
+    ostringstream input;
+    ostringstream output;
+    for (int i = 0; i < lines; ++i)
+    {
+        input << "line" << i << "\n";
+        output << i << " line" << i << "\n";
+    }
+    expected = output.str();
+    return input.str();
+}
+}
+TEST(LinePipeline, keepsInputOrder)
+{
+    string expected;
+    istringstream input(numbered(1000, expected));
+    vector<CopyLines> copies(3);
+    vector<LineBatchProcessor*> processors;
+    for (size_t i = 0; i < copies.size(); ++i)
+    {
+        processors.push_back(&copies[i]);
+    }
+    Collect writer;
+    runLinePipeline(input, processors, writer, 7);
+    EXPECT_EQ(expected, writer.mText);
+}
+TEST(LinePipeline, failingStageStopsEveryThread)
+{
+    //far more batches than circulate, so a stage left blocked would hang
+    string expected;
+    string text = numbered(5000, expected);
+    vector<CopyLines> copies(2, CopyLines(123));
+    vector<LineBatchProcessor*> processors;
+    processors.push_back(&copies[0]);
+    processors.push_back(&copies[1]);
+    for (int round = 0; round < 20; ++round)
+    {
+        istringstream input(text);
+        Collect writer;
+        EXPECT_THROW(runLinePipeline(input, processors, writer, 4), runtime_error);
+        EXPECT_LT(writer.mText.size(), expected.size());
+    }
+
+    vector<CopyLines> fine(2);
+    processors[0] = &fine[0];
+    processors[1] = &fine[1];
+    istringstream input(text);
+    Collect writer(3);
+    try
+    {
+        runLinePipeline(input, processors, writer, 4);
+        FAIL() << "the writer error was lost";
+    }
+    catch (runtime_error& e)
+    {
+        EXPECT_EQ(string("writer failed"), e.what());
+    }
+    EXPECT_THROW(runLinePipeline(input, vector<LineBatchProcessor*>(), writer, 4), invalid_argument);
+}
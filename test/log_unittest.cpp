@@ -0,0 +1,72 @@
+#include <log.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "gtest/gtest.h"
+using namespace std;
+using namespace mlplus;
+static void* logLines(void*)
+{
+    for (int i = 0; i < 1000; ++i)
+    {
+        WARN("line %d", i);
+    }
+    return NULL;
+}
+static int countLines(FILE* file, const char* needle)
+{
+    rewind(file);
+    char line[2048];
+    int count = 0;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        count += strstr(line, needle) != NULL;
+    }
+    return count;
+}
+TEST(Logger, AsyncKeepsEveryRecordWhenBlocking){
+    FILE* file = tmpfile();
+    ASSERT_TRUE(file != NULL);
+    Logger* logger = Logger::instance(Logger::LOG_LEVEL);
+    FILE* previous = logger->setLogHandler(file);
+    ASSERT_TRUE(logger->startAsync(16, Logger::BLOCK_WHEN_FULL));
+    EXPECT_TRUE(logger->isAsync());
+    pthread_t threads[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        pthread_create(&threads[i], NULL, logLines, NULL);
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    logger->stopAsync();
+    EXPECT_FALSE(logger->isAsync());
+    EXPECT_EQ(0u, logger->droppedRecords());
+    EXPECT_EQ(4000, countLines(file, "[WARN]"));
+    EXPECT_EQ(4, countLines(file, "line 999\n"));
+    LOG("%s", "synchronous again");
+    EXPECT_EQ(1, countLines(file, "synchronous again"));
+    logger->setLogHandler(previous);
+    fclose(file);
+}
+TEST(Logger, AsyncDropsWhenFull){
+    FILE* file = tmpfile();
+    ASSERT_TRUE(file != NULL);
+    Logger* logger = Logger::instance(Logger::LOG_LEVEL);
+    FILE* previous = logger->setLogHandler(file);
+    ASSERT_TRUE(logger->startAsync(2, Logger::DROP_WHEN_FULL));
+    for (int i = 0; i < 10000; ++i)
+    {
+        LOG("record %d", i);
+    }
+    logger->stopAsync();
+    unsigned long dropped = logger->droppedRecords();
+    EXPECT_EQ(10000, countLines(file, "record ") + (int)dropped);
+    if (dropped > 0)
+    {
+        EXPECT_GE(countLines(file, "log records dropped"), 1);
+    }
+    logger->setLogHandler(previous);
+    fclose(file);
+}
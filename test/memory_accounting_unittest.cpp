@@ -0,0 +1,134 @@
+#include <memory_accounting.h>
+#include <vector>
+#include "dataset.h"
+#include "instance.h"
+#include "instance_container.h"
+#include "attribute_container.h"
+#include "estimators/discrete_estimator.h"
+#include "thread_pool.h"
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+TEST(MemoryAccounting, chargeAndPeak)
+{
+    memory::flushThread();
+    int64_t before = memory::bytesInUse(memory::PARSER_BUFFERS);
+    memory::charge(memory::PARSER_BUFFERS, 1000);
+    // below FLUSH_BYTES the change stays with the thread
+    EXPECT_EQ(memory::bytesInUse(memory::PARSER_BUFFERS), before);
+    memory::flushThread();
+    EXPECT_EQ(memory::bytesInUse(memory::PARSER_BUFFERS), before + 1000);
+    memory::charge(memory::PARSER_BUFFERS, 1 << 20);
+    EXPECT_EQ(memory::bytesInUse(memory::PARSER_BUFFERS), before + 1000 + (1 << 20));
+    EXPECT_GE(memory::peakBytes(memory::PARSER_BUFFERS), before + 1000 + (1 << 20));
+    memory::release(memory::PARSER_BUFFERS, (1 << 20) + 1000);
+    memory::flushThread();
+    EXPECT_EQ(memory::bytesInUse(memory::PARSER_BUFFERS), before);
+    EXPECT_GE(memory::totalPeakBytes(), memory::peakBytes(memory::PARSER_BUFFERS));
+    EXPECT_STREQ(memory::tagName(memory::TREE_NODES), "tree_nodes");
+}
+
+class ChargeTask : public Runnable
+{
+public:
+    /*override*/ void run()
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            memory::charge(memory::ATTRIBUTES, 100);
+        }
+    }
+};
+TEST(MemoryAccounting, threads)
+{
+    memory::flushThread();
+    int64_t before = memory::bytesInUse(memory::ATTRIBUTES);
+    vector<ChargeTask*> tasks;
+    {
+        ThreadPool pool(4);
+        for (int i = 0; i < 8; ++i)
+        {
+            tasks.push_back(new ChargeTask());
+            pool.submit(tasks.back());
+        }
+        pool.wait();
+    }
+    // the workers settle their share as they exit
+    EXPECT_EQ(memory::bytesInUse(memory::ATTRIBUTES), before + 8 * 1000 * 100);
+    memory::release(memory::ATTRIBUTES, 8 * 1000 * 100);
+    memory::flushThread();
+    EXPECT_EQ(memory::bytesInUse(memory::ATTRIBUTES), before);
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        delete tasks[i];
+    }
+}
+
+TEST(MemoryAccounting, phases)
+{
+    size_t count = memory::phases().size();
+    {
+        memory::Phase outer("outer");
+        {
+            memory::Phase inner("inner");
+            memory::charge(memory::TREE_NODES, 4 << 20);
+            memory::release(memory::TREE_NODES, 4 << 20);
+        }
+        memory::charge(memory::TREE_NODES, 1 << 20);
+        memory::release(memory::TREE_NODES, 1 << 20);
+    }
+    vector<memory::PhaseRecord> records = memory::phases();
+    ASSERT_EQ(records.size(), count + 2);
+    const memory::PhaseRecord& inner = records[count];
+    const memory::PhaseRecord& outer = records[count + 1];
+    EXPECT_EQ(inner.name, "inner");
+    EXPECT_EQ(outer.name, "outer");
+    EXPECT_GE(inner.peakBytes - inner.startBytes, 4 << 20);
+    EXPECT_EQ(inner.endBytes, inner.startBytes);
+    // the outer peak covers the inner phase
+    EXPECT_GE(outer.peakBytes, inner.peakBytes);
+    EXPECT_GT(outer.peakResidentBytes, 0u);
+}
+
+TEST(MemoryAccounting, datasetUsage)
+{
+    memory::flushThread();
+    int64_t before = memory::bytesInUse(memory::DATASET_VALUES);
+    DataSet* data = new DataSet("usage", new VectorAttributeContainer(), new DenseInstanceContainer());
+    for (int a = 0; a < 100; ++a)
+    {
+        data->getAttributeContainer()->add(new Attribute("a"));
+    }
+    vector<ValueType> values(100, 1);
+    for (int i = 0; i < 1000; ++i)
+    {
+        data->add(new DenseInstance(values));
+    }
+    size_t usage = data->memoryUsage();
+    EXPECT_GE(usage, 1000 * 100 * sizeof(ValueType));
+    EXPECT_LT(usage, 2 * 1000 * 100 * sizeof(ValueType));
+    memory::flushThread();
+    EXPECT_GE(memory::bytesInUse(memory::DATASET_VALUES) - before, (int64_t)(1000 * 100 * sizeof(ValueType)));
+
+    // a view counts its rows, not the instances
+    vector<int> rows(1000);
+    for (int i = 0; i < 1000; ++i)
+    {
+        rows[i] = i;
+    }
+    DataSet* view = data->subset(rows);
+    EXPECT_LT(view->memoryUsage(), usage / 10);
+    delete view;
+    delete data;
+    memory::flushThread();
+    EXPECT_EQ(memory::bytesInUse(memory::DATASET_VALUES), before);
+
+    int64_t estimators = memory::bytesInUse(memory::ESTIMATORS);
+    estimators::Estimator* e = new estimators::DiscreteEstimator(1000);
+    EXPECT_GE(e->memoryUsage(), 1000 * sizeof(double));
+    memory::flushThread();
+    EXPECT_EQ(memory::bytesInUse(memory::ESTIMATORS) - estimators, (int64_t)e->memoryUsage());
+    delete e;
+    memory::flushThread();
+    EXPECT_EQ(memory::bytesInUse(memory::ESTIMATORS), estimators);
+}
@@ -0,0 +1,137 @@
+#include "io/text_parser.h"
+#include "dataset.h"
+#include "naive_bayes.h"
+#include <cmath>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <pthread.h>
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+namespace
+{
+void expectSamePredictions(NaiveBayes& expected, NaiveBayes& actual, DataSet* data)
+{
+    for (int i = 0; i < data->numInstances(); i += 7)
+    {
+        vector<double> e = expected.targetDistribution(data->instanceAt(i));
+        vector<double> a = actual.targetDistribution(data->instanceAt(i));
+        ASSERT_EQ(e.size(), a.size());
+        for (unsigned j = 0; j < e.size(); ++j)
+        {
+            //both paths agree on instances every class gives zero likelihood
+            if (isnan(e[j]))
+            {
+                EXPECT_TRUE(isnan(a[j]));
+                continue;
+            }
+            EXPECT_NEAR(e[j], a[j], 1e-9);
+        }
+    }
+}
+struct Ingest
+{
+    NaiveBayes* model;
+    DataSet* data;
+};
+void* ingest(void* arg)
+{
+    Ingest* job = static_cast<Ingest*>(arg);
+    for (int i = 0; i < job->data->numInstances(); ++i)
+    {
+        job->model->update(job->data->instanceAt(i));
+    }
+    return NULL;
+}
+}
+TEST(NaiveBayesKernel, MatchesVirtualEstimators){
+    std::auto_ptr<TextParser> p(new TextParser("example.names"));
+    std::auto_ptr<DataSet> data(p->readData("example.cases"));
+    NaiveBayes nb("nb", data->numTargets());
+    nb.train(data.get());
+    EXPECT_TRUE(nb.compile());
+
+    //concurrent estimators are never compiled, they keep the virtual path
+    NaiveBayes legacy("legacy", data->numTargets());
+    legacy.setConcurrency(1);
+    legacy.train(data.get());
+    EXPECT_FALSE(legacy.compile());
+    expectSamePredictions(legacy, nb, data.get());
+
+    stringstream model;
+    nb.save(model);
+    stringstream copy(model.str());
+    NaiveBayes loaded("loaded", data->numTargets());
+    loaded.load(model);
+    EXPECT_TRUE(loaded.compile());
+    NaiveBayes legacyLoaded("legacyLoaded", data->numTargets());
+    legacyLoaded.setConcurrency(1);
+    legacyLoaded.load(copy);
+    expectSamePredictions(legacyLoaded, loaded, data.get());
+}
+TEST(NaiveBayesKernel, UpdateFallsBackUntilCompiled){
+    std::auto_ptr<TextParser> p(new TextParser("example.names"));
+    std::auto_ptr<DataSet> data(p->readData("example.cases"));
+    NaiveBayes nb("nb", data->numTargets());
+    nb.train(data.get());
+    NaiveBayes legacy("legacy", data->numTargets());
+    legacy.setConcurrency(1);
+    legacy.train(data.get());
+    for (int i = 0; i < 10; ++i)
+    {
+        nb.update(data->instanceAt(i));
+        legacy.update(data->instanceAt(i));
+    }
+    expectSamePredictions(legacy, nb, data.get());
+    EXPECT_TRUE(nb.compile());
+    expectSamePredictions(legacy, nb, data.get());
+}
+TEST(NaiveBayesKernel, TopKMatchesDistribution){
+    std::auto_ptr<TextParser> p(new TextParser("example.names"));
+    std::auto_ptr<DataSet> data(p->readData("example.cases"));
+    NaiveBayes nb("nb", data->numTargets());
+    nb.train(data.get());
+    for (int i = 0; i < data->numInstances(); i += 13)
+    {
+        vector<double> dist = nb.targetDistribution(data->instanceAt(i));
+        vector<pair<int, double> > top = nb.predictTopK(data->instanceAt(i), 2);
+        ASSERT_EQ(2u, top.size());
+        if (isnan(dist[0]))
+        {
+            continue;
+        }
+        EXPECT_GE(top[0].second, top[1].second);
+        for (unsigned j = 0; j < top.size(); ++j)
+        {
+            EXPECT_NEAR(dist[top[j].first], top[j].second, 1e-9);
+        }
+        pair<int, double> best = nb.predict(data->instanceAt(i));
+        EXPECT_EQ(top[0].first, best.first);
+    }
+}
+TEST(NaiveBayesKernel, ConcurrentIngestMatchesSerial){
+    std::auto_ptr<TextParser> p(new TextParser("example.names"));
+    std::auto_ptr<DataSet> data(p->readData("example.cases"));
+    NaiveBayes nb("nb", data->numTargets());
+    nb.train(data.get());
+    NaiveBayes concurrent("concurrent", data->numTargets());
+    concurrent.setConcurrency(4);
+    concurrent.train(data.get());
+    const int threads = 4;
+    Ingest job = {&concurrent, data.get()};
+    pthread_t ids[threads];
+    for (int t = 0; t < threads; ++t)
+    {
+        pthread_create(&ids[t], NULL, ingest, &job);
+    }
+    for (int t = 0; t < threads; ++t)
+    {
+        pthread_join(ids[t], NULL);
+        Ingest serial = {&nb, data.get()};
+        ingest(&serial);
+    }
+    EXPECT_FALSE(concurrent.compile());
+    expectSamePredictions(concurrent, nb, data.get());
+}
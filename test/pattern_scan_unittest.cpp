@@ -0,0 +1,197 @@
+#include <multipattern/pattern_scan.h>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <vector>
+#include <string>
+#include "gtest/gtest.h"
+using namespace std;
+TEST(PatternScan, ShortAndLongEnglishWords){
+    vector<string> patterns;
+    patterns.push_back("he");
+    patterns.push_back("hers");
+    patterns.push_back("\xe4\xb8\xad\xe5\x9b\xbd");
+    PatternScan scanner;
+    scanner.Init(patterns);
+    map<string, uint32_t> matches;
+    EXPECT_EQ(3, scanner.Scan("he said hers ushers \xe4\xb8\xad\xe5\x9b\xbd\xe4\xba\xba", matches));
+    EXPECT_EQ(1u, matches["he"]);
+    EXPECT_EQ(1u, matches["hers"]);
+    EXPECT_EQ(1u, matches["\xe4\xb8\xad\xe5\x9b\xbd"]);
+    EXPECT_EQ(3u, matches.size());
+}
+TEST(PatternScan, CountsByIdAndWeight){
+    vector<string> patterns;
+    patterns.push_back("zebra");
+    patterns.push_back("ant");
+    patterns.push_back("zebra");
+    vector<uint32_t> ids;
+    ids.push_back(7);
+    ids.push_back(3);
+    ids.push_back(9);
+    vector<float> weights;
+    weights.push_back(0.5);
+    weights.push_back(2);
+    weights.push_back(4);
+    PatternScan scanner;
+    scanner.Init(patterns, ids, weights);
+    EXPECT_EQ(10u, scanner.IdCount());
+    EXPECT_EQ("ant", scanner.Pattern(3));
+    EXPECT_EQ(0.5, scanner.Weight(7));
+    MatchCounter matches;
+    EXPECT_EQ(3, scanner.Scan("zebra ant zebra", matches));
+    ASSERT_EQ(2u, matches.Size());
+    EXPECT_EQ(MatchCounter::Match(7, 2), matches[0]);
+    EXPECT_EQ(MatchCounter::Match(3, 1), matches[1]);
+    matches.Sort();
+    EXPECT_EQ(MatchCounter::Match(3, 1), matches[0]);
+    scanner.Scan("ant", matches);
+    EXPECT_EQ(MatchCounter::Match(3, 2), matches[0]);
+    matches.Clear();
+    EXPECT_TRUE(matches.Empty());
+    EXPECT_EQ(1, scanner.Scan("zebra", matches, 1));
+    EXPECT_EQ(MatchCounter::Match(7, 1), matches[0]);
+}
+TEST(PatternScan, LongMixedText){
+    vector<string> patterns;
+    patterns.push_back("ab");
+    patterns.push_back("abcdef");
+    patterns.push_back("\xe4\xb8\xad");
+    patterns.push_back("x\xe4\xb8\xad\xe5\x9b\xbd");
+    PatternScan scanner;
+    scanner.Init(patterns);
+    string text;
+    for (int i = 0; i < 40; ++i)
+    {
+        text += "ab abcdef qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqq x\xe4\xb8\xad\xe5\x9b\xbd ";
+    }
+    MatchCounter matches;
+    EXPECT_EQ(160, scanner.Scan(text, matches));
+    matches.Sort();
+    ASSERT_EQ(4u, matches.Size());
+    for (size_t i = 0; i < matches.Size(); ++i)
+    {
+        EXPECT_EQ(MatchCounter::Match(i, 40), matches[i]);
+    }
+}
+TEST(PatternScan, CompiledDictionary){
+    vector<string> patterns;
+    patterns.push_back("he");
+    patterns.push_back("hers");
+    patterns.push_back("\xe4\xb8\xad\xe5\x9b\xbd\xe4\xba\xba");
+    vector<uint32_t> ids;
+    ids.push_back(1);
+    ids.push_back(2);
+    ids.push_back(5);
+    vector<float> weights(3, 1.5);
+    PatternScan scanner(2);
+    scanner.Init(patterns, ids, weights);
+    const char* path = "pattern_scan_unittest.dict";
+    scanner.SaveCompiled(path);
+    EXPECT_TRUE(PatternScan::IsCompiled(path));
+    PatternScan loaded;
+    loaded.LoadCompiled(path);
+    EXPECT_EQ(6u, loaded.IdCount());
+    EXPECT_EQ("hers", loaded.Pattern(2));
+    EXPECT_EQ(1.5, loaded.Weight(5));
+    const string text = "he hers \xe4\xb8\xad\xe5\x9b\xbd\xe4\xba\xba hers";
+    MatchCounter expected;
+    MatchCounter actual;
+    EXPECT_EQ(scanner.Scan(text, expected), loaded.Scan(text, actual));
+    EXPECT_EQ(expected.Matches(), actual.Matches());
+    EXPECT_EQ(3u, actual.Size());
+    remove(path);
+    EXPECT_FALSE(PatternScan::IsCompiled(path));
+    EXPECT_THROW(loaded.LoadCompiled(path), std::runtime_error);
+}
+// header fields the corruptions below patch, as laid out by SaveCompiled
+static const size_t PATTERN_COUNT = 24;
+static const size_t PATTERN_OFFSETS = 48;
+static const size_t PATTERN_IDS = 72;
+static const size_t TABLES = 104;
+static const size_t TABLE_CAPACITY = 136;
+static uint64_t ReadU64(const string& image, size_t at)
+{
+    uint64_t value;
+    memcpy(&value, image.data() + at, sizeof(value));
+    return value;
+}
+template <class T>
+static void Write(string& image, size_t at, T value)
+{
+    memcpy(&image[at], &value, sizeof(value));
+}
+static bool LoadFails(const string& image)
+{
+    const char* path = "pattern_scan_corrupt.dict";
+    FILE* file = fopen(path, "wb");
+    fwrite(image.data(), 1, image.size(), file);
+    fclose(file);
+    PatternScan scanner;
+    bool failed = false;
+    try
+    {
+        scanner.LoadCompiled(path);
+    }
+    catch (std::runtime_error&)
+    {
+        failed = true;
+    }
+    remove(path);
+    return failed;
+}
+TEST(PatternScan, CorruptCompiledDictionary){
+    vector<string> patterns;
+    patterns.push_back("he");
+    patterns.push_back("hers");
+    patterns.push_back("she");
+    PatternScan scanner(2);
+    scanner.Init(patterns);
+    const char* path = "pattern_scan_unittest.dict";
+    scanner.SaveCompiled(path);
+    string image;
+    FILE* file = fopen(path, "rb");
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        image.append(buffer, n);
+    }
+    fclose(file);
+    remove(path);
+    EXPECT_FALSE(LoadFails(image));
+    EXPECT_TRUE(LoadFails(image.substr(0, image.size() - 8)));
+
+    uint64_t patternCount = ReadU64(image, PATTERN_COUNT);
+    uint64_t offsets = ReadU64(image, PATTERN_OFFSETS);
+    uint64_t ids = ReadU64(image, PATTERN_IDS);
+    uint64_t table = ReadU64(image, TABLES);
+    uint64_t capacity = ReadU64(image, TABLE_CAPACITY);
+    uint64_t filled = table;
+    while (ReadU64(image, filled) == 0)
+    {
+        filled += 16;
+    }
+
+    string corrupt = image;
+    Write<uint32_t>(corrupt, filled + 12, patternCount + 1);
+    EXPECT_TRUE(LoadFails(corrupt));
+
+    corrupt = image;
+    Write<uint64_t>(corrupt, offsets + 16, ReadU64(image, offsets + 24) + 1);
+    EXPECT_TRUE(LoadFails(corrupt));
+
+    corrupt = image;
+    Write<uint32_t>(corrupt, ids + 4, 1000);
+    EXPECT_TRUE(LoadFails(corrupt));
+
+    corrupt = image;
+    for (uint64_t slot = table; slot < table + capacity * 16; slot += 16)
+    {
+        Write<uint64_t>(corrupt, slot, slot);
+        Write<uint32_t>(corrupt, slot + 8, 1);
+        Write<uint32_t>(corrupt, slot + 12, patternCount);
+    }
+    EXPECT_TRUE(LoadFails(corrupt));
+}
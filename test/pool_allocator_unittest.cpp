@@ -0,0 +1,108 @@
+#include <pool_allocator.h>
+#include <map>
+#include <vector>
+#include "thread_pool.h"
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+TEST(PoolAllocator, sizeClasses)
+{
+    for (size_t size = 0; size <= MemoryPool::MAX_SIZE; ++size)
+    {
+        size_t c = MemoryPool::sizeClass(size);
+        ASSERT_LT(c, (size_t)MemoryPool::NUM_CLASSES);
+        EXPECT_GE(MemoryPool::classSize(c), size);
+        if (c > 0)
+        {
+            EXPECT_LT(MemoryPool::classSize(c - 1), size);
+        }
+    }
+    EXPECT_EQ(MemoryPool::classSize(MemoryPool::NUM_CLASSES - 1), (size_t)MemoryPool::MAX_SIZE);
+}
+TEST(PoolAllocator, reuse)
+{
+    void* a = MemoryPool::allocate(40);
+    void* b = MemoryPool::allocate(48);
+    EXPECT_NE(a, b);
+    EXPECT_EQ((size_t)a % 16, 0u);
+    MemoryPool::deallocate(a, 40);
+    // the same class, the last object freed is the next one handed out
+    EXPECT_EQ(MemoryPool::allocate(33), a);
+    MemoryPool::deallocate(a, 33);
+    MemoryPool::deallocate(b, 48);
+    void* big = MemoryPool::allocate(MemoryPool::MAX_SIZE + 1);
+    MemoryPool::deallocate(big, MemoryPool::MAX_SIZE + 1);
+
+    vector<int, PoolAllocator<int> > values;
+    map<int, int, less<int>, PoolAllocator<pair<const int, int> > > squares;
+    for (int i = 0; i < 10000; ++i)
+    {
+        values.push_back(i);
+        squares[i] = i * i;
+    }
+    EXPECT_EQ(values[9999], 9999);
+    EXPECT_EQ(squares[100], 10000);
+}
+
+/**
+ * @brief allocates and frees in a pattern of its own, and frees half of
+ *        what the previous task left
+ */
+class ChurnTask : public Runnable
+{
+public:
+    ChurnTask(int task, vector<void*>& handOff): mTask(task), mHandOff(handOff) {}
+    /*override*/ void run()
+    {
+        vector<void*> live(256, (void*)NULL);
+        for (int i = 0; i < 20000; ++i)
+        {
+            size_t slot = (i * 7 + mTask) % live.size();
+            size_t size = 8 + (slot * 24) % 600;
+            if (live[slot] != NULL)
+            {
+                // the first word is overwritten by the free list
+                ASSERT_EQ(((char*)live[slot])[size - 1], (char)slot);
+                MemoryPool::deallocate(live[slot], size);
+            }
+            live[slot] = MemoryPool::allocate(size);
+            ((char*)live[slot])[size - 1] = (char)slot;
+        }
+        for (size_t slot = 0; slot < live.size(); ++slot)
+        {
+            MemoryPool::deallocate(live[slot], 8 + (slot * 24) % 600);
+        }
+        mHandOff[mTask] = MemoryPool::allocate(100);
+    }
+private:
+    int mTask;
+    vector<void*>& mHandOff;
+};
+TEST(PoolAllocator, threadChurn)
+{
+    vector<void*> handOff(16, (void*)NULL);
+    vector<ChurnTask*> tasks;
+    {
+        ThreadPool pool(4);
+        for (int i = 0; i < 16; ++i)
+        {
+            tasks.push_back(new ChurnTask(i, handOff));
+            pool.submit(tasks.back());
+        }
+        pool.wait();
+    }
+    // objects from other threads come back to this one
+    for (size_t i = 0; i < handOff.size(); ++i)
+    {
+        MemoryPool::deallocate(handOff[i], 100);
+        delete tasks[i];
+    }
+    size_t reserved = MemoryPool::bytesReserved();
+    EXPECT_GT(reserved, 0u);
+    size_t released = MemoryPool::releaseFreeBlocks();
+    EXPECT_GT(released, 0u);
+    EXPECT_EQ(MemoryPool::bytesReserved(), reserved - released);
+    // released classes still work
+    void* p = MemoryPool::allocate(100);
+    MemoryPool::deallocate(p, 100);
+}
@@ -0,0 +1,58 @@
+#define MLPLUS_PROFILE
+#include <profile.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "thread_pool.h"
+#include "gtest/gtest.h"
+using namespace std;
+using namespace mlplus;
+static string reportText(bool json)
+{
+    FILE* file = tmpfile();
+    profile::report(file, json);
+    string text(ftell(file), '\0');
+    rewind(file);
+    size_t read = fread(&text[0], 1, text.size(), file);
+    fclose(file);
+    text.resize(read);
+    return text;
+}
+static void countRows(int rows)
+{
+    MLPLUS_PROFILE_SCOPE("ProfileTest::countRows");
+    for (int i = 0; i < rows; ++i)
+    {
+        MLPLUS_PROFILE_COUNT("ProfileTest rows", 1);
+    }
+}
+class CountTask : public Runnable
+{
+public:
+    void run()
+    {
+        countRows(1000);
+    }
+};
+TEST(Profile, SumsThreads){
+    profile::reset();
+    CountTask tasks[4];
+    {
+        ThreadPool pool(4);
+        for (int i = 0; i < 4; ++i)
+        {
+            pool.submit(&tasks[i]);
+        }
+        pool.wait();
+    }
+    countRows(10);
+    string table = reportText(false);
+    EXPECT_NE(string::npos, table.find("ProfileTest::countRows"));
+    string json = reportText(true);
+    EXPECT_NE(string::npos, json.find("{\"name\":\"ProfileTest::countRows\",\"calls\":5,\"count\":0,"));
+    EXPECT_NE(string::npos, json.find("{\"name\":\"ProfileTest rows\",\"calls\":4010,\"count\":4010,"));
+}
+TEST(Profile, SameNameSharesProbe){
+    EXPECT_EQ(profile::registerProbe("ProfileTest shared"), profile::registerProbe("ProfileTest shared"));
+    EXPECT_NE(profile::registerProbe("ProfileTest shared"), profile::registerProbe("ProfileTest other"));
+}
@@ -0,0 +1,107 @@
+#include <rng.h>
+#include <cmath>
+#include <vector>
+#include "thread_pool.h"
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+TEST(Rng, streams)
+{
+    Xoshiro256 a(42);
+    Xoshiro256 b(42);
+    Xoshiro256 jumped = Xoshiro256::stream(42, 1);
+    Xoshiro256 other(43);
+    int sameJumped = 0, sameOther = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        uint64_t x = a.next();
+        EXPECT_EQ(x, b.next());
+        sameJumped += x == jumped.next();
+        sameOther += x == other.next();
+    }
+    EXPECT_EQ(sameJumped, 0);
+    EXPECT_EQ(sameOther, 0);
+    Xoshiro256 twice(42);
+    twice.jump();
+    twice.jump();
+    Xoshiro256 stream = Xoshiro256::stream(42, 2);
+    EXPECT_EQ(twice.next(), stream.next());
+}
+TEST(Rng, bulkMatchesScalar)
+{
+    Xoshiro256 scalar(7);
+    Xoshiro256 bulk(7);
+    vector<double> out(1001);
+    bulk.uniforms(&out[0], out.size());
+    for (size_t i = 0; i < out.size(); ++i)
+    {
+        double u = scalar.uniform();
+        EXPECT_EQ(u, out[i]);
+        EXPECT_GE(u, 0);
+        EXPECT_LT(u, 1);
+    }
+    EXPECT_EQ(scalar.next(), bulk.next());
+}
+TEST(Rng, gaussianMoments)
+{
+    const int n = 200001;
+    vector<double> bulk(n);
+    Xoshiro256 random(3);
+    random.gaussians(&bulk[0], n, 2, 3);
+    Xoshiro256 scalar(5);
+    double sums[2][2] = {{0, 0}, {0, 0}};
+    for (int i = 0; i < n; ++i)
+    {
+        double g = 2 + 3 * scalar.gaussian();
+        double values[2] = {bulk[i], g};
+        for (int k = 0; k < 2; ++k)
+        {
+            sums[k][0] += values[k];
+            sums[k][1] += values[k] * values[k];
+        }
+    }
+    for (int k = 0; k < 2; ++k)
+    {
+        double mean = sums[k][0] / n;
+        EXPECT_NEAR(mean, 2, 0.03);
+        EXPECT_NEAR(sqrt(sums[k][1] / n - mean * mean), 3, 0.03);
+    }
+}
+
+class DrawTask : public Runnable
+{
+public:
+    DrawTask(int task, vector<uint64_t>& out): mTask(task), mOut(out) {}
+    /*override*/ void run()
+    {
+        seedThreadRandom(11, mTask);
+        mOut[mTask] = threadRandom().next();
+    }
+private:
+    int mTask;
+    vector<uint64_t>& mOut;
+};
+TEST(Rng, threadStreams)
+{
+    vector<uint64_t> single(8), parallel(8);
+    vector<DrawTask*> tasks;
+    for (int threads = 1; threads <= 4; threads += 3)
+    {
+        ThreadPool pool(threads);
+        for (int i = 0; i < 8; ++i)
+        {
+            tasks.push_back(new DrawTask(i, threads == 1 ? single : parallel));
+            pool.submit(tasks.back());
+        }
+        pool.wait();
+    }
+    for (int i = 0; i < 8; ++i)
+    {
+        EXPECT_EQ(single[i], parallel[i]);
+        EXPECT_EQ(single[i], Xoshiro256::stream(11, i).next());
+    }
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        delete tasks[i];
+    }
+}
@@ -0,0 +1,91 @@
+#include "io/text_parser.h"
+#include "dataset.h"
+#include "sampling.h"
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+TEST(Sampling, aliasFrequencies)
+{
+    vector<double> weights;
+    weights.push_back(1);
+    weights.push_back(0);
+    weights.push_back(3);
+    weights.push_back(6);
+    AliasTable table(weights);
+    ASSERT_EQ(table.size(), 4u);
+    SplitMix64 random(7);
+    vector<int> counts(4, 0);
+    const int draws = 100000;
+    for (int i = 0; i < draws; ++i)
+    {
+        ++counts[table(random)];
+    }
+    EXPECT_EQ(counts[1], 0);
+    EXPECT_NEAR(counts[0] / (double)draws, 0.1, 0.01);
+    EXPECT_NEAR(counts[2] / (double)draws, 0.3, 0.01);
+    EXPECT_NEAR(counts[3] / (double)draws, 0.6, 0.01);
+    EXPECT_THROW(AliasTable(vector<double>(3, 0.0)), runtime_error);
+}
+TEST(Sampling, views)
+{
+    auto_ptr<TextParser> p(new TextParser("example.names"));
+    auto_ptr<DataSet> data(p->readData("example.cases"));
+    int rows = data->numInstances();
+    auto_ptr<DataSet> a(data->resample(5));
+    auto_ptr<DataSet> b(data->resample(5));
+    ASSERT_EQ(a->numInstances(), rows);
+    int distinct = 0;
+    for (int i = 0; i < rows; ++i)
+    {
+        EXPECT_EQ(a->instanceAt(i), b->instanceAt(i));
+        distinct += i == 0 || a->instanceAt(i) != a->instanceAt(i - 1);
+    }
+    // about 1 - 1/e of the rows make it into a bootstrap sample
+    EXPECT_NEAR(distinct / (double)rows, 0.632, 0.03);
+
+    auto_ptr<DataSet> shuffled(data->randomize(3));
+    ASSERT_EQ(shuffled->numInstances(), rows);
+    EXPECT_NE(shuffled->instanceAt(0), data->instanceAt(0));
+
+    vector<double> weights(rows, 0.0);
+    weights[7] = 2;
+    auto_ptr<DataSet> weighted(data->resampleWithWeights(weights, 1));
+    ASSERT_EQ(weighted->numInstances(), rows);
+    for (int i = 0; i < rows; i += 97)
+    {
+        EXPECT_EQ(weighted->instanceAt(i)->targetValue(), data->instanceAt(7)->targetValue());
+        EXPECT_DOUBLE_EQ(weighted->instanceAt(i)->getWeight(), 1);
+    }
+
+    vector<int> indices(1, 3);
+    data->instanceAt(3)->setWeight(1);
+    auto_ptr<DataSet> reweighted(data->subset(indices, vector<double>(1, 2.5)));
+    IInstance* ref = reweighted->instanceAt(0);
+    EXPECT_DOUBLE_EQ(ref->getWeight(), 2.5);
+    EXPECT_DOUBLE_EQ(data->instanceAt(3)->getWeight(), 1);
+    EXPECT_EQ(ref->getValue(1), data->instanceAt(3)->getValue(1));
+    auto_ptr<IInstance> copy(ref->clone());
+    EXPECT_DOUBLE_EQ(copy->getWeight(), 2.5);
+}
+TEST(Sampling, bagsIgnoreThreads)
+{
+    auto_ptr<TextParser> p(new TextParser("example.names"));
+    auto_ptr<DataSet> data(p->readData("example.cases"));
+    vector<DataSet*> single, parallel;
+    bootstrapBags(*data, 6, 11, 1, single);
+    bootstrapBags(*data, 6, 11, 4, parallel);
+    ASSERT_EQ(single.size(), 6u);
+    ASSERT_EQ(parallel.size(), 6u);
+    for (size_t b = 0; b < single.size(); ++b)
+    {
+        for (int i = 0; i < data->numInstances(); i += 13)
+        {
+            EXPECT_EQ(single[b]->instanceAt(i), parallel[b]->instanceAt(i));
+        }
+        delete single[b];
+        delete parallel[b];
+    }
+}
@@ -0,0 +1,215 @@
+#include <score_metrics.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "synthetic_data.h"
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+struct Row
+{
+    double score;
+    double positive;
+    double negative;
+};
+static bool byScore(const Row& a, const Row& b)
+{
+    return a.score < b.score;
+}
+/**
+ * @brief scores rounded to 3 decimals, so there are ties, with outcomes that follow the score
+ */
+static vector<Row> rows(int count, uint64_t seed)
+{
+    SplitMix64 random(seed);
+    vector<Row> out;
+    for (int i = 0; i < count; ++i)
+    {
+        Row row;
+        row.score = floor(random.uniform() * 1000) / 1000;
+        bool positive = random.uniform() < row.score;
+        row.positive = positive;
+        row.negative = !positive;
+        out.push_back(row);
+    }
+    return out;
+}
+/**
+ * @brief the probability that a positive outranks a negative, ties count half
+ */
+static double pairAuc(vector<Row> data)
+{
+    sort(data.begin(), data.end(), byScore);
+    double negativesBelow = 0, area = 0, positives = 0;
+    for (size_t i = 0; i < data.size();)
+    {
+        size_t j = i;
+        double p = 0, n = 0;
+        for (; j < data.size() && data[j].score == data[i].score; ++j)
+        {
+            p += data[j].positive;
+            n += data[j].negative;
+        }
+        area += p * (negativesBelow + 0.5 * n);
+        negativesBelow += n;
+        positives += p;
+        i = j;
+    }
+    return area / (positives * negativesBelow);
+}
+TEST(scoreMetricsTest, binaryMetrics)
+{
+    BinaryMetrics a;
+    BinaryMetrics b;
+    a.add(0.8, 1, 0);
+    a.add(0.2, 0, 1);
+    b.add(0.6, 0, 1);
+    b.add(0.4, 1, 3);
+    a.merge(b);
+    EXPECT_DOUBLE_EQ(a.weight(), 7);
+    EXPECT_DOUBLE_EQ(a.positives(), 2);
+    EXPECT_DOUBLE_EQ(a.accuracy(), (1 + 1 + 0 + 3) / 7.0);
+    double logLoss = -(log(0.8) + log(0.8) + log(0.4) + log(0.4) + 3 * log(0.6)) / 7;
+    EXPECT_NEAR(a.logLoss(), logLoss, 1e-12);
+    double sse = 0.04 + 0.04 + 0.36 + 0.36 + 3 * 0.16;
+    EXPECT_NEAR(a.rmse(), sqrt(sse / 7), 1e-12);
+    EXPECT_NEAR(a.meanScore(), (0.8 + 0.2 + 0.6 + 4 * 0.4) / 7, 1e-12);
+}
+TEST(scoreMetricsTest, curveSweep)
+{
+    // positives at 0.9 and 0.5, negatives at 0.7 and 0.5: 2.5 of 4 pairs in order
+    CurveSweep sweep;
+    sweep.add(1, 0);
+    sweep.add(0, 1);
+    sweep.add(1, 1);
+    CurveMetrics curve = sweep.metrics();
+    EXPECT_DOUBLE_EQ(curve.auc, 0.625);
+    EXPECT_DOUBLE_EQ(curve.aucError, 0.125);
+    // precision 1 at recall 0.5, 2/4 at recall 1
+    EXPECT_DOUBLE_EQ(curve.prAuc, 0.5 * 1 + 0.5 * 0.5);
+}
+TEST(scoreMetricsTest, histogramBoundsExact)
+{
+    vector<Row> data = rows(20000, 3);
+    double exact = pairAuc(data);
+    ScoreHistogram fine(1000);
+    ScoreHistogram coarse(16);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        fine.add(data[i].score, data[i].positive, data[i].negative);
+        coarse.add(data[i].score, data[i].positive, data[i].negative);
+    }
+    CurveMetrics f = fine.curve();
+    CurveMetrics c = coarse.curve();
+    // one bin per distinct score gives the exact area
+    EXPECT_NEAR(f.auc, exact, 1e-9);
+    EXPECT_NEAR(c.auc, exact, c.aucError);
+    EXPECT_GT(c.aucError, f.aucError);
+    vector<ScoreBin> buckets;
+    fine.calibration(10, buckets);
+    ASSERT_EQ(buckets.size(), 10u);
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        double weight = buckets[i].positive + buckets[i].negative;
+        double mean = buckets[i].scoreSum / weight;
+        EXPECT_GE(mean, i / 10.0);
+        EXPECT_LT(mean, (i + 1) / 10.0);
+        // the outcomes follow the scores
+        EXPECT_NEAR(buckets[i].positive / weight, mean, 0.05);
+    }
+}
+TEST(scoreMetricsTest, sorterMatchesPairs)
+{
+    vector<Row> data = rows(50000, 5);
+    double exact = pairAuc(data);
+    ScoreHistogram histogram(1000);
+    // room for a run in memory, the rest spills to temporary files
+    ScoreSorter sorter(1000 * 24, 1000);
+    {
+        ScoreSorter::Writer a(sorter);
+        ScoreSorter::Writer b(sorter);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            (i % 3 == 0 ? a : b).add(data[i].score, data[i].positive, data[i].negative);
+            histogram.add(data[i].score, data[i].positive, data[i].negative);
+        }
+    }
+    EXPECT_GT(sorter.numSpilledRuns(), 0u);
+    EXPECT_LT(sorter.numSpilledRuns(), sorter.numRuns());
+    CurveMetrics curve = sorter.curve();
+    EXPECT_NEAR(curve.auc, exact, 1e-9);
+    EXPECT_DOUBLE_EQ(curve.aucError, histogram.curve().aucError);
+    EXPECT_NEAR(curve.prAuc, histogram.curve().prAuc, 1e-9);
+}
+TEST(scoreMetricsTest, sorterSumsTiesInDouble)
+{
+    // tie groups past 2^24, where a float sum stops counting single rows
+    const double big = 1 << 24;
+    vector<Row> data;
+    Row high = {0.9, big, 1};
+    Row low = {0.1, 1, big};
+    for (int i = 0; i < 3; ++i)
+    {
+        data.push_back(high);
+        data.push_back(low);
+    }
+    Row one = {0.9, 1, 0};
+    data.push_back(one);
+    ScoreSorter sorter;
+    {
+        ScoreSorter::Writer writer(sorter);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            writer.add(data[i].score, data[i].positive, data[i].negative);
+        }
+    }
+    EXPECT_DOUBLE_EQ(sorter.curve().auc, pairAuc(data));
+}
+TEST(scoreMetricsTest, groups)
+{
+    GroupMetrics groups(1000);
+    GroupMetrics other(1000);
+    // q1 is ordered perfectly, q2 backwards, q3 has a single outcome
+    groups.add("q1", 0.9, 1, 0);
+    groups.add("q1", 0.1, 0, 1);
+    other.add("q1", 0.5, 1, 1);
+    groups.add("q2", 0.2, 1, 0);
+    groups.add("q2", 0.7, 0, 1);
+    other.add("q3", 0.3, 0, 5);
+    groups.merge(other);
+    EXPECT_EQ(groups.numGroups(), 3u);
+    double error = 0;
+    // q1: 3.5 of 4 pairs with weight 4, q2: 0 with weight 2
+    EXPECT_NEAR(groups.groupAuc(&error), (4 * 0.875 + 2 * 0) / 6, 1e-12);
+    EXPECT_NEAR(error, 4 * 0.125 / 6, 1e-12);
+    FILE* file = tmpfile();
+    groups.write(file);
+    rewind(file);
+    char line[256];
+    ASSERT_TRUE(fgets(line, sizeof(line), file) != NULL);
+    EXPECT_EQ(strncmp(line, "q1\t4\t2\t0.875000\t", 16), 0);
+    fclose(file);
+}
+TEST(scoreMetricsTest, parseDouble)
+{
+    const char* text = "  0.125\t-3 1e-3 +2.5E2 12345678901234567890 .5 x";
+    const char* end = text + strlen(text);
+    const char* p = text;
+    double expected[] = {0.125, -3, 1e-3, 250, 12345678901234567890.0, 0.5};
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i)
+    {
+        double value = 0;
+        p = parseDouble(p, end, value);
+        ASSERT_TRUE(p != NULL);
+        EXPECT_DOUBLE_EQ(value, expected[i]);
+    }
+    double value = 0;
+    EXPECT_TRUE(parseDouble(p, end, value) == NULL);
+    EXPECT_TRUE(parseDouble(end, end, value) == NULL);
+    const char* nan = "nan";
+    EXPECT_TRUE(parseDouble(nan, nan + 3, value) == nan + 3);
+    EXPECT_TRUE(value != value);
+}
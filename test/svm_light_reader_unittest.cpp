@@ -0,0 +1,79 @@
+#include <svm_light_reader.h>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "dataset.h"
+#include "feature_hasher.h"
+#include "instance_interface.h"
+#include "attribute_container_interface.h"
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+static void writeText(const string& path, const string& text)
+{
+    ofstream out(path.c_str(), ios::binary);
+    out.write(text.data(), text.size());
+}
+TEST(SvmLightReader, rows)
+{
+    writeText("svm_light.data", "2 3:1 7:2.5\n\n1\t3:4 \r\n3 9:1\n");
+    auto_ptr<DataSet> dataset(readSvmLight("svm_light.data"));
+    ASSERT_TRUE(dataset.get() != NULL);
+    ASSERT_EQ(dataset->numInstances(), 3);
+    // the target and features 3, 7 and 9, each once
+    EXPECT_EQ(dataset->getAttributeContainer()->size(), 4u);
+    IInstance* first = dataset->instanceAt(0);
+    EXPECT_EQ(first->targetIndex(), 0);
+    EXPECT_EQ(first->targetValue(), 1);
+    EXPECT_EQ(first->numValues(), 3);
+    EXPECT_EQ(first->getValue(7), 2.5);
+    EXPECT_EQ(dataset->instanceAt(1)->targetValue(), 0);
+    EXPECT_EQ(dataset->instanceAt(1)->getValue(3), 4);
+    EXPECT_EQ(dataset->instanceAt(2)->targetValue(), 2);
+
+    // bayes_msg_passing shifts its features down by one, feature 1 would be the target
+    writeText("svm_light.data", "2 1:5 3:1 7:2.5\n");
+    dataset.reset(readSvmLight("svm_light.data", -1));
+    EXPECT_EQ(dataset->instanceAt(0)->numValues(), 3);
+    EXPECT_EQ(dataset->instanceAt(0)->targetValue(), 1);
+    EXPECT_EQ(dataset->instanceAt(0)->getValue(6), 2.5);
+
+    writeText("svm_light.data", "1 3:1 x:2\n");
+    EXPECT_THROW(readSvmLight("svm_light.data"), runtime_error);
+    writeText("svm_light.data", "1 3:1 4:\n");
+    EXPECT_THROW(readSvmLight("svm_light.data"), runtime_error);
+    remove("svm_light.data");
+    EXPECT_TRUE(readSvmLight("svm_light.data") == NULL);
+}
+TEST(SvmLightReader, hashed)
+{
+    writeText("svm_light.data", "1 3:1 7:2\n2 3:1 1000000:1\n");
+    FeatureHasher hasher(4);
+    auto_ptr<DataSet> dataset(readSvmLight("svm_light.data", 0, &hasher));
+    remove("svm_light.data");
+    ASSERT_TRUE(dataset.get() != NULL);
+    ASSERT_EQ(dataset->numInstances(), 2);
+    // the rows as the hasher merges them, bucket b at attribute b + 1
+    int ids[2][2] = {{3, 7}, {3, 1000000}};
+    ValueType raw[2][2] = {{1, 2}, {1, 1}};
+    for (int i = 0; i < 2; ++i)
+    {
+        vector<FeatureHasher::HashedFeature> hashed;
+        hasher.add(ids[i][0], raw[i][0], hashed);
+        hasher.add(ids[i][1], raw[i][1], hashed);
+        vector<int> indices(1, 0);
+        vector<ValueType> values(1, i);
+        FeatureHasher::finish(hashed, indices, values, 1);
+        IInstance* instance = dataset->instanceAt(i);
+        ASSERT_EQ(instance->numValues(), (int)indices.size());
+        for (int local = 0; local < instance->numValues(); ++local)
+        {
+            EXPECT_EQ(instance->attributeIndex(local), indices[local]);
+            EXPECT_EQ(instance->getValueArray()[local], values[local]);
+        }
+    }
+    EXPECT_LE(dataset->getAttributeContainer()->size(), 5u);
+}
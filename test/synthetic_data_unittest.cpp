@@ -0,0 +1,143 @@
+#include <synthetic_data.h>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "decision_tree.h"
+#include "attribute_spec.h"
+#include "dataset.h"
+#include "io/text_parser.h"
+#include "gtest/gtest.h"
+using namespace mlplus;
+using namespace std;
+static void writeText(const string& path, const string& text)
+{
+    ofstream out(path.c_str(), ios::binary);
+    out.write(text.data(), text.size());
+}
+TEST(syntheticDataTest, deterministic)
+{
+    DenseDataSpec dense;
+    SparseDataSpec sparse;
+    string a, b, c;
+    SyntheticDataGenerator(7).appendDenseRows(dense, 0, 200, a);
+    SyntheticDataGenerator(7).appendDenseRows(dense, 0, 200, b);
+    SyntheticDataGenerator(8).appendDenseRows(dense, 0, 200, c);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    a.clear();
+    b.clear();
+    SyntheticDataGenerator(7).appendSparseRows(sparse, 0, 200, a);
+    SyntheticDataGenerator(7).appendSparseRows(sparse, 0, 200, b);
+    EXPECT_EQ(a, b);
+}
+TEST(syntheticDataTest, chunksJoin)
+{
+    DenseDataSpec dense;
+    SparseDataSpec sparse;
+    SyntheticDataGenerator generator(38);
+    string whole, parts;
+    generator.appendDenseRows(dense, 0, 1000, whole);
+    generator.appendDenseRows(dense, 0, 123, parts);
+    generator.appendDenseRows(dense, 123, 877, parts);
+    EXPECT_EQ(whole, parts);
+    whole.clear();
+    parts.clear();
+    generator.appendSparseRows(sparse, 0, 1000, whole);
+    generator.appendSparseRows(sparse, 0, 500, parts);
+    generator.appendSparseRows(sparse, 500, 500, parts);
+    EXPECT_EQ(whole, parts);
+}
+TEST(syntheticDataTest, zipf)
+{
+    ZipfDistribution zipf(1000, 1.0);
+    SplitMix64 random(1);
+    vector<int> counts(1001, 0);
+    for (int i = 0; i < 100000; ++i)
+    {
+        uint32_t k = zipf(random);
+        ASSERT_GE(k, 1u);
+        ASSERT_LE(k, 1000u);
+        ++counts[k];
+    }
+    // P(1) / P(2) is 2 for exponent 1, and the head outweighs the tail
+    EXPECT_NEAR(counts[1] / (double)counts[2], 2.0, 0.2);
+    EXPECT_GT(counts[1], counts[10] * 5);
+    EXPECT_GT(counts[1], 100000 / 10);
+}
+TEST(syntheticDataTest, sparseRows)
+{
+    SparseDataSpec spec;
+    spec.classes = 3;
+    spec.features = 500;
+    string text;
+    SyntheticDataGenerator(38).appendSparseRows(spec, 0, 100, text);
+    istringstream in(text);
+    string line;
+    int rows = 0;
+    while (getline(in, line))
+    {
+        ++rows;
+        istringstream fields(line);
+        int label = 0;
+        fields >> label;
+        EXPECT_GE(label, 1);
+        EXPECT_LE(label, 3);
+        string pair;
+        int last = 0;
+        while (fields >> pair)
+        {
+            int id = 0, count = 0;
+            ASSERT_EQ(sscanf(pair.c_str(), "%d:%d", &id, &count), 2);
+            EXPECT_GT(id, last);
+            EXPECT_LE(id, 500);
+            EXPECT_GE(count, 1);
+            last = id;
+        }
+    }
+    EXPECT_EQ(rows, 100);
+}
+TEST(syntheticDataTest, denseParses)
+{
+    DenseDataSpec spec;
+    spec.classes = 3;
+    spec.numeric = 4;
+    spec.nominal = 2;
+    spec.nominalValues = 5;
+    spec.implicit = 2;
+    ostringstream names;
+    SyntheticDataGenerator::writeNames(spec, names);
+    string rows;
+    SyntheticDataGenerator(38).appendDenseRows(spec, 0, 300, rows);
+    writeText("synthetic.names", names.str());
+    writeText("synthetic.data", rows);
+    std::auto_ptr<TextParser> parser(new TextParser("synthetic.names"));
+    std::auto_ptr<DataSet> dataset(parser->readData("synthetic.data"));
+    EXPECT_EQ(dataset->numInstances(), 300);
+    EXPECT_EQ(dataset->targetIndex(), 0);
+    EXPECT_EQ(dataset->numTargets(), 3);
+    // the target, the numeric and nominal columns, and the implicit attributes
+    EXPECT_EQ(dataset->numAttributes(), 1 + 4 + 2 + 2);
+
+    TreeModelSpec model;
+    model.trees = 3;
+    model.depth = 4;
+    ostringstream trees;
+    SyntheticDataGenerator(38).writeBoostedTrees(spec, model, trees);
+    istringstream in(trees.str());
+    BoostDecisionTree boost;
+    ASSERT_TRUE(boost.read(in, parser->getAttributeSpec()));
+    EXPECT_EQ(boost.numTree(), 3);
+    float* confidence = new float[spec.classes];
+    for (int i = 0; i < dataset->numInstances(); ++i)
+    {
+        int klass = boost.classify(dataset->instanceAt(i), &confidence);
+        EXPECT_GE(klass, 0);
+        EXPECT_LT(klass, 3);
+    }
+    delete [] confidence;
+    remove("synthetic.names");
+    remove("synthetic.data");
+}
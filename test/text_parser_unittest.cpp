@@ -19,14 +19,14 @@ TEST(textParserText, smock) {
     EXPECT_EQ(pData->numInstances(),2696); 
     float f[] = {1,351,1.02366,3,7.64E-12,117,115,1.939192,62.7151,350.7265,0.1055139};
     IInstance* first = pData->instanceAt(0);
-    const vector<ValueType>& values =  first->getValueArray();
+    const ValueArray& values =  first->getValueArray();
     EXPECT_EQ(values.size() ,11u); 
     for (unsigned i = 0; i < values.size(); ++i)
     {
         EXPECT_EQ(values[i] ,f[i]); 
     }
     IInstance* last = pData->instanceAt(2695);
-    const vector<ValueType>& v2 =  last->getValueArray();
+    const ValueArray& v2 =  last->getValueArray();
     EXPECT_EQ(v2.size() ,11u); 
     float l[] = {0,0,0.96331,0,4.48E-12,1,0,0.0625,0,14,0};
     for (unsigned i = 0; i < v2.size(); ++i)
@@ -0,0 +1,71 @@
+#include <thread_pool.h>
+#include <stdexcept>
+#include <vector>
+#include "gtest/gtest.h"
+using namespace std;
+using namespace mlplus;
+class SumTask : public Runnable
+{
+public:
+    SumTask(BoundedQueue<int>& queue, long& total, Mutex& mutex):
+        mQueue(queue), mTotal(total), mMutex(mutex) {}
+    void run()
+    {
+        int value;
+        long sum = 0;
+        while (mQueue.pop(value))
+        {
+            sum += value;
+        }
+        ScopedLock lock(mMutex);
+        mTotal += sum;
+    }
+private:
+    BoundedQueue<int>& mQueue;
+    long& mTotal;
+    Mutex& mMutex;
+};
+class FailingTask : public Runnable
+{
+public:
+    void run()
+    {
+        throw std::invalid_argument("task failed");
+    }
+};
+TEST(ThreadPool, ProducerConsumers){
+    ThreadPool pool(4);
+    EXPECT_EQ(4, pool.size());
+    BoundedQueue<int> queue(3);
+    long total = 0;
+    Mutex mutex;
+    vector<SumTask*> tasks;
+    for (int i = 0; i < pool.size(); ++i)
+    {
+        tasks.push_back(new SumTask(queue, total, mutex));
+        pool.submit(tasks.back());
+    }
+    for (int i = 1; i <= 10000; ++i)
+    {
+        EXPECT_TRUE(queue.push(i));
+    }
+    queue.close();
+    EXPECT_FALSE(queue.push(0));
+    pool.wait();
+    EXPECT_EQ(50005000, total);
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        delete tasks[i];
+    }
+}
+TEST(ThreadPool, RethrowsTaskError){
+    ThreadPool pool(2);
+    FailingTask task;
+    pool.submit(&task);
+    EXPECT_THROW(pool.wait(), std::runtime_error);
+    pool.submit(&task);
+    pool.submit(&task);
+    EXPECT_THROW(pool.wait(), std::runtime_error);
+    pool.wait();
+    EXPECT_GE(ThreadPool::hardwareThreads(), 1);
+}
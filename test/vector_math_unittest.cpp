@@ -0,0 +1,79 @@
+#include <vector_math.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "gtest/gtest.h"
+using namespace std;
+using namespace mlplus;
+TEST(VectorMath, FastExpBoundedError){
+    for (double x = -700; x < 709; x += 0.37)
+    {
+        EXPECT_LT(fabs(fastExp(x) / exp(x) - 1), 1e-9) << x;
+    }
+    EXPECT_EQ(0, fastExp(-numeric_limits<double>::infinity()));
+    EXPECT_EQ(numeric_limits<double>::infinity(), fastExp(800));
+    EXPECT_TRUE(isnan(fastExp(NAN)));
+    EXPECT_EQ(1, fastExp(0));
+}
+TEST(VectorMath, FastLogBoundedError){
+    for (double x = 1e-300; x < 1e300; x *= 1.7)
+    {
+        EXPECT_LT(fabs(fastLog(x) - log(x)), 1e-10) << x;
+    }
+    EXPECT_LT(fabs(fastLog(1e-310) - log(1e-310)), 1e-10);
+    EXPECT_EQ(-numeric_limits<double>::infinity(), fastLog(0));
+    EXPECT_TRUE(isnan(fastLog(-1)));
+}
+TEST(VectorMath, ArraysMatchScalar){
+    double in[] = {-1000, -3.5, -0.25, 0, 0.5, 2, 30, 700, -INFINITY};
+    int n = sizeof(in) / sizeof(double);
+    double out[9];
+    expArray(in, out, n);
+    for (int i = 0; i < n; ++i)
+    {
+        EXPECT_EQ(fastExp(in[i]), out[i]) << i;
+    }
+    sigmoid(in, out, n);
+    for (int i = 0; i < n; ++i)
+    {
+        EXPECT_NEAR(1 / (1 + exp(-in[i])), out[i], 1e-9) << i;
+    }
+}
+TEST(VectorMath, SoftmaxIsStable){
+    vector<double> score(1001);
+    for (unsigned i = 0; i < score.size(); ++i)
+    {
+        score[i] = -1e4 + i * 0.01;
+    }
+    double lse = logSumExp(&score[0], score.size());
+    double expected = score.back() + log(1 / (1 - exp(-0.01)) - exp(-10.01) / (1 - exp(-0.01)));
+    EXPECT_NEAR(expected, lse, 1e-8);
+    vector<double> prob(score.size());
+    softmax(&score[0], &prob[0], score.size());
+    double sum = 0;
+    for (unsigned i = 0; i < prob.size(); ++i)
+    {
+        EXPECT_NEAR(exp(score[i] - lse), prob[i], 1e-9);
+        sum += prob[i];
+    }
+    EXPECT_NEAR(1, sum, 1e-9);
+    double odd[] = {-INFINITY, 0, log(3.0)};
+    softmax(odd, odd, 3);
+    EXPECT_EQ(0, odd[0]);
+    EXPECT_NEAR(0.25, odd[1], 1e-9);
+    EXPECT_NEAR(0.75, odd[2], 1e-9);
+}
+TEST(VectorMath, SelectTopK){
+    double score[] = {0.5, 3, NAN, -1, 3, 7, 2};
+    vector<pair<int, double> > top;
+    selectTopK(score, 7, 3, top);
+    ASSERT_EQ(3u, top.size());
+    EXPECT_EQ(5, top[0].first);
+    EXPECT_EQ(1, top[1].first);
+    EXPECT_EQ(4, top[2].first);
+    selectTopK(score, 7, 10, top);
+    ASSERT_EQ(7u, top.size());
+    EXPECT_EQ(2, top.back().first);
+    selectTopK(score, 7, 0, top);
+    EXPECT_TRUE(top.empty());
+}
@@ -1,34 +1,24 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
-#include <string.h>
-#include <vector>
+#include "score_metrics.h"
+#include "thread_pool.h"
+#include <boost/program_options.hpp>
+#include <cstdio>
+#include <cctype>
+#include <cstring>
 #include <iostream>
-#include <algorithm>
-#define debug 0
-static const int MAX_ITEMS = 100000;
-static const float eps = 1.0e-10;
+#include <memory>
+#include <string>
+#include <vector>
 using namespace std;
-/* 
-
-   A typical ROC curve for reasonably accurate predictions looks 
-   like this:
+namespace po = boost::program_options;
+using namespace mlplus;
+/*
+   Evaluates the predictions of a click log, one row per line:
 
-   |                                   *
-   S   |                         *        
-   E   |                 *
-   N   |           *
-   S   |               
-   I   |       *  
-   T   |       
-   I   |    *
-   V   |    
-   I   |  *
-   T   |  
-   Y   |*
-   - - - - - - - - - - - - - - - - - - - 
-   1 - SPECIFICITY
+       pred pv click [group]
 
+   pred is the predicted click probability of pv impressions with click
+   clicks, group an optional query or slice key. With a single prediction per
+   impression pv is 1 and click the 0/1 label.
 
    MODEL PREDICTION
 
@@ -40,134 +30,342 @@ using namespace std;
    - - - + - - - - - - - - - - - + - - - - -
    |      A+C     B+D      |  A+B+C+D
 
-
-   1 = POSITIVE
-   0 = NEGATIVE
-
-
    ACC = (A+D) /(A+B+C+D)
-   PPV = A / (A+C)
-   NPV = D / (B+D)
-   SEN = A / (A+B)
-   SPE = D / (C+D)
-
 
+   The input is streamed in blocks to --threads workers, each filling its own
+   accumulators, which are merged at the end, so the memory does not grow with
+   the rows. ROC and PR area are exact, from an external merge sort of the
+   scores that keeps --memory_mb of sorted runs in memory and spills the
+   rest. With --approximate they come from a --bins score histogram instead,
+   in fixed memory, with a bound on the ROC error.
 */
-struct Instance
+struct Options
+{
+    double threshold;
+    int bins;
+    bool exact;
+    bool groups;
+    int groupBins;
+};
+
+/**
+ * the accumulators of one worker
+ */
+class Evaluator
 {
-    float pos;
-    float neg;
-    float pred;
-    Instance(float a=0.0f, float b=0.0f, float c=0.0f):pos(a),neg(b), pred(c){}
-    friend bool operator< (const Instance& a, const Instance& b)
-    {   
-         return a.pred < b.pred; 
+public:
+    Evaluator(const Options& options, ScoreSorter* sorter):
+        mOptions(options),
+        mMetrics(options.threshold),
+        mHistogram(options.bins),
+        mGroups(options.groupBins, options.threshold),
+        mWriter(sorter ? new ScoreSorter::Writer(*sorter) : NULL),
+        mRows(0),
+        mMalformed(0)
+    {
+    }
+    /**
+     * @brief the complete lines of a block
+     */
+    void parse(const char* p, const char* end)
+    {
+        while (p < end)
+        {
+            const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+            if (eol == NULL)
+            {
+                eol = end;
+            }
+            parseLine(p, eol);
+            p = eol + 1;
+        }
+    }
+    void merge(Evaluator& other)
+    {
+        mMetrics.merge(other.mMetrics);
+        mHistogram.merge(other.mHistogram);
+        mGroups.merge(other.mGroups);
+        mRows += other.mRows;
+        mMalformed += other.mMalformed;
+    }
+    void flush()
+    {
+        if (mWriter.get() != NULL)
+        {
+            mWriter->flush();
+        }
+    }
+    const BinaryMetrics& metrics() const {return mMetrics;}
+    const ScoreHistogram& histogram() const {return mHistogram;}
+    const GroupMetrics& groups() const {return mGroups;}
+    uint64_t rows() const {return mRows;}
+    uint64_t malformed() const {return mMalformed;}
+private:
+    static bool blank(const char* p, const char* eol)
+    {
+        for (; p < eol; ++p)
+        {
+            if (!isspace(*p))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    void parseLine(const char* line, const char* eol)
+    {
+        double pred = 0, pv = 0, click = 0;
+        const char* p = line;
+        if ((p = parseDouble(p, eol, pred)) == NULL || (p = parseDouble(p, eol, pv)) == NULL ||
+            (p = parseDouble(p, eol, click)) == NULL)
+        {
+            mMalformed += !blank(line, eol);
+            return;
+        }
+        double positive = click;
+        double negative = pv - click;
+        ++mRows;
+        mMetrics.add(pred, positive, negative);
+        mHistogram.add(pred, positive, negative);
+        if (mWriter.get() != NULL)
+        {
+            mWriter->add(pred, positive, negative);
+        }
+        if (mOptions.groups)
+        {
+            while (p < eol && (*p == ' ' || *p == '\t'))
+            {
+                ++p;
+            }
+            const char* key = p;
+            while (p < eol && *p != ' ' && *p != '\t' && *p != '\r')
+            {
+                ++p;
+            }
+            mKey.assign(key, p);
+            mGroups.add(mKey, pred, positive, negative);
+        }
     }
+    const Options& mOptions;
+    BinaryMetrics mMetrics;
+    ScoreHistogram mHistogram;
+    GroupMetrics mGroups;
+    auto_ptr<ScoreSorter::Writer> mWriter;
+    string mKey;
+    uint64_t mRows;
+    uint64_t mMalformed;
+};
+
+struct Block
+{
+    vector<char> text;
+    size_t size;
 };
-double accuracy(vector<Instance>& cases, double threshold)
+
+class EvaluateTask : public Runnable
 {
-    int no_item = cases.size();
-    float a,b,c,d;
-    int item;
-    a = 0; b = 0; c = 0; d = 0;
-    for (item=0; item<no_item; item++)
-    {
-            if (cases[item].pred >= threshold )
-                a+=cases[item].pos;
-            else
-                b+=cases[item].pos;
-            if (cases[item].pred>= threshold )
-                c+=cases[item].neg;
-            else
-                d+=cases[item].neg;
+public:
+    EvaluateTask(Evaluator& evaluator, BoundedQueue<Block*>& input, BoundedQueue<Block*>& recycle):
+        mEvaluator(evaluator), mInput(input), mRecycle(recycle)
+    {
     }
-    return( ((double)(a+d)) / (((double)(a+b+c+d)) + eps) );
-}
+    /*override*/ void run()
+    {
+        Block* block = NULL;
+        while (mInput.pop(block))
+        {
+            mEvaluator.parse(&block->text[0], &block->text[0] + block->size);
+            mRecycle.push(block);
+        }
+        mEvaluator.flush();
+    }
+private:
+    Evaluator& mEvaluator;
+    BoundedQueue<Block*>& mInput;
+    BoundedQueue<Block*>& mRecycle;
+};
 
-int main (int argc, char**argv)
+int main(int argn, char** args)
 {
-    int plot = false;
-    float no_item = 0;
-    float mean_true = 0.0;
-    float mean_pred = 0.0;
-    float sse = 0.0;
-    float pos = 0;
-    float neg = 0;
-    float p1 = 0;
-    vector<Instance> cases;
-    cases.reserve(10000);
-    float pv, click;
-    while (cin >> p1 >> pv >> click) 
-    {
-       /* Note that unlike the rest of the code, the RMSE calculation 
-         assumes the class is 0 or 1 and that the probabilities 
-         probably have been correctly normalized.
-       */
-        pos = click; //pv , click
-        neg = pv - click;
-        sse+= pos * (1-p1)*(1-p1) + neg * p1 * p1;
-        mean_true+= pos + neg;
-        mean_pred+= pos * p1 + neg * p1;
-        no_item += pos + neg;
-        cases.push_back(Instance(pos, neg, p1));
-    }
-    mean_true = mean_true / ((double) no_item);
-    mean_pred = mean_pred / ((double) no_item);
-    float rmse = sqrt (sse / ((double) no_item));
-    if (debug)
-    {
-        printf("%d pats read. mean_true %6.4lf. mean_pred %6.4lf\n", cases.size(), mean_true, mean_pred);
-        fflush(stdout);
+    string input = "-";
+    int threads = 0;
+    int blockKb = 4096;
+    int memoryMb = 1024;
+    int calibration = 0;
+    string tempDir;
+    string groupOutput;
+    Options options;
+    options.threshold = 0.5;
+    options.bins = 65536;
+    bool approximate = false;
+    options.groups = false;
+    options.groupBins = 1000;
+    po::options_description desc("Allowed options for [auc]");
+    desc.add_options()("help,h", "message:")
+        ("input,i", po::value<string>(&input), "click log of \"pred pv click [group]\" lines, - reads stdin")
+        ("threads,j", po::value<int>(&threads), "parser threads, 0 uses every processor")
+        ("block_kb", po::value<int>(&blockKb), "input handed to a thread at a time")
+        ("threshold", po::value<double>(&options.threshold), "predictions at or above count as positive for ACC")
+        ("approximate", po::bool_switch(&approximate), "ROC and PR area from a score histogram, no sort")
+        ("bins", po::value<int>(&options.bins), "approximate: score histogram bins")
+        ("exact", "exact ROC and PR area by an external sort of the scores, the default")
+        ("memory_mb", po::value<int>(&memoryMb), "exact: sorted runs kept in memory before spilling")
+        ("temp_dir", po::value<string>(&tempDir), "exact: directory of the spilled runs")
+        ("calibration", po::value<int>(&calibration), "print a reliability table of this many score buckets")
+        ("group", po::bool_switch(&options.groups), "the 4th column is a group key, print the weighted group AUC")
+        ("group_bins", po::value<int>(&options.groupBins), "score bins of the per group ROC area")
+        ("group_output", po::value<string>(&groupOutput), "write the metrics of every group to this file");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argn, args, desc), vm);
+    po::notify(vm);
+    if (vm.count("help"))
+    {
+        cout << desc << endl;
+        return 1;
+    }
+    options.exact = !approximate;
+    FILE* in = input == "-" ? stdin : fopen(input.c_str(), "rb");
+    if (in == NULL)
+    {
+        cerr << "cannot open " << input << endl;
+        return 1;
     }
 
-    float total_true_0 = 0;
-    float total_true_1 = 0;
-    for (int item=0; item<cases.size(); item++)
+    ThreadPool pool(threads);
+    size_t blockSize = (size_t)(blockKb > 0 ? blockKb : 1) * 1024;
+    auto_ptr<ScoreSorter> sorter;
+    if (options.exact)
+    {
+        size_t memory = (size_t)(memoryMb > 0 ? memoryMb : 1) << 20;
+        // a run per worker and block, so the sorted runs are what fills the memory
+        sorter.reset(new ScoreSorter(memory, blockSize / 16 + 1, tempDir));
+    }
+    vector<Evaluator*> evaluators;
+    vector<EvaluateTask*> tasks;
+    vector<Block> blocks(pool.size() * 2);
+    BoundedQueue<Block*> freeBlocks(blocks.size());
+    BoundedQueue<Block*> parseQueue(blocks.size());
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        blocks[i].text.resize(blockSize);
+        freeBlocks.push(&blocks[i]);
+    }
+    for (int i = 0; i < pool.size(); ++i)
     {
-        total_true_0+=cases[item].neg;
-        total_true_1+=cases[item].pos;
+        evaluators.push_back(new Evaluator(options, sorter.get()));
+        tasks.push_back(new EvaluateTask(*evaluators.back(), parseQueue, freeBlocks));
+        pool.submit(tasks.back());
     }
-    /* sort data by predicted value */
-    sort(cases.begin(), cases.end());
-    /* now let's do the ROC cruve and area */
 
-    float tp = 0; 
-    float fn = total_true_1; 
-    float fp = 0; 
-    float tn = total_true_0;
+    // blocks end at a line end, the partial line moves on to the next block
+    string carry;
+    Block* block = NULL;
+    while (freeBlocks.pop(block))
+    {
+        if (carry.size() >= blockSize)
+        {
+            blockSize = carry.size() * 2;
+        }
+        if (block->text.size() < blockSize)
+        {
+            block->text.resize(blockSize);
+        }
+        memcpy(&block->text[0], carry.data(), carry.size());
+        size_t size = carry.size() + fread(&block->text[carry.size()], 1, block->text.size() - carry.size(), in);
+        bool last = size < block->text.size();
+        size_t end = size;
+        if (!last)
+        {
+            while (end > 0 && block->text[end - 1] != '\n')
+            {
+                --end;
+            }
+        }
+        carry.assign(&block->text[0] + end, size - end);
+        block->size = end;
+        parseQueue.push(block);
+        if (last)
+        {
+            break;
+        }
+    }
+    parseQueue.close();
+    try
+    {
+        pool.wait();
+    }
+    catch (const exception& e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    if (in != stdin)
+    {
+        fclose(in);
+    }
 
-    float tpr  = ((double) tp) / ((double) (tp+fn));
-    float fpr = ((double) fp) / ((double) (fp+tn));
-    if (plot)
-        printf ("%6.4lf %6.4lf\n", fpr, tpr);
-    float roc_area = 0.0;
-    float tpr_prev = tpr;
-    float fpr_prev = fpr;
-    for (int item=cases.size()-1; item>-1; item--)
-    {
-        tp += cases[item].pos;  //true positive
-        fn -= cases[item].pos;  //false negtive
-        fp += cases[item].neg;  //false positive
-        tn -= cases[item].neg;  
-        tpr = ((double) tp) / ((double) (tp+fn));
-        fpr  = ((double) fp) / ((double) (tn+fp));
-        if ( item > 0 )
-            if (cases[item].pred!= cases[item-1].pred)
+    Evaluator& total = *evaluators[0];
+    for (size_t i = 1; i < evaluators.size(); ++i)
+    {
+        total.merge(*evaluators[i]);
+    }
+    if (total.malformed() > 0)
+    {
+        cerr << "skipped " << total.malformed() << " malformed lines" << endl;
+    }
+    const BinaryMetrics& metrics = total.metrics();
+    CurveMetrics curve = sorter.get() ? sorter->curve() : total.histogram().curve();
+    printf("ACC %8.5lf\n", metrics.accuracy());
+    printf("RMS %8.5lf\n", metrics.rmse());
+    printf("ROC %8.5lf\n", curve.auc);
+    if (sorter.get() == NULL)
+    {
+        printf("ROC_ERR %8.5lf\n", curve.aucError);
+    }
+    printf("PR %8.5lf\n", curve.prAuc);
+    printf("LOGLOSS %8.5lf\n", metrics.logLoss());
+    printf("ROWS %llu\n", (unsigned long long)total.rows());
+    printf("WEIGHT %.0lf\n", metrics.weight());
+    printf("MEAN_TRUE %8.5lf\n", metrics.meanOutcome());
+    printf("MEAN_PRED %8.5lf\n", metrics.meanScore());
+    if (options.groups)
+    {
+        double error = 0;
+        double gauc = total.groups().groupAuc(&error);
+        printf("GROUPS %lu\n", (unsigned long)total.groups().numGroups());
+        printf("GAUC %8.5lf\n", gauc);
+        printf("GAUC_ERR %8.5lf\n", error);
+        if (!groupOutput.empty())
+        {
+            FILE* out = fopen(groupOutput.c_str(), "w");
+            if (out == NULL)
+            {
+                cerr << "cannot open " << groupOutput << endl;
+            }
+            else
             {
-                if ( plot )
-                    printf ("%6.4lf %6.4lf\n", fpr, tpr);
-                roc_area+= 0.5*(tpr+tpr_prev)*(fpr-fpr_prev);
-                tpr_prev = tpr;
-                fpr_prev = fpr;
+                fprintf(out, "group\tweight\tpositives\tauc\tlogloss\tmean_pred\tmean_true\n");
+                total.groups().write(out);
+                fclose(out);
             }
-        if ( item == 0 )
+        }
+    }
+    if (calibration > 0)
+    {
+        vector<ScoreBin> buckets;
+        total.histogram().calibration(calibration, buckets);
+        printf("CAL low high weight mean_pred mean_true\n");
+        for (size_t i = 0; i < buckets.size(); ++i)
         {
-            if ( plot )
-                printf ("%6.4lf %6.4lf\n", fpr, tpr);
-            roc_area+= 0.5*(tpr+tpr_prev)*(fpr-fpr_prev);
+            double weight = buckets[i].positive + buckets[i].negative;
+            printf("CAL %.4f %.4f %.0f %.6f %.6f\n", (double)i / buckets.size(), (double)(i + 1) / buckets.size(),
+                   weight, weight > 0 ? buckets[i].scoreSum / weight : 0, weight > 0 ? buckets[i].positive / weight : 0);
         }
     }
-    printf ("ACC %8.5lf\n", accuracy(cases, 0.5));
-    printf ("RMS %8.5lf\n", rmse);
-    printf ("ROC %8.5lf\n", roc_area);
+    for (size_t i = 0; i < evaluators.size(); ++i)
+    {
+        delete tasks[i];
+        delete evaluators[i];
+    }
+    return 0;
 }
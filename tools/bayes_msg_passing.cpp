@@ -1,17 +1,16 @@
 #include "bayes_message_passing.h"
 #include "dataset.h"
-#include "attribute_container.h"
-#include "instance_container.h"
-#include <boost/algorithm/string.hpp>
-#include <boost/tokenizer.hpp>
-#include <boost/lexical_cast.hpp>
+#include "feature_hasher.h"
+#include "svm_light_reader.h"
+#include "iterator_interface.h"
+#include "evaluation.h"
 #include <boost/program_options.hpp>
 #include <fstream>
 #include <algorithm>
 #include <iostream>
 #include <iterator>
+#include <memory>
 using namespace std;
-using namespace boost;
 namespace po = boost::program_options;
 using namespace mlplus;
 using namespace mlplus::estimators;
@@ -21,11 +20,15 @@ int main(int argn, char** args)
     string input_data;
     string model_file;
     bool istrain = false;
+    int hashBits = 0;
+    int hashCount = 1;
     po::options_description desc("Allowed options for [bayes_message_passing]");
     desc.add_options()("help,h", "message:")
         ("train,t", "train or classify")
         ("input_data,i", po::value<string>(&input_data), "trainning or classify data")
-        ("model_file,m", po::value<string>(&model_file), "model file name");
+        ("model_file,m", po::value<string>(&model_file), "model file name")
+        ("hash_bits,b", po::value<int>(&hashBits), "hash the features into 2^hash_bits buckets, 0 keeps the raw ids")
+        ("hash_count,c", po::value<int>(&hashCount), "number of buckets every feature is hashed to");
     po::variables_map vm;
     po::store(po::parse_command_line(argn, args, desc), vm);
     po::notify(vm); 
@@ -47,70 +50,41 @@ int main(int argn, char** args)
         cout << desc << "\n";
         return 1;
     }
-    string str;
-    ifstream ifs(input_data.c_str());
-    IAttributeContainer* attributes = new MapAttributeContainer();
-    IInstanceContainer* instances = new SparseInstanceContainer();
-    DataSet dataset("sparse_classify", attributes, instances);
-    vector<string> attributeVector;
-    IInstance* instance = NULL;
-    while(getline(ifs, str))
+    auto_ptr<FeatureHasher> hasher(hashBits > 0 ? new FeatureHasher(hashBits, hashCount) : NULL);
+    //the features are counted from 0 here
+    auto_ptr<DataSet> dataset(readSvmLight(input_data, -1, hasher.get()));
+    if (dataset.get() == NULL)
     {
-        split(attributeVector, str, is_any_of("\t "),token_compress_on);
-        vector<ValueType> values;
-        vector<int> indices;
-        for(unsigned i = 0; i < attributeVector.size(); ++i)
-        {
-            if (attributeVector[i].empty()) continue;
-            vector<string> kvs;
-            split(kvs, attributeVector[i], is_any_of(":"));
-            Attribute* target = new Attribute(kvs[0], Attribute::BINARY);//name of attribute
-            int idcs = 0;
-            ValueType value = 0;
-            if (i != 0)
-            {
-                idcs = boost::lexical_cast<int, string>(kvs[0]) - 1;
-                value = boost::lexical_cast<ValueType>(kvs.back());
-            }
-            else
-            {
-                value = boost::lexical_cast<ValueType>(kvs.back()) - 1;
-            }
-            target->setIndex(idcs);
-            attributes->add(target);
-            indices.push_back(idcs);
-            values.push_back(value);
-        }
-        instance = new SparseInstance(values, indices, 1);
-        instance->setDataset(&dataset);
-        instances->add(instance);
+        cerr << "cannot open " << input_data << endl;
+        return 1;
     }
-    dataset.setTargetIndex(0);
     BayesMsgPassing bayes("sparse_classify", 6);
 
     if (istrain) //trainning
     {
-        bayes.train(&dataset);
+        bayes.train(dataset.get());
         bayes.save(cout);
     }
     else
     {
         ifstream model(model_file.c_str());
         bayes.load(model);
-        AutoInstanceIteratorPtr instanceIt(dataset.newInstanceIterator());
-        float all = 0;
-        float right = 0;
+        AutoInstanceIteratorPtr instanceIt(dataset->newInstanceIterator());
+        ClassificationMetrics metrics(bayes.numClasses());
         while(instanceIt->hasMore())
         {
             IInstance* ins = instanceIt->next();
-            pair<int, double> v = bayes.predict(ins);
-            if (v.first == ins->targetValue())
+            //every class ranked by its score, with its probability
+            vector<pair<int, double> > ranked = bayes.predictTopK(ins, bayes.numClasses());
+            vector<double> vect(bayes.numClasses());
+            for (size_t i = 0; i < ranked.size(); ++i)
             {
-                ++right;
+                vect[ranked[i].first] = ranked[i].second;
             }
-            ++all;
-            cout << v.first << endl;
+            int predicted = ranked.empty() ? 0 : ranked[0].first;
+            metrics.add((int)ins->targetValue(), predicted, vect);
+            cout << predicted << endl;
         }
-        cerr << "Accurate:" << right/all << endl;
+        metrics.print(cerr);
     }
 }
@@ -11,6 +11,7 @@
 #include "string_utility.h"
 #include "expression.h"
 #include "decision_tree.h"
+#include "memory_accounting.h"
 using namespace mlplus;
 using namespace std;
 void bye(int argn, char** args)
@@ -30,11 +31,14 @@ int main(int argn, char** args)
     char* names = args[1];
     char* model = args[2];
 
+    memory::Phase load("load_model");
     NamesFileReader reader(names);
     AttributeSpec spec(reader);
     ifstream ifs(model);
     BoostDecisionTree tree;
     tree.read(ifs, &spec); 
+    load.end();
+    memory::Phase classify("classify");
     string line;
     vector<float> decodeValue;
     decodeValue.reserve(512);
@@ -0,0 +1,85 @@
+#include "dataset.h"
+#include "itemset_mining.h"
+#include "memory_accounting.h"
+#include "svm_light_reader.h"
+#include <boost/program_options.hpp>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+using namespace std;
+namespace po = boost::program_options;
+using namespace mlplus;
+/*
+   frequent itemsets and association rules of a basket file:
+
+       frequent_itemsets -d baskets.txt -s 0.01 -c 0.6 -j 8
+
+   A line is a transaction in the svm-light format of the sparse tools,
+   "label item:value item:value ...", read by readSvmLight. The label is
+   not an item, the items are numbered from 1 as svm-light features are,
+   and an item with a value of 0 is not in the transaction.
+   A rule is printed a line as it is found, "antecedent => consequent" then
+   the support, the confidence and the lift, tab separated. With
+   MLPLUS_MEMORY_OUTPUT=- the memory of loading and mining is reported.
+*/
+int main(int argn, char** args)
+{
+    string data;
+    double support = 0.01;
+    double confidence = 0.5;
+    int maxLength = 0;
+    int threads = 0;
+    bool itemsetsOnly = false;
+    po::options_description desc("Allowed options for [frequent_itemsets]");
+    desc.add_options()("help,h", "message:")
+        ("data,d", po::value<string>(&data), "basket file, a transaction a line")
+        ("support,s", po::value<double>(&support), "least support, a fraction of the transactions below 1")
+        ("confidence,c", po::value<double>(&confidence), "least confidence of a rule")
+        ("max_length,l", po::value<int>(&maxLength), "most items of an itemset, 0 for no limit")
+        ("threads,j", po::value<int>(&threads), "mining threads, 0 uses every processor")
+        ("itemsets", po::bool_switch(&itemsetsOnly), "print the frequent itemsets and their support, no rules");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argn, args, desc), vm);
+    po::notify(vm);
+    if (vm.count("help") || data.empty())
+    {
+        cout << desc << endl;
+        return 1;
+    }
+    memory::Phase load("load");
+    auto_ptr<DataSet> baskets(readSvmLight(data));
+    if (baskets.get() == NULL)
+    {
+        cerr << "cannot open " << data << endl;
+        return 1;
+    }
+    ItemsetMiner miner(support, maxLength, threads);
+    miner.load(baskets.get(), baskets->targetIndex());
+    baskets.reset();
+    load.end();
+    cerr << miner.numTransactions() << " transactions, " << miner.numFrequentItems()
+         << " items in at least " << miner.minSupport() << endl;
+
+    memory::Phase mine("mine");
+    vector<FrequentItemset> itemsets;
+    miner.mine(itemsets);
+    mine.end();
+    cerr << itemsets.size() << " frequent itemsets" << endl;
+    if (itemsetsOnly)
+    {
+        for (size_t i = 0; i < itemsets.size(); ++i)
+        {
+            for (size_t k = 0; k < itemsets[i].items.size(); ++k)
+            {
+                cout << (k > 0 ? " " : "") << itemsets[i].items[k];
+            }
+            cout << "\t" << itemsets[i].support << "\n";
+        }
+        return 0;
+    }
+    memory::Phase rules("rules");
+    RuleWriter writer(cout);
+    miner.rules(itemsets, confidence, writer);
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "synthetic_data.h"
+#include "thread_pool.h"
+#include <boost/program_options.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+namespace po = boost::program_options;
+using namespace mlplus;
+
+/**
+ * Rows [first, first + count) generated on a pool thread.
+ */
+class ChunkTask : public Runnable
+{
+public:
+    ChunkTask(const SyntheticDataGenerator& generator, bool dense, const DenseDataSpec& denseSpec,
+              const SparseDataSpec& sparseSpec):
+        mGenerator(generator), mDense(dense), mDenseSpec(denseSpec), mSparseSpec(sparseSpec),
+        mFirst(0), mCount(0)
+    {
+    }
+    void reset(uint64_t first, uint64_t count)
+    {
+        mFirst = first;
+        mCount = count;
+        mText.clear();
+    }
+    /*override*/ void run()
+    {
+        if (mDense)
+        {
+            mGenerator.appendDenseRows(mDenseSpec, mFirst, mCount, mText);
+        }
+        else
+        {
+            mGenerator.appendSparseRows(mSparseSpec, mFirst, mCount, mText);
+        }
+    }
+    const string& text() const
+    {
+        return mText;
+    }
+private:
+    const SyntheticDataGenerator& mGenerator;
+    bool mDense;
+    const DenseDataSpec& mDenseSpec;
+    const SparseDataSpec& mSparseSpec;
+    uint64_t mFirst;
+    uint64_t mCount;
+    string mText;
+};
+
+static void writeNames(const string& file, const DenseDataSpec& spec)
+{
+    ofstream names(file.c_str());
+    SyntheticDataGenerator::writeNames(spec, names);
+}
+
+int main(int argn, char** args)
+{
+    string kind;
+    string output;
+    uint64_t rows = 0;
+    uint64_t seed = 1;
+    int threads = 0;
+    int chunkRows = 65536;
+    DenseDataSpec dense;
+    SparseDataSpec sparse;
+    TreeModelSpec model;
+    po::options_description desc("Allowed options for [gen_data]");
+    desc.add_options()("help,h", "message:")
+        ("kind,k", po::value<string>(&kind), "dense: <output>.names and <output>.data, "
+            "sparse: svm-light <output>.samp, tree: <output>.names and a boosted C5 model <output>.tree")
+        ("output,o", po::value<string>(&output), "output file prefix, - writes the rows to stdout")
+        ("rows,r", po::value<uint64_t>(&rows), "number of rows")
+        ("seed,s", po::value<uint64_t>(&seed), "the same seed gives the same bytes")
+        ("threads,j", po::value<int>(&threads), "generator threads, 0 uses every processor")
+        ("chunk_rows", po::value<int>(&chunkRows), "rows generated by a thread at a time")
+        ("classes", po::value<int>(&dense.classes), "number of classes")
+        ("numeric", po::value<int>(&dense.numeric), "dense: numeric attributes")
+        ("nominal", po::value<int>(&dense.nominal), "dense: nominal attributes")
+        ("nominal_values", po::value<int>(&dense.nominalValues), "dense: values of every nominal attribute")
+        ("implicit", po::value<int>(&dense.implicit), "dense: implicit attributes defined by expressions")
+        ("features", po::value<uint32_t>(&sparse.features), "sparse: number of feature ids")
+        ("features_per_row", po::value<int>(&sparse.featuresPerRow), "sparse: mean features drawn per row")
+        ("zipf", po::value<double>(&sparse.zipfExponent), "sparse: exponent of the feature id distribution")
+        ("trees", po::value<int>(&model.trees), "tree: number of boosted trees")
+        ("depth", po::value<int>(&model.depth), "tree: depth of every tree");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argn, args, desc), vm);
+    po::notify(vm);
+    if (vm.count("help") || output.empty() || (kind != "dense" && kind != "sparse" && kind != "tree"))
+    {
+        cout << desc << "\n";
+        return 1;
+    }
+    if (dense.classes < 1 || dense.nominalValues < 1 || sparse.features < 1 || chunkRows < 1)
+    {
+        cerr << "classes, nominal_values, features and chunk_rows must be positive\n";
+        return 1;
+    }
+    sparse.classes = dense.classes;
+    SyntheticDataGenerator generator(seed);
+    if (kind == "tree")
+    {
+        writeNames(output + ".names", dense);
+        ofstream tree((output + ".tree").c_str());
+        generator.writeBoostedTrees(dense, model, tree);
+        return tree ? 0 : 1;
+    }
+    if (kind == "dense" && output != "-")
+    {
+        writeNames(output + ".names", dense);
+    }
+    FILE* out = stdout;
+    if (output != "-")
+    {
+        string file = output + (kind == "dense" ? ".data" : ".samp");
+        out = fopen(file.c_str(), "wb");
+        if (out == NULL)
+        {
+            cerr << "cannot open " << file << endl;
+            return 1;
+        }
+    }
+
+    ThreadPool pool(threads);
+    vector<ChunkTask*> tasks;
+    for (int i = 0; i < pool.size(); ++i)
+    {
+        tasks.push_back(new ChunkTask(generator, kind == "dense", dense, sparse));
+    }
+    // every round generates one chunk per thread, then writes them in order
+    for (uint64_t next = 0; next < rows;)
+    {
+        size_t used = 0;
+        for (; used < tasks.size() && next < rows; ++used)
+        {
+            uint64_t count = min<uint64_t>(chunkRows, rows - next);
+            tasks[used]->reset(next, count);
+            pool.submit(tasks[used]);
+            next += count;
+        }
+        pool.wait();
+        for (size_t i = 0; i < used; ++i)
+        {
+            fwrite(tasks[i]->text().data(), 1, tasks[i]->text().size(), out);
+        }
+    }
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        delete tasks[i];
+    }
+    int status = 0;
+    if (fflush(out) != 0 || ferror(out))
+    {
+        cerr << "error writing the output" << endl;
+        status = 1;
+    }
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return status;
+}
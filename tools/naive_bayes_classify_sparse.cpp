@@ -1,65 +1,34 @@
 #include "naive_bayes.h"
 #include "dataset.h"
-#include "attribute_container.h"
-#include "instance_container.h"
-#include <boost/algorithm/string.hpp>
-#include <boost/tokenizer.hpp>
-#include <boost/lexical_cast.hpp>
+#include "feature_hasher.h"
+#include "svm_light_reader.h"
+#include "iterator_interface.h"
+#include "evaluation.h"
 #include <fstream>
 #include <algorithm>
 #include <iostream>
 #include <iterator>
+#include <memory>
 using namespace std;
-using namespace boost;
 using namespace mlplus;
 using namespace mlplus::estimators;
 int main(int argn, char** args)
 {
     if (argn < 3)
     {
-        cerr << args[0] << " <model_file> <input_data>\n";
+        cerr << args[0] << " <model_file> <input_data> [hash_bits [hash_count]]\n"
+             << "hash_bits and hash_count must match the ones used for training\n";
         exit(0);
     }
-    string str;
-    ifstream ifs(args[2]);
-
-    IAttributeContainer* attributes = new MapAttributeContainer();
-    IInstanceContainer* instances = new SparseInstanceContainer();
-    DataSet dataset("sparse_classify", attributes, instances);
-    vector<string> attributeVector;
-    IInstance* instance = NULL;
-    while(getline(ifs, str))
+    int hashBits = argn > 3 ? atoi(args[3]) : 0;
+    int hashCount = argn > 4 ? atoi(args[4]) : 1;
+    auto_ptr<FeatureHasher> hasher(hashBits > 0 ? new FeatureHasher(hashBits, hashCount) : NULL);
+    auto_ptr<DataSet> dataset(readSvmLight(args[2], 0, hasher.get()));
+    if (dataset.get() == NULL)
     {
-        split(attributeVector, str, is_any_of("\t "),token_compress_on);
-        vector<ValueType> values;
-        vector<int> indices;
-        for(unsigned i = 0; i < attributeVector.size(); ++i)
-        {
-            if (attributeVector[i].empty()) continue;
-            vector<string> kvs;
-            split(kvs, attributeVector[i], is_any_of(":"));
-            Attribute* target = new Attribute(kvs[0], Attribute::BINARY);//name of attribute
-            int idcs = 0;
-            ValueType value = 0;
-            if (i != 0)
-            {
-                idcs = boost::lexical_cast<int, string>(kvs[0]);
-                value = boost::lexical_cast<ValueType, string>(kvs.back());
-            }
-            else
-            {
-                value = boost::lexical_cast<ValueType, string>(kvs.back()) - 1;
-            }
-            target->setIndex(idcs);
-            attributes->add(target);
-            indices.push_back(idcs);
-            values.push_back(value);
-        }
-        instance = new SparseInstance(values, indices, 1);
-        instance->setDataset(&dataset);
-        instances->add(instance);
+        cerr << "cannot open " << args[2] << endl;
+        return 1;
     }
-    dataset.setTargetIndex(0);
 
     ifstream model(args[1]);
     NaiveBayes bayes("sparse_classify", 6);
@@ -71,26 +40,14 @@ int main(int argn, char** args)
     //pair<int, double> v = bayes.predict(instance);
     //cout << "predict:" << v.first << " with prob: " << v.second << endl;
     //
-    AutoInstanceIteratorPtr instanceIt(dataset.newInstanceIterator());
-    float all = 0;
-    float right = 0;
+    AutoInstanceIteratorPtr instanceIt(dataset->newInstanceIterator());
+    ClassificationMetrics metrics(bayes.numClasses());
     while(instanceIt->hasMore())
     {
         IInstance* ins = instanceIt->next();
-        /*
         std::vector<double> vect = bayes.targetDistribution(ins);
-        vector<double>::const_iterator it = max_element(vect.begin(), vect.end());
-        int r = it - vect.begin();
-        cout << ins->targetValue() << " v.s " << r << " with prob: ";
-        */
-        pair<int, double> v = bayes.predict(ins);
-        if (v.first == ins->targetValue())
-        {
-            ++right;
-        }
-        ++all;
-        //copy(vect.begin(),vect.end(),ostream_iterator<double>( cout," " ));
-        cout << v.first << endl;
+        metrics.add((int)ins->targetValue(), vect);
+        cout << max_element(vect.begin(), vect.end()) - vect.begin() << endl;
     }
-    cerr << "Accurate:" << right/all << endl;
+    metrics.print(cerr);
 }
@@ -1,73 +1,40 @@
 #include "naive_bayes.h"
 #include "dataset.h"
-#include "attribute_container.h"
-#include "instance_container.h"
-#include <boost/algorithm/string.hpp>
-#include <boost/tokenizer.hpp>
-#include <boost/lexical_cast.hpp>
+#include "feature_hasher.h"
+#include "svm_light_reader.h"
+#include "memory_accounting.h"
 #include <fstream>
 #include <algorithm>
 #include <iostream>
 #include <iterator>
+#include <memory>
 using namespace std;
-using namespace boost;
 using namespace mlplus;
 using namespace mlplus::estimators;
 int main(int argn, char** args)
 {
     if (argn < 2)
     {
-        cerr << args[0] << " <input_data>\n";
+        cerr << args[0] << " <input_data> [hash_bits [hash_count]]\n"
+             << "MLPLUS_MEMORY_OUTPUT=- reports the memory of loading and training on stderr\n";
         exit(0);
     }
-    string str;
-    ifstream ifs(args[1]);
-
-    IAttributeContainer* attributes = new MapAttributeContainer();
-    IInstanceContainer* instances = new SparseInstanceContainer();
-    DataSet dataset("sparse_classify", attributes, instances);
-    vector<string> attributeVector;
-    attributeVector.reserve(100000);
-    IInstance* instance = NULL;
-    while(getline(ifs, str))
+    int hashBits = argn > 2 ? atoi(args[2]) : 0;
+    int hashCount = argn > 3 ? atoi(args[3]) : 1;
+    auto_ptr<FeatureHasher> hasher(hashBits > 0 ? new FeatureHasher(hashBits, hashCount) : NULL);
+    memory::Phase load("load");
+    auto_ptr<DataSet> dataset(readSvmLight(args[1], 0, hasher.get()));
+    if (dataset.get() == NULL)
     {
-        split(attributeVector, str, is_any_of("\t "),token_compress_on);
-        vector<ValueType> values;
-        vector<int> indices;
-        for(unsigned i = 0; i < attributeVector.size(); ++i)
-        {
-            if (attributeVector[i].empty()) continue;
-            vector<string> kvs;
-
-            split(kvs, attributeVector[i], is_any_of(":"));
-            
-            Attribute* target = new Attribute(kvs[0], Attribute::BINARY);//name of attribute
-            int idcs = 0;
-            ValueType value = 0;
-            if (i != 0)
-            {
-                idcs = boost::lexical_cast<int>(kvs[0]);
-                value = boost::lexical_cast<ValueType>(kvs.back());
-            }
-            else
-            {
-                value = boost::lexical_cast<ValueType, string>(kvs.back()) - 1;
-            }
-            target->setIndex(idcs);
-            attributes->add(target);
-            indices.push_back(idcs);
-            values.push_back(value);
-
-        }
-        instance = new SparseInstance(values, indices, 1);
-        instance->setDataset(&dataset);
-        instance->setWeight(1);
-        instances->add(instance);
+        cerr << "cannot open " << args[1] << endl;
+        return 1;
     }
-    dataset.setTargetIndex(0);
+    load.end();
+    memory::Phase train("train");
     NaiveBayes bayes("sparse_classify", 6);
     //bayes.setEventModel();
-    bayes.train(&dataset);
+    bayes.train(dataset.get());
+    train.end();
     //std::vector<double> vect = bayes.targetDistribution(instance);
     //copy(vect.begin(),vect.end(),ostream_iterator<double>( cout," " ));
     //cout << "\n";